@@ -10,6 +10,7 @@
 
 #include "audio/audio_send_stream.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -120,6 +121,8 @@ AudioSendStream::AudioSendStream(
 AudioSendStream::~AudioSendStream() {
   RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
   LOG(LS_INFO) << "~AudioSendStream: " << config_.ToString();
+  RTC_DCHECK(!shared_encoder_leader_);
+  RTC_DCHECK(shared_encoder_followers_.empty());
   transport_->send_side_cc()->DeRegisterPacketFeedbackObserver(this);
   channel_proxy_->RegisterTransport(nullptr);
   channel_proxy_->ResetSenderCongestionControlObjects();
@@ -135,6 +138,7 @@ const webrtc::AudioSendStream::Config& AudioSendStream::GetConfig() const {
 void AudioSendStream::Reconfigure(
     const webrtc::AudioSendStream::Config& new_config) {
   ConfigureStream(this, new_config, false);
+  UpdateSharedEncoders();
 }
 
 void AudioSendStream::ConfigureStream(
@@ -144,6 +148,8 @@ void AudioSendStream::ConfigureStream(
   LOG(LS_INFO) << "AudioSendStream::Configuring: " << new_config.ToString();
   const auto& channel_proxy = stream->channel_proxy_;
   const auto& old_config = stream->config_;
+  RTC_DCHECK(first_time || old_config.shared_encoder_leader_ssrc ==
+                               new_config.shared_encoder_leader_ssrc);
 
   if (first_time || old_config.rtp.ssrc != new_config.rtp.ssrc) {
     channel_proxy->SetLocalSSRC(new_config.rtp.ssrc);
@@ -244,6 +250,8 @@ void AudioSendStream::Start() {
   if (error != 0) {
     LOG(LS_ERROR) << "AudioSendStream::Start failed with error: " << error;
   }
+  sending_ = error == 0;
+  UpdateSharedEncoders();
 }
 
 void AudioSendStream::Stop() {
@@ -255,6 +263,8 @@ void AudioSendStream::Stop() {
   if (error != 0) {
     LOG(LS_ERROR) << "AudioSendStream::Stop failed with error: " << error;
   }
+  sending_ = false;
+  // Stopping the channel already ended the sharing of its encoder.
 }
 
 bool AudioSendStream::SendTelephoneEvent(int payload_type,
@@ -269,6 +279,8 @@ bool AudioSendStream::SendTelephoneEvent(int payload_type,
 void AudioSendStream::SetMuted(bool muted) {
   RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
   channel_proxy_->SetInputMute(muted);
+  muted_ = muted;
+  UpdateSharedEncoders();
 }
 
 webrtc::AudioSendStream::Stats AudioSendStream::GetStats() const {
@@ -425,6 +437,53 @@ const TimeInterval& AudioSendStream::GetActiveLifetime() const {
   return active_lifetime_;
 }
 
+void AudioSendStream::SetSharedEncoderLeader(AudioSendStream* leader) {
+  RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
+  RTC_DCHECK_NE(this, leader);
+  if (shared_encoder_leader_) {
+    std::vector<AudioSendStream*>& followers =
+        shared_encoder_leader_->shared_encoder_followers_;
+    followers.erase(std::remove(followers.begin(), followers.end(), this),
+                    followers.end());
+    // Stop sharing right away, |shared_encoder_leader_| may be destroyed next.
+    shared_encoder_leader_ = nullptr;
+    UpdateSharedEncoder();
+  }
+  shared_encoder_leader_ = leader;
+  if (leader) {
+    leader->shared_encoder_followers_.push_back(this);
+    UpdateSharedEncoder();
+  }
+}
+
+void AudioSendStream::UpdateSharedEncoder() {
+  RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
+  const AudioSendStream* leader = shared_encoder_leader_;
+  if (!leader) {
+    channel_proxy_->SetSharedEncoderLeader(nullptr);
+    return;
+  }
+  const Config& leader_config = leader->config_;
+  const bool share =
+      sending_ && leader->sending_ && !muted_ && !leader->muted_ &&
+      config_.send_codec_spec == leader_config.send_codec_spec &&
+      config_.audio_network_adaptor_config ==
+          leader_config.audio_network_adaptor_config;
+  if (!channel_proxy_->SetSharedEncoderLeader(
+          share ? leader->channel_proxy_.get() : nullptr)) {
+    LOG(LS_WARNING) << "SSRC " << config_.rtp.ssrc
+                    << " can't share the encoder of SSRC "
+                    << leader_config.rtp.ssrc;
+  }
+}
+
+void AudioSendStream::UpdateSharedEncoders() {
+  if (shared_encoder_leader_)
+    UpdateSharedEncoder();
+  for (AudioSendStream* follower : shared_encoder_followers_)
+    follower->UpdateSharedEncoder();
+}
+
 VoiceEngine* AudioSendStream::voice_engine() const {
   internal::AudioState* audio_state =
       static_cast<internal::AudioState*>(audio_state_.get());
@@ -78,6 +78,14 @@ class AudioSendStream final : public webrtc::AudioSendStream,
   RtpState GetRtpState() const;
   const TimeInterval& GetActiveLifetime() const;
 
+  // Makes this stream share the encoder of |leader|, see
+  // Config::shared_encoder_leader_ssrc. Called by Call, which also unlinks
+  // the streams before destroying either of them.
+  void SetSharedEncoderLeader(AudioSendStream* leader);
+  const std::vector<AudioSendStream*>& shared_encoder_followers() const {
+    return shared_encoder_followers_;
+  }
+
  private:
   class TimedTransport;
 
@@ -101,6 +109,12 @@ class AudioSendStream final : public webrtc::AudioSendStream,
 
   void RegisterCngPayloadType(int payload_type, int clockrate_hz);
 
+  // Shares the encoder of |shared_encoder_leader_| if possible, and stops
+  // sharing it otherwise.
+  void UpdateSharedEncoder();
+  // Same for this stream and for the streams following it.
+  void UpdateSharedEncoders();
+
   rtc::ThreadChecker worker_thread_checker_;
   rtc::ThreadChecker pacer_thread_checker_;
   rtc::TaskQueue* worker_queue_;
@@ -123,6 +137,11 @@ class AudioSendStream final : public webrtc::AudioSendStream,
   std::unique_ptr<TimedTransport> timed_send_transport_adapter_;
   TimeInterval active_lifetime_;
 
+  bool sending_ = false;
+  bool muted_ = false;
+  AudioSendStream* shared_encoder_leader_ = nullptr;
+  std::vector<AudioSendStream*> shared_encoder_followers_;
+
   RTC_DISALLOW_IMPLICIT_CONSTRUCTORS(AudioSendStream);
 };
 }  // namespace internal
@@ -31,6 +31,8 @@ std::string AudioSendStream::Config::ToString() const {
   ss << ", max_bitrate_bps: " << max_bitrate_bps;
   ss << ", send_codec_spec: "
      << (send_codec_spec ? send_codec_spec->ToString() : "<unset>");
+  if (shared_encoder_leader_ssrc)
+    ss << ", shared_encoder_leader_ssrc: " << *shared_encoder_leader_ssrc;
   ss << '}';
   return ss.str();
 }
@@ -132,6 +132,14 @@ class AudioSendStream {
     rtc::Optional<SendCodecSpec> send_codec_spec;
     rtc::scoped_refptr<AudioEncoderFactory> encoder_factory;
 
+    // SSRC of another audio send stream of the same Call to share the encoder
+    // of. While both streams are sending and unmuted with the same
+    // |send_codec_spec| and |audio_network_adaptor_config|, this stream sends
+    // the payloads encoded for that stream instead of encoding its own input,
+    // with its own SSRC and sequence numbers. Can't be changed with
+    // Reconfigure().
+    rtc::Optional<uint32_t> shared_encoder_leader_ssrc;
+
     // Track ID as specified during track creation.
     std::string track_id;
   };
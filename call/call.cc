@@ -612,6 +612,25 @@ webrtc::AudioSendStream* Call::CreateAudioSendStream(
                audio_send_ssrcs_.end());
     audio_send_ssrcs_[config.rtp.ssrc] = send_stream;
   }
+  {
+    // Link the new stream with the streams it shares an encoder with, in
+    // whichever order they were created.
+    ReadLockScoped read_lock(*send_crit_);
+    if (config.shared_encoder_leader_ssrc) {
+      const auto& it =
+          audio_send_ssrcs_.find(*config.shared_encoder_leader_ssrc);
+      if (it != audio_send_ssrcs_.end())
+        send_stream->SetSharedEncoderLeader(it->second);
+    }
+    for (const auto& kv : audio_send_ssrcs_) {
+      const rtc::Optional<uint32_t>& leader_ssrc =
+          kv.second->GetConfig().shared_encoder_leader_ssrc;
+      if (kv.second != send_stream && leader_ssrc &&
+          *leader_ssrc == config.rtp.ssrc) {
+        kv.second->SetSharedEncoderLeader(send_stream);
+      }
+    }
+  }
   {
     ReadLockScoped read_lock(*receive_crit_);
     for (AudioReceiveStream* stream : audio_receive_streams_) {
@@ -635,6 +654,14 @@ void Call::DestroyAudioSendStream(webrtc::AudioSendStream* send_stream) {
   const uint32_t ssrc = send_stream->GetConfig().rtp.ssrc;
   webrtc::internal::AudioSendStream* audio_send_stream =
       static_cast<webrtc::internal::AudioSendStream*>(send_stream);
+  // Unlink the streams sharing an encoder with this one. The followers keep
+  // their leader SSRC, so they're linked again if a stream with that SSRC is
+  // created.
+  const std::vector<AudioSendStream*> followers =
+      audio_send_stream->shared_encoder_followers();
+  for (AudioSendStream* follower : followers)
+    follower->SetSharedEncoderLeader(nullptr);
+  audio_send_stream->SetSharedEncoderLeader(nullptr);
   suspended_audio_send_ssrcs_[ssrc] = audio_send_stream->GetRtpState();
   {
     WriteLockScoped write_lock(*send_crit_);
@@ -742,6 +769,26 @@ webrtc::VideoSendStream* Call::CreateVideoSendStream(
     }
     video_send_streams_.insert(send_stream);
   }
+  {
+    // Link the new stream with the streams it shares an encoder with, in
+    // whichever order they were created.
+    ReadLockScoped read_lock(*send_crit_);
+    const rtc::Optional<uint32_t>& leader_ssrc =
+        send_stream->config().shared_encoder_leader_ssrc;
+    if (leader_ssrc) {
+      const auto& it = video_send_ssrcs_.find(*leader_ssrc);
+      if (it != video_send_ssrcs_.end())
+        send_stream->SetSharedEncoderLeader(it->second);
+    }
+    for (VideoSendStream* stream : video_send_streams_) {
+      const rtc::Optional<uint32_t>& ssrc =
+          stream->config().shared_encoder_leader_ssrc;
+      if (stream != send_stream && ssrc &&
+          std::find(ssrcs.begin(), ssrcs.end(), *ssrc) != ssrcs.end()) {
+        stream->SetSharedEncoderLeader(send_stream);
+      }
+    }
+  }
   send_stream->SignalNetworkState(video_network_state_);
   UpdateAggregateNetworkState();
 
@@ -771,6 +818,15 @@ void Call::DestroyVideoSendStream(webrtc::VideoSendStream* send_stream) {
   }
   RTC_CHECK(send_stream_impl != nullptr);
 
+  // Unlink the streams sharing an encoder with this one. The followers keep
+  // their leader SSRC, so they're linked again if a stream with that SSRC is
+  // created.
+  const std::vector<VideoSendStream*> followers =
+      send_stream_impl->shared_encoder_followers();
+  for (VideoSendStream* follower : followers)
+    follower->SetSharedEncoderLeader(nullptr);
+  send_stream_impl->SetSharedEncoderLeader(nullptr);
+
   VideoSendStream::RtpStateMap rtp_states;
   VideoSendStream::RtpPayloadStateMap rtp_payload_states;
   send_stream_impl->StopPermanentlyAndGetRtpStates(&rtp_states,
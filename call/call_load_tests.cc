@@ -0,0 +1,361 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "call/call.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/flags.h"
+#include "rtc_base/json.h"
+#include "rtc_base/memory_usage.h"
+#include "rtc_base/ptr_util.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/call_test.h"
+#include "test/constants.h"
+#include "test/direct_transport.h"
+#include "test/encoder_settings.h"
+#include "test/fake_encoder.h"
+#include "test/frame_generator_capturer.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+#if defined(WEBRTC_LINUX)
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+// The defaults keep the test short enough for the perf bots. Pass larger
+// values to measure how far a machine scales.
+DEFINE_int(load_test_max_calls, 4,
+    "Number of concurrent calls the load test ramps up to, doubling the "
+    "number at each step.");
+DEFINE_int(load_test_step_duration_ms, 1000,
+    "Duration of the measurement at each step of the load test.");
+DEFINE_string(load_test_output, "",
+    "If set, the load test writes its results as JSON to this file.");
+
+namespace webrtc {
+namespace {
+
+const int kWidth = 640;
+const int kHeight = 360;
+const int kFramerate = 30;
+// Time for new calls to ramp up and get RTCP sender reports, which are needed
+// to measure latency, before the measurement of a step starts.
+const int kWarmupMs = 2000;
+
+// Records the capture-to-render latency of the frames it receives.
+class LatencyRecorder : public rtc::VideoSinkInterface<VideoFrame> {
+ public:
+  explicit LatencyRecorder(Clock* clock) : clock_(clock) {}
+
+  void OnFrame(const VideoFrame& frame) override {
+    // The capture time is only known after the first RTCP sender report.
+    if (frame.ntp_time_ms() <= 0)
+      return;
+    int64_t latency_ms =
+        clock_->CurrentNtpInMilliseconds() - frame.ntp_time_ms();
+    rtc::CritScope lock(&crit_);
+    latencies_ms_.push_back(latency_ms);
+  }
+
+  void AppendAndClear(std::vector<int64_t>* latencies_ms) {
+    rtc::CritScope lock(&crit_);
+    latencies_ms->insert(latencies_ms->end(), latencies_ms_.begin(),
+                         latencies_ms_.end());
+    latencies_ms_.clear();
+  }
+
+ private:
+  Clock* const clock_;
+  rtc::CriticalSection crit_;
+  std::vector<int64_t> latencies_ms_ RTC_GUARDED_BY(crit_);
+};
+
+// CPU time used by each thread of the process so far, summed over threads
+// with the same name. Only implemented on Linux.
+std::map<std::string, int64_t> GetThreadCpuTimesNanos() {
+  std::map<std::string, int64_t> cpu_times_ns;
+#if defined(WEBRTC_LINUX)
+  DIR* tasks = opendir("/proc/self/task");
+  if (!tasks)
+    return cpu_times_ns;
+  const int64_t ns_per_tick = rtc::kNumNanosecsPerSec / sysconf(_SC_CLK_TCK);
+  while (dirent* entry = readdir(tasks)) {
+    if (entry->d_name[0] == '.')
+      continue;
+    std::string path =
+        std::string("/proc/self/task/") + entry->d_name + "/stat";
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file)
+      continue;
+    char buffer[1024];
+    size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    buffer[length] = '\0';
+    // The format is "tid (name) state ...", where utime and stime are the
+    // 12th and 13th fields after the name, and the name may contain spaces.
+    char* name_begin = strchr(buffer, '(');
+    char* name_end = strrchr(buffer, ')');
+    if (!name_begin || !name_end || name_end < name_begin)
+      continue;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    if (sscanf(name_end + 2,
+               "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime,
+               &stime) != 2) {
+      continue;
+    }
+    std::string name(name_begin + 1, name_end);
+    cpu_times_ns[name] += (utime + stime) * ns_per_tick;
+  }
+  closedir(tasks);
+#endif
+  return cpu_times_ns;
+}
+
+int64_t Percentile(std::vector<int64_t> values, int percentile) {
+  if (values.empty())
+    return -1;
+  size_t index = (values.size() - 1) * percentile / 100;
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+std::string ToString(double value) {
+  std::ostringstream ss;
+  ss << value;
+  return ss.str();
+}
+
+}  // namespace
+
+// Measures how the resources used by a process scale with the number of
+// calls in it. Each call is a sender and a receiver Call connected by fake
+// networks, with one video stream from a fake capturer through the fake
+// encoder and decoder. The number of calls is doubled at each step, up to
+// --load_test_max_calls, and the CPU usage per call (total and per thread),
+// memory per call and capture-to-render latency percentiles of each step are
+// reported as perf results, and as JSON in --load_test_output.
+class CallLoadTest : public test::CallTest {
+ protected:
+  struct LoadCall {
+    explicit LoadCall(Clock* clock) : encoder(clock), renderer(clock) {}
+
+    std::unique_ptr<Call> sender_call;
+    std::unique_ptr<Call> receiver_call;
+    std::unique_ptr<test::DirectTransport> send_transport;
+    std::unique_ptr<test::DirectTransport> receive_transport;
+    test::FakeEncoder encoder;
+    std::unique_ptr<VideoDecoder> decoder;
+    VideoSendStream* send_stream = nullptr;
+    VideoReceiveStream* receive_stream = nullptr;
+    std::unique_ptr<test::FrameGeneratorCapturer> capturer;
+    LatencyRecorder renderer;
+  };
+
+  struct StepResult {
+    size_t num_calls = 0;
+    double cpu_percent_per_call = 0;
+    int64_t memory_bytes_per_call = 0;
+    int64_t latency_p50_ms = -1;
+    int64_t latency_p90_ms = -1;
+    int64_t latency_p99_ms = -1;
+    // CPU usage per call of each (kind of) thread.
+    std::map<std::string, double> thread_cpu_percent_per_call;
+  };
+
+  std::unique_ptr<LoadCall> CreateLoadCall() {
+    std::unique_ptr<LoadCall> call = rtc::MakeUnique<LoadCall>(clock_);
+    call->sender_call.reset(Call::Create(Call::Config(event_log_.get())));
+    call->receiver_call.reset(Call::Create(Call::Config(event_log_.get())));
+    call->send_transport = rtc::MakeUnique<test::DirectTransport>(
+        &task_queue_, call->sender_call.get(), payload_type_map_);
+    call->receive_transport = rtc::MakeUnique<test::DirectTransport>(
+        &task_queue_, call->receiver_call.get(), payload_type_map_);
+    call->send_transport->SetReceiver(call->receiver_call->Receiver());
+    call->receive_transport->SetReceiver(call->sender_call->Receiver());
+
+    VideoSendStream::Config send_config(call->send_transport.get());
+    send_config.encoder_settings.encoder = &call->encoder;
+    send_config.encoder_settings.payload_name = "FAKE";
+    send_config.encoder_settings.payload_type = kFakeVideoSendPayloadType;
+    send_config.rtp.ssrcs.push_back(kVideoSendSsrcs[0]);
+    send_config.rtp.extensions.push_back(
+        RtpExtension(RtpExtension::kTransportSequenceNumberUri,
+                     test::kTransportSequenceNumberExtensionId));
+    VideoEncoderConfig encoder_config;
+    test::FillEncoderConfiguration(1, &encoder_config);
+
+    VideoReceiveStream::Config receive_config(call->receive_transport.get());
+    receive_config.rtp.remote_ssrc = kVideoSendSsrcs[0];
+    receive_config.rtp.local_ssrc = kReceiverLocalVideoSsrc;
+    receive_config.rtp.transport_cc = true;
+    receive_config.rtp.extensions = send_config.rtp.extensions;
+    receive_config.renderer = &call->renderer;
+    VideoReceiveStream::Decoder decoder =
+        test::CreateMatchingDecoder(send_config.encoder_settings);
+    call->decoder.reset(decoder.decoder);
+    receive_config.decoders.push_back(decoder);
+
+    call->send_stream = call->sender_call->CreateVideoSendStream(
+        std::move(send_config), std::move(encoder_config));
+    call->receive_stream = call->receiver_call->CreateVideoReceiveStream(
+        std::move(receive_config));
+    call->capturer.reset(test::FrameGeneratorCapturer::Create(
+        kWidth, kHeight, kFramerate, clock_));
+    call->send_stream->SetSource(
+        call->capturer.get(),
+        VideoSendStream::DegradationPreference::kMaintainFramerate);
+
+    call->receive_stream->Start();
+    call->send_stream->Start();
+    call->capturer->Start();
+    return call;
+  }
+
+  void DestroyLoadCall(std::unique_ptr<LoadCall> call) {
+    call->capturer->Stop();
+    call->send_stream->Stop();
+    call->receive_stream->Stop();
+    call->sender_call->DestroyVideoSendStream(call->send_stream);
+    call->receiver_call->DestroyVideoReceiveStream(call->receive_stream);
+    call->send_transport.reset();
+    call->receive_transport.reset();
+    call->sender_call.reset();
+    call->receiver_call.reset();
+  }
+
+  StepResult MeasureStep(
+      const std::vector<std::unique_ptr<LoadCall>>& calls) {
+    for (const auto& call : calls) {
+      std::vector<int64_t> discarded;
+      call->renderer.AppendAndClear(&discarded);
+    }
+    const int64_t start_time_ns = rtc::TimeNanos();
+    const int64_t start_cpu_ns = rtc::GetProcessCpuTimeNanos();
+    std::map<std::string, int64_t> start_thread_cpu_ns =
+        GetThreadCpuTimesNanos();
+
+    SleepMs(FLAG_load_test_step_duration_ms);
+
+    const double elapsed_ns = rtc::TimeNanos() - start_time_ns;
+    const double num_calls = calls.size();
+    StepResult result;
+    result.num_calls = calls.size();
+    result.cpu_percent_per_call =
+        100 * (rtc::GetProcessCpuTimeNanos() - start_cpu_ns) / elapsed_ns /
+        num_calls;
+    for (const auto& thread : GetThreadCpuTimesNanos()) {
+      result.thread_cpu_percent_per_call[thread.first] =
+          100 * (thread.second - start_thread_cpu_ns[thread.first]) /
+          elapsed_ns / num_calls;
+    }
+    std::vector<int64_t> latencies_ms;
+    for (const auto& call : calls)
+      call->renderer.AppendAndClear(&latencies_ms);
+    result.latency_p50_ms = Percentile(latencies_ms, 50);
+    result.latency_p90_ms = Percentile(latencies_ms, 90);
+    result.latency_p99_ms = Percentile(latencies_ms, 99);
+    return result;
+  }
+
+  static void PrintStepResult(const StepResult& result) {
+    const std::string trace = std::to_string(result.num_calls) + "_calls";
+    test::PrintResult("call_load", "_cpu_per_call", trace,
+                      ToString(result.cpu_percent_per_call), "percent", true);
+    test::PrintResult("call_load", "_memory_per_call", trace,
+                      static_cast<size_t>(result.memory_bytes_per_call),
+                      "bytes", true);
+    test::PrintResult("call_load", "_latency_p50", trace,
+                      std::to_string(result.latency_p50_ms), "ms", false);
+    test::PrintResult("call_load", "_latency_p90", trace,
+                      std::to_string(result.latency_p90_ms), "ms", false);
+    test::PrintResult("call_load", "_latency_p99", trace,
+                      std::to_string(result.latency_p99_ms), "ms", true);
+    for (const auto& thread : result.thread_cpu_percent_per_call) {
+      test::PrintResult("call_load_thread_cpu_per_call", "_" + thread.first,
+                        trace, ToString(thread.second), "percent", false);
+    }
+  }
+
+  static void WriteJson(const std::string& path,
+                        const std::vector<StepResult>& results) {
+    // Thread names come from the OS and may contain any character, so let
+    // JsonCpp do the escaping.
+    Json::Value json(Json::arrayValue);
+    for (const StepResult& result : results) {
+      Json::Value step(Json::objectValue);
+      step["num_calls"] = Json::UInt64(result.num_calls);
+      step["cpu_percent_per_call"] = result.cpu_percent_per_call;
+      step["memory_bytes_per_call"] =
+          Json::Int64(result.memory_bytes_per_call);
+      step["latency_p50_ms"] = Json::Int64(result.latency_p50_ms);
+      step["latency_p90_ms"] = Json::Int64(result.latency_p90_ms);
+      step["latency_p99_ms"] = Json::Int64(result.latency_p99_ms);
+      Json::Value threads(Json::objectValue);
+      for (const auto& thread : result.thread_cpu_percent_per_call)
+        threads[thread.first] = thread.second;
+      step["thread_cpu_percent_per_call"] = threads;
+      json.append(step);
+    }
+
+    FILE* file = fopen(path.c_str(), "w");
+    ASSERT_TRUE(file != nullptr) << "Can't open " << path;
+    const std::string output = Json::StyledWriter().write(json);
+    fwrite(output.data(), 1, output.size(), file);
+    fclose(file);
+  }
+};
+
+TEST_F(CallLoadTest, RampsUpVideoCalls) {
+  std::vector<std::unique_ptr<LoadCall>> calls;
+  std::vector<StepResult> results;
+  const int64_t baseline_memory_bytes = rtc::GetProcessResidentSizeBytes();
+
+  for (size_t num_calls = 1;
+       num_calls <= static_cast<size_t>(FLAG_load_test_max_calls);
+       num_calls *= 2) {
+    task_queue_.SendTask([this, &calls, num_calls]() {
+      while (calls.size() < num_calls)
+        calls.push_back(CreateLoadCall());
+    });
+    SleepMs(kWarmupMs);
+
+    StepResult result = MeasureStep(calls);
+    result.memory_bytes_per_call =
+        (rtc::GetProcessResidentSizeBytes() - baseline_memory_bytes) /
+        static_cast<int64_t>(num_calls);
+    PrintStepResult(result);
+    results.push_back(result);
+  }
+
+  task_queue_.SendTask([this, &calls]() {
+    for (auto& call : calls)
+      DestroyLoadCall(std::move(call));
+    calls.clear();
+  });
+
+  if (strlen(FLAG_load_test_output) > 0)
+    WriteJson(FLAG_load_test_output, results);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,435 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "call/rtp_forwarder.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "api/call/transport.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/ptr_util.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+namespace {
+
+const int64_t kRateWindowMs = 1000;
+// Minimum time between key frame requests for the same layer. Requests from
+// all targets are coalesced.
+const int64_t kMinKeyFrameRequestIntervalMs = 300;
+const int kRtpVideoClockRateHz = 90000;
+
+}  // namespace
+
+struct RtpForwarder::Target {
+  Target(uint32_t ssrc, Transport* transport)
+      : ssrc(ssrc),
+        transport(new rtc::RefCountedObject<TargetTransport>(transport)) {}
+
+  const uint32_t ssrc;
+  const rtc::scoped_refptr<rtc::RefCountedObject<TargetTransport>> transport;
+  uint32_t bitrate_bps = std::numeric_limits<uint32_t>::max();
+
+  // Layer being forwarded, or -1 before the first key frame.
+  int current_layer = -1;
+  // Layer to switch to at its next key frame.
+  int desired_layer = 0;
+  int max_temporal_layer = kMaxTemporalLayers - 1;
+
+  // Frame currently being dropped, identified by its RTP timestamp.
+  bool dropping_frame = false;
+  uint32_t dropped_frame_timestamp = 0;
+
+  // Rewriting state. Outgoing values are the incoming ones plus the offsets.
+  bool has_sent = false;
+  uint16_t last_sequence_number = 0;
+  uint32_t last_timestamp = 0;
+  int64_t last_send_time_ms = 0;
+  int last_picture_id = -1;
+  int last_tl0_pic_idx = -1;
+  uint16_t sequence_number_offset = 0;
+  uint32_t timestamp_offset = 0;
+  uint16_t picture_id_offset = 0;
+  uint8_t tl0_pic_idx_offset = 0;
+};
+
+RtpForwarder::RtpForwarder(Clock* clock,
+                           const std::vector<uint32_t>& layer_ssrcs,
+                           int vp8_payload_type,
+                           KeyFrameRequester* key_frame_requester)
+    : clock_(clock),
+      layer_ssrcs_(layer_ssrcs),
+      vp8_payload_type_(vp8_payload_type),
+      key_frame_requester_(key_frame_requester),
+      last_key_frame_request_ms_(layer_ssrcs.size(),
+                                 -kMinKeyFrameRequestIntervalMs) {
+  RTC_DCHECK(clock_);
+  RTC_DCHECK(!layer_ssrcs_.empty());
+  RTC_DCHECK_GE(vp8_payload_type_, 0);
+  RTC_DCHECK_LE(vp8_payload_type_, 127);
+  for (size_t i = 0; i < layer_ssrcs_.size(); ++i) {
+    layer_rates_.emplace_back(
+        new RateStatistics(kRateWindowMs, RateStatistics::kBpsScale));
+    for (int j = 0; j < kMaxTemporalLayers; ++j) {
+      temporal_layer_rates_.emplace_back(
+          new RateStatistics(kRateWindowMs, RateStatistics::kBpsScale));
+    }
+  }
+}
+
+RtpForwarder::~RtpForwarder() = default;
+
+void RtpForwarder::AddTarget(uint32_t ssrc, Transport* transport) {
+  RTC_DCHECK(transport);
+  std::vector<uint32_t> requests;
+  {
+    rtc::CritScope lock(&crit_);
+    RTC_DCHECK(!FindTarget(ssrc));
+    targets_.push_back(rtc::MakeUnique<Target>(ssrc, transport));
+    // The new receiver can't start before the next key frame.
+    MaybeRequestKeyFrame(0, clock_->TimeInMilliseconds(), &requests);
+  }
+  for (uint32_t request_ssrc : requests)
+    key_frame_requester_->RequestKeyFrame(request_ssrc);
+}
+
+void RtpForwarder::RemoveTarget(uint32_t ssrc) {
+  rtc::scoped_refptr<rtc::RefCountedObject<TargetTransport>> transport;
+  {
+    rtc::CritScope lock(&crit_);
+    auto it = std::find_if(targets_.begin(), targets_.end(),
+                           [ssrc](const std::unique_ptr<Target>& target) {
+                             return target->ssrc == ssrc;
+                           });
+    if (it == targets_.end())
+      return;
+    transport = (*it)->transport;
+    targets_.erase(it);
+  }
+  // An OnRtpPacket() call that started before the target was erased may still
+  // send to it. Wait for a packet being sent and stop any later ones.
+  rtc::CritScope lock(&transport->delivery_lock);
+  transport->removed = true;
+}
+
+void RtpForwarder::SetTargetBitrate(uint32_t ssrc, uint32_t bitrate_bps) {
+  rtc::CritScope lock(&crit_);
+  Target* target = FindTarget(ssrc);
+  if (target)
+    target->bitrate_bps = bitrate_bps;
+}
+
+void RtpForwarder::OnKeyFrameRequest(uint32_t ssrc) {
+  std::vector<uint32_t> requests;
+  {
+    rtc::CritScope lock(&crit_);
+    Target* target = FindTarget(ssrc);
+    if (!target)
+      return;
+    // A pending layer switch needs a key frame of the new layer anyway.
+    MaybeRequestKeyFrame(target->desired_layer, clock_->TimeInMilliseconds(),
+                         &requests);
+  }
+  for (uint32_t request_ssrc : requests)
+    key_frame_requester_->RequestKeyFrame(request_ssrc);
+}
+
+int RtpForwarder::GetCurrentLayer(uint32_t ssrc) const {
+  rtc::CritScope lock(&crit_);
+  for (const auto& target : targets_) {
+    if (target->ssrc == ssrc)
+      return target->current_layer;
+  }
+  return -1;
+}
+
+void RtpForwarder::OnRtpPacket(const RtpPacketReceived& packet) {
+  const auto it =
+      std::find(layer_ssrcs_.begin(), layer_ssrcs_.end(), packet.Ssrc());
+  if (it == layer_ssrcs_.end())
+    return;
+  const int layer = static_cast<int>(it - layer_ssrcs_.begin());
+  // Padding isn't forwarded; each outgoing stream is paced and padded by its
+  // own sender.
+  if (packet.payload_size() == 0)
+    return;
+
+  // Without parsing the payload, neither key frames nor layer boundaries are
+  // known, and forwarding from anywhere but a key frame corrupts the video.
+  if (packet.PayloadType() != vp8_payload_type_)
+    return;
+  Vp8Descriptor vp8;
+  if (!ParseVp8Descriptor(packet.payload().data(), packet.payload_size(),
+                          packet.headers_size(), &vp8)) {
+    LOG(LS_WARNING) << "Dropping VP8 packet with invalid descriptor, ssrc "
+                    << packet.Ssrc();
+    return;
+  }
+
+  rtc::CritScope delivery_lock(&delivery_crit_);
+  const size_t size = packet.size();
+  packets_.Clear();
+  {
+    rtc::CritScope lock(&crit_);
+    const int64_t now_ms = clock_->TimeInMilliseconds();
+    layer_rates_[layer]->Update(size, now_ms);
+    if (vp8.temporal_idx >= 0 && vp8.temporal_idx < kMaxTemporalLayers) {
+      temporal_layer_rates_[layer * kMaxTemporalLayers + vp8.temporal_idx]
+          ->Update(size, now_ms);
+    }
+
+    packets_.EnsureCapacity(size * targets_.size());
+    for (const auto& target : targets_) {
+      packets_.AppendData(packet.data(), size);
+      if (ForwardTo(target.get(), layer, vp8, packet.SequenceNumber(),
+                    packet.Timestamp(), now_ms,
+                    packets_.data() + packets_.size() - size,
+                    &key_frame_requests_)) {
+        transports_.push_back(target->transport);
+      } else {
+        packets_.SetSize(packets_.size() - size);
+      }
+    }
+  }
+  for (size_t i = 0; i < transports_.size(); ++i) {
+    rtc::CritScope lock(&transports_[i]->delivery_lock);
+    if (!transports_[i]->removed) {
+      transports_[i]->transport->SendRtp(packets_.data() + i * size, size,
+                                         PacketOptions());
+    }
+  }
+  transports_.clear();
+  for (uint32_t request_ssrc : key_frame_requests_)
+    key_frame_requester_->RequestKeyFrame(request_ssrc);
+  key_frame_requests_.clear();
+}
+
+bool RtpForwarder::ParseVp8Descriptor(const uint8_t* payload,
+                                      size_t payload_size,
+                                      size_t payload_offset,
+                                      Vp8Descriptor* vp8) {
+  //      0 1 2 3 4 5 6 7
+  //     +-+-+-+-+-+-+-+-+
+  //     |X|R|N|S|R| PID | (REQUIRED)
+  //     +-+-+-+-+-+-+-+-+
+  // X:  |I|L|T|K| RSV   | (OPTIONAL)
+  //     +-+-+-+-+-+-+-+-+
+  // I:  |M| PictureID   | (OPTIONAL)
+  //     +-+-+-+-+-+-+-+-+
+  //     |   PictureID   |
+  //     +-+-+-+-+-+-+-+-+
+  // L:  |   TL0PICIDX   | (OPTIONAL)
+  //     +-+-+-+-+-+-+-+-+
+  // T/K:|TID|Y| KEYIDX  | (OPTIONAL)
+  //     +-+-+-+-+-+-+-+-+
+  size_t pos = 0;
+  if (payload_size < 1)
+    return false;
+  const bool extension = (payload[0] & 0x80) != 0;
+  vp8->start_of_frame = (payload[0] & 0x10) != 0 && (payload[0] & 0x07) == 0;
+  ++pos;
+  if (extension) {
+    if (payload_size < pos + 1)
+      return false;
+    const bool has_picture_id = (payload[pos] & 0x80) != 0;
+    const bool has_tl0_pic_idx = (payload[pos] & 0x40) != 0;
+    const bool has_tid_or_key_idx = (payload[pos] & 0x30) != 0;
+    const bool has_tid = (payload[pos] & 0x20) != 0;
+    ++pos;
+    if (has_picture_id) {
+      if (payload_size < pos + 1)
+        return false;
+      vp8->picture_id_offset = payload_offset + pos;
+      vp8->long_picture_id = (payload[pos] & 0x80) != 0;
+      if (vp8->long_picture_id) {
+        if (payload_size < pos + 2)
+          return false;
+        vp8->picture_id = ((payload[pos] & 0x7F) << 8) | payload[pos + 1];
+        pos += 2;
+      } else {
+        vp8->picture_id = payload[pos] & 0x7F;
+        ++pos;
+      }
+    }
+    if (has_tl0_pic_idx) {
+      if (payload_size < pos + 1)
+        return false;
+      vp8->tl0_pic_idx_offset = payload_offset + pos;
+      vp8->tl0_pic_idx = payload[pos];
+      ++pos;
+    }
+    if (has_tid_or_key_idx) {
+      if (payload_size < pos + 1)
+        return false;
+      if (has_tid) {
+        vp8->temporal_idx = payload[pos] >> 6;
+        vp8->layer_sync = (payload[pos] & 0x20) != 0;
+      }
+      ++pos;
+    }
+  }
+  if (vp8->start_of_frame) {
+    // The P bit of the VP8 payload header is 0 for key frames.
+    if (payload_size < pos + 1)
+      return false;
+    vp8->key_frame = (payload[pos] & 0x01) == 0;
+  }
+  return true;
+}
+
+int RtpForwarder::SelectLayer(const Target& target, int64_t now_ms) const {
+  for (int layer = static_cast<int>(layer_ssrcs_.size()) - 1; layer > 0;
+       --layer) {
+    rtc::Optional<uint32_t> rate = layer_rates_[layer]->Rate(now_ms);
+    if (rate && *rate <= target.bitrate_bps)
+      return layer;
+  }
+  return 0;
+}
+
+int RtpForwarder::SelectMaxTemporalLayer(const Target& target,
+                                         int64_t now_ms) const {
+  RTC_DCHECK_GE(target.current_layer, 0);
+  uint32_t bitrate_bps = 0;
+  for (int tid = 0; tid < kMaxTemporalLayers; ++tid) {
+    rtc::Optional<uint32_t> rate =
+        temporal_layer_rates_[target.current_layer * kMaxTemporalLayers + tid]
+            ->Rate(now_ms);
+    bitrate_bps += rate.value_or(0);
+    // The base layer is always forwarded.
+    if (tid > 0 && bitrate_bps > target.bitrate_bps)
+      return tid - 1;
+  }
+  return kMaxTemporalLayers - 1;
+}
+
+void RtpForwarder::MaybeRequestKeyFrame(int layer,
+                                        int64_t now_ms,
+                                        std::vector<uint32_t>* requests) {
+  if (!key_frame_requester_)
+    return;
+  if (now_ms - last_key_frame_request_ms_[layer] <
+      kMinKeyFrameRequestIntervalMs) {
+    return;
+  }
+  last_key_frame_request_ms_[layer] = now_ms;
+  requests->push_back(layer_ssrcs_[layer]);
+}
+
+bool RtpForwarder::ForwardTo(Target* target,
+                             int layer,
+                             const Vp8Descriptor& vp8,
+                             uint16_t sequence_number,
+                             uint32_t timestamp,
+                             int64_t now_ms,
+                             uint8_t* packet,
+                             std::vector<uint32_t>* requests) {
+  if (layer != target->current_layer) {
+    if (layer != target->desired_layer || !vp8.key_frame)
+      return false;
+    // Switch layers, continuing the outgoing stream where it left off.
+    if (target->has_sent) {
+      target->sequence_number_offset =
+          target->last_sequence_number + 1 - sequence_number;
+      const int64_t elapsed_ticks = std::max<int64_t>(
+          1, (now_ms - target->last_send_time_ms) * kRtpVideoClockRateHz /
+                 1000);
+      target->timestamp_offset = target->last_timestamp +
+                                 static_cast<uint32_t>(elapsed_ticks) -
+                                 timestamp;
+      if (vp8.picture_id >= 0 && target->last_picture_id >= 0) {
+        target->picture_id_offset =
+            target->last_picture_id + 1 - vp8.picture_id;
+      }
+      if (vp8.tl0_pic_idx >= 0 && target->last_tl0_pic_idx >= 0) {
+        target->tl0_pic_idx_offset =
+            target->last_tl0_pic_idx + 1 - vp8.tl0_pic_idx;
+      }
+    }
+    target->current_layer = layer;
+    target->max_temporal_layer = kMaxTemporalLayers - 1;
+    target->dropping_frame = false;
+  }
+
+  if (vp8.start_of_frame) {
+    // Pick the layer to switch to, if any. A key frame is needed for that.
+    target->desired_layer = SelectLayer(*target, now_ms);
+    if (target->desired_layer != target->current_layer)
+      MaybeRequestKeyFrame(target->desired_layer, now_ms, requests);
+
+    // Temporal layers can be dropped at any frame, but only be added back at
+    // frames that don't depend on earlier frames of that layer.
+    if (vp8.temporal_idx >= 0) {
+      const int max_temporal_layer = SelectMaxTemporalLayer(*target, now_ms);
+      if (max_temporal_layer < target->max_temporal_layer ||
+          vp8.layer_sync || vp8.temporal_idx == 0) {
+        target->max_temporal_layer = max_temporal_layer;
+      }
+    }
+    target->dropping_frame = vp8.temporal_idx > target->max_temporal_layer;
+    if (target->dropping_frame) {
+      target->dropped_frame_timestamp = timestamp;
+      // Keep the outgoing picture ids continuous.
+      if (vp8.picture_id >= 0)
+        --target->picture_id_offset;
+    }
+  }
+
+  if (target->dropping_frame && timestamp == target->dropped_frame_timestamp) {
+    // Keep the outgoing sequence numbers continuous.
+    --target->sequence_number_offset;
+    return false;
+  }
+
+  const uint16_t out_sequence_number =
+      sequence_number + target->sequence_number_offset;
+  const uint32_t out_timestamp = timestamp + target->timestamp_offset;
+  ByteWriter<uint16_t>::WriteBigEndian(packet + 2, out_sequence_number);
+  ByteWriter<uint32_t>::WriteBigEndian(packet + 4, out_timestamp);
+  ByteWriter<uint32_t>::WriteBigEndian(packet + 8, target->ssrc);
+  if (vp8.picture_id >= 0) {
+    const uint16_t mask = vp8.long_picture_id ? 0x7FFF : 0x7F;
+    const int picture_id = (vp8.picture_id + target->picture_id_offset) & mask;
+    if (vp8.long_picture_id) {
+      packet[vp8.picture_id_offset] = 0x80 | (picture_id >> 8);
+      packet[vp8.picture_id_offset + 1] = picture_id & 0xFF;
+    } else {
+      packet[vp8.picture_id_offset] = picture_id;
+    }
+    target->last_picture_id = picture_id;
+  }
+  if (vp8.tl0_pic_idx >= 0) {
+    const uint8_t tl0_pic_idx = vp8.tl0_pic_idx + target->tl0_pic_idx_offset;
+    packet[vp8.tl0_pic_idx_offset] = tl0_pic_idx;
+    target->last_tl0_pic_idx = tl0_pic_idx;
+  }
+
+  target->has_sent = true;
+  target->last_sequence_number = out_sequence_number;
+  target->last_timestamp = out_timestamp;
+  target->last_send_time_ms = now_ms;
+  return true;
+}
+
+RtpForwarder::Target* RtpForwarder::FindTarget(uint32_t ssrc) {
+  for (const auto& target : targets_) {
+    if (target->ssrc == ssrc)
+      return target.get();
+  }
+  return nullptr;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef CALL_RTP_FORWARDER_H_
+#define CALL_RTP_FORWARDER_H_
+
+#include <memory>
+#include <vector>
+
+#include "call/rtp_packet_sink_interface.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/rate_statistics.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/scoped_ref_ptr.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+class Clock;
+class Transport;
+
+// Selective forwarding of one incoming video stream, possibly simulcast, to
+// any number of outgoing streams, without decoding. Register the forwarder as
+// the sink of each of the incoming |layer_ssrcs| in an RtpDemuxer, e.g. with
+// RtpStreamReceiverController::CreateReceiver().
+//
+// Every outgoing stream (a "target") gets a continuous stream: its own SSRC,
+// and sequence numbers, timestamps and VP8 picture ids / TL0PICIDX rewritten
+// to hide layer switches and dropped frames. Based on the bitrate set for a
+// target, the forwarder picks the highest simulcast layer that fits, switching
+// at key frames only (and requesting them when needed), and drops the VP8
+// temporal layers that don't fit within the selected layer.
+//
+// Only VP8 is supported, since key frames must be detected to start and switch
+// layers; packets with other payload types than |vp8_payload_type| are
+// dropped. Packets are assumed to arrive mostly in order; header extensions
+// and RTX are passed through unmodified.
+//
+// Packets are sent without holding the lock of the target list, so that a
+// slow transport doesn't hold up adding and removing targets. RemoveTarget()
+// waits for a packet being sent to the removed target, and no packets are
+// sent to it once it returns.
+class RtpForwarder : public RtpPacketSinkInterface {
+ public:
+  // Receives key frame requests for the incoming stream with SSRC |ssrc|.
+  class KeyFrameRequester {
+   public:
+    virtual void RequestKeyFrame(uint32_t ssrc) = 0;
+
+   protected:
+    virtual ~KeyFrameRequester() {}
+  };
+
+  // |layer_ssrcs| are the SSRCs of the incoming simulcast layers, lowest
+  // resolution first.
+  RtpForwarder(Clock* clock,
+               const std::vector<uint32_t>& layer_ssrcs,
+               int vp8_payload_type,
+               KeyFrameRequester* key_frame_requester);
+  ~RtpForwarder() override;
+
+  // Adds an outgoing stream sent with |ssrc| on |transport|. The first key
+  // frame of the lowest layer starts the stream.
+  void AddTarget(uint32_t ssrc, Transport* transport);
+  void RemoveTarget(uint32_t ssrc);
+
+  // Sets the bitrate available for the outgoing stream |ssrc|, e.g. from the
+  // bandwidth estimate of its receiver.
+  void SetTargetBitrate(uint32_t ssrc, uint32_t bitrate_bps);
+
+  // Handles a key frame request (PLI/FIR) from the receiver of |ssrc|.
+  void OnKeyFrameRequest(uint32_t ssrc);
+
+  // Returns the simulcast layer currently forwarded to |ssrc|, or -1.
+  int GetCurrentLayer(uint32_t ssrc) const;
+
+  // RtpPacketSinkInterface.
+  void OnRtpPacket(const RtpPacketReceived& packet) override;
+
+ private:
+  // Maximum number of VP8 temporal layers tracked.
+  static const int kMaxTemporalLayers = 4;
+
+  // The fields of the VP8 payload descriptor (RFC 7741) that are used or
+  // rewritten, with offsets relative to the start of the RTP packet.
+  struct Vp8Descriptor {
+    bool start_of_frame = false;
+    bool key_frame = false;
+    int picture_id = -1;
+    bool long_picture_id = false;
+    size_t picture_id_offset = 0;
+    int tl0_pic_idx = -1;
+    size_t tl0_pic_idx_offset = 0;
+    int temporal_idx = -1;
+    bool layer_sync = false;
+  };
+  // Transport of a target, shared between the target list and the
+  // OnRtpPacket() call sending to it. |delivery_lock| is held while a packet
+  // is sent, so that RemoveTarget() can wait for that to finish.
+  struct TargetTransport {
+    explicit TargetTransport(Transport* transport) : transport(transport) {}
+
+    Transport* const transport;
+    rtc::CriticalSection delivery_lock;
+    bool removed RTC_GUARDED_BY(delivery_lock) = false;
+  };
+  struct Target;
+
+  static bool ParseVp8Descriptor(const uint8_t* payload,
+                                 size_t payload_size,
+                                 size_t payload_offset,
+                                 Vp8Descriptor* vp8);
+
+  int SelectLayer(const Target& target, int64_t now_ms) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  int SelectMaxTemporalLayer(const Target& target, int64_t now_ms) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void MaybeRequestKeyFrame(int layer,
+                            int64_t now_ms,
+                            std::vector<uint32_t>* requests)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Rewrites |packet|, a copy of the incoming packet, for |target|. Returns
+  // false if the packet isn't forwarded to |target|.
+  bool ForwardTo(Target* target,
+                 int layer,
+                 const Vp8Descriptor& vp8,
+                 uint16_t sequence_number,
+                 uint32_t timestamp,
+                 int64_t now_ms,
+                 uint8_t* packet,
+                 std::vector<uint32_t>* requests)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  Target* FindTarget(uint32_t ssrc) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  Clock* const clock_;
+  const std::vector<uint32_t> layer_ssrcs_;
+  const int vp8_payload_type_;
+  KeyFrameRequester* const key_frame_requester_;
+
+  rtc::CriticalSection crit_;
+  std::vector<std::unique_ptr<Target>> targets_ RTC_GUARDED_BY(crit_);
+  // Incoming bitrate per layer, and per temporal layer of each layer, at
+  // index layer * kMaxTemporalLayers + temporal layer.
+  std::vector<std::unique_ptr<RateStatistics>> layer_rates_
+      RTC_GUARDED_BY(crit_);
+  std::vector<std::unique_ptr<RateStatistics>> temporal_layer_rates_
+      RTC_GUARDED_BY(crit_);
+  std::vector<int64_t> last_key_frame_request_ms_ RTC_GUARDED_BY(crit_);
+
+  // Serializes OnRtpPacket() calls, which reuse the buffers below rather than
+  // allocate them per packet.
+  rtc::CriticalSection delivery_crit_;
+  // The rewritten copies of the current packet, one per target it's forwarded
+  // to, in the order of |transports_|.
+  rtc::Buffer packets_ RTC_GUARDED_BY(delivery_crit_);
+  std::vector<rtc::scoped_refptr<rtc::RefCountedObject<TargetTransport>>>
+      transports_ RTC_GUARDED_BY(delivery_crit_);
+  std::vector<uint32_t> key_frame_requests_ RTC_GUARDED_BY(delivery_crit_);
+};
+
+}  // namespace webrtc
+
+#endif  // CALL_RTP_FORWARDER_H_
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "api/call/transport.h"
+#include "call/rtp_forwarder.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/arraysize.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+const int kVp8PayloadType = 100;
+const uint32_t kLayerSsrcs[] = {1111, 2222, 3333};
+const uint32_t kFirstTargetSsrc = 10000;
+// About 2.5 Mbps of 1200 byte packets for the top layer, for 10 s.
+const int kNumFrames = 300;
+const int kPacketsPerFrame = 8;
+const size_t kPacketSize = 1200;
+
+class CountingTransport : public Transport {
+ public:
+  bool SendRtp(const uint8_t* packet,
+               size_t length,
+               const PacketOptions& options) override {
+    ++num_packets;
+    num_bytes += length;
+    return true;
+  }
+  bool SendRtcp(const uint8_t* packet, size_t length) override {
+    return true;
+  }
+
+  size_t num_packets = 0;
+  size_t num_bytes = 0;
+};
+
+// A VP8 packet of |frame| of a stream with three temporal layers and a key
+// frame every 100 frames.
+RtpPacketReceived CreatePacket(uint32_t ssrc, int frame, int index) {
+  RtpPacketReceived packet;
+  packet.SetPayloadType(kVp8PayloadType);
+  packet.SetSsrc(ssrc);
+  packet.SetSequenceNumber(
+      static_cast<uint16_t>(frame * kPacketsPerFrame + index));
+  packet.SetTimestamp(frame * 3000);
+  packet.SetMarker(index == kPacketsPerFrame - 1);
+  uint8_t* payload = packet.AllocatePayload(kPacketSize);
+  memset(payload, 0, kPacketSize);
+  const int kTemporalPattern[] = {0, 2, 1, 2};
+  payload[0] = index == 0 ? 0x90 : 0x80;  // X, S for the first packet.
+  payload[1] = 0xE0;                      // I, L, T.
+  payload[2] = 0x80 | ((frame >> 8) & 0x7F);
+  payload[3] = frame & 0xFF;
+  payload[4] = static_cast<uint8_t>(frame / 4);
+  payload[5] = kTemporalPattern[frame % 4] << 6;
+  payload[6] = frame % 100 == 0 ? 0x00 : 0x01;
+  return packet;
+}
+
+void RunForwarding(size_t num_targets) {
+  SimulatedClock clock(1000);
+  RtpForwarder forwarder(
+      &clock, std::vector<uint32_t>(std::begin(kLayerSsrcs),
+                                    std::end(kLayerSsrcs)),
+      kVp8PayloadType, nullptr);
+  std::vector<CountingTransport> transports(num_targets);
+  for (size_t i = 0; i < num_targets; ++i) {
+    forwarder.AddTarget(kFirstTargetSsrc + i, &transports[i]);
+    // Spread the targets over all layers and temporal layers.
+    forwarder.SetTargetBitrate(kFirstTargetSsrc + i,
+                               static_cast<uint32_t>(200000 + i * 40000));
+  }
+
+  std::vector<RtpPacketReceived> packets;
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    for (uint32_t ssrc : kLayerSsrcs) {
+      for (int index = 0; index < kPacketsPerFrame; ++index)
+        packets.push_back(CreatePacket(ssrc, frame, index));
+    }
+  }
+
+  int64_t elapsed_ns = 0;
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    const size_t begin = frame * kPacketsPerFrame * arraysize(kLayerSsrcs);
+    const size_t end = begin + kPacketsPerFrame * arraysize(kLayerSsrcs);
+    const int64_t start_ns = rtc::TimeNanos();
+    for (size_t i = begin; i < end; ++i)
+      forwarder.OnRtpPacket(packets[i]);
+    elapsed_ns += rtc::TimeNanos() - start_ns;
+    clock.AdvanceTimeMilliseconds(33);
+  }
+
+  size_t num_forwarded = 0;
+  for (const CountingTransport& transport : transports)
+    num_forwarded += transport.num_packets;
+  EXPECT_GT(num_forwarded, 0u);
+
+  const std::string trace = std::to_string(num_targets) + "_targets";
+  webrtc::test::PrintResult(
+      "rtp_forwarder", "", trace + "_per_incoming_packet",
+      static_cast<size_t>(elapsed_ns / packets.size()), "ns", true);
+  webrtc::test::PrintResult(
+      "rtp_forwarder", "", trace + "_per_forwarded_packet",
+      static_cast<size_t>(elapsed_ns / std::max<size_t>(num_forwarded, 1)),
+      "ns", false);
+}
+
+}  // namespace
+
+// Cost of forwarding a three layer simulcast stream to an SFU-sized number of
+// receivers, excluding the transport.
+TEST(RtpForwarderPerformanceTest, ForwardTo10Targets) {
+  RunForwarding(10);
+}
+
+TEST(RtpForwarderPerformanceTest, ForwardTo100Targets) {
+  RunForwarding(100);
+}
+
+}  // namespace webrtc
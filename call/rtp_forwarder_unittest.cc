@@ -0,0 +1,275 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "call/rtp_forwarder.h"
+
+#include <vector>
+
+#include "api/call/transport.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::ElementsAre;
+
+const int kVp8PayloadType = 100;
+const uint32_t kLowSsrc = 1111;
+const uint32_t kHighSsrc = 2222;
+const uint32_t kTargetSsrc = 3333;
+
+class PacketRecordingTransport : public Transport {
+ public:
+  bool SendRtp(const uint8_t* packet,
+               size_t length,
+               const PacketOptions& options) override {
+    RtpPacketReceived parsed;
+    EXPECT_TRUE(parsed.Parse(packet, length));
+    packets.push_back(parsed);
+    return true;
+  }
+  bool SendRtcp(const uint8_t* packet, size_t length) override {
+    return false;
+  }
+
+  std::vector<uint16_t> SequenceNumbers() const {
+    std::vector<uint16_t> sequence_numbers;
+    for (const RtpPacketReceived& packet : packets)
+      sequence_numbers.push_back(packet.SequenceNumber());
+    return sequence_numbers;
+  }
+
+  std::vector<int> PictureIds() const {
+    std::vector<int> picture_ids;
+    for (const RtpPacketReceived& packet : packets) {
+      const uint8_t* payload = packet.payload().data();
+      picture_ids.push_back(((payload[2] & 0x7F) << 8) | payload[3]);
+    }
+    return picture_ids;
+  }
+
+  std::vector<RtpPacketReceived> packets;
+};
+
+class RecordingKeyFrameRequester : public RtpForwarder::KeyFrameRequester {
+ public:
+  void RequestKeyFrame(uint32_t ssrc) override { requests.push_back(ssrc); }
+
+  std::vector<uint32_t> requests;
+};
+
+// Builds a single packet VP8 frame with picture id, TL0PICIDX and TID.
+RtpPacketReceived CreateVp8Packet(uint32_t ssrc,
+                                  uint16_t sequence_number,
+                                  uint32_t timestamp,
+                                  int picture_id,
+                                  uint8_t tl0_pic_idx,
+                                  int temporal_idx,
+                                  bool key_frame,
+                                  size_t payload_size = 100) {
+  RtpPacketReceived packet;
+  packet.SetPayloadType(kVp8PayloadType);
+  packet.SetSsrc(ssrc);
+  packet.SetSequenceNumber(sequence_number);
+  packet.SetTimestamp(timestamp);
+  uint8_t* payload = packet.AllocatePayload(payload_size);
+  memset(payload, 0, payload_size);
+  payload[0] = 0x90;  // X, S, partition 0.
+  payload[1] = 0xE0;  // I, L, T.
+  payload[2] = 0x80 | (picture_id >> 8);
+  payload[3] = picture_id & 0xFF;
+  payload[4] = tl0_pic_idx;
+  payload[5] = temporal_idx << 6;
+  payload[6] = key_frame ? 0x00 : 0x01;
+  return packet;
+}
+
+class RtpForwarderTest : public ::testing::Test {
+ protected:
+  RtpForwarderTest()
+      : clock_(1000),
+        forwarder_(&clock_,
+                   {kLowSsrc, kHighSsrc},
+                   kVp8PayloadType,
+                   &key_frame_requester_) {}
+
+  SimulatedClock clock_;
+  RecordingKeyFrameRequester key_frame_requester_;
+  PacketRecordingTransport transport_;
+  RtpForwarder forwarder_;
+};
+
+TEST_F(RtpForwarderTest, StartsAtKeyFrameAndRewritesHeader) {
+  forwarder_.AddTarget(kTargetSsrc, &transport_);
+  EXPECT_THAT(key_frame_requester_.requests, ElementsAre(kLowSsrc));
+
+  forwarder_.OnRtpPacket(
+      CreateVp8Packet(kLowSsrc, 10, 9000, 100, 5, 0, false));
+  EXPECT_TRUE(transport_.packets.empty());
+  EXPECT_EQ(-1, forwarder_.GetCurrentLayer(kTargetSsrc));
+
+  forwarder_.OnRtpPacket(CreateVp8Packet(kLowSsrc, 11, 12000, 101, 6, 0, true));
+  ASSERT_EQ(1u, transport_.packets.size());
+  EXPECT_EQ(kTargetSsrc, transport_.packets[0].Ssrc());
+  EXPECT_EQ(11, transport_.packets[0].SequenceNumber());
+  EXPECT_EQ(12000u, transport_.packets[0].Timestamp());
+  EXPECT_EQ(0, forwarder_.GetCurrentLayer(kTargetSsrc));
+}
+
+TEST_F(RtpForwarderTest, SwitchesLayerAtKeyFrameWithContinuousNumbering) {
+  forwarder_.AddTarget(kTargetSsrc, &transport_);
+  forwarder_.OnRtpPacket(CreateVp8Packet(kLowSsrc, 10, 9000, 100, 5, 0, true));
+  // Both layers fit the unlimited target bitrate, so the forwarder asks for a
+  // key frame of the high layer and switches once it arrives.
+  clock_.AdvanceTimeMilliseconds(33);
+  forwarder_.OnRtpPacket(
+      CreateVp8Packet(kHighSsrc, 499, 67000, 6999, 49, 0, false));
+  clock_.AdvanceTimeMilliseconds(33);
+  forwarder_.OnRtpPacket(
+      CreateVp8Packet(kHighSsrc, 500, 70000, 7000, 50, 0, false));
+  forwarder_.OnRtpPacket(
+      CreateVp8Packet(kLowSsrc, 11, 12000, 101, 6, 0, false));
+  EXPECT_EQ(kHighSsrc, key_frame_requester_.requests.back());
+  clock_.AdvanceTimeMilliseconds(33);
+  forwarder_.OnRtpPacket(
+      CreateVp8Packet(kHighSsrc, 501, 73000, 7001, 51, 0, true));
+  forwarder_.OnRtpPacket(
+      CreateVp8Packet(kLowSsrc, 12, 15000, 102, 7, 0, false));
+
+  EXPECT_EQ(1, forwarder_.GetCurrentLayer(kTargetSsrc));
+  EXPECT_THAT(transport_.SequenceNumbers(), ElementsAre(10, 11, 12));
+  EXPECT_THAT(transport_.PictureIds(), ElementsAre(100, 101, 102));
+  EXPECT_LT(transport_.packets[1].Timestamp(),
+            transport_.packets[2].Timestamp());
+}
+
+TEST_F(RtpForwarderTest, DropsTemporalLayersAboveTargetBitrate) {
+  forwarder_.AddTarget(kTargetSsrc, &transport_);
+  // Alternate TID 0 and TID 1 frames of equal size.
+  uint16_t sequence_number = 0;
+  int picture_id = 0;
+  for (int i = 0; i < 60; ++i) {
+    forwarder_.OnRtpPacket(CreateVp8Packet(kLowSsrc, sequence_number++,
+                                           i * 3000, picture_id++, i / 2,
+                                           i % 2, i == 0, 1000));
+    clock_.AdvanceTimeMilliseconds(33);
+  }
+  ASSERT_EQ(60u, transport_.packets.size());
+
+  // Only the base layer fits.
+  forwarder_.SetTargetBitrate(kTargetSsrc, 150000);
+  transport_.packets.clear();
+  for (int i = 60; i < 66; ++i) {
+    forwarder_.OnRtpPacket(CreateVp8Packet(kLowSsrc, sequence_number++,
+                                           i * 3000, picture_id++, i / 2,
+                                           i % 2, false, 1000));
+    clock_.AdvanceTimeMilliseconds(33);
+  }
+  EXPECT_THAT(transport_.SequenceNumbers(), ElementsAre(60, 61, 62));
+  EXPECT_THAT(transport_.PictureIds(), ElementsAre(60, 61, 62));
+}
+
+TEST_F(RtpForwarderTest, CoalescesKeyFrameRequests) {
+  PacketRecordingTransport other_transport;
+  forwarder_.AddTarget(kTargetSsrc, &transport_);
+  forwarder_.AddTarget(kTargetSsrc + 1, &other_transport);
+  forwarder_.OnKeyFrameRequest(kTargetSsrc);
+  EXPECT_EQ(1u, key_frame_requester_.requests.size());
+
+  clock_.AdvanceTimeMilliseconds(300);
+  forwarder_.OnKeyFrameRequest(kTargetSsrc);
+  forwarder_.OnKeyFrameRequest(kTargetSsrc + 1);
+  EXPECT_EQ(2u, key_frame_requester_.requests.size());
+}
+
+TEST_F(RtpForwarderTest, DropsPacketsOfOtherPayloadTypes) {
+  forwarder_.AddTarget(kTargetSsrc, &transport_);
+  // Key frames can't be found in payloads that aren't parsed.
+  RtpPacketReceived packet =
+      CreateVp8Packet(kLowSsrc, 10, 9000, 100, 5, 0, true);
+  packet.SetPayloadType(kVp8PayloadType + 1);
+  forwarder_.OnRtpPacket(packet);
+  EXPECT_TRUE(transport_.packets.empty());
+  EXPECT_EQ(-1, forwarder_.GetCurrentLayer(kTargetSsrc));
+}
+
+TEST_F(RtpForwarderTest, TargetCanBeRemovedFromItsTransport) {
+  // Packets are sent after the forwarder has released its lock and is done
+  // with the list of targets.
+  class RemovingTransport : public PacketRecordingTransport {
+   public:
+    explicit RemovingTransport(RtpForwarder* forwarder)
+        : forwarder_(forwarder) {}
+    bool SendRtp(const uint8_t* packet,
+                 size_t length,
+                 const PacketOptions& options) override {
+      forwarder_->RemoveTarget(kTargetSsrc);
+      return PacketRecordingTransport::SendRtp(packet, length, options);
+    }
+
+   private:
+    RtpForwarder* const forwarder_;
+  };
+
+  RemovingTransport removing_transport(&forwarder_);
+  forwarder_.AddTarget(kTargetSsrc, &removing_transport);
+  forwarder_.AddTarget(kTargetSsrc + 1, &transport_);
+  forwarder_.OnRtpPacket(CreateVp8Packet(kLowSsrc, 10, 9000, 100, 5, 0, true));
+  forwarder_.OnRtpPacket(
+      CreateVp8Packet(kLowSsrc, 11, 12000, 101, 6, 0, false));
+
+  EXPECT_EQ(1u, removing_transport.packets.size());
+  EXPECT_THAT(transport_.SequenceNumbers(), ElementsAre(10, 11));
+  EXPECT_EQ(-1, forwarder_.GetCurrentLayer(kTargetSsrc));
+}
+
+TEST_F(RtpForwarderTest, RemoveTargetWaitsForPacketBeingSent) {
+  class SlowTransport : public PacketRecordingTransport {
+   public:
+    bool SendRtp(const uint8_t* packet,
+                 size_t length,
+                 const PacketOptions& options) override {
+      sending.Set();
+      SleepMs(100);
+      return PacketRecordingTransport::SendRtp(packet, length, options);
+    }
+
+    rtc::Event sending{false, false};
+  };
+
+  SlowTransport slow_transport;
+  forwarder_.AddTarget(kTargetSsrc, &slow_transport);
+  rtc::PlatformThread thread(
+      [](void* forwarder) {
+        static_cast<RtpForwarder*>(forwarder)->OnRtpPacket(
+            CreateVp8Packet(kLowSsrc, 10, 9000, 100, 5, 0, true));
+      },
+      &forwarder_, "RtpForwarderSender");
+  thread.Start();
+  ASSERT_TRUE(slow_transport.sending.Wait(1000));
+  forwarder_.RemoveTarget(kTargetSsrc);
+  // The packet being sent has been recorded, so |slow_transport| could be
+  // deleted here.
+  EXPECT_EQ(1u, slow_transport.packets.size());
+  thread.Stop();
+
+  forwarder_.OnRtpPacket(
+      CreateVp8Packet(kLowSsrc, 11, 12000, 101, 6, 0, false));
+  EXPECT_EQ(1u, slow_transport.packets.size());
+}
+
+}  // namespace
+}  // namespace webrtc
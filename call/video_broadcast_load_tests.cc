@@ -0,0 +1,226 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "api/call/transport.h"
+#include "call/call.h"
+#include "media/base/videobroadcaster.h"
+#include "modules/video_coding/codecs/vp8/include/vp8.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/flags.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/call_test.h"
+#include "test/encoder_settings.h"
+#include "test/frame_generator_capturer.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+DEFINE_int(broadcast_test_receivers, 100,
+    "Number of receivers the video broadcast load test sends a source to.");
+DEFINE_int(broadcast_test_duration_ms, 5000,
+    "Duration of the measurement of the video broadcast load test.");
+
+namespace webrtc {
+namespace {
+
+const int kWidth = 320;
+const int kHeight = 180;
+const int kFramerate = 30;
+// Time for the encoders to start and the bitrates to be allocated before the
+// measurement starts.
+const int kWarmupMs = 2000;
+const uint32_t kFirstSsrc = 1000;
+
+// Counts the frames encoded by the streams it's the post encode callback of.
+class EncodeCounter : public EncodedFrameObserver {
+ public:
+  void EncodedFrameCallback(const EncodedFrame& encoded_frame) override {
+    rtc::CritScope lock(&crit_);
+    ++num_encodes_;
+  }
+
+  int num_encodes() {
+    rtc::CritScope lock(&crit_);
+    return num_encodes_;
+  }
+
+ private:
+  rtc::CriticalSection crit_;
+  int num_encodes_ RTC_GUARDED_BY(crit_) = 0;
+};
+
+// Counts the RTP bytes sent to all receivers.
+class CountingTransport : public Transport {
+ public:
+  bool SendRtp(const uint8_t* packet,
+               size_t length,
+               const PacketOptions& options) override {
+    rtc::CritScope lock(&crit_);
+    num_bytes_ += length;
+    return true;
+  }
+  bool SendRtcp(const uint8_t* packet, size_t length) override {
+    return true;
+  }
+
+  size_t num_bytes() {
+    rtc::CritScope lock(&crit_);
+    return num_bytes_;
+  }
+
+ private:
+  rtc::CriticalSection crit_;
+  size_t num_bytes_ RTC_GUARDED_BY(crit_) = 0;
+};
+
+// The default streams, with three temporal layers for the streams sharing an
+// encoder to drop.
+class TemporalLayersStreamFactory
+    : public VideoEncoderConfig::VideoStreamFactoryInterface {
+ private:
+  std::vector<VideoStream> CreateEncoderStreams(
+      int width,
+      int height,
+      const VideoEncoderConfig& encoder_config) override {
+    std::vector<VideoStream> streams =
+        test::CreateVideoStreams(width, height, encoder_config);
+    for (VideoStream& stream : streams) {
+      stream.temporal_layer_thresholds_bps.push_back(
+          stream.max_bitrate_bps / 4);
+      stream.temporal_layer_thresholds_bps.push_back(
+          stream.max_bitrate_bps / 2);
+    }
+    return streams;
+  }
+};
+
+std::string ToString(double value) {
+  std::ostringstream ss;
+  ss << value;
+  return ss.str();
+}
+
+}  // namespace
+
+// Measures the cost of sending one source to --broadcast_test_receivers
+// receivers from a single Call, as an SFU-like server would: with a VP8
+// video send stream and encoder per receiver, and with all streams sharing
+// the encoder of the first one (see
+// VideoSendStream::Config::shared_encoder_leader_ssrc). The encodes per
+// second, process CPU usage and sent bitrate of both are reported as perf
+// results.
+class VideoBroadcastLoadTest : public test::CallTest {
+ protected:
+  void RunBroadcast(const std::string& trace, bool share_encoder) {
+    const int num_receivers = FLAG_broadcast_test_receivers;
+    std::vector<std::unique_ptr<VideoEncoder>> encoders;
+    std::vector<VideoSendStream*> send_streams;
+    std::unique_ptr<test::FrameGeneratorCapturer> capturer;
+    rtc::VideoBroadcaster broadcaster;
+    EncodeCounter encode_counter;
+    CountingTransport transport;
+
+    task_queue_.SendTask([&]() {
+      Call::Config config(event_log_.get());
+      // Enough for all temporal layers of every stream.
+      config.bitrate_config.start_bitrate_bps =
+          num_receivers *
+          test::DefaultVideoStreamFactory::kMaxBitratePerStream[0];
+      config.bitrate_config.max_bitrate_bps =
+          config.bitrate_config.start_bitrate_bps;
+      CreateSenderCall(config);
+
+      for (int i = 0; i < num_receivers; ++i) {
+        VideoSendStream::Config send_config(&transport);
+        send_config.encoder_settings.payload_name = "VP8";
+        send_config.encoder_settings.payload_type = kVideoSendPayloadType;
+        send_config.rtp.ssrcs.push_back(kFirstSsrc + i);
+        if (share_encoder && i > 0) {
+          send_config.shared_encoder_leader_ssrc =
+              rtc::Optional<uint32_t>(kFirstSsrc);
+        } else {
+          encoders.emplace_back(VP8Encoder::Create());
+          send_config.encoder_settings.encoder = encoders.back().get();
+          send_config.post_encode_callback = &encode_counter;
+        }
+        VideoEncoderConfig encoder_config;
+        test::FillEncoderConfiguration(1, &encoder_config);
+        encoder_config.video_stream_factory =
+            new rtc::RefCountedObject<TemporalLayersStreamFactory>();
+
+        VideoSendStream* send_stream = sender_call_->CreateVideoSendStream(
+            std::move(send_config), std::move(encoder_config));
+        if (!share_encoder || i == 0) {
+          send_stream->SetSource(
+              &broadcaster,
+              VideoSendStream::DegradationPreference::kMaintainFramerate);
+        }
+        send_stream->Start();
+        send_streams.push_back(send_stream);
+      }
+
+      capturer.reset(test::FrameGeneratorCapturer::Create(
+          kWidth, kHeight, kFramerate, clock_));
+      capturer->AddOrUpdateSink(&broadcaster, rtc::VideoSinkWants());
+      capturer->Start();
+    });
+    SleepMs(kWarmupMs);
+
+    const int start_encodes = encode_counter.num_encodes();
+    const size_t start_bytes = transport.num_bytes();
+    const int64_t start_time_ns = rtc::TimeNanos();
+    const int64_t start_cpu_ns = rtc::GetProcessCpuTimeNanos();
+
+    SleepMs(FLAG_broadcast_test_duration_ms);
+
+    const double elapsed_ns = rtc::TimeNanos() - start_time_ns;
+    const double cpu_percent =
+        100 * (rtc::GetProcessCpuTimeNanos() - start_cpu_ns) / elapsed_ns;
+    const double encodes_per_second =
+        (encode_counter.num_encodes() - start_encodes) *
+        rtc::kNumNanosecsPerSec / elapsed_ns;
+    const double sent_kbps = 8 * (transport.num_bytes() - start_bytes) *
+                             rtc::kNumNanosecsPerMillisec / elapsed_ns;
+
+    task_queue_.SendTask([&]() {
+      capturer->Stop();
+      for (VideoSendStream* send_stream : send_streams) {
+        send_stream->Stop();
+        sender_call_->DestroyVideoSendStream(send_stream);
+      }
+      DestroyCalls();
+    });
+
+    test::PrintResult("video_broadcast", "_encodes_per_second", trace,
+                      ToString(encodes_per_second), "encodes/s", true);
+    test::PrintResult("video_broadcast", "_cpu", trace, ToString(cpu_percent),
+                      "percent", true);
+    test::PrintResult("video_broadcast", "_sent_bitrate", trace,
+                      ToString(sent_kbps), "kbps", false);
+    EXPECT_GT(encodes_per_second, 0);
+  }
+};
+
+TEST_F(VideoBroadcastLoadTest, EncoderPerReceiver) {
+  RunBroadcast("encoder_per_receiver", false);
+}
+
+TEST_F(VideoBroadcastLoadTest, SharedEncoder) {
+  RunBroadcast("shared_encoder", true);
+}
+
+}  // namespace webrtc
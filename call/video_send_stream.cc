@@ -75,6 +75,8 @@ std::string VideoSendStream::Config::ToString() const {
      << (pre_encode_callback ? "(VideoSinkInterface)" : "nullptr");
   ss << ", post_encode_callback: "
      << (post_encode_callback ? "(EncodedFrameObserver)" : "nullptr");
+  if (shared_encoder_leader_ssrc)
+    ss << ", shared_encoder_leader_ssrc: " << *shared_encoder_leader_ssrc;
   ss << ", render_delay_ms: " << render_delay_ms;
   ss << ", target_delay_ms: " << target_delay_ms;
   ss << ", suspend_below_min_bitrate: "
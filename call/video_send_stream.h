@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "api/call/transport.h"
+#include "api/optional.h"
 #include "api/rtpparameters.h"
 #include "call/rtp_config.h"
 #include "call/video_config.h"
@@ -203,6 +204,16 @@ class VideoSendStream {
     // than the measuring window, since the sample data will have been dropped.
     EncodedFrameObserver* post_encode_callback = nullptr;
 
+    // SSRC of another video send stream of the same Call whose encoder output
+    // this stream sends, e.g. to broadcast one source to many receivers at the
+    // cost of a single encode. Such a stream has no encoder of its own, so
+    // SetSource() and ReconfigureVideoEncoder() have no effect, and it sends
+    // nothing while no stream with that SSRC exists. Both streams must have
+    // the same codec settings and number of simulcast layers. Each stream
+    // keeps its own SSRCs, sequence numbers and picture ids; key frame
+    // requests are forwarded to, and rate limited by, the leader.
+    rtc::Optional<uint32_t> shared_encoder_leader_ssrc;
+
     // Expected delay needed by the renderer, i.e. the frame will be delivered
     // this many milliseconds, if possible, earlier than expected render time.
     // Only valid if |local_renderer| is set.
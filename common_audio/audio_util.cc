@@ -12,33 +12,287 @@
 
 #include "typedefs.h"  // NOLINT(build/include)
 
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace webrtc {
+namespace {
+
+// The vectorized conversions below do the same float operations, in the same
+// order, as the scalar functions in audio_util.h, so that the results are
+// bit-exact. The scalar functions handle the remaining samples.
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+
+// Returns |positive| where |v| > 0 and |other| elsewhere.
+inline __m128 SelectPositive(__m128 v, __m128 positive, __m128 other) {
+  const __m128 mask = _mm_cmpgt_ps(v, _mm_setzero_ps());
+  return _mm_or_ps(_mm_and_ps(mask, positive), _mm_andnot_ps(mask, other));
+}
+
+inline __m128 FloatToFloatS16(__m128 v) {
+  return _mm_mul_ps(v, SelectPositive(v, _mm_set1_ps(limits_int16::max()),
+                                      _mm_set1_ps(-limits_int16::min())));
+}
+
+inline __m128 FloatS16ToFloat(__m128 v) {
+  const float kMaxInt16Inverse = 1.f / limits_int16::max();
+  const float kMinInt16Inverse = 1.f / limits_int16::min();
+  return _mm_mul_ps(v, SelectPositive(v, _mm_set1_ps(kMaxInt16Inverse),
+                                      _mm_set1_ps(-kMinInt16Inverse)));
+}
+
+// Rounds half away from zero and saturates, like FloatS16ToS16(float).
+inline __m128i FloatS16ToS32(__m128 v) {
+  __m128 rounded =
+      _mm_add_ps(v, SelectPositive(v, _mm_set1_ps(0.5f), _mm_set1_ps(-0.5f)));
+  rounded = _mm_max_ps(rounded, _mm_set1_ps(limits_int16::min()));
+  rounded = _mm_min_ps(rounded, _mm_set1_ps(limits_int16::max()));
+  return _mm_cvttps_epi32(rounded);
+}
+
+inline __m128i FloatS16ToS16(__m128 low, __m128 high) {
+  return _mm_packs_epi32(FloatS16ToS32(low), FloatS16ToS32(high));
+}
+
+inline void S16ToFloatS16(__m128i v, __m128* low, __m128* high) {
+  // Sign extend by shifting the samples into the upper half of 32 bits.
+  *low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+  *high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+
+#elif defined(WEBRTC_HAS_NEON)
+
+inline float32x4_t SelectPositive(float32x4_t v,
+                                  float32x4_t positive,
+                                  float32x4_t other) {
+  return vbslq_f32(vcgtq_f32(v, vdupq_n_f32(0.f)), positive, other);
+}
+
+inline float32x4_t FloatToFloatS16(float32x4_t v) {
+  return vmulq_f32(v, SelectPositive(v, vdupq_n_f32(limits_int16::max()),
+                                     vdupq_n_f32(-limits_int16::min())));
+}
+
+inline float32x4_t FloatS16ToFloat(float32x4_t v) {
+  const float kMaxInt16Inverse = 1.f / limits_int16::max();
+  const float kMinInt16Inverse = 1.f / limits_int16::min();
+  return vmulq_f32(v, SelectPositive(v, vdupq_n_f32(kMaxInt16Inverse),
+                                     vdupq_n_f32(-kMinInt16Inverse)));
+}
+
+// Rounds half away from zero and saturates, like FloatS16ToS16(float).
+inline int32x4_t FloatS16ToS32(float32x4_t v) {
+  float32x4_t rounded =
+      vaddq_f32(v, SelectPositive(v, vdupq_n_f32(0.5f), vdupq_n_f32(-0.5f)));
+  rounded = vmaxq_f32(rounded, vdupq_n_f32(limits_int16::min()));
+  rounded = vminq_f32(rounded, vdupq_n_f32(limits_int16::max()));
+  return vcvtq_s32_f32(rounded);
+}
+
+inline int16x8_t FloatS16ToS16(float32x4_t low, float32x4_t high) {
+  return vcombine_s16(vmovn_s32(FloatS16ToS32(low)),
+                      vmovn_s32(FloatS16ToS32(high)));
+}
+
+inline void S16ToFloatS16(int16x8_t v, float32x4_t* low, float32x4_t* high) {
+  *low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+  *high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+}
+
+#endif
+
+}  // namespace
 
 void FloatToS16(const float* src, size_t size, int16_t* dest) {
-  for (size_t i = 0; i < size; ++i)
+  size_t i = 0;
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  for (; i + 8 <= size; i += 8) {
+    const __m128 low = FloatToFloatS16(_mm_loadu_ps(src + i));
+    const __m128 high = FloatToFloatS16(_mm_loadu_ps(src + i + 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                     FloatS16ToS16(low, high));
+  }
+#elif defined(WEBRTC_HAS_NEON)
+  for (; i + 8 <= size; i += 8) {
+    const float32x4_t low = FloatToFloatS16(vld1q_f32(src + i));
+    const float32x4_t high = FloatToFloatS16(vld1q_f32(src + i + 4));
+    vst1q_s16(dest + i, FloatS16ToS16(low, high));
+  }
+#endif
+  for (; i < size; ++i)
     dest[i] = FloatToS16(src[i]);
 }
 
 void S16ToFloat(const int16_t* src, size_t size, float* dest) {
-  for (size_t i = 0; i < size; ++i)
+  size_t i = 0;
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  for (; i + 8 <= size; i += 8) {
+    __m128 low, high;
+    S16ToFloatS16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)),
+                  &low, &high);
+    _mm_storeu_ps(dest + i, FloatS16ToFloat(low));
+    _mm_storeu_ps(dest + i + 4, FloatS16ToFloat(high));
+  }
+#elif defined(WEBRTC_HAS_NEON)
+  for (; i + 8 <= size; i += 8) {
+    float32x4_t low, high;
+    S16ToFloatS16(vld1q_s16(src + i), &low, &high);
+    vst1q_f32(dest + i, FloatS16ToFloat(low));
+    vst1q_f32(dest + i + 4, FloatS16ToFloat(high));
+  }
+#endif
+  for (; i < size; ++i)
     dest[i] = S16ToFloat(src[i]);
 }
 
+void S16ToFloatS16(const int16_t* src, size_t size, float* dest) {
+  size_t i = 0;
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  for (; i + 8 <= size; i += 8) {
+    __m128 low, high;
+    S16ToFloatS16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)),
+                  &low, &high);
+    _mm_storeu_ps(dest + i, low);
+    _mm_storeu_ps(dest + i + 4, high);
+  }
+#elif defined(WEBRTC_HAS_NEON)
+  for (; i + 8 <= size; i += 8) {
+    float32x4_t low, high;
+    S16ToFloatS16(vld1q_s16(src + i), &low, &high);
+    vst1q_f32(dest + i, low);
+    vst1q_f32(dest + i + 4, high);
+  }
+#endif
+  for (; i < size; ++i)
+    dest[i] = src[i];
+}
+
 void FloatS16ToS16(const float* src, size_t size, int16_t* dest) {
-  for (size_t i = 0; i < size; ++i)
+  size_t i = 0;
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  for (; i + 8 <= size; i += 8) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dest + i),
+        FloatS16ToS16(_mm_loadu_ps(src + i), _mm_loadu_ps(src + i + 4)));
+  }
+#elif defined(WEBRTC_HAS_NEON)
+  for (; i + 8 <= size; i += 8) {
+    vst1q_s16(dest + i,
+              FloatS16ToS16(vld1q_f32(src + i), vld1q_f32(src + i + 4)));
+  }
+#endif
+  for (; i < size; ++i)
     dest[i] = FloatS16ToS16(src[i]);
 }
 
 void FloatToFloatS16(const float* src, size_t size, float* dest) {
-  for (size_t i = 0; i < size; ++i)
+  size_t i = 0;
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  for (; i + 4 <= size; i += 4)
+    _mm_storeu_ps(dest + i, FloatToFloatS16(_mm_loadu_ps(src + i)));
+#elif defined(WEBRTC_HAS_NEON)
+  for (; i + 4 <= size; i += 4)
+    vst1q_f32(dest + i, FloatToFloatS16(vld1q_f32(src + i)));
+#endif
+  for (; i < size; ++i)
     dest[i] = FloatToFloatS16(src[i]);
 }
 
 void FloatS16ToFloat(const float* src, size_t size, float* dest) {
-  for (size_t i = 0; i < size; ++i)
+  size_t i = 0;
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  for (; i + 4 <= size; i += 4)
+    _mm_storeu_ps(dest + i, FloatS16ToFloat(_mm_loadu_ps(src + i)));
+#elif defined(WEBRTC_HAS_NEON)
+  for (; i + 4 <= size; i += 4)
+    vst1q_f32(dest + i, FloatS16ToFloat(vld1q_f32(src + i)));
+#endif
+  for (; i < size; ++i)
     dest[i] = FloatS16ToFloat(src[i]);
 }
 
+template <>
+void Deinterleave<int16_t>(const int16_t* interleaved,
+                           size_t samples_per_channel,
+                           size_t num_channels,
+                           int16_t* const* deinterleaved) {
+  size_t i = 0;
+  if (num_channels == 2) {
+    int16_t* left = deinterleaved[0];
+    int16_t* right = deinterleaved[1];
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+    for (; i + 8 <= samples_per_channel; i += 8) {
+      const __m128i a =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(interleaved));
+      const __m128i b =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(interleaved + 8));
+      interleaved += 16;
+      // Each 32 bits hold a left sample in the lower and a right sample in
+      // the upper half. Sign extend either half and pack them again.
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(left + i),
+          _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                          _mm_srai_epi32(_mm_slli_epi32(b, 16), 16)));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(right + i),
+          _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16)));
+    }
+#elif defined(WEBRTC_HAS_NEON)
+    for (; i + 8 <= samples_per_channel; i += 8) {
+      const int16x8x2_t samples = vld2q_s16(interleaved);
+      interleaved += 16;
+      vst1q_s16(left + i, samples.val[0]);
+      vst1q_s16(right + i, samples.val[1]);
+    }
+#endif
+  }
+  for (; i < samples_per_channel; ++i) {
+    for (size_t j = 0; j < num_channels; ++j)
+      deinterleaved[j][i] = *interleaved++;
+  }
+}
+
+template <>
+void Interleave<int16_t>(const int16_t* const* deinterleaved,
+                         size_t samples_per_channel,
+                         size_t num_channels,
+                         int16_t* interleaved) {
+  size_t i = 0;
+  if (num_channels == 2) {
+    const int16_t* left = deinterleaved[0];
+    const int16_t* right = deinterleaved[1];
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+    for (; i + 8 <= samples_per_channel; i += 8) {
+      const __m128i l =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+      const __m128i r =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(interleaved),
+                       _mm_unpacklo_epi16(l, r));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(interleaved + 8),
+                       _mm_unpackhi_epi16(l, r));
+      interleaved += 16;
+    }
+#elif defined(WEBRTC_HAS_NEON)
+    for (; i + 8 <= samples_per_channel; i += 8) {
+      int16x8x2_t samples;
+      samples.val[0] = vld1q_s16(left + i);
+      samples.val[1] = vld1q_s16(right + i);
+      vst2q_s16(interleaved, samples);
+      interleaved += 16;
+    }
+#endif
+  }
+  for (; i < samples_per_channel; ++i) {
+    for (size_t j = 0; j < num_channels; ++j)
+      *interleaved++ = deinterleaved[j][i];
+  }
+}
+
 template <>
 void DownmixInterleavedToMono<int16_t>(const int16_t* interleaved,
                                        size_t num_frames,
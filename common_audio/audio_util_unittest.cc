@@ -122,6 +122,76 @@ TEST(AudioUtilTest, InterleavingStereo) {
   ExpectArraysEq(kInterleaved, interleaved, kLength);
 }
 
+// The vectorized array conversions must be bit-exact with the scalar ones,
+// including for the samples that don't fill a whole vector.
+TEST(AudioUtilTest, ArrayConversionsAreBitExact) {
+  const size_t kSize = 77;
+  float float_input[kSize];
+  float float_s16_input[kSize];
+  int16_t s16_input[kSize];
+  for (size_t i = 0; i < kSize; ++i) {
+    // Covers the full range, rounding ties, zero and values out of range.
+    float_s16_input[i] = (static_cast<float>(i) - kSize / 2) * 997.5f;
+    float_input[i] = float_s16_input[i] / 32768.f;
+    s16_input[i] = static_cast<int16_t>(FloatS16ToS16(float_s16_input[i]));
+  }
+  float_s16_input[0] = 0.5f;
+  float_s16_input[1] = -0.5f;
+  float_s16_input[2] = 32766.5f;
+  float_s16_input[3] = -32767.5f;
+  float_input[4] = 1.f;
+  float_input[5] = -1.f;
+  s16_input[6] = limits_int16::max();
+  s16_input[7] = limits_int16::min();
+
+  for (size_t size = 0; size <= kSize; ++size) {
+    int16_t s16_output[kSize];
+    float float_output[kSize];
+
+    FloatToS16(float_input, size, s16_output);
+    for (size_t i = 0; i < size; ++i)
+      EXPECT_EQ(FloatToS16(float_input[i]), s16_output[i]);
+
+    FloatS16ToS16(float_s16_input, size, s16_output);
+    for (size_t i = 0; i < size; ++i)
+      EXPECT_EQ(FloatS16ToS16(float_s16_input[i]), s16_output[i]);
+
+    S16ToFloat(s16_input, size, float_output);
+    for (size_t i = 0; i < size; ++i)
+      EXPECT_EQ(S16ToFloat(s16_input[i]), float_output[i]);
+
+    S16ToFloatS16(s16_input, size, float_output);
+    for (size_t i = 0; i < size; ++i)
+      EXPECT_EQ(static_cast<float>(s16_input[i]), float_output[i]);
+
+    FloatToFloatS16(float_input, size, float_output);
+    for (size_t i = 0; i < size; ++i)
+      EXPECT_EQ(FloatToFloatS16(float_input[i]), float_output[i]);
+
+    FloatS16ToFloat(float_s16_input, size, float_output);
+    for (size_t i = 0; i < size; ++i)
+      EXPECT_EQ(FloatS16ToFloat(float_s16_input[i]), float_output[i]);
+  }
+}
+
+TEST(AudioUtilTest, InterleavingLongStereo) {
+  const size_t kSamplesPerChannel = 37;
+  int16_t interleaved[2 * kSamplesPerChannel];
+  for (size_t i = 0; i < 2 * kSamplesPerChannel; ++i)
+    interleaved[i] = static_cast<int16_t>(i * 1777 - 32768);
+  int16_t left[kSamplesPerChannel], right[kSamplesPerChannel];
+  int16_t* deinterleaved[] = {left, right};
+  Deinterleave(interleaved, kSamplesPerChannel, 2, deinterleaved);
+  for (size_t i = 0; i < kSamplesPerChannel; ++i) {
+    EXPECT_EQ(interleaved[2 * i], left[i]);
+    EXPECT_EQ(interleaved[2 * i + 1], right[i]);
+  }
+
+  int16_t reinterleaved[2 * kSamplesPerChannel];
+  Interleave(deinterleaved, kSamplesPerChannel, 2, reinterleaved);
+  ExpectArraysEq(interleaved, reinterleaved, 2 * kSamplesPerChannel);
+}
+
 TEST(AudioUtilTest, InterleavingMonoIsIdentical) {
   const int16_t kInterleaved[] = {1, 2, 3, 4, 5};
   const size_t kSamplesPerChannel = 5;
@@ -59,8 +59,11 @@ static inline float FloatS16ToFloat(float v) {
   return v * (v > 0 ? kMaxInt16Inverse : -kMinInt16Inverse);
 }
 
+// The array versions are vectorized where possible, with results that are
+// bit-exact with the scalar functions above.
 void FloatToS16(const float* src, size_t size, int16_t* dest);
 void S16ToFloat(const int16_t* src, size_t size, float* dest);
+void S16ToFloatS16(const int16_t* src, size_t size, float* dest);
 void FloatS16ToS16(const float* src, size_t size, int16_t* dest);
 void FloatToFloatS16(const float* src, size_t size, float* dest);
 void FloatS16ToFloat(const float* src, size_t size, float* dest);
@@ -117,6 +120,19 @@ void Interleave(const T* const* deinterleaved,
   }
 }
 
+// Vectorized for stereo.
+template <>
+void Deinterleave<int16_t>(const int16_t* interleaved,
+                           size_t samples_per_channel,
+                           size_t num_channels,
+                           int16_t* const* deinterleaved);
+
+template <>
+void Interleave<int16_t>(const int16_t* const* deinterleaved,
+                         size_t samples_per_channel,
+                         size_t num_channels,
+                         int16_t* interleaved);
+
 // Copies audio from a single channel buffer pointed to by |mono| to each
 // channel of |interleaved|. There must be sufficient space allocated in
 // |interleaved| (|samples_per_channel| * |num_channels|).
@@ -296,8 +296,12 @@ void H264BitstreamParser::ParseSlice(const uint8_t* slice, size_t length) {
 
 void H264BitstreamParser::ParseBitstream(const uint8_t* bitstream,
                                          size_t length) {
-  std::vector<H264::NaluIndex> nalu_indices =
-      H264::FindNaluIndices(bitstream, length);
+  ParseBitstream(bitstream, H264::FindNaluIndices(bitstream, length));
+}
+
+void H264BitstreamParser::ParseBitstream(
+    const uint8_t* bitstream,
+    const std::vector<H264::NaluIndex>& nalu_indices) {
   for (const H264::NaluIndex& index : nalu_indices)
     ParseSlice(&bitstream[index.payload_start_offset], index.payload_size);
 }
@@ -13,7 +13,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <vector>
+
 #include "api/optional.h"
+#include "common_video/h264/h264_common.h"
 #include "common_video/h264/pps_parser.h"
 #include "common_video/h264/sps_parser.h"
 
@@ -43,6 +46,12 @@ class H264BitstreamParser {
   // Parse an additional chunk of H264 bitstream.
   void ParseBitstream(const uint8_t* bitstream, size_t length);
 
+  // Same as above, but for a chunk whose NALUs have already been located, e.g.
+  // by H264::FindNaluIndices() or the encoder's fragmentation header. Avoids
+  // scanning the bitstream for start codes a second time.
+  void ParseBitstream(const uint8_t* bitstream,
+                      const std::vector<H264::NaluIndex>& nalu_indices);
+
   // Get the last extracted QP value from the parsed bitstream.
   bool GetLastSliceQp(int* qp) const;
 
@@ -85,4 +85,15 @@ TEST(H264BitstreamParserTest, ReportsLastSliceQpForCABACImageSlices) {
   EXPECT_EQ(24, qp);
 }
 
+TEST(H264BitstreamParserTest, ReportsLastSliceQpForPrecomputedNaluIndices) {
+  H264BitstreamParser h264_parser;
+  const std::vector<H264::NaluIndex> nalu_indices =
+      H264::FindNaluIndices(kH264BitstreamChunk, sizeof(kH264BitstreamChunk));
+  ASSERT_EQ(3u, nalu_indices.size());
+  h264_parser.ParseBitstream(kH264BitstreamChunk, nalu_indices);
+  int qp;
+  ASSERT_TRUE(h264_parser.GetLastSliceQp(&qp));
+  EXPECT_EQ(35, qp);
+}
+
 }  // namespace webrtc
@@ -10,42 +10,51 @@
 
 #include "common_video/h264/h264_common.h"
 
+#include <string.h>
+
 namespace webrtc {
 namespace H264 {
 
 const uint8_t kNaluTypeMask = 0x1F;
+const uint8_t kEmulationByte = 0x03u;
 
 std::vector<NaluIndex> FindNaluIndices(const uint8_t* buffer,
                                        size_t buffer_size) {
-  // This is sorta like Boyer-Moore, but with only the first optimization step:
-  // given a 3-byte sequence we're looking at, if the 3rd byte isn't 1 or 0,
-  // skip ahead to the next 3-byte sequence. 0s and 1s are relatively rare, so
-  // this will skip the majority of reads/checks.
+  // A start sequence always ends with a 1 byte, and 1s are relatively rare in
+  // the bitstream, so use memchr() (which is vectorized in every libc we
+  // support) to skip straight to the next candidate and only then check for
+  // the two preceding zero bytes.
   std::vector<NaluIndex> sequences;
   if (buffer_size < kNaluShortStartSequenceSize)
     return sequences;
 
-  const size_t end = buffer_size - kNaluShortStartSequenceSize;
-  for (size_t i = 0; i < end;) {
-    if (buffer[i + 2] > 1) {
-      i += 3;
-    } else if (buffer[i + 2] == 1 && buffer[i + 1] == 0 && buffer[i] == 0) {
-      // We found a start sequence, now check if it was a 3 of 4 byte one.
-      NaluIndex index = {i, i + 3, 0};
-      if (index.start_offset > 0 && buffer[index.start_offset - 1] == 0)
-        --index.start_offset;
+  // A start sequence must be followed by at least one byte, so the last byte
+  // of the buffer can never terminate one.
+  const uint8_t* const end = buffer + buffer_size - 1;
+  const uint8_t* pos = buffer + kNaluShortStartSequenceSize - 1;
+  while (pos < end) {
+    pos = static_cast<const uint8_t*>(memchr(pos, 1, end - pos));
+    if (!pos)
+      break;
+    if (pos[-1] != 0 || pos[-2] != 0) {
+      ++pos;
+      continue;
+    }
+    // We found a start sequence, now check if it was a 3 of 4 byte one.
+    const size_t i = pos - buffer - 2;
+    NaluIndex index = {i, i + 3, 0};
+    if (index.start_offset > 0 && buffer[index.start_offset - 1] == 0)
+      --index.start_offset;
 
-      // Update length of previous entry.
-      auto it = sequences.rbegin();
-      if (it != sequences.rend())
-        it->payload_size = index.start_offset - it->payload_start_offset;
+    // Update length of previous entry.
+    auto it = sequences.rbegin();
+    if (it != sequences.rend())
+      it->payload_size = index.start_offset - it->payload_start_offset;
 
-      sequences.push_back(index);
+    sequences.push_back(index);
 
-      i += 3;
-    } else {
-      ++i;
-    }
+    // The next start sequence can end no earlier than 3 bytes from here.
+    pos += kNaluShortStartSequenceSize;
   }
 
   // Update length of last entry, if any.
@@ -64,28 +73,33 @@ std::vector<uint8_t> ParseRbsp(const uint8_t* data, size_t length) {
   std::vector<uint8_t> out;
   out.reserve(length);
 
-  for (size_t i = 0; i < length;) {
-    // Be careful about over/underflow here. byte_length_ - 3 can underflow, and
-    // i + 3 can overflow, but byte_length_ - i can't, because i < byte_length_
-    // above, and that expression will produce the number of bytes left in
-    // the stream including the byte at i.
-    if (length - i >= 3 && !data[i] && !data[i + 1] && data[i + 2] == 3) {
-      // Two rbsp bytes.
-      out.push_back(data[i++]);
-      out.push_back(data[i++]);
-      // Skip the emulation byte.
-      i++;
+  // Emulation prevention bytes are rare, so find them with memchr() and copy
+  // the runs of rbsp bytes in between in bulk. Occurrences of 00 00 03 can't
+  // overlap, so every one found at or after |run_start| is an escape.
+  size_t run_start = 0;
+  size_t search = 2;
+  while (search < length) {
+    const uint8_t* found = static_cast<const uint8_t*>(
+        memchr(data + search, kEmulationByte, length - search));
+    if (!found)
+      break;
+    const size_t i = found - data;
+    if (i - 2 >= run_start && data[i - 1] == 0 && data[i - 2] == 0) {
+      // Copy everything up to and including the two rbsp zero bytes, then
+      // skip the emulation byte.
+      out.insert(out.end(), data + run_start, data + i);
+      run_start = i + 1;
+      search = run_start + 2;
     } else {
-      // Single rbsp byte.
-      out.push_back(data[i++]);
+      search = i + 1;
     }
   }
+  out.insert(out.end(), data + run_start, data + length);
   return out;
 }
 
 void WriteRbsp(const uint8_t* bytes, size_t length, rtc::Buffer* destination) {
   static const uint8_t kZerosInStartSequence = 2;
-  static const uint8_t kEmulationByte = 0x03u;
   size_t num_consecutive_zeros = 0;
   destination->EnsureCapacity(destination->size() + length);
 
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/h264/h264_common.h"
+
+#include <vector>
+
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace H264 {
+
+TEST(H264CommonTest, FindNaluIndicesEmptyForShortOrStartCodeFreeBuffers) {
+  const uint8_t kShort[] = {0x00, 0x01};
+  EXPECT_TRUE(FindNaluIndices(kShort, sizeof(kShort)).empty());
+  // A start sequence at the very end has no payload and isn't reported.
+  const uint8_t kTrailing[] = {0x12, 0x00, 0x00, 0x01};
+  EXPECT_TRUE(FindNaluIndices(kTrailing, sizeof(kTrailing)).empty());
+  const uint8_t kNoStartCode[] = {0x00, 0x02, 0x01, 0x00, 0x01, 0x00};
+  EXPECT_TRUE(FindNaluIndices(kNoStartCode, sizeof(kNoStartCode)).empty());
+}
+
+TEST(H264CommonTest, FindNaluIndicesShortAndLongStartSequences) {
+  const uint8_t kBuffer[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x01,
+                             0x00, 0x00, 0x01, 0x68, 0xce, 0x00, 0x00,
+                             0x00, 0x01, 0x65, 0x00, 0x00, 0x01, 0x41};
+  const std::vector<NaluIndex> indices =
+      FindNaluIndices(kBuffer, sizeof(kBuffer));
+  ASSERT_EQ(4u, indices.size());
+
+  EXPECT_EQ(0u, indices[0].start_offset);
+  EXPECT_EQ(4u, indices[0].payload_start_offset);
+  EXPECT_EQ(3u, indices[0].payload_size);
+
+  EXPECT_EQ(7u, indices[1].start_offset);
+  EXPECT_EQ(10u, indices[1].payload_start_offset);
+  EXPECT_EQ(2u, indices[1].payload_size);
+
+  EXPECT_EQ(12u, indices[2].start_offset);
+  EXPECT_EQ(16u, indices[2].payload_start_offset);
+  EXPECT_EQ(1u, indices[2].payload_size);
+
+  EXPECT_EQ(17u, indices[3].start_offset);
+  EXPECT_EQ(20u, indices[3].payload_start_offset);
+  EXPECT_EQ(1u, indices[3].payload_size);
+}
+
+TEST(H264CommonTest, ParseRbspRemovesEmulationBytes) {
+  const uint8_t kEscaped[] = {0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x01,
+                              0x03, 0x00, 0x00, 0x03, 0x03, 0x00, 0x03};
+  const std::vector<uint8_t> kExpected = {0x00, 0x00, 0x00, 0x00, 0x01,
+                                          0x03, 0x00, 0x00, 0x03, 0x00,
+                                          0x03};
+  EXPECT_EQ(kExpected, ParseRbsp(kEscaped, sizeof(kEscaped)));
+}
+
+TEST(H264CommonTest, ParseRbspRoundTripsWriteRbsp) {
+  std::vector<uint8_t> rbsp;
+  for (int i = 0; i < 1024; ++i)
+    rbsp.push_back(i % 7 < 4 ? 0 : static_cast<uint8_t>(i % 5));
+  rtc::Buffer escaped;
+  WriteRbsp(rbsp.data(), rbsp.size(), &escaped);
+  EXPECT_GT(escaped.size(), rbsp.size());
+  EXPECT_EQ(rbsp, ParseRbsp(escaped.data(), escaped.size()));
+}
+
+}  // namespace H264
+}  // namespace webrtc
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "common_video/h264/h264_bitstream_parser.h"
+#include "common_video/h264/h264_common.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+// Roughly the size of a 3840x2160 key frame at 20 Mbps, split into slices the
+// way hardware encoders typically do for 4K.
+constexpr size_t kFrameSizeBytes = 1000000;
+constexpr size_t kNumSlices = 8;
+constexpr int kNumIterations = 100;
+
+const uint8_t kSpsPps[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x80, 0x20,
+                           0xda, 0x01, 0x40, 0x16, 0xe8, 0x06, 0xd0, 0xa1,
+                           0x35, 0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x06,
+                           0xe2};
+
+// IDR NALU header and slice header matching |kSpsPps|, QP 35.
+const uint8_t kIdrSliceHeader[] = {0x00, 0x00, 0x00, 0x01, 0x65, 0xb8,
+                                   0x40, 0xf0, 0x8c, 0x03, 0xf2, 0x75};
+
+// The byte-by-byte scanner FindNaluIndices() used before it was switched to
+// memchr(), kept here to track the speedup.
+std::vector<H264::NaluIndex> ReferenceFindNaluIndices(const uint8_t* buffer,
+                                                      size_t buffer_size) {
+  std::vector<H264::NaluIndex> sequences;
+  if (buffer_size < H264::kNaluShortStartSequenceSize)
+    return sequences;
+
+  const size_t end = buffer_size - H264::kNaluShortStartSequenceSize;
+  for (size_t i = 0; i < end;) {
+    if (buffer[i + 2] > 1) {
+      i += 3;
+    } else if (buffer[i + 2] == 1 && buffer[i + 1] == 0 && buffer[i] == 0) {
+      H264::NaluIndex index = {i, i + 3, 0};
+      if (index.start_offset > 0 && buffer[index.start_offset - 1] == 0)
+        --index.start_offset;
+      auto it = sequences.rbegin();
+      if (it != sequences.rend())
+        it->payload_size = index.start_offset - it->payload_start_offset;
+      sequences.push_back(index);
+      i += 3;
+    } else {
+      ++i;
+    }
+  }
+  auto it = sequences.rbegin();
+  if (it != sequences.rend())
+    it->payload_size = buffer_size - it->payload_start_offset;
+  return sequences;
+}
+
+// Builds an access unit of SPS, PPS and |kNumSlices| IDR slices whose payload
+// is random data with emulation prevention applied, like an encoder's output.
+rtc::Buffer Create4kKeyFrame() {
+  Random random(0x4b);
+  rtc::Buffer frame(kSpsPps, sizeof(kSpsPps));
+  const size_t slice_payload_size = kFrameSizeBytes / kNumSlices;
+  std::vector<uint8_t> payload(slice_payload_size);
+  for (size_t i = 0; i < kNumSlices; ++i) {
+    for (uint8_t& byte : payload) {
+      // Bias towards zero bytes so that escapes and start code candidates
+      // show up about as often as in real CABAC output.
+      byte = random.Rand(0, 3) == 0 ? 0 : random.Rand<uint8_t>();
+    }
+    frame.AppendData(kIdrSliceHeader, sizeof(kIdrSliceHeader));
+    H264::WriteRbsp(payload.data(), payload.size(), &frame);
+  }
+  return frame;
+}
+
+// Returns the throughput of |function| over |frame| in MB/s.
+template <typename Function>
+size_t MeasureThroughput(const rtc::Buffer& frame, Function function) {
+  const int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumIterations; ++i)
+    function();
+  const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+  return static_cast<size_t>(frame.size() * kNumIterations /
+                             std::max<int64_t>(elapsed_us, 1));
+}
+
+}  // namespace
+
+TEST(H264ParsingPerformanceTest, FindNaluIndices4k) {
+  const rtc::Buffer frame = Create4kKeyFrame();
+  const std::vector<H264::NaluIndex> expected =
+      ReferenceFindNaluIndices(frame.data(), frame.size());
+  ASSERT_EQ(2 + kNumSlices, expected.size());
+
+  std::vector<H264::NaluIndex> indices;
+  const size_t reference_throughput = MeasureThroughput(frame, [&] {
+    indices = ReferenceFindNaluIndices(frame.data(), frame.size());
+  });
+  const size_t throughput = MeasureThroughput(frame, [&] {
+    indices = H264::FindNaluIndices(frame.data(), frame.size());
+  });
+
+  ASSERT_EQ(expected.size(), indices.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].start_offset, indices[i].start_offset);
+    EXPECT_EQ(expected[i].payload_start_offset,
+              indices[i].payload_start_offset);
+    EXPECT_EQ(expected[i].payload_size, indices[i].payload_size);
+  }
+
+  test::PrintResult("h264_find_nalu_indices", "", "reference_4k",
+                    reference_throughput, "MBps", false);
+  test::PrintResult("h264_find_nalu_indices", "", "memchr_4k", throughput,
+                    "MBps", true);
+}
+
+TEST(H264ParsingPerformanceTest, ParseRbsp4k) {
+  const rtc::Buffer frame = Create4kKeyFrame();
+  const std::vector<H264::NaluIndex> indices =
+      H264::FindNaluIndices(frame.data(), frame.size());
+
+  size_t rbsp_size = 0;
+  const size_t throughput = MeasureThroughput(frame, [&] {
+    rbsp_size = 0;
+    for (const H264::NaluIndex& index : indices) {
+      rbsp_size += H264::ParseRbsp(frame.data() + index.payload_start_offset,
+                                   index.payload_size)
+                       .size();
+    }
+  });
+  EXPECT_LT(rbsp_size, frame.size());
+
+  test::PrintResult("h264_parse_rbsp", "", "4k", throughput, "MBps", true);
+}
+
+TEST(H264ParsingPerformanceTest, ParseBitstream4k) {
+  const rtc::Buffer frame = Create4kKeyFrame();
+  const std::vector<H264::NaluIndex> indices =
+      H264::FindNaluIndices(frame.data(), frame.size());
+
+  H264BitstreamParser parser;
+  const size_t scanning_throughput = MeasureThroughput(
+      frame, [&] { parser.ParseBitstream(frame.data(), frame.size()); });
+  const size_t shared_indices_throughput = MeasureThroughput(
+      frame, [&] { parser.ParseBitstream(frame.data(), indices); });
+
+  int qp;
+  ASSERT_TRUE(parser.GetLastSliceQp(&qp));
+  EXPECT_EQ(35, qp);
+
+  test::PrintResult("h264_parse_bitstream", "", "scanning_4k",
+                    scanning_throughput, "MBps", false);
+  test::PrintResult("h264_parse_bitstream", "", "shared_indices_4k",
+                    shared_indices_throughput, "MBps", true);
+}
+
+}  // namespace webrtc
@@ -10,7 +10,11 @@
 
 #include "media/base/adaptedvideotracksource.h"
 
+#include <utility>
+
 #include "api/video/i420_buffer.h"
+#include "libyuv/rotate.h"
+#include "rtc_base/checks.h"
 
 namespace rtc {
 
@@ -48,9 +52,28 @@ void AdaptedVideoTrackSource::OnFrame(const webrtc::VideoFrame& frame) {
   if (apply_rotation() && frame.rotation() != webrtc::kVideoRotation_0 &&
       buffer->type() == webrtc::VideoFrameBuffer::Type::kI420) {
     /* Apply pending rotation. */
+    const webrtc::I420BufferInterface* src = buffer->GetI420();
+    int rotated_width = src->width();
+    int rotated_height = src->height();
+    if (frame.rotation() == webrtc::kVideoRotation_90 ||
+        frame.rotation() == webrtc::kVideoRotation_270) {
+      std::swap(rotated_width, rotated_height);
+    }
+    rtc::scoped_refptr<webrtc::I420Buffer> rotated_buffer;
+    {
+      rtc::CritScope lock(&rotated_buffer_pool_crit_);
+      rotated_buffer =
+          rotated_buffer_pool_.CreateBuffer(rotated_width, rotated_height);
+    }
+    RTC_CHECK_EQ(0, libyuv::I420Rotate(
+        src->DataY(), src->StrideY(), src->DataU(), src->StrideU(),
+        src->DataV(), src->StrideV(), rotated_buffer->MutableDataY(),
+        rotated_buffer->StrideY(), rotated_buffer->MutableDataU(),
+        rotated_buffer->StrideU(), rotated_buffer->MutableDataV(),
+        rotated_buffer->StrideV(), src->width(), src->height(),
+        static_cast<libyuv::RotationMode>(frame.rotation())));
     broadcaster_.OnFrame(webrtc::VideoFrame(
-        webrtc::I420Buffer::Rotate(*buffer->GetI420(), frame.rotation()),
-        webrtc::kVideoRotation_0, frame.timestamp_us()));
+        rotated_buffer, webrtc::kVideoRotation_0, frame.timestamp_us()));
   } else {
     broadcaster_.OnFrame(frame);
   }
@@ -13,6 +13,7 @@
 
 #include "api/mediastreaminterface.h"
 #include "api/notifier.h"
+#include "common_video/include/i420_buffer_pool.h"
 #include "media/base/videoadapter.h"
 #include "media/base/videobroadcaster.h"
 
@@ -76,6 +77,12 @@ class AdaptedVideoTrackSource
   rtc::CriticalSection stats_crit_;
   rtc::Optional<Stats> stats_ RTC_GUARDED_BY(stats_crit_);
 
+  // Buffers for frames rotated in OnFrame(), reused once all sinks have
+  // released them.
+  rtc::CriticalSection rotated_buffer_pool_crit_;
+  webrtc::I420BufferPool rotated_buffer_pool_
+      RTC_GUARDED_BY(rotated_buffer_pool_crit_);
+
   VideoBroadcaster broadcaster_;
 };
 
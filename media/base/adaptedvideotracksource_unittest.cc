@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "media/base/adaptedvideotracksource.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/video_frame.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/refcountedobject.h"
+
+namespace {
+
+class TestVideoTrackSource : public rtc::AdaptedVideoTrackSource {
+ public:
+  using rtc::AdaptedVideoTrackSource::OnFrame;
+
+  SourceState state() const override { return kLive; }
+  bool remote() const override { return false; }
+  bool is_screencast() const override { return false; }
+  rtc::Optional<bool> needs_denoising() const override {
+    return rtc::Optional<bool>();
+  }
+};
+
+class FrameRecordingSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+ public:
+  void OnFrame(const webrtc::VideoFrame& frame) override {
+    buffer_ = frame.video_frame_buffer();
+    rotation_ = frame.rotation();
+  }
+
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> TakeBuffer() {
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer = buffer_;
+    buffer_ = nullptr;
+    return buffer;
+  }
+  webrtc::VideoRotation rotation() const { return rotation_; }
+
+ private:
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer_;
+  webrtc::VideoRotation rotation_ = webrtc::kVideoRotation_0;
+};
+
+}  // namespace
+
+TEST(AdaptedVideoTrackSourceTest, RotatesIntoPooledBuffers) {
+  rtc::scoped_refptr<TestVideoTrackSource> source(
+      new rtc::RefCountedObject<TestVideoTrackSource>());
+  FrameRecordingSink sink;
+  rtc::VideoSinkWants wants;
+  wants.rotation_applied = true;
+  static_cast<rtc::VideoSourceInterface<webrtc::VideoFrame>*>(source.get())
+      ->AddOrUpdateSink(&sink, wants);
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(64, 32));
+  webrtc::I420Buffer::SetBlack(buffer);
+  // Mark the top left pixel, which ends up top right after rotating by 90.
+  buffer->MutableDataY()[0] = 255;
+
+  source->OnFrame(webrtc::VideoFrame(buffer, webrtc::kVideoRotation_90, 0));
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> rotated = sink.TakeBuffer();
+  ASSERT_TRUE(rotated);
+  EXPECT_EQ(webrtc::kVideoRotation_0, sink.rotation());
+  EXPECT_EQ(32, rotated->width());
+  EXPECT_EQ(64, rotated->height());
+  EXPECT_EQ(255, rotated->GetI420()->DataY()[31]);
+  EXPECT_EQ(0, rotated->GetI420()->DataY()[0]);
+
+  // While the first rotated buffer is still in use, a new one is needed.
+  source->OnFrame(webrtc::VideoFrame(buffer, webrtc::kVideoRotation_90, 1));
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> second = sink.TakeBuffer();
+  ASSERT_TRUE(second);
+  EXPECT_NE(rotated->GetI420()->DataY(), second->GetI420()->DataY());
+
+  // Once it has been released, its memory is used for the next frame.
+  const uint8_t* const released_data = rotated->GetI420()->DataY();
+  rotated = nullptr;
+  source->OnFrame(webrtc::VideoFrame(buffer, webrtc::kVideoRotation_90, 2));
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> third = sink.TakeBuffer();
+  ASSERT_TRUE(third);
+  EXPECT_EQ(released_data, third->GetI420()->DataY());
+  EXPECT_EQ(255, third->GetI420()->DataY()[31]);
+
+  static_cast<rtc::VideoSourceInterface<webrtc::VideoFrame>*>(source.get())
+      ->RemoveSink(&sink);
+}
@@ -14,6 +14,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <limits>
+#include <vector>
 
 #include "api/optional.h"
 #include "media/base/mediaconstants.h"
@@ -43,9 +44,44 @@ int roundUp(int value_to_round, int multiple, int max_value) {
                                     : (max_value / multiple * multiple);
 }
 
+// Sets |scale| to the factor of |scale_factors| that makes |input_pixels|
+// closest to |target_pixels|, but no higher than |max_pixels|. Returns false
+// if none is low enough.
+bool FindScaleInLadder(
+    int input_pixels,
+    int target_pixels,
+    int max_pixels,
+    const std::vector<cricket::VideoAdapter::ScaleFactor>& scale_factors,
+    Fraction* scale) {
+  *scale = Fraction{1, 1};
+  int min_pixel_diff = std::numeric_limits<int>::max();
+  if (input_pixels <= max_pixels)
+    min_pixel_diff = std::abs(input_pixels - target_pixels);
+
+  for (const cricket::VideoAdapter::ScaleFactor& scale_factor :
+       scale_factors) {
+    Fraction current_scale =
+        Fraction{scale_factor.numerator, scale_factor.denominator};
+    int output_pixels = current_scale.scale_pixel_count(input_pixels);
+    if (output_pixels <= max_pixels) {
+      int diff = std::abs(target_pixels - output_pixels);
+      if (diff < min_pixel_diff) {
+        min_pixel_diff = diff;
+        *scale = current_scale;
+      }
+    }
+  }
+  return min_pixel_diff != std::numeric_limits<int>::max();
+}
+
 // Generates a scale factor that makes |input_pixels| close to |target_pixels|,
-// but no higher than |max_pixels|.
-Fraction FindScale(int input_pixels, int target_pixels, int max_pixels) {
+// but no higher than |max_pixels|. It's taken from |scale_factors| unless that
+// is empty or has no factor that is low enough.
+Fraction FindScale(
+    int input_pixels,
+    int target_pixels,
+    int max_pixels,
+    const std::vector<cricket::VideoAdapter::ScaleFactor>& scale_factors) {
   // This function only makes sense for a positive target.
   RTC_DCHECK_GT(target_pixels, 0);
   RTC_DCHECK_GT(max_pixels, 0);
@@ -55,6 +91,13 @@ Fraction FindScale(int input_pixels, int target_pixels, int max_pixels) {
   if (target_pixels >= input_pixels)
     return Fraction{1, 1};
 
+  Fraction ladder_scale;
+  if (!scale_factors.empty() &&
+      FindScaleInLadder(input_pixels, target_pixels, max_pixels,
+                        scale_factors, &ladder_scale)) {
+    return ladder_scale;
+  }
+
   Fraction current_scale = Fraction{1, 1};
   Fraction best_scale = Fraction{1, 1};
   // The minimum (absolute) difference between the number of output pixels and
@@ -215,8 +258,9 @@ bool VideoAdapter::AdaptFrameResolution(int in_width,
     *cropped_height =
         std::min(in_height, static_cast<int>(in_width / requested_aspect));
   }
-  const Fraction scale = FindScale((*cropped_width) * (*cropped_height),
-                                   target_pixel_count, max_pixel_count);
+  const Fraction scale =
+      FindScale((*cropped_width) * (*cropped_height), target_pixel_count,
+                max_pixel_count, scale_factors_);
   // Adjust cropping slightly to get even integer output size and a perfect
   // scale factor. Make sure the resulting dimensions are aligned correctly
   // to be nice to hardware encoders.
@@ -274,4 +318,19 @@ void VideoAdapter::OnResolutionFramerateRequest(
   max_framerate_request_ = max_framerate_fps;
 }
 
+void VideoAdapter::SetScaleFactors(
+    const std::vector<ScaleFactor>& scale_factors) {
+  for (size_t i = 0; i < scale_factors.size(); ++i) {
+    RTC_DCHECK_GT(scale_factors[i].numerator, 0);
+    RTC_DCHECK_LT(scale_factors[i].numerator, scale_factors[i].denominator);
+    if (i > 0) {
+      RTC_DCHECK_LT(
+          scale_factors[i].numerator * scale_factors[i - 1].denominator,
+          scale_factors[i - 1].numerator * scale_factors[i].denominator);
+    }
+  }
+  rtc::CritScope cs(&critical_section_);
+  scale_factors_ = scale_factors;
+}
+
 }  // namespace cricket
@@ -11,6 +11,8 @@
 #ifndef MEDIA_BASE_VIDEOADAPTER_H_
 #define MEDIA_BASE_VIDEOADAPTER_H_
 
+#include <vector>
+
 #include "api/optional.h"
 #include "media/base/videocommon.h"
 #include "rtc_base/constructormagic.h"
@@ -24,6 +26,13 @@ namespace cricket {
 // VideoAdapter is thread safe.
 class VideoAdapter {
  public:
+  // Scales both the width and the height of the cropped input frame by
+  // |numerator| / |denominator|.
+  struct ScaleFactor {
+    int numerator;
+    int denominator;
+  };
+
   VideoAdapter();
   // The output frames will have height and width that is divisible by
   // |required_resolution_alignment|.
@@ -62,6 +71,15 @@ class VideoAdapter {
       int max_pixel_count,
       int max_framerate_fps);
 
+  // Makes |AdaptFrameResolution| choose the output resolution from
+  // |scale_factors|, instead of from the default ladder of alternating 3/4
+  // and 2/3 steps. E.g. {1/3} gives 640x360 from 1920x1080, which the
+  // default ladder skips. The factors must be less than 1 and in decreasing
+  // order. The unscaled input is always a candidate. The default ladder is
+  // used if none of them is small enough for the requested maximum, and
+  // after an empty ladder is set.
+  void SetScaleFactors(const std::vector<ScaleFactor>& scale_factors);
+
  private:
   // Determine if frame should be dropped based on input fps and requested fps.
   bool KeepFrame(int64_t in_timestamp_ns);
@@ -86,6 +104,8 @@ class VideoAdapter {
   int resolution_request_target_pixel_count_ RTC_GUARDED_BY(critical_section_);
   int resolution_request_max_pixel_count_ RTC_GUARDED_BY(critical_section_);
   int max_framerate_request_ RTC_GUARDED_BY(critical_section_);
+  // Set by SetScaleFactors. Empty for the default ladder.
+  std::vector<ScaleFactor> scale_factors_ RTC_GUARDED_BY(critical_section_);
 
   // The critical section to protect the above variables.
   rtc::CriticalSection critical_section_;
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "api/video/i420_buffer.h"
+#include "common_video/include/i420_buffer_pool.h"
+#include "media/base/videoadapter.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+const int kInputWidth = 1920;
+const int kInputHeight = 1080;
+const int kNumFrames = 300;  // 10 s at 30 fps.
+const int64_t kFrameIntervalNs = rtc::kNumNanosecsPerSec / 30;
+
+rtc::scoped_refptr<webrtc::I420Buffer> CreateInputBuffer() {
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer =
+      webrtc::I420Buffer::Create(kInputWidth, kInputHeight);
+  for (int y = 0; y < kInputHeight; ++y) {
+    for (int x = 0; x < kInputWidth; ++x)
+      buffer->MutableDataY()[y * buffer->StrideY() + x] = (x + y) & 0xFF;
+  }
+  for (int y = 0; y < buffer->ChromaHeight(); ++y) {
+    for (int x = 0; x < buffer->ChromaWidth(); ++x) {
+      buffer->MutableDataU()[y * buffer->StrideU() + x] = x & 0xFF;
+      buffer->MutableDataV()[y * buffer->StrideV() + x] = y & 0xFF;
+    }
+  }
+  return buffer;
+}
+
+// Adapts |kNumFrames| 1080p frames to 360p, the way AdaptedVideoTrackSource
+// does: the adapter picks the resolution, and the cropped input is scaled
+// into a pooled buffer in one pass. Prints the CPU time per adapted frame.
+void RunAdaptation(const std::string& trace,
+                   const std::vector<VideoAdapter::ScaleFactor>& scale_factors,
+                   int expected_width,
+                   int expected_height) {
+  const rtc::scoped_refptr<webrtc::I420Buffer> input = CreateInputBuffer();
+  VideoAdapter adapter;
+  adapter.SetScaleFactors(scale_factors);
+  adapter.OnResolutionFramerateRequest(rtc::Optional<int>(640 * 360),
+                                       std::numeric_limits<int>::max(),
+                                       std::numeric_limits<int>::max());
+  webrtc::I420BufferPool buffer_pool;
+
+  int adapted_frames = 0;
+  const int64_t start_cpu_ns = rtc::GetThreadCpuTimeNanos();
+  for (int i = 0; i < kNumFrames; ++i) {
+    int cropped_width;
+    int cropped_height;
+    int out_width;
+    int out_height;
+    if (!adapter.AdaptFrameResolution(kInputWidth, kInputHeight,
+                                      i * kFrameIntervalNs, &cropped_width,
+                                      &cropped_height, &out_width,
+                                      &out_height)) {
+      continue;
+    }
+    EXPECT_EQ(expected_width, out_width);
+    EXPECT_EQ(expected_height, out_height);
+    rtc::scoped_refptr<webrtc::I420Buffer> output =
+        buffer_pool.CreateBuffer(out_width, out_height);
+    output->CropAndScaleFrom(*input, (kInputWidth - cropped_width) / 2,
+                             (kInputHeight - cropped_height) / 2,
+                             cropped_width, cropped_height);
+    ++adapted_frames;
+  }
+  const int64_t elapsed_cpu_ns = rtc::GetThreadCpuTimeNanos() - start_cpu_ns;
+
+  ASSERT_EQ(kNumFrames, adapted_frames);
+  webrtc::test::PrintResult(
+      "video_adapter", "_cpu_per_frame", trace,
+      static_cast<size_t>(elapsed_cpu_ns / rtc::kNumNanosecsPerMicrosec /
+                          adapted_frames),
+      "us", true);
+}
+
+}  // namespace
+
+TEST(VideoAdapterPerformanceTest, DefaultLadder1080pTo405p) {
+  RunAdaptation("default_ladder_1080p_to_405p", {}, 720, 405);
+}
+
+TEST(VideoAdapterPerformanceTest, OneThirdLadder1080pTo360p) {
+  RunAdaptation("one_third_ladder_1080p_to_360p", {{1, 3}}, 640, 360);
+}
+
+}  // namespace cricket
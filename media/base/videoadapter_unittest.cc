@@ -1096,4 +1096,62 @@ TEST_F(VideoAdapterTest, TestAdaptToMax) {
   EXPECT_EQ(640, out_width_);
   EXPECT_EQ(360, out_height_);
 }
+
+// The default ladder has no step between 960x540 and 720x405 for 1080p input,
+// while a ladder with 1/3 gives exactly 640x360.
+TEST_F(VideoAdapterTest, TestScaleFactorLadder) {
+  adapter_.OnResolutionFramerateRequest(rtc::Optional<int>(640 * 360),
+                                        std::numeric_limits<int>::max(),
+                                        std::numeric_limits<int>::max());
+  EXPECT_TRUE(adapter_.AdaptFrameResolution(1920, 1080, 0, &cropped_width_,
+                                            &cropped_height_, &out_width_,
+                                            &out_height_));
+  EXPECT_EQ(720, out_width_);
+  EXPECT_EQ(405, out_height_);
+
+  adapter_.SetScaleFactors({{1, 2}, {1, 3}});
+  EXPECT_TRUE(adapter_.AdaptFrameResolution(1920, 1080, 0, &cropped_width_,
+                                            &cropped_height_, &out_width_,
+                                            &out_height_));
+  EXPECT_EQ(1920, cropped_width_);
+  EXPECT_EQ(1080, cropped_height_);
+  EXPECT_EQ(640, out_width_);
+  EXPECT_EQ(360, out_height_);
+
+  // An empty ladder restores the default one.
+  adapter_.SetScaleFactors({});
+  EXPECT_TRUE(adapter_.AdaptFrameResolution(1920, 1080, 0, &cropped_width_,
+                                            &cropped_height_, &out_width_,
+                                            &out_height_));
+  EXPECT_EQ(720, out_width_);
+  EXPECT_EQ(405, out_height_);
+}
+
+TEST_F(VideoAdapterTest, TestScaleFactorLadderWithAlignment) {
+  VideoAdapter adapter(16);
+  adapter.SetScaleFactors({{1, 2}, {1, 4}});
+  adapter.OnResolutionFramerateRequest(rtc::Optional<int>(480 * 270),
+                                       std::numeric_limits<int>::max(),
+                                       std::numeric_limits<int>::max());
+  EXPECT_TRUE(adapter.AdaptFrameResolution(1920, 1080, 0, &cropped_width_,
+                                           &cropped_height_, &out_width_,
+                                           &out_height_));
+  EXPECT_EQ(480, out_width_);
+  EXPECT_EQ(256, out_height_);
+}
+
+// Factors that are too large for the requested maximum fall back to the
+// default ladder.
+TEST_F(VideoAdapterTest, TestScaleFactorLadderAboveMax) {
+  adapter_.SetScaleFactors({{1, 2}});
+  adapter_.OnResolutionFramerateRequest(rtc::Optional<int>(),
+                                        960 * 540 - 1,
+                                        std::numeric_limits<int>::max());
+  EXPECT_TRUE(adapter_.AdaptFrameResolution(1920, 1080, 0, &cropped_width_,
+                                            &cropped_height_, &out_width_,
+                                            &out_height_));
+  EXPECT_EQ(720, out_width_);
+  EXPECT_EQ(405, out_height_);
+}
+
 }  // namespace cricket
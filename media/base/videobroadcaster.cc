@@ -12,6 +12,7 @@
 
 #include <limits>
 
+#include "api/optional.h"
 #include "api/video/i420_buffer.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
@@ -30,15 +31,32 @@ void VideoBroadcaster::AddOrUpdateSink(
   rtc::CritScope cs(&sinks_and_wants_lock_);
   VideoSourceBase::AddOrUpdateSink(sink, wants);
   UpdateWants();
+  UpdateDeliveryTargets();
 }
 
 void VideoBroadcaster::RemoveSink(
     VideoSinkInterface<webrtc::VideoFrame>* sink) {
   RTC_DCHECK(thread_checker_.CalledOnValidThread());
   RTC_DCHECK(sink != nullptr);
-  rtc::CritScope cs(&sinks_and_wants_lock_);
-  VideoSourceBase::RemoveSink(sink);
-  UpdateWants();
+  rtc::scoped_refptr<rtc::RefCountedObject<SinkState>> state;
+  {
+    rtc::CritScope cs(&sinks_and_wants_lock_);
+    if (delivery_targets_) {
+      for (const DeliveryTarget& target : *delivery_targets_) {
+        if (target.state->sink == sink)
+          state = target.state;
+      }
+    }
+    VideoSourceBase::RemoveSink(sink);
+    UpdateWants();
+    UpdateDeliveryTargets();
+  }
+  if (state) {
+    // OnFrame() calls that started before the update above may still deliver
+    // to |sink|. Wait for a delivery in progress and stop any later ones.
+    rtc::CritScope cs(&state->delivery_lock);
+    state->removed = true;
+  }
 }
 
 bool VideoBroadcaster::frame_wanted() const {
@@ -52,9 +70,18 @@ VideoSinkWants VideoBroadcaster::wants() const {
 }
 
 void VideoBroadcaster::OnFrame(const webrtc::VideoFrame& frame) {
-  rtc::CritScope cs(&sinks_and_wants_lock_);
-  for (auto& sink_pair : sink_pairs()) {
-    if (sink_pair.wants.rotation_applied &&
+  rtc::scoped_refptr<DeliveryTargets> targets;
+  {
+    rtc::CritScope cs(&sinks_and_wants_lock_);
+    targets = delivery_targets_;
+  }
+  if (!targets)
+    return;
+
+  // Created on first use and shared by all sinks that want black frames.
+  rtc::Optional<webrtc::VideoFrame> black_frame;
+  for (const DeliveryTarget& target : *targets) {
+    if (target.wants.rotation_applied &&
         frame.rotation() != webrtc::kVideoRotation_0) {
       // Calls to OnFrame are not synchronized with changes to the sink wants.
       // When rotation_applied is set to true, one or a few frames may get here
@@ -63,14 +90,35 @@ void VideoBroadcaster::OnFrame(const webrtc::VideoFrame& frame) {
       LOG(LS_VERBOSE) << "Discarding frame with unexpected rotation.";
       continue;
     }
-    if (sink_pair.wants.black_frames) {
-      sink_pair.sink->OnFrame(webrtc::VideoFrame(
-          GetBlackFrameBuffer(frame.width(), frame.height()), frame.rotation(),
-          frame.timestamp_us()));
-    } else {
-      sink_pair.sink->OnFrame(frame);
+    if (target.wants.black_frames && !black_frame) {
+      rtc::CritScope cs(&sinks_and_wants_lock_);
+      black_frame.emplace(GetBlackFrameBuffer(frame.width(), frame.height()),
+                          frame.rotation(), frame.timestamp_us());
+    }
+    rtc::CritScope cs(&target.state->delivery_lock);
+    if (target.state->removed)
+      continue;
+    target.state->sink->OnFrame(target.wants.black_frames ? *black_frame
+                                                          : frame);
+  }
+}
+
+void VideoBroadcaster::UpdateDeliveryTargets() {
+  rtc::scoped_refptr<DeliveryTargets> targets(new DeliveryTargets());
+  targets->reserve(sink_pairs().size());
+  for (const SinkPair& sink_pair : sink_pairs()) {
+    rtc::scoped_refptr<rtc::RefCountedObject<SinkState>> state;
+    if (delivery_targets_) {
+      for (const DeliveryTarget& target : *delivery_targets_) {
+        if (target.state->sink == sink_pair.sink)
+          state = target.state;
+      }
     }
+    if (!state)
+      state = new rtc::RefCountedObject<SinkState>(sink_pair.sink);
+    targets->push_back(DeliveryTarget{state, sink_pair.wants});
   }
+  delivery_targets_ = targets;
 }
 
 void VideoBroadcaster::UpdateWants() {
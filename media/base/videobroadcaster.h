@@ -19,6 +19,8 @@
 #include "media/base/videosinkinterface.h"
 #include "media/base/videosourcebase.h"
 #include "rtc_base/criticalsection.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/scoped_ref_ptr.h"
 #include "rtc_base/thread_checker.h"
 
 namespace rtc {
@@ -48,10 +50,34 @@ class VideoBroadcaster : public VideoSourceBase,
   // it will never receive a frame with pending rotation. Our caller
   // may pass in frames without precise synchronization with changes
   // to the VideoSinkWants.
+  // Frames are delivered without holding any lock shared between sinks, so a
+  // slow sink delays neither the other sinks nor AddOrUpdateSink() and
+  // RemoveSink() for other sinks. Once RemoveSink() has returned, the removed
+  // sink will not receive any more frames.
   void OnFrame(const webrtc::VideoFrame& frame) override;
 
  protected:
+  // Delivery state of a sink, shared between the sink list and the OnFrame()
+  // calls in flight. |delivery_lock| is held while a frame is delivered to
+  // |sink|, so that RemoveSink() can wait for that delivery to finish.
+  struct SinkState {
+    explicit SinkState(VideoSinkInterface<webrtc::VideoFrame>* sink)
+        : sink(sink) {}
+    VideoSinkInterface<webrtc::VideoFrame>* const sink;
+    rtc::CriticalSection delivery_lock;
+    bool removed RTC_GUARDED_BY(delivery_lock) = false;
+  };
+  struct DeliveryTarget {
+    rtc::scoped_refptr<rtc::RefCountedObject<SinkState>> state;
+    VideoSinkWants wants;
+  };
+  // Immutable once published in |delivery_targets_|; OnFrame() takes a
+  // reference to the current list and iterates over it without locking.
+  using DeliveryTargets = rtc::RefCountedObject<std::vector<DeliveryTarget>>;
+
   void UpdateWants() RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
+  void UpdateDeliveryTargets()
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
   const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& GetBlackFrameBuffer(
       int width,
       int height) RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
@@ -60,7 +86,10 @@ class VideoBroadcaster : public VideoSourceBase,
   rtc::CriticalSection sinks_and_wants_lock_;
 
   VideoSinkWants current_wants_ RTC_GUARDED_BY(sinks_and_wants_lock_);
-  rtc::scoped_refptr<webrtc::VideoFrameBuffer> black_frame_buffer_;
+  rtc::scoped_refptr<DeliveryTargets> delivery_targets_
+      RTC_GUARDED_BY(sinks_and_wants_lock_);
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> black_frame_buffer_
+      RTC_GUARDED_BY(sinks_and_wants_lock_);
 };
 
 }  // namespace rtc
@@ -12,12 +12,77 @@
 #include "api/video/i420_buffer.h"
 #include "api/video/video_frame.h"
 #include "media/base/fakevideorenderer.h"
+#include "rtc_base/event.h"
 #include "rtc_base/gunit.h"
+#include "rtc_base/platform_thread.h"
 
 using rtc::VideoBroadcaster;
 using rtc::VideoSinkWants;
 using cricket::FakeVideoRenderer;
 
+namespace {
+
+class FrameBufferRecordingSink
+    : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+ public:
+  void OnFrame(const webrtc::VideoFrame& frame) override {
+    buffer_ = frame.video_frame_buffer();
+    rotation_ = frame.rotation();
+  }
+
+  const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& buffer() const {
+    return buffer_;
+  }
+  webrtc::VideoRotation rotation() const { return rotation_; }
+
+ private:
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer_;
+  webrtc::VideoRotation rotation_ = webrtc::kVideoRotation_0;
+};
+
+// Blocks in OnFrame() until Unblock() is called.
+class BlockingSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+ public:
+  BlockingSink() : frame_received_(false, false), unblock_(true, false) {}
+
+  void OnFrame(const webrtc::VideoFrame& frame) override {
+    frame_received_.Set();
+    unblock_.Wait(rtc::Event::kForever);
+  }
+
+  bool WaitForFrame() { return frame_received_.Wait(5000); }
+  void Unblock() { unblock_.Set(); }
+
+ private:
+  rtc::Event frame_received_;
+  rtc::Event unblock_;
+};
+
+// Delivers one frame to a VideoBroadcaster on a separate thread.
+class FrameDeliverer {
+ public:
+  FrameDeliverer(VideoBroadcaster* broadcaster,
+                 const webrtc::VideoFrame& frame)
+      : broadcaster_(broadcaster),
+        frame_(frame),
+        thread_(&FrameDeliverer::Run, this, "FrameDeliverer") {
+    thread_.Start();
+  }
+
+  void Stop() { thread_.Stop(); }
+
+ private:
+  static void Run(void* obj) {
+    FrameDeliverer* deliverer = static_cast<FrameDeliverer*>(obj);
+    deliverer->broadcaster_->OnFrame(deliverer->frame_);
+  }
+
+  VideoBroadcaster* const broadcaster_;
+  const webrtc::VideoFrame frame_;
+  rtc::PlatformThread thread_;
+};
+
+}  // namespace
 
 TEST(VideoBroadcasterTest, frame_wanted) {
   VideoBroadcaster broadcaster;
@@ -191,3 +256,79 @@ TEST(VideoBroadcasterTest, SinkWantsBlackFrames) {
   EXPECT_TRUE(sink2.black_frame());
   EXPECT_EQ(30, sink2.timestamp_us());
 }
+
+TEST(VideoBroadcasterTest, DiscardsPendingRotationForRotationAppliedSinks) {
+  VideoBroadcaster broadcaster;
+
+  VideoSinkWants rotation_wants;
+  rotation_wants.rotation_applied = true;
+  FrameBufferRecordingSink rotated_sink;
+  FrameBufferRecordingSink unrotated_sink;
+  broadcaster.AddOrUpdateSink(&rotated_sink, rotation_wants);
+  broadcaster.AddOrUpdateSink(&unrotated_sink, VideoSinkWants());
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(100, 50));
+  webrtc::I420Buffer::SetBlack(buffer);
+  broadcaster.OnFrame(
+      webrtc::VideoFrame(buffer, webrtc::kVideoRotation_90, 10));
+
+  EXPECT_EQ(buffer, unrotated_sink.buffer());
+  EXPECT_EQ(webrtc::kVideoRotation_90, unrotated_sink.rotation());
+  EXPECT_FALSE(rotated_sink.buffer());
+}
+
+TEST(VideoBroadcasterTest, SharesBlackFrameBetweenSinks) {
+  VideoBroadcaster broadcaster;
+
+  VideoSinkWants black_wants;
+  black_wants.black_frames = true;
+  FrameBufferRecordingSink sink1;
+  FrameBufferRecordingSink sink2;
+  broadcaster.AddOrUpdateSink(&sink1, black_wants);
+  broadcaster.AddOrUpdateSink(&sink2, black_wants);
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(100, 200));
+  buffer->InitializeData();
+  broadcaster.OnFrame(webrtc::VideoFrame(buffer, webrtc::kVideoRotation_0, 0));
+
+  ASSERT_TRUE(sink1.buffer());
+  EXPECT_NE(buffer, sink1.buffer());
+  EXPECT_EQ(sink1.buffer(), sink2.buffer());
+}
+
+TEST(VideoBroadcasterTest, SlowSinkDoesNotBlockSinkUpdates) {
+  VideoBroadcaster broadcaster;
+  BlockingSink slow_sink;
+  FakeVideoRenderer other_sink;
+  broadcaster.AddOrUpdateSink(&slow_sink, VideoSinkWants());
+  broadcaster.AddOrUpdateSink(&other_sink, VideoSinkWants());
+
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(16, 16));
+  buffer->InitializeData();
+  FrameDeliverer deliverer(
+      &broadcaster, webrtc::VideoFrame(buffer, webrtc::kVideoRotation_0, 0));
+  ASSERT_TRUE(slow_sink.WaitForFrame());
+
+  // |slow_sink| is now stuck in OnFrame(). Sinks can still be added, updated
+  // and removed, and the removed sink gets no more frames.
+  FakeVideoRenderer new_sink;
+  VideoSinkWants wants;
+  wants.max_pixel_count = 1280 * 720;
+  broadcaster.AddOrUpdateSink(&new_sink, VideoSinkWants());
+  broadcaster.AddOrUpdateSink(&other_sink, wants);
+  EXPECT_EQ(1280 * 720, broadcaster.wants().max_pixel_count);
+  broadcaster.RemoveSink(&other_sink);
+  EXPECT_EQ(0, other_sink.num_rendered_frames());
+
+  slow_sink.Unblock();
+  deliverer.Stop();
+  EXPECT_EQ(0, other_sink.num_rendered_frames());
+  EXPECT_EQ(0, new_sink.num_rendered_frames());
+
+  broadcaster.OnFrame(webrtc::VideoFrame(buffer, webrtc::kVideoRotation_0, 1));
+  EXPECT_EQ(1, new_sink.num_rendered_frames());
+  EXPECT_EQ(0, other_sink.num_rendered_frames());
+}
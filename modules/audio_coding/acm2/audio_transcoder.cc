@@ -0,0 +1,228 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/include/audio_transcoder.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace webrtc {
+
+namespace {
+
+// Used to size the decode buffer when the decoder cannot tell the duration
+// of a payload.
+const int kMaxPacketDurationMs = 120;
+
+}  // namespace
+
+AudioTranscoder::AudioTranscoder(std::unique_ptr<AudioDecoder> decoder,
+                                 int decoder_rtp_timestamp_rate_hz,
+                                 std::unique_ptr<AudioEncoder> encoder,
+                                 AudioPacketizationCallback* callback)
+    : decoder_(std::move(decoder)),
+      encoder_(std::move(encoder)),
+      callback_(callback),
+      decoder_rtp_timestamp_rate_hz_(decoder_rtp_timestamp_rate_hz),
+      decoder_samples_per_10ms_(decoder_->SampleRateHz() / 100 *
+                                decoder_->Channels()),
+      encoder_samples_per_10ms_(encoder_->SampleRateHz() / 100 *
+                                encoder_->NumChannels()),
+      pending_(decoder_samples_per_10ms_) {
+  RTC_DCHECK(callback_);
+  RTC_CHECK_GT(decoder_rtp_timestamp_rate_hz_, 0);
+  RTC_CHECK_GE(2, decoder_->Channels());
+  RTC_CHECK_GE(2, encoder_->NumChannels());
+  // Room for both downmixed audio at the decoder rate and upmixed audio at
+  // the encoder rate.
+  channel_converted_.resize(
+      std::max(decoder_samples_per_10ms_, encoder_samples_per_10ms_));
+  resampled_.resize(encoder_samples_per_10ms_);
+}
+
+AudioTranscoder::~AudioTranscoder() = default;
+
+int AudioTranscoder::InsertPacket(rtc::ArrayView<const uint8_t> payload,
+                                  uint32_t rtp_timestamp) {
+  const int duration = decoder_->PacketDuration(payload.data(), payload.size());
+  const size_t max_samples =
+      (duration > 0 ? static_cast<size_t>(duration)
+                    : static_cast<size_t>(decoder_->SampleRateHz() *
+                                          kMaxPacketDurationMs / 1000)) *
+      decoder_->Channels();
+  if (decoded_.size() < max_samples)
+    decoded_.resize(max_samples);
+
+  AudioDecoder::SpeechType speech_type;
+  const int num_samples = decoder_->Decode(
+      payload.data(), payload.size(), decoder_->SampleRateHz(),
+      decoded_.size() * sizeof(int16_t), decoded_.data(), &speech_type);
+  if (num_samples < 0) {
+    LOG(LS_WARNING) << "Failed to decode a payload of " << payload.size()
+                    << " bytes.";
+    return -1;
+  }
+  const int decoder_rate_hz = decoder_->SampleRateHz();
+  if (first_packet_) {
+    rtp_timestamp_ = rtp_timestamp;
+    first_packet_ = false;
+  } else if (rtp_timestamp != next_incoming_timestamp_) {
+    const int32_t gap =
+        static_cast<int32_t>(rtp_timestamp - next_incoming_timestamp_);
+    if (gap > 0) {
+      if (SkipGap(static_cast<size_t>(static_cast<int64_t>(gap) *
+                                      decoder_rate_hz /
+                                      decoder_rtp_timestamp_rate_hz_)) != 0) {
+        return -1;
+      }
+    } else {
+      // The stream went back in time, e.g. the sender restarted. Drop what
+      // is left of the old audio, and keep the outgoing timestamps running.
+      LOG(LS_WARNING) << "Incoming RTP timestamp went back by " << -gap
+                      << ".";
+      pending_samples_ = 0;
+    }
+  }
+  next_incoming_timestamp_ =
+      rtp_timestamp +
+      static_cast<uint32_t>(static_cast<int64_t>(num_samples) /
+                            decoder_->Channels() *
+                            decoder_rtp_timestamp_rate_hz_ / decoder_rate_hz);
+
+  const int16_t* audio = decoded_.data();
+  size_t remaining = static_cast<size_t>(num_samples);
+
+  // Complete the 10 ms block started by the previous payload.
+  if (pending_samples_ > 0) {
+    const size_t num_copied =
+        std::min(remaining, decoder_samples_per_10ms_ - pending_samples_);
+    memcpy(&pending_[pending_samples_], audio, num_copied * sizeof(*audio));
+    pending_samples_ += num_copied;
+    audio += num_copied;
+    remaining -= num_copied;
+    if (pending_samples_ < decoder_samples_per_10ms_)
+      return 0;
+    pending_samples_ = 0;
+    if (Encode10Ms(pending_.data()) != 0)
+      return -1;
+  }
+
+  // Encode directly from the decode buffer.
+  for (; remaining >= decoder_samples_per_10ms_;
+       remaining -= decoder_samples_per_10ms_) {
+    if (Encode10Ms(audio) != 0)
+      return -1;
+    audio += decoder_samples_per_10ms_;
+  }
+
+  memcpy(pending_.data(), audio, remaining * sizeof(*audio));
+  pending_samples_ = remaining;
+  return 0;
+}
+
+void AudioTranscoder::Reset() {
+  decoder_->Reset();
+  encoder_->Reset();
+  first_packet_ = true;
+  rtp_timestamp_ = 0;
+  next_incoming_timestamp_ = 0;
+  pending_samples_ = 0;
+}
+
+int AudioTranscoder::SkipGap(size_t num_samples) {
+  const size_t num_channels = decoder_->Channels();
+  if (pending_samples_ > 0) {
+    const size_t num_padded =
+        std::min(num_samples * num_channels,
+                 decoder_samples_per_10ms_ - pending_samples_);
+    memset(&pending_[pending_samples_], 0, num_padded * sizeof(pending_[0]));
+    pending_samples_ += num_padded;
+    num_samples -= num_padded / num_channels;
+    if (pending_samples_ < decoder_samples_per_10ms_)
+      return 0;
+    pending_samples_ = 0;
+    if (Encode10Ms(pending_.data()) != 0)
+      return -1;
+  }
+  rtp_timestamp_ += static_cast<uint32_t>(static_cast<int64_t>(num_samples) *
+                                          encoder_->RtpTimestampRateHz() /
+                                          decoder_->SampleRateHz());
+  return 0;
+}
+
+int AudioTranscoder::Encode10Ms(const int16_t* audio) {
+  const int decoder_rate_hz = decoder_->SampleRateHz();
+  const int encoder_rate_hz = encoder_->SampleRateHz();
+  const size_t encoder_channels = encoder_->NumChannels();
+  size_t num_channels = decoder_->Channels();
+
+  // Downmix before resampling, and upmix after, to resample as few channels
+  // as possible.
+  if (num_channels > encoder_channels) {
+    for (size_t i = 0; i < decoder_samples_per_10ms_ / 2; ++i) {
+      channel_converted_[i] = (audio[2 * i] + audio[2 * i + 1]) >> 1;
+    }
+    audio = channel_converted_.data();
+    num_channels = 1;
+  }
+
+  if (decoder_rate_hz != encoder_rate_hz) {
+    if (resampler_.InitializeIfNeeded(decoder_rate_hz, encoder_rate_hz,
+                                      num_channels) != 0) {
+      LOG(LS_ERROR) << "InitializeIfNeeded(" << decoder_rate_hz << ", "
+                    << encoder_rate_hz << ", " << num_channels
+                    << ") failed.";
+      return -1;
+    }
+    if (resampler_.Resample(audio, decoder_rate_hz / 100 * num_channels,
+                            resampled_.data(), resampled_.size()) < 0) {
+      return -1;
+    }
+    audio = resampled_.data();
+  }
+
+  if (num_channels < encoder_channels) {
+    for (size_t i = 0; i < encoder_samples_per_10ms_ / 2; ++i) {
+      channel_converted_[2 * i] = audio[i];
+      channel_converted_[2 * i + 1] = audio[i];
+    }
+    audio = channel_converted_.data();
+  }
+
+  encoded_.Clear();
+  const AudioEncoder::EncodedInfo encoded_info = encoder_->Encode(
+      rtp_timestamp_,
+      rtc::ArrayView<const int16_t>(audio, encoder_samples_per_10ms_),
+      &encoded_);
+  rtp_timestamp_ += encoder_->RtpTimestampRateHz() / 100;
+  if (encoded_.size() == 0 && !encoded_info.send_even_if_empty) {
+    // Not enough data.
+    return 0;
+  }
+  RTC_DCHECK(encoded_info.redundant.empty());
+
+  FrameType frame_type;
+  if (encoded_.size() == 0) {
+    frame_type = kEmptyFrame;
+  } else {
+    frame_type = encoded_info.speech ? kAudioFrameSpeech : kAudioFrameCN;
+  }
+  callback_->SendData(frame_type, encoded_info.payload_type,
+                      encoded_info.encoded_timestamp, encoded_.data(),
+                      encoded_.size(), nullptr);
+  return 0;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,220 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <math.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "api/audio/audio_mixer.h"
+#include "modules/audio_coding/codecs/g711/audio_decoder_pcm.h"
+#include "modules/audio_coding/codecs/g711/audio_encoder_pcm.h"
+#include "modules/audio_coding/codecs/opus/audio_encoder_opus.h"
+#include "modules/audio_coding/include/audio_coding_module.h"
+#include "modules/audio_coding/include/audio_transcoder.h"
+#include "modules/audio_mixer/audio_mixer_impl.h"
+#include "modules/audio_processing/include/audio_processing.h"
+#include "modules/include/module_common_types.h"
+#include "rtc_base/random.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+const int kPcmuPayloadType = 0;
+const int kOpusPayloadType = 111;
+const int kPacketSizeMs = 20;
+const int kPacketSizeSamples = 8 * kPacketSizeMs;
+const int kNumPackets = 500;  // 10 s.
+const uint32_t kSsrc = 0x1234;
+
+class CountingCallback : public AudioPacketizationCallback {
+ public:
+  int32_t SendData(FrameType frame_type,
+                   uint8_t payload_type,
+                   uint32_t timestamp,
+                   const uint8_t* payload_data,
+                   size_t payload_len_bytes,
+                   const RTPFragmentationHeader* fragmentation) override {
+    ++num_packets;
+    return 0;
+  }
+
+  int num_packets = 0;
+};
+
+// The receiving side of a voe::Channel, as seen by the mixer.
+class NetEqSource : public AudioMixer::Source {
+ public:
+  explicit NetEqSource(AudioCodingModule* acm) : acm_(acm) {}
+
+  AudioFrameInfo GetAudioFrameWithInfo(int sample_rate_hz,
+                                       AudioFrame* audio_frame) override {
+    bool muted;
+    if (acm_->PlayoutData10Ms(sample_rate_hz, audio_frame, &muted) != 0)
+      return AudioFrameInfo::kError;
+    return muted ? AudioFrameInfo::kMuted : AudioFrameInfo::kNormal;
+  }
+  int Ssrc() const override { return kSsrc; }
+  int PreferredSampleRate() const override { return 8000; }
+
+ private:
+  AudioCodingModule* const acm_;
+};
+
+// Returns |kNumPackets| PCMU packets, as sent by a SIP leg, of a tone with
+// some noise on top.
+std::vector<rtc::Buffer> CreatePcmuPackets() {
+  AudioEncoderPcmU encoder((AudioEncoderPcmU::Config()));
+  Random random(0x5a);
+  std::vector<rtc::Buffer> packets;
+  int16_t audio[80];
+  rtc::Buffer encoded;
+  for (int i = 0; static_cast<int>(packets.size()) < kNumPackets; ++i) {
+    for (int j = 0; j < 80; ++j) {
+      audio[j] = static_cast<int16_t>(
+          4000 * sin(2 * M_PI * 440 * (80 * i + j) / 8000) +
+          random.Rand(-500, 500));
+    }
+    encoder.Encode(0, audio, &encoded);
+    if (encoded.size() > 0) {
+      packets.push_back(std::move(encoded));
+      encoded.Clear();
+    }
+  }
+  return packets;
+}
+
+std::unique_ptr<AudioEncoder> CreatePcmAEncoder() {
+  return std::unique_ptr<AudioEncoder>(
+      new AudioEncoderPcmA(AudioEncoderPcmA::Config()));
+}
+
+std::unique_ptr<AudioEncoder> CreateOpusEncoder() {
+  return std::unique_ptr<AudioEncoder>(
+      new AudioEncoderOpus(AudioEncoderOpusConfig(), kOpusPayloadType));
+}
+
+// Returns the time in us to bridge |packets| with an AudioTranscoder.
+int64_t RunTranscoder(const std::vector<rtc::Buffer>& packets,
+                      std::unique_ptr<AudioEncoder> encoder) {
+  CountingCallback callback;
+  AudioTranscoder transcoder(
+      std::unique_ptr<AudioDecoder>(new AudioDecoderPcmU(1)), 8000,
+      std::move(encoder), &callback);
+  const int64_t start_us = rtc::TimeMicros();
+  for (size_t i = 0; i < packets.size(); ++i) {
+    EXPECT_EQ(0, transcoder.InsertPacket(packets[i],
+                                         kPacketSizeSamples * i));
+  }
+  const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+  EXPECT_GT(callback.num_packets, 0);
+  return elapsed_us;
+}
+
+// Returns the time in us to bridge |packets| the way a VoiceEngine based
+// server does: NetEq in the receiving ACM, the AudioMixer, APM with the
+// default voice engine options except for AEC, and the sending ACM.
+int64_t RunVoiceEnginePath(const std::vector<rtc::Buffer>& packets,
+                           std::unique_ptr<AudioEncoder> encoder) {
+  std::unique_ptr<AudioCodingModule> receiver(AudioCodingModule::Create());
+  EXPECT_TRUE(receiver->RegisterReceiveCodec(kPcmuPayloadType,
+                                             SdpAudioFormat("pcmu", 8000, 1)));
+  NetEqSource source(receiver.get());
+  rtc::scoped_refptr<AudioMixerImpl> mixer = AudioMixerImpl::Create();
+  EXPECT_TRUE(mixer->AddSource(&source));
+  std::unique_ptr<AudioProcessing> apm(AudioProcessing::Create());
+  apm->high_pass_filter()->Enable(true);
+  apm->noise_suppression()->Enable(true);
+  apm->gain_control()->set_mode(GainControl::kAdaptiveDigital);
+  apm->gain_control()->Enable(true);
+  CountingCallback callback;
+  std::unique_ptr<AudioCodingModule> sender(AudioCodingModule::Create());
+  sender->SetEncoder(std::move(encoder));
+  sender->RegisterTransportCallback(&callback);
+
+  WebRtcRTPHeader rtp_header;
+  rtp_header.header.sequenceNumber = 0;
+  rtp_header.header.timestamp = 0;
+  rtp_header.header.payloadType = kPcmuPayloadType;
+  rtp_header.header.markerBit = false;
+  rtp_header.header.ssrc = kSsrc;
+  rtp_header.header.numCSRCs = 0;
+  rtp_header.header.payload_type_frequency = 8000;
+  rtp_header.frameType = kAudioFrameSpeech;
+  rtp_header.type.Audio.channel = 1;
+  rtp_header.type.Audio.isCNG = false;
+  AudioFrame frame;
+  uint32_t capture_timestamp = 0;
+
+  const int64_t start_us = rtc::TimeMicros();
+  for (const rtc::Buffer& packet : packets) {
+    EXPECT_EQ(0, receiver->IncomingPacket(packet.data(), packet.size(),
+                                          rtp_header));
+    ++rtp_header.header.sequenceNumber;
+    rtp_header.header.timestamp += kPacketSizeSamples;
+    for (int i = 0; i < kPacketSizeMs / 10; ++i) {
+      mixer->Mix(1, &frame);
+      EXPECT_EQ(AudioProcessing::kNoError, apm->ProcessStream(&frame));
+      frame.timestamp_ = capture_timestamp;
+      capture_timestamp += static_cast<uint32_t>(frame.samples_per_channel_);
+      EXPECT_LE(0, sender->Add10MsData(frame));
+    }
+  }
+  const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+  EXPECT_GT(callback.num_packets, 0);
+  mixer->RemoveSource(&source);
+  return elapsed_us;
+}
+
+// Prints how many legs one core can bridge in real time, with and without
+// the transcoder.
+void PrintLegsPerCore(const std::string& trace,
+                      int64_t transcoder_us,
+                      int64_t voice_engine_us) {
+  const int64_t duration_us = kNumPackets * kPacketSizeMs * 1000;
+  const size_t transcoder_legs =
+      static_cast<size_t>(duration_us / std::max<int64_t>(transcoder_us, 1));
+  const size_t voice_engine_legs =
+      static_cast<size_t>(duration_us / std::max<int64_t>(voice_engine_us, 1));
+  test::PrintResult("audio_transcoder", "", trace + "_transcoder",
+                    transcoder_legs, "legs_per_core", true);
+  test::PrintResult("audio_transcoder", "", trace + "_voice_engine",
+                    voice_engine_legs, "legs_per_core", true);
+  EXPECT_GT(transcoder_legs, 0u);
+}
+
+}  // namespace
+
+// G.711 to G.711, where the transcoder needs no resampling at all.
+TEST(AudioTranscoderPerformanceTest, PcmUToPcmA) {
+  const std::vector<rtc::Buffer> packets = CreatePcmuPackets();
+  const int64_t transcoder_us = RunTranscoder(packets, CreatePcmAEncoder());
+  const int64_t voice_engine_us =
+      RunVoiceEnginePath(packets, CreatePcmAEncoder());
+  PrintLegsPerCore("pcmu_to_pcma", transcoder_us, voice_engine_us);
+}
+
+// A SIP leg bridged to a WebRTC leg, where the cost of the Opus encoder is
+// the same on both paths.
+TEST(AudioTranscoderPerformanceTest, PcmUToOpus) {
+  const std::vector<rtc::Buffer> packets = CreatePcmuPackets();
+  const int64_t transcoder_us = RunTranscoder(packets, CreateOpusEncoder());
+  const int64_t voice_engine_us =
+      RunVoiceEnginePath(packets, CreateOpusEncoder());
+  PrintLegsPerCore("pcmu_to_opus", transcoder_us, voice_engine_us);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,264 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/include/audio_transcoder.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include "modules/audio_coding/codecs/g711/audio_decoder_pcm.h"
+#include "modules/audio_coding/codecs/g711/audio_encoder_pcm.h"
+#include "modules/audio_coding/codecs/pcm16b/audio_decoder_pcm16b.h"
+#include "modules/audio_coding/codecs/pcm16b/audio_encoder_pcm16b.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+const uint32_t kFirstTimestamp = 4711;
+
+struct Packet {
+  FrameType frame_type;
+  uint8_t payload_type;
+  uint32_t timestamp;
+  std::vector<uint8_t> payload;
+};
+
+class PacketCollector : public AudioPacketizationCallback {
+ public:
+  int32_t SendData(FrameType frame_type,
+                   uint8_t payload_type,
+                   uint32_t timestamp,
+                   const uint8_t* payload_data,
+                   size_t payload_len_bytes,
+                   const RTPFragmentationHeader* fragmentation) override {
+    packets.push_back({frame_type, payload_type, timestamp,
+                       std::vector<uint8_t>(
+                           payload_data, payload_data + payload_len_bytes)});
+    return 0;
+  }
+
+  std::vector<Packet> packets;
+};
+
+// Returns |num_samples| of a 1 kHz tone sampled at |sample_rate_hz|, with
+// each sample repeated |num_channels| times.
+std::vector<int16_t> Tone(int sample_rate_hz,
+                          size_t num_channels,
+                          size_t num_samples) {
+  std::vector<int16_t> tone;
+  for (size_t i = 0; i < num_samples; ++i) {
+    const int16_t sample =
+        static_cast<int16_t>(8000 * sin(2 * M_PI * 1000 * i / sample_rate_hz));
+    tone.insert(tone.end(), num_channels, sample);
+  }
+  return tone;
+}
+
+// Encodes |audio| with |encoder| and returns the packets.
+std::vector<rtc::Buffer> Encode(AudioEncoder* encoder,
+                                const std::vector<int16_t>& audio) {
+  const size_t samples_per_10ms =
+      encoder->SampleRateHz() / 100 * encoder->NumChannels();
+  std::vector<rtc::Buffer> packets;
+  rtc::Buffer encoded;
+  for (size_t i = 0; i + samples_per_10ms <= audio.size();
+       i += samples_per_10ms) {
+    encoder->Encode(
+        0, rtc::ArrayView<const int16_t>(&audio[i], samples_per_10ms),
+        &encoded);
+    if (encoded.size() > 0) {
+      packets.push_back(std::move(encoded));
+      encoded.Clear();
+    }
+  }
+  return packets;
+}
+
+// Returns the RMS of the decoded |packet|.
+double DecodedRms(AudioDecoder* decoder, const std::vector<uint8_t>& packet) {
+  std::vector<int16_t> decoded(packet.size() * 2);
+  AudioDecoder::SpeechType speech_type;
+  const int num_samples =
+      decoder->Decode(packet.data(), packet.size(), decoder->SampleRateHz(),
+                      decoded.size() * sizeof(int16_t), decoded.data(),
+                      &speech_type);
+  EXPECT_GT(num_samples, 0);
+  double sum_squares = 0.0;
+  for (int i = 0; i < num_samples; ++i)
+    sum_squares += decoded[i] * decoded[i];
+  return sqrt(sum_squares / num_samples);
+}
+
+}  // namespace
+
+TEST(AudioTranscoderTest, PcmUToPcmA) {
+  AudioEncoderPcmU pcmu_encoder((AudioEncoderPcmU::Config()));
+  const std::vector<int16_t> tone = Tone(8000, 1, 8000);
+  const std::vector<rtc::Buffer> pcmu_packets = Encode(&pcmu_encoder, tone);
+  ASSERT_EQ(50u, pcmu_packets.size());
+
+  PacketCollector collector;
+  AudioTranscoder transcoder(
+      std::unique_ptr<AudioDecoder>(new AudioDecoderPcmU(1)), 8000,
+      std::unique_ptr<AudioEncoder>(
+          new AudioEncoderPcmA(AudioEncoderPcmA::Config())),
+      &collector);
+  for (size_t i = 0; i < pcmu_packets.size(); ++i) {
+    EXPECT_EQ(0, transcoder.InsertPacket(pcmu_packets[i],
+                                         kFirstTimestamp + 160 * i));
+  }
+
+  ASSERT_EQ(50u, collector.packets.size());
+  AudioDecoderPcmA pcma_decoder(1);
+  for (size_t i = 0; i < collector.packets.size(); ++i) {
+    const Packet& packet = collector.packets[i];
+    EXPECT_EQ(kAudioFrameSpeech, packet.frame_type);
+    EXPECT_EQ(8, packet.payload_type);
+    EXPECT_EQ(kFirstTimestamp + 160 * i, packet.timestamp);
+    ASSERT_EQ(160u, packet.payload.size());
+
+    // G.711 is a sample by sample quantization, so the audio survives
+    // transcoding up to the quantization error.
+    int16_t decoded[160];
+    AudioDecoder::SpeechType speech_type;
+    ASSERT_EQ(160, pcma_decoder.Decode(packet.payload.data(), 160, 8000,
+                                       sizeof(decoded), decoded,
+                                       &speech_type));
+    for (size_t j = 0; j < 160; ++j)
+      EXPECT_NEAR(tone[160 * i + j], decoded[j], 512);
+  }
+}
+
+TEST(AudioTranscoderTest, ResamplesAndDownmixesOnce) {
+  AudioEncoderPcm16B::Config config;
+  config.sample_rate_hz = 48000;
+  config.num_channels = 2;
+  AudioEncoderPcm16B pcm16b_encoder(config);
+  const std::vector<rtc::Buffer> pcm16b_packets =
+      Encode(&pcm16b_encoder, Tone(48000, 2, 48000));
+  ASSERT_EQ(50u, pcm16b_packets.size());
+
+  PacketCollector collector;
+  AudioTranscoder transcoder(
+      std::unique_ptr<AudioDecoder>(new AudioDecoderPcm16B(48000, 2)), 48000,
+      std::unique_ptr<AudioEncoder>(
+          new AudioEncoderPcmU(AudioEncoderPcmU::Config())),
+      &collector);
+  for (size_t i = 0; i < pcm16b_packets.size(); ++i) {
+    EXPECT_EQ(0, transcoder.InsertPacket(pcm16b_packets[i],
+                                         kFirstTimestamp + 960 * i));
+  }
+
+  // The outgoing timestamps follow the clock of the encoder.
+  ASSERT_EQ(50u, collector.packets.size());
+  for (size_t i = 0; i < collector.packets.size(); ++i) {
+    EXPECT_EQ(kFirstTimestamp + 160 * i, collector.packets[i].timestamp);
+    EXPECT_EQ(160u, collector.packets[i].payload.size());
+  }
+
+  // Once past the delay of the resampler, the tone has its original level.
+  AudioDecoderPcmU pcmu_decoder(1);
+  EXPECT_NEAR(8000 / sqrt(2.0),
+              DecodedRms(&pcmu_decoder, collector.packets.back().payload),
+              200);
+}
+
+TEST(AudioTranscoderTest, KeepsAudioThatDoesNotFillA10MsBlock) {
+  AudioEncoderPcmU::Config config;
+  config.frame_size_ms = 10;
+  PacketCollector collector;
+  AudioTranscoder transcoder(
+      std::unique_ptr<AudioDecoder>(new AudioDecoderPcm16B(8000, 1)), 8000,
+      std::unique_ptr<AudioEncoder>(new AudioEncoderPcmU(config)),
+      &collector);
+
+  // 30 samples, 3.75 ms, per payload.
+  const uint8_t kPayload[60] = {0};
+  for (int i = 0; i < 8; ++i)
+    EXPECT_EQ(0, transcoder.InsertPacket(kPayload, kFirstTimestamp + 30 * i));
+
+  // 240 samples make three 10 ms packets.
+  ASSERT_EQ(3u, collector.packets.size());
+  for (size_t i = 0; i < collector.packets.size(); ++i) {
+    EXPECT_EQ(kFirstTimestamp + 80 * i, collector.packets[i].timestamp);
+    EXPECT_EQ(80u, collector.packets[i].payload.size());
+  }
+
+  // Audio that was not encoded is dropped on reset, and the outgoing
+  // timestamps start over from the next payload.
+  transcoder.Reset();
+  for (int i = 0; i < 2; ++i)
+    EXPECT_EQ(0, transcoder.InsertPacket(kPayload, 30 * i));
+  EXPECT_EQ(3u, collector.packets.size());
+  EXPECT_EQ(0, transcoder.InsertPacket(kPayload, 60));
+  ASSERT_EQ(4u, collector.packets.size());
+  EXPECT_EQ(0u, collector.packets.back().timestamp);
+}
+
+TEST(AudioTranscoderTest, KeepsGapsFromLostPackets) {
+  AudioEncoderPcmU pcmu_encoder((AudioEncoderPcmU::Config()));
+  const std::vector<rtc::Buffer> pcmu_packets =
+      Encode(&pcmu_encoder, Tone(8000, 1, 8000));
+  ASSERT_EQ(50u, pcmu_packets.size());
+
+  PacketCollector collector;
+  AudioTranscoder transcoder(
+      std::unique_ptr<AudioDecoder>(new AudioDecoderPcmU(1)), 8000,
+      std::unique_ptr<AudioEncoder>(
+          new AudioEncoderPcmA(AudioEncoderPcmA::Config())),
+      &collector);
+  std::vector<uint32_t> expected_timestamps;
+  for (size_t i = 0; i < pcmu_packets.size(); ++i) {
+    // Lose packets 10 to 12.
+    if (i >= 10 && i <= 12)
+      continue;
+    EXPECT_EQ(0, transcoder.InsertPacket(pcmu_packets[i],
+                                         kFirstTimestamp + 160 * i));
+    expected_timestamps.push_back(kFirstTimestamp + 160 * i);
+  }
+
+  ASSERT_EQ(expected_timestamps.size(), collector.packets.size());
+  for (size_t i = 0; i < collector.packets.size(); ++i)
+    EXPECT_EQ(expected_timestamps[i], collector.packets[i].timestamp);
+}
+
+TEST(AudioTranscoderTest, PadsAudioBeforeAGapWithSilence) {
+  AudioEncoderPcmU::Config config;
+  config.frame_size_ms = 10;
+  PacketCollector collector;
+  AudioTranscoder transcoder(
+      std::unique_ptr<AudioDecoder>(new AudioDecoderPcm16B(16000, 1)), 16000,
+      std::unique_ptr<AudioEncoder>(new AudioEncoderPcmU(config)),
+      &collector);
+
+  // 60 samples at 16 kHz, 3.75 ms, of full scale audio.
+  uint8_t payload[120];
+  memset(payload, 0x7f, sizeof(payload));
+  EXPECT_EQ(0, transcoder.InsertPacket(payload, kFirstTimestamp));
+  EXPECT_TRUE(collector.packets.empty());
+
+  // After 200 ms of DTX, the first 3.75 ms are encoded in a block of their
+  // own, and the next payload keeps its distance to the first.
+  EXPECT_EQ(0, transcoder.InsertPacket(payload, kFirstTimestamp + 3200));
+  ASSERT_EQ(1u, collector.packets.size());
+  EXPECT_EQ(kFirstTimestamp, collector.packets[0].timestamp);
+  EXPECT_EQ(0xff, collector.packets[0].payload.back());  // Silence.
+  EXPECT_EQ(0, transcoder.InsertPacket(payload, kFirstTimestamp + 3260));
+  EXPECT_EQ(0, transcoder.InsertPacket(payload, kFirstTimestamp + 3320));
+  ASSERT_EQ(2u, collector.packets.size());
+  EXPECT_EQ(kFirstTimestamp + 1600, collector.packets[1].timestamp);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,213 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/include/offline_audio_receiver.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace webrtc {
+
+namespace {
+
+// Used to size the decode buffer when a frame cannot tell its duration.
+const int kMaxFrameDurationMs = 120;
+
+}  // namespace
+
+OfflineAudioReceiver::OfflineAudioReceiver(
+    rtc::scoped_refptr<AudioDecoderFactory> decoder_factory,
+    Callback* callback,
+    int chunk_ms,
+    size_t max_reordering)
+    : decoder_factory_(std::move(decoder_factory)),
+      callback_(callback),
+      chunk_ms_(chunk_ms),
+      max_reordering_(max_reordering) {
+  RTC_DCHECK(decoder_factory_);
+  RTC_DCHECK(callback_);
+  RTC_DCHECK_GT(chunk_ms_, 0);
+}
+
+OfflineAudioReceiver::~OfflineAudioReceiver() = default;
+
+void OfflineAudioReceiver::SetCodecs(
+    const std::map<int, SdpAudioFormat>& codecs) {
+  // Packets held back were sent with the old mapping, so they are decoded
+  // with it.
+  Flush();
+  codecs_ = codecs;
+  decoders_.clear();
+}
+
+void OfflineAudioReceiver::InsertPacket(
+    const RTPHeader& rtp_header,
+    rtc::ArrayView<const uint8_t> payload) {
+  const int64_t sequence_number =
+      sequence_number_unwrapper_.Unwrap(rtp_header.sequenceNumber);
+  if (first_packet_) {
+    next_sequence_number_ = sequence_number;
+    first_packet_ = false;
+  }
+  if (sequence_number < next_sequence_number_ ||
+      packets_.count(sequence_number) > 0) {
+    ++stats_.discarded_packets;
+    return;
+  }
+  Packet& packet = packets_[sequence_number];
+  packet.payload_type = rtp_header.payloadType;
+  packet.timestamp = rtp_header.timestamp;
+  packet.payload.SetData(payload.data(), payload.size());
+  DecodeInOrder();
+}
+
+void OfflineAudioReceiver::Flush() {
+  while (!packets_.empty()) {
+    auto it = packets_.begin();
+    stats_.lost_packets += it->first - next_sequence_number_;
+    DecodePacket(&it->second);
+    next_sequence_number_ = it->first + 1;
+    packets_.erase(it);
+  }
+  EmitChunk();
+}
+
+void OfflineAudioReceiver::DecodeInOrder() {
+  while (!packets_.empty()) {
+    auto it = packets_.begin();
+    if (it->first != next_sequence_number_) {
+      // Wait for the missing packet, unless too many later packets have
+      // arrived already.
+      if (packets_.size() <= max_reordering_)
+        return;
+      stats_.lost_packets += it->first - next_sequence_number_;
+    }
+    DecodePacket(&it->second);
+    next_sequence_number_ = it->first + 1;
+    packets_.erase(it);
+  }
+}
+
+void OfflineAudioReceiver::DecodePacket(Packet* packet) {
+  auto decoder_it = decoders_.find(packet->payload_type);
+  if (decoder_it == decoders_.end()) {
+    // Payload types without a decoder get a null one, so that the factory is
+    // only asked, and the warning only logged, once.
+    auto codec_it = codecs_.find(packet->payload_type);
+    Decoder decoder = {nullptr, 0};
+    if (codec_it != codecs_.end()) {
+      decoder.decoder = decoder_factory_->MakeAudioDecoder(codec_it->second);
+      decoder.rtp_clockrate_hz = codec_it->second.clockrate_hz;
+    }
+    if (!decoder.decoder) {
+      LOG(LS_WARNING) << "No decoder for payload type "
+                      << static_cast<int>(packet->payload_type);
+    }
+    decoder_it =
+        decoders_.emplace(packet->payload_type, std::move(decoder)).first;
+  }
+  if (!decoder_it->second.decoder) {
+    ++stats_.discarded_packets;
+    return;
+  }
+  const Decoder& decoder = decoder_it->second;
+
+  bool decoded = false;
+  for (AudioDecoder::ParseResult& result : decoder.decoder->ParsePayload(
+           std::move(packet->payload), packet->timestamp)) {
+    // Lower priorities are redundant copies, e.g. FEC, of audio from earlier
+    // packets. They are only needed where that audio is missing, i.e. where
+    // they start at or after the end of what has been decoded.
+    const bool redundant = result.priority != 0;
+    if (redundant &&
+        (!decoded_end_timestamp_ ||
+         IsNewerTimestamp(*decoded_end_timestamp_, result.timestamp))) {
+      continue;
+    }
+    const size_t duration = result.frame->Duration();
+    const size_t max_samples =
+        (duration > 0 ? duration
+                      : static_cast<size_t>(decoder.decoder->SampleRateHz() *
+                                            kMaxFrameDurationMs / 1000)) *
+        decoder.decoder->Channels();
+    if (decoded_.size() < max_samples)
+      decoded_.resize(max_samples);
+    const rtc::Optional<AudioDecoder::EncodedAudioFrame::DecodeResult>
+        decode_result = result.frame->Decode(decoded_);
+    if (!decode_result) {
+      LOG(LS_WARNING) << "Failed to decode a frame at timestamp "
+                      << result.timestamp;
+      continue;
+    }
+    AppendAudio(decoder, packet->payload_type, result.timestamp,
+                rtc::ArrayView<const int16_t>(
+                    decoded_.data(), decode_result->num_decoded_samples));
+    if (redundant) {
+      ++stats_.recovered_frames;
+    } else {
+      decoded = true;
+    }
+  }
+  if (decoded) {
+    ++stats_.decoded_packets;
+  } else {
+    ++stats_.discarded_packets;
+  }
+}
+
+void OfflineAudioReceiver::AppendAudio(const Decoder& decoder,
+                                       uint8_t payload_type,
+                                       uint32_t timestamp,
+                                       rtc::ArrayView<const int16_t> audio) {
+  if (!chunk_.empty() && (payload_type != chunk_payload_type_ ||
+                          timestamp != chunk_end_timestamp_)) {
+    EmitChunk();
+  }
+  if (chunk_.empty()) {
+    chunk_payload_type_ = payload_type;
+    chunk_sample_rate_hz_ = decoder.decoder->SampleRateHz();
+    chunk_num_channels_ = decoder.decoder->Channels();
+    chunk_timestamp_ = timestamp;
+    chunk_end_timestamp_ = timestamp;
+  }
+  const size_t chunk_size =
+      static_cast<size_t>(chunk_sample_rate_hz_ * chunk_ms_ / 1000) *
+      chunk_num_channels_;
+  while (!audio.empty()) {
+    const size_t num_samples =
+        std::min(audio.size(), chunk_size - chunk_.size());
+    chunk_.insert(chunk_.end(), audio.begin(), audio.begin() + num_samples);
+    audio = audio.subview(num_samples);
+    // The RTP clock may differ from the sample rate, e.g. for G.722.
+    const int64_t samples_per_channel = num_samples / chunk_num_channels_;
+    chunk_end_timestamp_ += static_cast<uint32_t>(
+        samples_per_channel * decoder.rtp_clockrate_hz / chunk_sample_rate_hz_);
+    if (chunk_.size() == chunk_size) {
+      EmitChunk();
+      // The rest of |audio| starts the next chunk.
+      chunk_timestamp_ = chunk_end_timestamp_;
+    }
+  }
+  decoded_end_timestamp_ = rtc::Optional<uint32_t>(chunk_end_timestamp_);
+}
+
+void OfflineAudioReceiver::EmitChunk() {
+  if (chunk_.empty())
+    return;
+  callback_->OnDecodedAudio(chunk_timestamp_, chunk_sample_rate_hz_,
+                            chunk_num_channels_, chunk_);
+  // Keeps the capacity, so that later chunks do not allocate.
+  chunk_.clear();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "modules/audio_coding/include/offline_audio_receiver.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+const uint8_t kPayloadType = 96;
+const int kPacketSizeMs = 20;
+const int kNumPackets = 30000;  // 10 minutes.
+
+class CountingCallback : public OfflineAudioReceiver::Callback {
+ public:
+  void OnDecodedAudio(uint32_t rtp_timestamp,
+                      int sample_rate_hz,
+                      size_t num_channels,
+                      rtc::ArrayView<const int16_t> audio) override {
+    num_samples += audio.size();
+  }
+
+  size_t num_samples = 0;
+};
+
+// Decodes 10 minutes of 20 ms packets of |format|, with every tenth pair of
+// packets swapped, and prints how many times faster than real time that is.
+// |payload_size| is the size of each packet in bytes.
+void RunDecoding(const std::string& trace,
+                 const SdpAudioFormat& format,
+                 size_t payload_size) {
+  std::vector<uint8_t> payload(payload_size);
+  for (size_t i = 0; i < payload.size(); ++i)
+    payload[i] = static_cast<uint8_t>(i * 37);
+  const uint32_t timestamps_per_packet =
+      format.clockrate_hz * kPacketSizeMs / 1000;
+
+  CountingCallback callback;
+  OfflineAudioReceiver receiver(CreateBuiltinAudioDecoderFactory(), &callback,
+                                1000, 8);
+  receiver.SetCodecs({{kPayloadType, format}});
+  RTPHeader header;
+  header.payloadType = kPayloadType;
+
+  const int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumPackets; ++i) {
+    const int index = i % 10 == 4 ? i + 1 : i % 10 == 5 ? i - 1 : i;
+    header.sequenceNumber = static_cast<uint16_t>(index);
+    header.timestamp = index * timestamps_per_packet;
+    receiver.InsertPacket(header, payload);
+  }
+  receiver.Flush();
+  const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+
+  EXPECT_EQ(static_cast<uint64_t>(kNumPackets),
+            receiver.GetStats().decoded_packets);
+  EXPECT_EQ(format.clockrate_hz * format.num_channels * kPacketSizeMs / 1000 *
+                static_cast<size_t>(kNumPackets),
+            callback.num_samples);
+  const int64_t duration_us =
+      static_cast<int64_t>(kNumPackets) * kPacketSizeMs * 1000;
+  test::PrintResult("offline_audio_receiver", "", trace,
+                    static_cast<size_t>(duration_us /
+                                        std::max<int64_t>(elapsed_us, 1)),
+                    "x_real_time", true);
+}
+
+}  // namespace
+
+TEST(OfflineAudioReceiverPerformanceTest, PcmU) {
+  RunDecoding("pcmu_8khz_mono", SdpAudioFormat("PCMU", 8000, 1), 160);
+}
+
+TEST(OfflineAudioReceiverPerformanceTest, L16Mono) {
+  RunDecoding("l16_48khz_mono", SdpAudioFormat("L16", 48000, 1), 1920);
+}
+
+TEST(OfflineAudioReceiverPerformanceTest, L16Stereo) {
+  RunDecoding("l16_48khz_stereo", SdpAudioFormat("L16", 48000, 2), 3840);
+}
+
+}  // namespace webrtc
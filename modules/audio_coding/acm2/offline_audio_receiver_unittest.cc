@@ -0,0 +1,279 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/include/offline_audio_receiver.h"
+
+#include <memory>
+#include <vector>
+
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "modules/audio_coding/codecs/legacy_encoded_audio_frame.h"
+#include "modules/audio_coding/codecs/pcm16b/audio_decoder_pcm16b.h"
+#include "rtc_base/refcountedobject.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+const uint32_t kFirstTimestamp = 4711;
+const uint16_t kFirstSequenceNumber = 65534;
+const uint8_t kPayloadType = 96;
+const int kSampleRateHz = 8000;
+const size_t kSamplesPerPacket = 80;
+
+struct Chunk {
+  uint32_t rtp_timestamp;
+  std::vector<int16_t> audio;
+};
+
+class ChunkCollector : public OfflineAudioReceiver::Callback {
+ public:
+  void OnDecodedAudio(uint32_t rtp_timestamp,
+                      int sample_rate_hz,
+                      size_t num_channels,
+                      rtc::ArrayView<const int16_t> audio) override {
+    EXPECT_EQ(kSampleRateHz, sample_rate_hz);
+    EXPECT_EQ(1u, num_channels);
+    chunks.push_back({rtp_timestamp,
+                      std::vector<int16_t>(audio.begin(), audio.end())});
+  }
+
+  std::vector<Chunk> chunks;
+};
+
+// Decodes payloads which hold the L16 audio of the previous packet, as a
+// redundant copy, followed by that of their own packet.
+class FecDecoder : public AudioDecoder {
+ public:
+  FecDecoder() : pcm16b_(kSampleRateHz, 1) {}
+
+  std::vector<ParseResult> ParsePayload(rtc::Buffer&& payload,
+                                        uint32_t timestamp) override {
+    const size_t half = payload.size() / 2;
+    std::vector<ParseResult> results;
+    results.emplace_back(
+        timestamp - kSamplesPerPacket, 1,
+        std::unique_ptr<EncodedAudioFrame>(new LegacyEncodedAudioFrame(
+            &pcm16b_, rtc::Buffer(payload.data(), half))));
+    results.emplace_back(
+        timestamp, 0,
+        std::unique_ptr<EncodedAudioFrame>(new LegacyEncodedAudioFrame(
+            &pcm16b_, rtc::Buffer(payload.data() + half, half))));
+    return results;
+  }
+  void Reset() override { pcm16b_.Reset(); }
+  int SampleRateHz() const override { return pcm16b_.SampleRateHz(); }
+  size_t Channels() const override { return pcm16b_.Channels(); }
+
+ protected:
+  int DecodeInternal(const uint8_t* encoded,
+                     size_t encoded_len,
+                     int sample_rate_hz,
+                     int16_t* decoded,
+                     SpeechType* speech_type) override {
+    return pcm16b_.Decode(encoded, encoded_len, sample_rate_hz, encoded_len,
+                          decoded, speech_type);
+  }
+
+ private:
+  AudioDecoderPcm16B pcm16b_;
+};
+
+class FecDecoderFactory : public AudioDecoderFactory {
+ public:
+  std::vector<AudioCodecSpec> GetSupportedDecoders() override { return {}; }
+  bool IsSupportedDecoder(const SdpAudioFormat& format) override {
+    return true;
+  }
+  std::unique_ptr<AudioDecoder> MakeAudioDecoder(
+      const SdpAudioFormat& format) override {
+    return std::unique_ptr<AudioDecoder>(new FecDecoder());
+  }
+};
+
+// Appends the L16 audio of the |index|th 10 ms packet of a stream, whose
+// samples count up from zero, to |payload|.
+void AppendAudio(int index, std::vector<uint8_t>* payload) {
+  for (size_t i = 0; i < kSamplesPerPacket; ++i) {
+    const int16_t sample = static_cast<int16_t>(index * kSamplesPerPacket + i);
+    payload->push_back(static_cast<uint8_t>(sample >> 8));
+    payload->push_back(static_cast<uint8_t>(sample & 0xFF));
+  }
+}
+
+// Inserts the |index|th packet of the stream. With |fec|, the packet also
+// carries the audio of the previous one, for FecDecoder.
+void InsertPacket(OfflineAudioReceiver* receiver,
+                  int index,
+                  uint8_t payload_type = kPayloadType,
+                  bool fec = false) {
+  RTPHeader header;
+  header.payloadType = payload_type;
+  header.sequenceNumber = static_cast<uint16_t>(kFirstSequenceNumber + index);
+  header.timestamp = kFirstTimestamp + index * kSamplesPerPacket;
+  std::vector<uint8_t> payload;
+  if (fec)
+    AppendAudio(index - 1, &payload);
+  AppendAudio(index, &payload);
+  receiver->InsertPacket(header, payload);
+}
+
+// Checks that |chunk| holds |num_samples| of the stream from |first_sample|
+// on.
+void ExpectSamples(const Chunk& chunk,
+                   size_t first_sample,
+                   size_t num_samples) {
+  EXPECT_EQ(kFirstTimestamp + first_sample, chunk.rtp_timestamp);
+  ASSERT_EQ(num_samples, chunk.audio.size());
+  for (size_t i = 0; i < chunk.audio.size(); ++i)
+    EXPECT_EQ(static_cast<int16_t>(first_sample + i), chunk.audio[i]);
+}
+
+// Checks that |chunk| holds packets |first_index| to |last_index|.
+void ExpectPackets(const Chunk& chunk, int first_index, int last_index) {
+  ExpectSamples(chunk, first_index * kSamplesPerPacket,
+                (last_index - first_index + 1) * kSamplesPerPacket);
+}
+
+class OfflineAudioReceiverTest : public ::testing::Test {
+ protected:
+  void CreateReceiver(int chunk_ms, size_t max_reordering) {
+    receiver_.reset(new OfflineAudioReceiver(
+        CreateBuiltinAudioDecoderFactory(), &collector_, chunk_ms,
+        max_reordering));
+    receiver_->SetCodecs(
+        {{kPayloadType, SdpAudioFormat("L16", kSampleRateHz, 1)}});
+  }
+
+  ChunkCollector collector_;
+  std::unique_ptr<OfflineAudioReceiver> receiver_;
+};
+
+}  // namespace
+
+TEST_F(OfflineAudioReceiverTest, DecodesReorderedPacketsInOrder) {
+  CreateReceiver(1000, 3);
+  for (int index : {0, 2, 1, 4, 3})
+    InsertPacket(receiver_.get(), index);
+  EXPECT_TRUE(collector_.chunks.empty());
+  receiver_->Flush();
+
+  ASSERT_EQ(1u, collector_.chunks.size());
+  ExpectPackets(collector_.chunks[0], 0, 4);
+  OfflineAudioReceiver::Stats stats = receiver_->GetStats();
+  EXPECT_EQ(5u, stats.decoded_packets);
+  EXPECT_EQ(0u, stats.lost_packets);
+  EXPECT_EQ(0u, stats.discarded_packets);
+}
+
+TEST_F(OfflineAudioReceiverTest, GivesUpOnMissingPackets) {
+  CreateReceiver(1000, 2);
+  for (int index : {0, 1, 3, 4})
+    InsertPacket(receiver_.get(), index);
+  // Packet 2 may still come.
+  EXPECT_TRUE(collector_.chunks.empty());
+  InsertPacket(receiver_.get(), 5);
+  // Packet 2 is lost, which ends the first chunk. Late and duplicate packets
+  // are dropped.
+  ASSERT_EQ(1u, collector_.chunks.size());
+  ExpectPackets(collector_.chunks[0], 0, 1);
+  InsertPacket(receiver_.get(), 2);
+  InsertPacket(receiver_.get(), 5);
+  receiver_->Flush();
+
+  ASSERT_EQ(2u, collector_.chunks.size());
+  ExpectPackets(collector_.chunks[1], 3, 5);
+  OfflineAudioReceiver::Stats stats = receiver_->GetStats();
+  EXPECT_EQ(5u, stats.decoded_packets);
+  EXPECT_EQ(1u, stats.lost_packets);
+  EXPECT_EQ(2u, stats.discarded_packets);
+}
+
+TEST_F(OfflineAudioReceiverTest, EmitsChunksOfChunkMs) {
+  CreateReceiver(20, 0);
+  for (int index = 0; index < 5; ++index)
+    InsertPacket(receiver_.get(), index);
+  ASSERT_EQ(2u, collector_.chunks.size());
+  receiver_->Flush();
+
+  ASSERT_EQ(3u, collector_.chunks.size());
+  ExpectPackets(collector_.chunks[0], 0, 1);
+  ExpectPackets(collector_.chunks[1], 2, 3);
+  ExpectPackets(collector_.chunks[2], 4, 4);
+}
+
+TEST_F(OfflineAudioReceiverTest, SplitsFramesBetweenChunks) {
+  CreateReceiver(15, 0);
+  for (int index = 0; index < 5; ++index)
+    InsertPacket(receiver_.get(), index);
+  ASSERT_EQ(3u, collector_.chunks.size());
+  receiver_->Flush();
+
+  // No chunk is longer than 15 ms, and the chunks follow each other without
+  // gaps.
+  ASSERT_EQ(4u, collector_.chunks.size());
+  ExpectSamples(collector_.chunks[0], 0, 120);
+  ExpectSamples(collector_.chunks[1], 120, 120);
+  ExpectSamples(collector_.chunks[2], 240, 120);
+  ExpectSamples(collector_.chunks[3], 360, 40);
+}
+
+TEST_F(OfflineAudioReceiverTest, DecodesFecOfLostPackets) {
+  OfflineAudioReceiver receiver(new rtc::RefCountedObject<FecDecoderFactory>(),
+                                &collector_, 1000, 0);
+  receiver.SetCodecs({{kPayloadType, SdpAudioFormat("L16", kSampleRateHz, 1)}});
+  for (int index : {0, 1, 3, 4})
+    InsertPacket(&receiver, index, kPayloadType, true);
+  receiver.Flush();
+
+  // Packet 2 is recovered from the FEC in packet 3. The other redundant
+  // copies are of audio which was already decoded, and are skipped.
+  ASSERT_EQ(1u, collector_.chunks.size());
+  ExpectPackets(collector_.chunks[0], 0, 4);
+  OfflineAudioReceiver::Stats stats = receiver.GetStats();
+  EXPECT_EQ(4u, stats.decoded_packets);
+  EXPECT_EQ(1u, stats.lost_packets);
+  EXPECT_EQ(1u, stats.recovered_frames);
+}
+
+TEST_F(OfflineAudioReceiverTest, DecodesHeldPacketsBeforeChangingCodecs) {
+  CreateReceiver(1000, 3);
+  for (int index : {0, 2, 3})
+    InsertPacket(receiver_.get(), index);
+  ASSERT_TRUE(collector_.chunks.empty());
+
+  // Packets 2 and 3 were sent as 8 kHz L16, and are decoded as such even
+  // though the payload type now means something else.
+  receiver_->SetCodecs(
+      {{kPayloadType, SdpAudioFormat("L16", 2 * kSampleRateHz, 1)}});
+  ASSERT_EQ(2u, collector_.chunks.size());
+  ExpectPackets(collector_.chunks[0], 0, 0);
+  ExpectPackets(collector_.chunks[1], 2, 3);
+  OfflineAudioReceiver::Stats stats = receiver_->GetStats();
+  EXPECT_EQ(3u, stats.decoded_packets);
+  EXPECT_EQ(1u, stats.lost_packets);
+}
+
+TEST_F(OfflineAudioReceiverTest, DropsUnknownPayloadTypes) {
+  CreateReceiver(1000, 0);
+  InsertPacket(receiver_.get(), 0);
+  InsertPacket(receiver_.get(), 1, kPayloadType + 1);
+  InsertPacket(receiver_.get(), 2);
+  receiver_->Flush();
+
+  // The dropped packet leaves a gap in the timestamps.
+  ASSERT_EQ(2u, collector_.chunks.size());
+  ExpectPackets(collector_.chunks[0], 0, 0);
+  ExpectPackets(collector_.chunks[1], 2, 2);
+  EXPECT_EQ(1u, receiver_->GetStats().discarded_packets);
+}
+
+}  // namespace webrtc
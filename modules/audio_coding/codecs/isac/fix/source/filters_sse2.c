@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+
+#include "rtc_base/checks.h"
+#include "modules/audio_coding/codecs/isac/fix/source/codec.h"
+
+// Returns the sum of x[i] * y[i] for i in [0, n), computed exactly like the
+// C version. _mm_madd_epi16 adds two 16 x 16 bit products into a 32-bit lane,
+// which only overflows for (-32768)^2 + (-32768)^2 = 2^31. That lane wraps
+// to INT32_MIN, and is therefore zero extended instead of sign extended when
+// widened to 64 bits.
+static int64_t DotProduct(const int16_t* x, const int16_t* y, int n) {
+  const __m128i kMinInt32 = _mm_set1_epi32(INT32_MIN);
+  __m128i sum = _mm_setzero_si128();
+  int64_t sums[2];
+  int64_t prod = 0;
+  int i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    const __m128i x_v = _mm_loadu_si128((const __m128i*)&x[i]);
+    const __m128i y_v = _mm_loadu_si128((const __m128i*)&y[i]);
+    const __m128i prod_v = _mm_madd_epi16(x_v, y_v);
+    const __m128i sign_v = _mm_andnot_si128(_mm_cmpeq_epi32(prod_v, kMinInt32),
+                                            _mm_srai_epi32(prod_v, 31));
+    sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(prod_v, sign_v));
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(prod_v, sign_v));
+  }
+  _mm_storeu_si128((__m128i*)sums, sum);
+  prod = sums[0] + sums[1];
+
+  for (; i < n; i++) {
+    prod += x[i] * y[i];
+  }
+  return prod;
+}
+
+// Autocorrelation function in fixed point.
+// NOTE! Different from SPLIB-version in how it scales the signal.
+int WebRtcIsacfix_AutocorrSSE2(int32_t* __restrict r,
+                               const int16_t* __restrict x,
+                               int16_t N,
+                               int16_t order,
+                               int16_t* __restrict scale) {
+  int i = 0;
+  int16_t scaling = 0;
+  uint32_t temp = 0;
+  int64_t prod = 0;
+
+  RTC_DCHECK_EQ(0, N % 4);
+  RTC_DCHECK_GE(N, 8);
+
+  // Calculate r[0].
+  prod = DotProduct(x, x, N);
+
+  // Calculate scaling (the value of shifting).
+  temp = (uint32_t)(prod >> 31);
+  if(temp == 0) {
+    scaling = 0;
+  } else {
+    scaling = 32 - WebRtcSpl_NormU32(temp);
+  }
+  r[0] = (int32_t)(prod >> scaling);
+
+  // Perform the actual correlation calculation.
+  for (i = 1; i < order + 1; i++) {
+    prod = DotProduct(x, &x[i], N - i);
+    r[i] = (int32_t)(prod >> scaling);
+  }
+
+  *scale = scaling;
+
+  return(order + 1);
+}
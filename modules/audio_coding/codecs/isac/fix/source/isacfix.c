@@ -214,6 +214,20 @@ static void WebRtcIsacfix_InitNeon(void) {
 }
 #endif
 
+/****************************************************************************
+ * WebRtcIsacfix_InitSSE2(...)
+ *
+ * This function initializes function pointers for x86 SSE2 platform.
+ */
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+static void WebRtcIsacfix_InitSSE2(void) {
+  WebRtcIsacfix_AutocorrFix = WebRtcIsacfix_AutocorrSSE2;
+  WebRtcIsacfix_Spec2Time = WebRtcIsacfix_Spec2TimeSSE2;
+  WebRtcIsacfix_Time2Spec = WebRtcIsacfix_Time2SpecSSE2;
+}
+#endif
+
 /****************************************************************************
  * WebRtcIsacfix_InitMIPS(...)
  *
@@ -253,6 +267,12 @@ static void InitFunctionPointers(void) {
   WebRtcIsacfix_MatrixProduct1 = WebRtcIsacfix_MatrixProduct1C;
   WebRtcIsacfix_MatrixProduct2 = WebRtcIsacfix_MatrixProduct2C;
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcIsacfix_InitSSE2();
+  }
+#endif
+
 #if defined(WEBRTC_HAS_NEON)
   WebRtcIsacfix_InitNeon();
 #endif
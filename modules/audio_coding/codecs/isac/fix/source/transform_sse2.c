@@ -0,0 +1,297 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+
+#include "modules/audio_coding/codecs/isac/fix/source/codec.h"
+#include "modules/audio_coding/codecs/isac/fix/source/fft.h"
+#include "modules/audio_coding/codecs/isac/fix/source/settings.h"
+
+// Tables are defined in transform_tables.c file.
+// Cosine table 1 in Q14.
+extern const int16_t WebRtcIsacfix_kCosTab1[FRAMESAMPLES/2];
+// Sine table 1 in Q14.
+extern const int16_t WebRtcIsacfix_kSinTab1[FRAMESAMPLES/2];
+// Sine table 2 in Q14.
+extern const int16_t WebRtcIsacfix_kSinTab2[FRAMESAMPLES/4];
+
+// The functions below give the same results as the C versions, bit by bit.
+// The 16-bit factors |a| of the multiplications are kept in the low half of
+// 32-bit lanes, with the high half zero, so that _mm_madd_epi16(a, b)
+// multiplies |a| with the low 16 bits of |b|, as a signed number.
+
+// Returns the 16-bit values of |a| times the low 16 bits of |b|, as unsigned
+// numbers, like WEBRTC_SPL_MUL_16_U16().
+static inline __m128i MulU16(__m128i a, __m128i b) {
+  const __m128i prod = _mm_madd_epi16(a, b);
+  // Add |a| << 16 if the low half of |b| is negative as a signed number.
+  const __m128i negative = _mm_srai_epi32(_mm_slli_epi32(b, 16), 31);
+  return _mm_add_epi32(prod, _mm_and_si128(negative, _mm_slli_epi32(a, 16)));
+}
+
+// Like WEBRTC_SPL_MUL_16_32_RSFT16().
+static inline __m128i MulRsft16(__m128i a, __m128i b) {
+  const __m128i high = _mm_madd_epi16(a, _mm_srai_epi32(b, 16));
+  const __m128i low = _mm_madd_epi16(a, _mm_srli_epi32(_mm_slli_epi32(b, 16),
+                                                       17));
+  return _mm_add_epi32(
+      high, _mm_srai_epi32(_mm_add_epi32(low, _mm_set1_epi32(0x4000)), 15));
+}
+
+// Like WEBRTC_SPL_MUL_16_32_RSFT14().
+static inline __m128i MulRsft14(__m128i a, __m128i b) {
+  const __m128i high = _mm_slli_epi32(_mm_madd_epi16(a, _mm_srai_epi32(b, 16)),
+                                      2);
+  const __m128i low = _mm_srai_epi32(MulU16(a, b), 1);
+  return _mm_add_epi32(
+      high, _mm_srai_epi32(_mm_add_epi32(low, _mm_set1_epi32(0x1000)), 13));
+}
+
+// Like WEBRTC_SPL_MUL_16_32_RSFT11().
+static inline __m128i MulRsft11(__m128i a, __m128i b) {
+  const __m128i high = _mm_slli_epi32(_mm_madd_epi16(a, _mm_srai_epi32(b, 16)),
+                                      5);
+  const __m128i low = _mm_srai_epi32(MulU16(a, b), 1);
+  return _mm_add_epi32(
+      high, _mm_srai_epi32(_mm_add_epi32(low, _mm_set1_epi32(0x0200)), 10));
+}
+
+// Loads four 16-bit values as factors for the multiplications above.
+static inline __m128i LoadFactors(const int16_t* x) {
+  return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)x),
+                            _mm_setzero_si128());
+}
+
+// Loads four 16-bit values in reverse order, negated, as factors for the
+// multiplications above.
+static inline __m128i LoadNegatedReversedFactors(const int16_t* x) {
+  const __m128i reversed = _mm_shufflelo_epi16(
+      _mm_loadl_epi64((const __m128i*)x), _MM_SHUFFLE(0, 1, 2, 3));
+  return _mm_unpacklo_epi16(_mm_sub_epi16(_mm_setzero_si128(), reversed),
+                            _mm_setzero_si128());
+}
+
+// Loads four 16-bit values, sign extended to 32 bits.
+static inline __m128i LoadInt16(const int16_t* x) {
+  const __m128i v = _mm_loadl_epi64((const __m128i*)x);
+  return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+}
+
+static inline __m128i Reverse32(__m128i x) {
+  return _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+// Casts the 32-bit values in |low| and |high| to int16_t, like the C code.
+static inline __m128i PackInt16(__m128i low, __m128i high) {
+  return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(low, 16), 16),
+                         _mm_srai_epi32(_mm_slli_epi32(high, 16), 16));
+}
+
+// Converts |in|, in Q16, to the "fastest" vector |out| in Q(16+sh).
+static void ToFastest(const int32_t* in, int16_t sh, int16_t* out) {
+  int k;
+  if (sh >= 0) {
+    const __m128i shift = _mm_cvtsi32_si128(sh);
+    for (k = 0; k < FRAMESAMPLES/2; k += 8) {
+      const __m128i low = _mm_loadu_si128((const __m128i*)&in[k]);
+      const __m128i high = _mm_loadu_si128((const __m128i*)&in[k + 4]);
+      _mm_storeu_si128((__m128i*)&out[k],
+                       PackInt16(_mm_sll_epi32(low, shift),
+                                 _mm_sll_epi32(high, shift)));
+    }
+  } else {
+    const __m128i shift = _mm_cvtsi32_si128(-sh);
+    const __m128i round = _mm_set1_epi32(1 << (-sh - 1));
+    for (k = 0; k < FRAMESAMPLES/2; k += 8) {
+      const __m128i low = _mm_loadu_si128((const __m128i*)&in[k]);
+      const __m128i high = _mm_loadu_si128((const __m128i*)&in[k + 4]);
+      _mm_storeu_si128(
+          (__m128i*)&out[k],
+          PackInt16(_mm_sra_epi32(_mm_add_epi32(low, round), shift),
+                    _mm_sra_epi32(_mm_add_epi32(high, round), shift)));
+    }
+  }
+}
+
+// Loads four values of the "fastest" vector |x|, in Q(16+sh), in Q16.
+static inline __m128i LoadFromFastest(const int16_t* x,
+                                      int16_t sh,
+                                      __m128i shift) {
+  const __m128i v = LoadInt16(x);
+  return sh >= 0 ? _mm_sra_epi32(v, shift) : _mm_sll_epi32(v, shift);
+}
+
+static int16_t FastestShift(const int32_t* re, const int32_t* im) {
+  int32_t max_re = WebRtcSpl_MaxAbsValueW32(re, FRAMESAMPLES/2);
+  int32_t max_im = WebRtcSpl_MaxAbsValueW32(im, FRAMESAMPLES/2);
+  if (max_im > max_re) {
+    max_re = max_im;
+  }
+  // If sh becomes >= 0, then we should shift sh steps to the left, and the
+  // domain will become Q(16+sh). If sh becomes < 0, then we should shift -sh
+  // steps to the right, and the domain will become Q(16+sh).
+  return WebRtcSpl_NormW32(max_re) - 24;
+}
+
+void WebRtcIsacfix_Time2SpecSSE2(int16_t* inre1Q9,
+                                 int16_t* inre2Q9,
+                                 int16_t* outreQ7,
+                                 int16_t* outimQ7) {
+  int k;
+  int32_t tmpreQ16[FRAMESAMPLES/2], tmpimQ16[FRAMESAMPLES/2];
+  int16_t sh;
+  __m128i shift;
+  const __m128i zero = _mm_setzero_si128();
+  // 0.5 / sqrt(240) in Q19 is round(.5 / sqrt(240) * (2^19)) = 16921.
+  const __m128i fact_q19 = _mm_set1_epi32(16921);
+  const __m128i round = _mm_set1_epi32(4);
+
+  // Multiply with complex exponentials and combine into one complex vector.
+  for (k = 0; k < FRAMESAMPLES/2; k += 8) {
+    const __m128i in1 = _mm_loadu_si128((const __m128i*)&inre1Q9[k]);
+    const __m128i in2 = _mm_loadu_si128((const __m128i*)&inre2Q9[k]);
+    const __m128i cos =
+        _mm_loadu_si128((const __m128i*)&WebRtcIsacfix_kCosTab1[k]);
+    const __m128i sin =
+        _mm_loadu_si128((const __m128i*)&WebRtcIsacfix_kSinTab1[k]);
+    const __m128i neg_sin = _mm_sub_epi16(zero, sin);
+    __m128i xr_low = _mm_madd_epi16(_mm_unpacklo_epi16(in1, in2),
+                                    _mm_unpacklo_epi16(cos, sin));
+    __m128i xr_high = _mm_madd_epi16(_mm_unpackhi_epi16(in1, in2),
+                                     _mm_unpackhi_epi16(cos, sin));
+    __m128i xi_low = _mm_madd_epi16(_mm_unpacklo_epi16(in2, in1),
+                                    _mm_unpacklo_epi16(cos, neg_sin));
+    __m128i xi_high = _mm_madd_epi16(_mm_unpackhi_epi16(in2, in1),
+                                     _mm_unpackhi_epi16(cos, neg_sin));
+    xr_low = MulRsft16(fact_q19, _mm_srai_epi32(xr_low, 7));
+    xr_high = MulRsft16(fact_q19, _mm_srai_epi32(xr_high, 7));
+    xi_low = MulRsft16(fact_q19, _mm_srai_epi32(xi_low, 7));
+    xi_high = MulRsft16(fact_q19, _mm_srai_epi32(xi_high, 7));
+    // Q-domains: (Q16 * Q19 >> 16) >> 3 = Q16.
+    _mm_storeu_si128((__m128i*)&tmpreQ16[k],
+                     _mm_srai_epi32(_mm_add_epi32(xr_low, round), 3));
+    _mm_storeu_si128((__m128i*)&tmpreQ16[k + 4],
+                     _mm_srai_epi32(_mm_add_epi32(xr_high, round), 3));
+    _mm_storeu_si128((__m128i*)&tmpimQ16[k],
+                     _mm_srai_epi32(_mm_add_epi32(xi_low, round), 3));
+    _mm_storeu_si128((__m128i*)&tmpimQ16[k + 4],
+                     _mm_srai_epi32(_mm_add_epi32(xi_high, round), 3));
+  }
+
+  sh = FastestShift(tmpreQ16, tmpimQ16);
+  ToFastest(tmpreQ16, sh, inre1Q9);
+  ToFastest(tmpimQ16, sh, inre2Q9);
+
+  // Get DFT.
+  WebRtcIsacfix_FftRadix16Fastest(inre1Q9, inre2Q9, -1);  // real call
+
+  // Use symmetry to separate into two complex vectors and center frames in
+  // time around zero. The "fastest" vectors are converted back to Q16 on the
+  // fly.
+  shift = _mm_cvtsi32_si128(sh >= 0 ? sh : -sh);
+  for (k = 0; k < FRAMESAMPLES/4; k += 4) {
+    const int16_t* re_end = &inre1Q9[FRAMESAMPLES/2 - 4 - k];
+    const int16_t* im_end = &inre2Q9[FRAMESAMPLES/2 - 4 - k];
+    const __m128i re = LoadFromFastest(&inre1Q9[k], sh, shift);
+    const __m128i im = LoadFromFastest(&inre2Q9[k], sh, shift);
+    const __m128i re2 = Reverse32(LoadFromFastest(re_end, sh, shift));
+    const __m128i im2 = Reverse32(LoadFromFastest(im_end, sh, shift));
+    const __m128i xr = _mm_add_epi32(re, re2);
+    const __m128i yi = _mm_sub_epi32(re2, re);
+    const __m128i xi = _mm_sub_epi32(im, im2);
+    const __m128i yr = _mm_add_epi32(im, im2);
+    const __m128i tmp1r = LoadNegatedReversedFactors(
+        &WebRtcIsacfix_kSinTab2[FRAMESAMPLES/4 - 4 - k]);
+    const __m128i tmp1i = LoadFactors(&WebRtcIsacfix_kSinTab2[k]);
+    __m128i v1 = _mm_sub_epi32(MulRsft14(tmp1r, xr), MulRsft14(tmp1i, xi));
+    __m128i v2 = _mm_add_epi32(MulRsft14(tmp1i, xr), MulRsft14(tmp1r, xi));
+    _mm_storel_epi64((__m128i*)&outreQ7[k],
+                     PackInt16(_mm_srai_epi32(v1, 9), zero));
+    _mm_storel_epi64((__m128i*)&outimQ7[k],
+                     PackInt16(_mm_srai_epi32(v2, 9), zero));
+    v1 = _mm_sub_epi32(_mm_sub_epi32(zero, MulRsft14(tmp1i, yr)),
+                       MulRsft14(tmp1r, yi));
+    v2 = _mm_sub_epi32(MulRsft14(tmp1i, yi), MulRsft14(tmp1r, yr));
+    _mm_storel_epi64((__m128i*)&outreQ7[FRAMESAMPLES/2 - 4 - k],
+                     PackInt16(Reverse32(_mm_srai_epi32(v1, 9)), zero));
+    _mm_storel_epi64((__m128i*)&outimQ7[FRAMESAMPLES/2 - 4 - k],
+                     PackInt16(Reverse32(_mm_srai_epi32(v2, 9)), zero));
+  }
+}
+
+void WebRtcIsacfix_Spec2TimeSSE2(int16_t* inreQ7,
+                                 int16_t* inimQ7,
+                                 int32_t* outre1Q16,
+                                 int32_t* outre2Q16) {
+  int k;
+  int16_t sh;
+  __m128i shift;
+  // 1/240 is 273 in Q16.
+  const __m128i scale_q16 = _mm_set1_epi32(273);
+  // sqrt(240) in Q11 is round(15.49193338482967 * 2048) = 31727.
+  const __m128i fact_q11 = _mm_set1_epi32(31727);
+
+  for (k = 0; k < FRAMESAMPLES/4; k += 4) {
+    // Move zero in time to beginning of frames.
+    const __m128i tmp1r = LoadNegatedReversedFactors(
+        &WebRtcIsacfix_kSinTab2[FRAMESAMPLES/4 - 4 - k]);
+    const __m128i tmp1i = LoadFactors(&WebRtcIsacfix_kSinTab2[k]);
+    // Q7 -> Q16.
+    const __m128i in_re = _mm_slli_epi32(LoadInt16(&inreQ7[k]), 9);
+    const __m128i in_im = _mm_slli_epi32(LoadInt16(&inimQ7[k]), 9);
+    const __m128i in_re2 = Reverse32(
+        _mm_slli_epi32(LoadInt16(&inreQ7[FRAMESAMPLES/2 - 4 - k]), 9));
+    const __m128i in_im2 = Reverse32(
+        _mm_slli_epi32(LoadInt16(&inimQ7[FRAMESAMPLES/2 - 4 - k]), 9));
+
+    const __m128i xr = _mm_add_epi32(MulRsft14(tmp1r, in_re),
+                                     MulRsft14(tmp1i, in_im));
+    const __m128i xi = _mm_sub_epi32(MulRsft14(tmp1r, in_im),
+                                     MulRsft14(tmp1i, in_re));
+    const __m128i yr = _mm_sub_epi32(
+        _mm_sub_epi32(_mm_setzero_si128(), MulRsft14(tmp1r, in_im2)),
+        MulRsft14(tmp1i, in_re2));
+    const __m128i yi = _mm_sub_epi32(MulRsft14(tmp1i, in_im2),
+                                     MulRsft14(tmp1r, in_re2));
+
+    // Combine into one vector, z = x + j * y.
+    _mm_storeu_si128((__m128i*)&outre1Q16[k], _mm_sub_epi32(xr, yi));
+    _mm_storeu_si128((__m128i*)&outre1Q16[FRAMESAMPLES/2 - 4 - k],
+                     Reverse32(_mm_add_epi32(xr, yi)));
+    _mm_storeu_si128((__m128i*)&outre2Q16[k], _mm_add_epi32(xi, yr));
+    _mm_storeu_si128((__m128i*)&outre2Q16[FRAMESAMPLES/2 - 4 - k],
+                     Reverse32(_mm_sub_epi32(yr, xi)));
+  }
+
+  // Get IDFT.
+  sh = FastestShift(outre1Q16, outre2Q16);
+  ToFastest(outre1Q16, sh, inreQ7);
+  ToFastest(outre2Q16, sh, inimQ7);
+
+  WebRtcIsacfix_FftRadix16Fastest(inreQ7, inimQ7, 1);  // real call
+
+  // Convert the "fastest" vectors back to Q16, divide through by the
+  // normalizing constant 240, demodulate and separate.
+  shift = _mm_cvtsi32_si128(sh >= 0 ? sh : -sh);
+  for (k = 0; k < FRAMESAMPLES/2; k += 4) {
+    const __m128i re =
+        MulRsft16(scale_q16, LoadFromFastest(&inreQ7[k], sh, shift));
+    const __m128i im =
+        MulRsft16(scale_q16, LoadFromFastest(&inimQ7[k], sh, shift));
+    const __m128i tmp1r = LoadFactors(&WebRtcIsacfix_kCosTab1[k]);
+    const __m128i tmp1i = LoadFactors(&WebRtcIsacfix_kSinTab1[k]);
+    const __m128i xr = _mm_sub_epi32(MulRsft14(tmp1r, re),
+                                     MulRsft14(tmp1i, im));
+    const __m128i xi = _mm_add_epi32(MulRsft14(tmp1r, im),
+                                     MulRsft14(tmp1i, re));
+    _mm_storeu_si128((__m128i*)&outre1Q16[k], MulRsft11(fact_q11, xr));
+    _mm_storeu_si128((__m128i*)&outre2Q16[k], MulRsft11(fact_q11, xi));
+  }
+}
@@ -183,6 +183,11 @@ TEST_F(TransformTest, Time2SpecTest) {
 #if defined(WEBRTC_HAS_NEON)
   Time2SpecTester(WebRtcIsacfix_Time2SpecNeon);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    Time2SpecTester(WebRtcIsacfix_Time2SpecSSE2);
+  }
+#endif
 }
 
 TEST_F(TransformTest, Spec2TimeTest) {
@@ -190,4 +195,54 @@ TEST_F(TransformTest, Spec2TimeTest) {
 #if defined(WEBRTC_HAS_NEON)
   Spec2TimeTester(WebRtcIsacfix_Spec2TimeNeon);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    Spec2TimeTester(WebRtcIsacfix_Spec2TimeSSE2);
+  }
+#endif
+}
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Unlike the ARM versions, the SSE2 versions are bit-exact with the C
+// versions. Test signals of all amplitudes, so that the "fastest" vectors are
+// scaled both up and down.
+TEST_F(TransformTest, Sse2IsBitExact) {
+  if (!WebRtc_GetCPUInfo(kSSE2)) {
+    return;
+  }
+  for (int shift = 0; shift < 16; shift++) {
+    int16_t in_1[kSamples];
+    int16_t in_2[kSamples];
+    int16_t in_1_sse2[kSamples];
+    int16_t in_2_sse2[kSamples];
+    for (int i = 0; i < kSamples; i++) {
+      in_1[i] = in_1_sse2[i] = static_cast<int16_t>(i * i + 1777) >> shift;
+      in_2[i] = in_2_sse2[i] =
+          static_cast<int16_t>(i * 7919 - WEBRTC_SPL_WORD16_MAX) >> shift;
+    }
+
+    int16_t spec_1[kSamples];
+    int16_t spec_2[kSamples];
+    int16_t spec_1_sse2[kSamples];
+    int16_t spec_2_sse2[kSamples];
+    WebRtcIsacfix_Time2SpecC(in_1, in_2, spec_1, spec_2);
+    WebRtcIsacfix_Time2SpecSSE2(in_1_sse2, in_2_sse2, spec_1_sse2,
+                                spec_2_sse2);
+
+    int32_t out_1[kSamples];
+    int32_t out_2[kSamples];
+    int32_t out_1_sse2[kSamples];
+    int32_t out_2_sse2[kSamples];
+    WebRtcIsacfix_Spec2TimeC(spec_1, spec_2, out_1, out_2);
+    WebRtcIsacfix_Spec2TimeSSE2(spec_1_sse2, spec_2_sse2, out_1_sse2,
+                                out_2_sse2);
+
+    for (int i = 0; i < kSamples; i++) {
+      EXPECT_EQ(spec_1[i], spec_1_sse2[i]);
+      EXPECT_EQ(spec_2[i], spec_2_sse2[i]);
+      EXPECT_EQ(out_1[i], out_1_sse2[i]);
+      EXPECT_EQ(out_2[i], out_2_sse2[i]);
+    }
+  }
 }
+#endif
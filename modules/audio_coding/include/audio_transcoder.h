@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_CODING_INCLUDE_AUDIO_TRANSCODER_H_
+#define MODULES_AUDIO_CODING_INCLUDE_AUDIO_TRANSCODER_H_
+
+#include <memory>
+#include <vector>
+
+#include "api/array_view.h"
+#include "api/audio_codecs/audio_decoder.h"
+#include "api/audio_codecs/audio_encoder.h"
+#include "common_audio/resampler/include/push_resampler.h"
+#include "modules/audio_coding/include/audio_coding_module.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/constructormagic.h"
+
+namespace webrtc {
+
+// Transcodes one audio stream from one codec to another, for bridging two
+// call legs 1:1. Each incoming payload is decoded at the native rate of the
+// decoder, converted between mono and stereo and resampled once if the
+// encoder needs it, and encoded 10 ms at a time. There is no jitter buffer,
+// mixing or audio processing on the way, so packets must be inserted in
+// order, as they arrive.
+//
+// An AudioTranscoder has no threads or timers of its own, and does not
+// allocate memory once it has seen the largest payload, so a single thread
+// can run many of them, one packet at a time. It is not thread safe.
+class AudioTranscoder {
+ public:
+  // Encoded packets are passed to |callback|, which must outlive the
+  // transcoder. |decoder_rtp_timestamp_rate_hz| is the RTP clock of the
+  // incoming payloads, which is not always the sample rate of |decoder|, e.g.
+  // for G.722. Only mono and stereo are supported, and |encoder| must not
+  // produce redundant encodings.
+  AudioTranscoder(std::unique_ptr<AudioDecoder> decoder,
+                  int decoder_rtp_timestamp_rate_hz,
+                  std::unique_ptr<AudioEncoder> encoder,
+                  AudioPacketizationCallback* callback);
+  ~AudioTranscoder();
+
+  // Transcodes one incoming payload, calling the callback for every packet
+  // that the encoder outputs. Decoded audio that does not fill a 10 ms block
+  // is kept until the next payload. The timestamp of the first payload is
+  // used as the first outgoing RTP timestamp. Later outgoing timestamps are
+  // derived from the incoming ones, converted to the clock of the encoder, so
+  // that gaps from lost packets or DTX are kept. Audio left from before a gap
+  // is padded with silence. Returns 0 on success and -1 if the payload could
+  // not be decoded or the audio could not be encoded.
+  int InsertPacket(rtc::ArrayView<const uint8_t> payload,
+                   uint32_t rtp_timestamp);
+
+  // Resets the codecs and drops the audio that has not been encoded yet. The
+  // next payload starts over, as if it was the first.
+  void Reset();
+
+  AudioDecoder* decoder() { return decoder_.get(); }
+  AudioEncoder* encoder() { return encoder_.get(); }
+
+ private:
+  // Pads the audio left from the previous payload with silence to cover a
+  // gap of |num_samples| samples per channel, and advances the outgoing
+  // timestamp past the rest of the gap.
+  int SkipGap(size_t num_samples);
+
+  // Encodes one 10 ms block of decoded audio.
+  int Encode10Ms(const int16_t* audio);
+
+  const std::unique_ptr<AudioDecoder> decoder_;
+  const std::unique_ptr<AudioEncoder> encoder_;
+  AudioPacketizationCallback* const callback_;
+  const int decoder_rtp_timestamp_rate_hz_;
+  const size_t decoder_samples_per_10ms_;
+  const size_t encoder_samples_per_10ms_;
+  PushResampler<int16_t> resampler_;
+
+  bool first_packet_ = true;
+  // The outgoing RTP timestamp of the next 10 ms block to encode.
+  uint32_t rtp_timestamp_ = 0;
+  // The incoming RTP timestamp that follows the previous payload.
+  uint32_t next_incoming_timestamp_ = 0;
+  std::vector<int16_t> decoded_;
+  // Decoded audio left over from the previous payload, less than 10 ms.
+  std::vector<int16_t> pending_;
+  size_t pending_samples_ = 0;
+  std::vector<int16_t> channel_converted_;
+  std::vector<int16_t> resampled_;
+  rtc::Buffer encoded_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(AudioTranscoder);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_CODING_INCLUDE_AUDIO_TRANSCODER_H_
@@ -0,0 +1,158 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_CODING_INCLUDE_OFFLINE_AUDIO_RECEIVER_H_
+#define MODULES_AUDIO_CODING_INCLUDE_OFFLINE_AUDIO_RECEIVER_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "api/array_view.h"
+#include "api/audio_codecs/audio_decoder.h"
+#include "api/audio_codecs/audio_decoder_factory.h"
+#include "api/audio_codecs/audio_format.h"
+#include "api/optional.h"
+#include "common_types.h"  // NOLINT(build/include)
+#include "modules/include/module_common_types.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/scoped_ref_ptr.h"
+
+namespace webrtc {
+
+// Decodes an incoming audio stream as fast as its packets arrive, for
+// recording servers which do not play out in real time. Unlike AcmReceiver,
+// which decodes 10 ms per GetAudio() call, each packet is decoded as soon as
+// all packets before it have arrived, or have been given up on. Since there
+// is no playout clock, there is no time-stretching or loss concealment;
+// lost packets and DTX periods show as gaps in the timestamps of the audio.
+// Where a lost packet has a redundant copy in a later packet, e.g. Opus FEC,
+// the copy is decoded to fill the gap.
+//
+// Contiguous decoded audio is collected into chunks of up to |chunk_ms|,
+// which are handed to a Callback together with their RTP timestamp. Decoded
+// frames are split between chunks where needed. A chunk ends early where the
+// timestamps jump, or where the codec changes.
+//
+// An OfflineAudioReceiver has no threads or timers of its own, and is not
+// thread safe.
+class OfflineAudioReceiver {
+ public:
+  class Callback {
+   public:
+    virtual ~Callback() = default;
+
+    // |audio| holds interleaved samples at |sample_rate_hz|, and starts at
+    // |rtp_timestamp| in the RTP clock of the codec.
+    virtual void OnDecodedAudio(uint32_t rtp_timestamp,
+                                int sample_rate_hz,
+                                size_t num_channels,
+                                rtc::ArrayView<const int16_t> audio) = 0;
+  };
+
+  struct Stats {
+    // Packets which were decoded.
+    uint64_t decoded_packets = 0;
+    // Packets which never arrived, judging by their sequence numbers.
+    uint64_t lost_packets = 0;
+    // Redundant frames, e.g. FEC, which were decoded in place of lost ones.
+    uint64_t recovered_frames = 0;
+    // Packets which were dropped since they arrived after their turn, were
+    // duplicates, had an unknown payload type or could not be decoded.
+    uint64_t discarded_packets = 0;
+  };
+
+  // |callback| must outlive the receiver. A packet which is missing is given
+  // up on when |max_reordering| later packets have arrived.
+  OfflineAudioReceiver(rtc::scoped_refptr<AudioDecoderFactory> decoder_factory,
+                       Callback* callback,
+                       int chunk_ms,
+                       size_t max_reordering);
+  ~OfflineAudioReceiver();
+
+  // Replaces the payload type mapping. Packets held back for reordering are
+  // decoded with the old mapping first, treating any missing ones as lost,
+  // and all audio collected so far is emitted.
+  void SetCodecs(const std::map<int, SdpAudioFormat>& codecs);
+
+  // Inserts one RTP packet, and decodes all packets that are no longer
+  // waiting for an earlier one.
+  void InsertPacket(const RTPHeader& rtp_header,
+                    rtc::ArrayView<const uint8_t> payload);
+
+  // Decodes all packets held back, treating any missing ones as lost, and
+  // emits the audio collected so far. Call this at the end of the stream.
+  void Flush();
+
+  Stats GetStats() const { return stats_; }
+
+ private:
+  struct Decoder {
+    std::unique_ptr<AudioDecoder> decoder;
+    int rtp_clockrate_hz;
+  };
+
+  struct Packet {
+    uint8_t payload_type;
+    uint32_t timestamp;
+    rtc::Buffer payload;
+  };
+
+  // Decodes the packets in |packets_| from |next_sequence_number_| on, until
+  // one is missing.
+  void DecodeInOrder();
+  void DecodePacket(Packet* packet);
+  // Appends decoded audio, starting at |timestamp|, to the current chunk.
+  void AppendAudio(const Decoder& decoder,
+                   uint8_t payload_type,
+                   uint32_t timestamp,
+                   rtc::ArrayView<const int16_t> audio);
+  // Hands the current chunk, if any, to |callback_|.
+  void EmitChunk();
+
+  const rtc::scoped_refptr<AudioDecoderFactory> decoder_factory_;
+  Callback* const callback_;
+  const int chunk_ms_;
+  const size_t max_reordering_;
+
+  std::map<int, SdpAudioFormat> codecs_;
+  // Decoders are created when their payload type is first seen.
+  std::map<int, Decoder> decoders_;
+
+  SequenceNumberUnwrapper sequence_number_unwrapper_;
+  // Packets that have arrived but are waiting for an earlier one, by their
+  // unwrapped sequence number.
+  std::map<int64_t, Packet> packets_;
+  bool first_packet_ = true;
+  int64_t next_sequence_number_ = 0;
+
+  // The chunk being collected, and the payload type and format it was
+  // decoded from.
+  std::vector<int16_t> chunk_;
+  uint8_t chunk_payload_type_ = 0;
+  int chunk_sample_rate_hz_ = 0;
+  size_t chunk_num_channels_ = 0;
+  uint32_t chunk_timestamp_ = 0;
+  // The RTP timestamp that would continue the current chunk.
+  uint32_t chunk_end_timestamp_ = 0;
+  // The RTP timestamp that follows the last decoded audio, whether or not
+  // it has been emitted.
+  rtc::Optional<uint32_t> decoded_end_timestamp_;
+  std::vector<int16_t> decoded_;
+
+  Stats stats_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(OfflineAudioReceiver);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_CODING_INCLUDE_OFFLINE_AUDIO_RECEIVER_H_
@@ -43,6 +43,7 @@
 #include "modules/audio_coding/neteq/timestamp_scaler.h"
 #include "modules/include/module_common_types.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/location.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/safe_conversions.h"
 #include "rtc_base/sanitizer.h"
@@ -133,7 +134,7 @@ int NetEqImpl::InsertPacket(const RTPHeader& rtp_header,
                             uint32_t receive_timestamp) {
   rtc::MsanCheckInitialized(payload);
   TRACE_EVENT0("webrtc", "NetEqImpl::InsertPacket");
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (InsertPacketInternal(rtp_header, payload, receive_timestamp) != 0) {
     return kFail;
   }
@@ -144,7 +145,7 @@ void NetEqImpl::InsertEmptyPacket(const RTPHeader& /*rtp_header*/) {
   // TODO(henrik.lundin) Handle NACK as well. This will make use of the
   // rtp_header parameter.
   // https://bugs.chromium.org/p/webrtc/issues/detail?id=7611
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   delay_manager_->RegisterEmptyPacket();
 }
 
@@ -193,7 +194,7 @@ void SetAudioFrameActivityAndType(bool vad_enabled,
 
 int NetEqImpl::GetAudio(AudioFrame* audio_frame, bool* muted) {
   TRACE_EVENT0("webrtc", "NetEqImpl::GetAudio");
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (GetAudioInternal(audio_frame, muted) != 0) {
     return kFail;
   }
@@ -214,7 +215,7 @@ int NetEqImpl::GetAudio(AudioFrame* audio_frame, bool* muted) {
 }
 
 void NetEqImpl::SetCodecs(const std::map<int, SdpAudioFormat>& codecs) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   const std::vector<int> changed_payload_types =
       decoder_database_->SetCodecs(codecs);
   for (const int pt : changed_payload_types) {
@@ -225,7 +226,7 @@ void NetEqImpl::SetCodecs(const std::map<int, SdpAudioFormat>& codecs) {
 int NetEqImpl::RegisterPayloadType(NetEqDecoder codec,
                                    const std::string& name,
                                    uint8_t rtp_payload_type) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   LOG(LS_VERBOSE) << "RegisterPayloadType "
                   << static_cast<int>(rtp_payload_type) << " "
                   << static_cast<int>(codec);
@@ -240,7 +241,7 @@ int NetEqImpl::RegisterExternalDecoder(AudioDecoder* decoder,
                                        NetEqDecoder codec,
                                        const std::string& codec_name,
                                        uint8_t rtp_payload_type) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   LOG(LS_VERBOSE) << "RegisterExternalDecoder "
                   << static_cast<int>(rtp_payload_type) << " "
                   << static_cast<int>(codec);
@@ -260,13 +261,13 @@ bool NetEqImpl::RegisterPayloadType(int rtp_payload_type,
                                     const SdpAudioFormat& audio_format) {
   LOG(LS_VERBOSE) << "NetEqImpl::RegisterPayloadType: payload type "
                   << rtp_payload_type << ", codec " << audio_format;
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   return decoder_database_->RegisterPayload(rtp_payload_type, audio_format) ==
          DecoderDatabase::kOK;
 }
 
 int NetEqImpl::RemovePayloadType(uint8_t rtp_payload_type) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   int ret = decoder_database_->Remove(rtp_payload_type);
   if (ret == DecoderDatabase::kOK || ret == DecoderDatabase::kDecoderNotFound) {
     packet_buffer_->DiscardPacketsWithPayloadType(rtp_payload_type, &stats_);
@@ -276,12 +277,12 @@ int NetEqImpl::RemovePayloadType(uint8_t rtp_payload_type) {
 }
 
 void NetEqImpl::RemoveAllPayloadTypes() {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   decoder_database_->RemoveAll();
 }
 
 bool NetEqImpl::SetMinimumDelay(int delay_ms) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (delay_ms >= 0 && delay_ms <= 10000) {
     assert(delay_manager_.get());
     return delay_manager_->SetMinimumDelay(delay_ms);
@@ -290,7 +291,7 @@ bool NetEqImpl::SetMinimumDelay(int delay_ms) {
 }
 
 bool NetEqImpl::SetMaximumDelay(int delay_ms) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (delay_ms >= 0 && delay_ms <= 10000) {
     assert(delay_manager_.get());
     return delay_manager_->SetMaximumDelay(delay_ms);
@@ -299,7 +300,7 @@ bool NetEqImpl::SetMaximumDelay(int delay_ms) {
 }
 
 int NetEqImpl::LeastRequiredDelayMs() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   assert(delay_manager_.get());
   return delay_manager_->least_required_delay_ms();
 }
@@ -309,7 +310,7 @@ int NetEqImpl::SetTargetDelay() {
 }
 
 int NetEqImpl::TargetDelayMs() {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   RTC_DCHECK(delay_manager_.get());
   // The value from TargetLevel() is in number of packets, represented in Q8.
   const size_t target_delay_samples =
@@ -319,7 +320,7 @@ int NetEqImpl::TargetDelayMs() {
 }
 
 int NetEqImpl::CurrentDelayMs() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (fs_hz_ == 0)
     return 0;
   // Sum up the samples in the packet buffer with the future length of the sync
@@ -334,7 +335,7 @@ int NetEqImpl::CurrentDelayMs() const {
 }
 
 int NetEqImpl::FilteredCurrentDelayMs() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   // Calculate the filtered packet buffer level in samples. The value from
   // |buffer_level_filter_| is in number of packets, represented in Q8.
   const size_t packet_buffer_samples =
@@ -352,7 +353,7 @@ int NetEqImpl::FilteredCurrentDelayMs() const {
 // Deprecated.
 // TODO(henrik.lundin) Delete.
 void NetEqImpl::SetPlayoutMode(NetEqPlayoutMode mode) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (mode != playout_mode_) {
     playout_mode_ = mode;
     CreateDecisionLogic();
@@ -362,12 +363,12 @@ void NetEqImpl::SetPlayoutMode(NetEqPlayoutMode mode) {
 // Deprecated.
 // TODO(henrik.lundin) Delete.
 NetEqPlayoutMode NetEqImpl::PlayoutMode() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   return playout_mode_;
 }
 
 int NetEqImpl::NetworkStatistics(NetEqNetworkStatistics* stats) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   assert(decoder_database_.get());
   const size_t total_samples_in_buffers =
       packet_buffer_->NumSamplesInBuffer(decoder_frame_length_) +
@@ -383,38 +384,38 @@ int NetEqImpl::NetworkStatistics(NetEqNetworkStatistics* stats) {
 }
 
 NetEqLifetimeStatistics NetEqImpl::GetLifetimeStatistics() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   return stats_.GetLifetimeStatistics();
 }
 
 void NetEqImpl::GetRtcpStatistics(RtcpStatistics* stats) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (stats) {
     rtcp_.GetStatistics(false, stats);
   }
 }
 
 void NetEqImpl::GetRtcpStatisticsNoReset(RtcpStatistics* stats) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (stats) {
     rtcp_.GetStatistics(true, stats);
   }
 }
 
 void NetEqImpl::EnableVad() {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   assert(vad_.get());
   vad_->Enable();
 }
 
 void NetEqImpl::DisableVad() {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   assert(vad_.get());
   vad_->Disable();
 }
 
 rtc::Optional<uint32_t> NetEqImpl::GetPlayoutTimestamp() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (first_packet_ || last_mode_ == kModeRfc3389Cng ||
       last_mode_ == kModeCodecInternalCng) {
     // We don't have a valid RTP timestamp until we have decoded our first
@@ -427,12 +428,12 @@ rtc::Optional<uint32_t> NetEqImpl::GetPlayoutTimestamp() const {
 }
 
 int NetEqImpl::last_output_sample_rate_hz() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   return last_output_sample_rate_hz_;
 }
 
 rtc::Optional<CodecInst> NetEqImpl::GetDecoder(int payload_type) const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   const DecoderDatabase::DecoderInfo* di =
       decoder_database_->GetDecoderInfo(payload_type);
   if (!di) {
@@ -454,7 +455,7 @@ rtc::Optional<CodecInst> NetEqImpl::GetDecoder(int payload_type) const {
 
 rtc::Optional<SdpAudioFormat> NetEqImpl::GetDecoderFormat(
     int payload_type) const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   const DecoderDatabase::DecoderInfo* const di =
       decoder_database_->GetDecoderInfo(payload_type);
   if (!di) {
@@ -472,7 +473,7 @@ int NetEqImpl::SetTargetSampleRate() {
 }
 
 void NetEqImpl::FlushBuffers() {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   LOG(LS_VERBOSE) << "FlushBuffers";
   packet_buffer_->Flush();
   assert(sync_buffer_.get());
@@ -486,12 +487,12 @@ void NetEqImpl::FlushBuffers() {
 
 void NetEqImpl::PacketBufferStatistics(int* current_num_packets,
                                        int* max_num_packets) const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   packet_buffer_->BufferStat(current_num_packets, max_num_packets);
 }
 
 void NetEqImpl::EnableNack(size_t max_nack_list_size) {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (!nack_enabled_) {
     const int kNackThresholdPackets = 2;
     nack_.reset(NackTracker::Create(kNackThresholdPackets));
@@ -502,13 +503,13 @@ void NetEqImpl::EnableNack(size_t max_nack_list_size) {
 }
 
 void NetEqImpl::DisableNack() {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   nack_.reset();
   nack_enabled_ = false;
 }
 
 std::vector<uint16_t> NetEqImpl::GetNackList(int64_t round_trip_time_ms) const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   if (!nack_enabled_) {
     return std::vector<uint16_t>();
   }
@@ -517,23 +518,23 @@ std::vector<uint16_t> NetEqImpl::GetNackList(int64_t round_trip_time_ms) const {
 }
 
 std::vector<uint32_t> NetEqImpl::LastDecodedTimestamps() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   return last_decoded_timestamps_;
 }
 
 int NetEqImpl::SyncBufferSizeMs() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   return rtc::dchecked_cast<int>(sync_buffer_->FutureLength() /
                                  rtc::CheckedDivExact(fs_hz_, 1000));
 }
 
 const SyncBuffer* NetEqImpl::sync_buffer_for_test() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   return sync_buffer_.get();
 }
 
 Operations NetEqImpl::last_operation_for_test() const {
-  rtc::CritScope lock(&crit_sect_);
+  rtc::CritScope lock(&crit_sect_, RTC_FROM_HERE);
   return last_operation_;
 }
 
@@ -41,6 +41,16 @@ static const size_t kMinValidCallTimeTimeInMilliseconds =
 static const double k2Pi = 6.28318530717959;
 #endif
 
+// Raises |max_level| to |level| if it is lower. LogStats() may reset it to
+// zero at any time, and then the audio thread starts over from there.
+static void UpdateMaxLevel(int16_t level, std::atomic<int16_t>* max_level) {
+  int16_t current = max_level->load(std::memory_order_relaxed);
+  while (level > current &&
+         !max_level->compare_exchange_weak(current, level,
+                                           std::memory_order_relaxed)) {
+  }
+}
+
 AudioDeviceBuffer::AudioDeviceBuffer()
     : task_queue_(kTimerQueueName),
       audio_transport_cb_(nullptr),
@@ -61,6 +71,12 @@ AudioDeviceBuffer::AudioDeviceBuffer()
       rec_stat_count_(0),
       play_stat_count_(0),
       play_start_time_(0),
+      rec_callbacks_(0),
+      play_callbacks_(0),
+      rec_samples_(0),
+      play_samples_(0),
+      max_rec_level_(0),
+      max_play_level_(0),
       only_silence_recorded_(true),
       log_stats_(false) {
   LOG(INFO) << "AudioDeviceBuffer::ctor";
@@ -437,12 +453,13 @@ void AudioDeviceBuffer::LogStats(LogState state) {
   last_timer_task_time_ = now_time;
 
   Stats stats;
-  {
-    rtc::CritScope cs(&lock_);
-    stats = stats_;
-    stats_.max_rec_level = 0;
-    stats_.max_play_level = 0;
-  }
+  stats.rec_callbacks = rec_callbacks_.load(std::memory_order_relaxed);
+  stats.play_callbacks = play_callbacks_.load(std::memory_order_relaxed);
+  stats.rec_samples = rec_samples_.load(std::memory_order_relaxed);
+  stats.play_samples = play_samples_.load(std::memory_order_relaxed);
+  stats.max_rec_level = max_rec_level_.exchange(0, std::memory_order_relaxed);
+  stats.max_play_level =
+      max_play_level_.exchange(0, std::memory_order_relaxed);
 
   // Log the latest statistics but skip the first round just after state was
   // set to LOG_START. Hence, first printed log will be after ~10 seconds.
@@ -479,37 +496,33 @@ void AudioDeviceBuffer::LogStats(LogState state) {
 void AudioDeviceBuffer::ResetRecStats() {
   RTC_DCHECK_RUN_ON(&task_queue_);
   last_stats_.ResetRecStats();
-  rtc::CritScope cs(&lock_);
-  stats_.ResetRecStats();
+  rec_callbacks_.store(0, std::memory_order_relaxed);
+  rec_samples_.store(0, std::memory_order_relaxed);
+  max_rec_level_.store(0, std::memory_order_relaxed);
 }
 
 void AudioDeviceBuffer::ResetPlayStats() {
   RTC_DCHECK_RUN_ON(&task_queue_);
   last_stats_.ResetPlayStats();
-  rtc::CritScope cs(&lock_);
-  stats_.ResetPlayStats();
+  play_callbacks_.store(0, std::memory_order_relaxed);
+  play_samples_.store(0, std::memory_order_relaxed);
+  max_play_level_.store(0, std::memory_order_relaxed);
 }
 
 void AudioDeviceBuffer::UpdateRecStats(int16_t max_abs,
                                        size_t samples_per_channel) {
   RTC_DCHECK_RUN_ON(&recording_thread_checker_);
-  rtc::CritScope cs(&lock_);
-  ++stats_.rec_callbacks;
-  stats_.rec_samples += samples_per_channel;
-  if (max_abs > stats_.max_rec_level) {
-    stats_.max_rec_level = max_abs;
-  }
+  rec_callbacks_.fetch_add(1, std::memory_order_relaxed);
+  rec_samples_.fetch_add(samples_per_channel, std::memory_order_relaxed);
+  UpdateMaxLevel(max_abs, &max_rec_level_);
 }
 
 void AudioDeviceBuffer::UpdatePlayStats(int16_t max_abs,
                                         size_t samples_per_channel) {
   RTC_DCHECK_RUN_ON(&playout_thread_checker_);
-  rtc::CritScope cs(&lock_);
-  ++stats_.play_callbacks;
-  stats_.play_samples += samples_per_channel;
-  if (max_abs > stats_.max_play_level) {
-    stats_.max_play_level = max_abs;
-  }
+  play_callbacks_.fetch_add(1, std::memory_order_relaxed);
+  play_samples_.fetch_add(samples_per_channel, std::memory_order_relaxed);
+  UpdateMaxLevel(max_abs, &max_play_level_);
 }
 
 }  // namespace webrtc
@@ -11,9 +11,10 @@
 #ifndef MODULES_AUDIO_DEVICE_AUDIO_DEVICE_BUFFER_H_
 #define MODULES_AUDIO_DEVICE_AUDIO_DEVICE_BUFFER_H_
 
+#include <atomic>
+
 #include "modules/audio_device/include/audio_device.h"
 #include "rtc_base/buffer.h"
-#include "rtc_base/criticalsection.h"
 #include "rtc_base/task_queue.h"
 #include "rtc_base/thread_annotations.h"
 #include "rtc_base/thread_checker.h"
@@ -127,7 +128,8 @@ class AudioDeviceBuffer {
   void LogStats(LogState state);
 
   // Updates counters in each play/record callback. These counters are later
-  // (periodically) read by LogStats() using a lock.
+  // (periodically) read by LogStats(). No lock is taken, so that the audio
+  // threads never wait for the task queue.
   void UpdateRecStats(int16_t max_abs, size_t samples_per_channel);
   void UpdatePlayStats(int16_t max_abs, size_t samples_per_channel);
 
@@ -153,8 +155,6 @@ class AudioDeviceBuffer {
   // Native (platform specific) audio thread driving the recording side.
   rtc::ThreadChecker recording_thread_checker_;
 
-  rtc::CriticalSection lock_;
-
   // Task queue used to invoke LogStats() periodically. Tasks are executed on a
   // worker thread but it does not necessarily have to be the same thread for
   // each task.
@@ -231,8 +231,14 @@ class AudioDeviceBuffer {
   int64_t play_start_time_ RTC_ACCESS_ON(main_thread_checker_);
   int64_t rec_start_time_ RTC_ACCESS_ON(main_thread_checker_);
 
-  // Contains counters for playout and recording statistics.
-  Stats stats_ RTC_GUARDED_BY(lock_);
+  // Contains counters for playout and recording statistics. See Stats for
+  // details. Each counter is written by one audio thread only.
+  std::atomic<uint64_t> rec_callbacks_;
+  std::atomic<uint64_t> play_callbacks_;
+  std::atomic<uint64_t> rec_samples_;
+  std::atomic<uint64_t> play_samples_;
+  std::atomic<int16_t> max_rec_level_;
+  std::atomic<int16_t> max_play_level_;
 
   // Stores current stats at each timer task. Used to calculate differences
   // between two successive timer events.
@@ -0,0 +1,225 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_device/decoupled_audio_transport.h"
+
+#include <string.h>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+namespace {
+
+// How often the FIFOs are serviced. This is well below the smallest allowed
+// |buffer_ms|, so the engine gets several chances to catch up before the
+// device runs out of audio.
+const int kPollIntervalMs = 5;
+const int kMinBufferMs = 20;
+
+}  // namespace
+
+DecoupledAudioTransport::DecoupledAudioTransport(
+    AudioTransport* transport,
+    const AudioParameters& playout_parameters,
+    const AudioParameters& record_parameters,
+    int buffer_ms)
+    : transport_(transport),
+      playout_parameters_(playout_parameters),
+      record_parameters_(record_parameters),
+      playout_samples_per_10_ms_(playout_parameters.frames_per_10ms_buffer() *
+                                 playout_parameters.channels()),
+      record_samples_per_10_ms_(record_parameters.frames_per_10ms_buffer() *
+                                record_parameters.channels()),
+      playout_target_size_(buffer_ms * playout_samples_per_10_ms_ / 10),
+      playout_fifo_(playout_target_size_ + playout_samples_per_10_ms_),
+      record_fifo_(buffer_ms * record_samples_per_10_ms_ / 10),
+      playout_buffer_(new int16_t[playout_samples_per_10_ms_]),
+      record_buffer_(new int16_t[record_samples_per_10_ms_]),
+      total_delay_ms_(0),
+      clock_drift_(0),
+      current_mic_level_(0),
+      key_pressed_(false),
+      new_mic_level_(0),
+      playout_callbacks_(0),
+      playout_underruns_(0),
+      record_callbacks_(0),
+      record_overruns_(0),
+      stop_event_(false, false) {
+  RTC_DCHECK(transport_);
+  RTC_DCHECK(playout_parameters_.is_valid());
+  RTC_DCHECK(record_parameters_.is_valid());
+  RTC_DCHECK_GE(buffer_ms, kMinBufferMs);
+}
+
+DecoupledAudioTransport::~DecoupledAudioTransport() {
+  Stop();
+}
+
+void DecoupledAudioTransport::Start() {
+  if (thread_)
+    return;
+  playout_fifo_.Clear();
+  record_fifo_.Clear();
+  thread_.reset(new rtc::PlatformThread(&DecoupledAudioTransport::Run, this,
+                                        "DecoupledAudioTransport",
+                                        rtc::kRealtimePriority));
+  thread_->Start();
+}
+
+void DecoupledAudioTransport::Stop() {
+  if (!thread_)
+    return;
+  stop_event_.Set();
+  thread_->Stop();
+  thread_.reset();
+}
+
+DecoupledAudioTransport::Stats DecoupledAudioTransport::GetStats() const {
+  Stats stats;
+  stats.playout_callbacks = playout_callbacks_.load(std::memory_order_relaxed);
+  stats.playout_underruns = playout_underruns_.load(std::memory_order_relaxed);
+  stats.record_callbacks = record_callbacks_.load(std::memory_order_relaxed);
+  stats.record_overruns = record_overruns_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+int32_t DecoupledAudioTransport::RecordedDataIsAvailable(
+    const void* audioSamples,
+    const size_t nSamples,
+    const size_t nBytesPerSample,
+    const size_t nChannels,
+    const uint32_t samplesPerSec,
+    const uint32_t totalDelayMS,
+    const int32_t clockDrift,
+    const uint32_t currentMicLevel,
+    const bool keyPressed,
+    uint32_t& newMicLevel) {
+  RTC_DCHECK_EQ(record_parameters_.channels(), nChannels);
+  RTC_DCHECK_EQ(record_parameters_.sample_rate(),
+                static_cast<int>(samplesPerSec));
+  RTC_DCHECK_EQ(nChannels * sizeof(int16_t), nBytesPerSample);
+  record_callbacks_.fetch_add(1, std::memory_order_relaxed);
+  total_delay_ms_.store(totalDelayMS, std::memory_order_relaxed);
+  clock_drift_.store(clockDrift, std::memory_order_relaxed);
+  current_mic_level_.store(currentMicLevel, std::memory_order_relaxed);
+  key_pressed_.store(keyPressed, std::memory_order_relaxed);
+  if (!record_fifo_.Write(rtc::ArrayView<const int16_t>(
+          static_cast<const int16_t*>(audioSamples), nSamples * nChannels))) {
+    record_overruns_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // A level of zero means that the level is unchanged, so each new level
+  // from the engine is only handed to the device once.
+  newMicLevel = new_mic_level_.exchange(0, std::memory_order_relaxed);
+  return 0;
+}
+
+int32_t DecoupledAudioTransport::NeedMorePlayData(const size_t nSamples,
+                                                  const size_t nBytesPerSample,
+                                                  const size_t nChannels,
+                                                  const uint32_t samplesPerSec,
+                                                  void* audioSamples,
+                                                  size_t& nSamplesOut,
+                                                  int64_t* elapsed_time_ms,
+                                                  int64_t* ntp_time_ms) {
+  RTC_DCHECK_EQ(playout_parameters_.channels(), nChannels);
+  RTC_DCHECK_EQ(playout_parameters_.sample_rate(),
+                static_cast<int>(samplesPerSec));
+  RTC_DCHECK_EQ(nChannels * sizeof(int16_t), nBytesPerSample);
+  playout_callbacks_.fetch_add(1, std::memory_order_relaxed);
+  nSamplesOut = nSamples * nChannels;
+  if (!playout_fifo_.Read(rtc::ArrayView<int16_t>(
+          static_cast<int16_t*>(audioSamples), nSamplesOut))) {
+    playout_underruns_.fetch_add(1, std::memory_order_relaxed);
+    memset(audioSamples, 0, nSamplesOut * sizeof(int16_t));
+  }
+  *elapsed_time_ms = -1;
+  *ntp_time_ms = -1;
+  return 0;
+}
+
+void DecoupledAudioTransport::PushCaptureData(int voe_channel,
+                                              const void* audio_data,
+                                              int bits_per_sample,
+                                              int sample_rate,
+                                              size_t number_of_channels,
+                                              size_t number_of_frames) {
+  transport_->PushCaptureData(voe_channel, audio_data, bits_per_sample,
+                              sample_rate, number_of_channels,
+                              number_of_frames);
+}
+
+void DecoupledAudioTransport::PullRenderData(int bits_per_sample,
+                                             int sample_rate,
+                                             size_t number_of_channels,
+                                             size_t number_of_frames,
+                                             void* audio_data,
+                                             int64_t* elapsed_time_ms,
+                                             int64_t* ntp_time_ms) {
+  transport_->PullRenderData(bits_per_sample, sample_rate, number_of_channels,
+                             number_of_frames, audio_data, elapsed_time_ms,
+                             ntp_time_ms);
+}
+
+void DecoupledAudioTransport::Run(void* obj) {
+  DecoupledAudioTransport* self = static_cast<DecoupledAudioTransport*>(obj);
+  do {
+    self->ProcessRecordedAudio();
+    self->ProcessPlayoutAudio();
+  } while (!self->stop_event_.Wait(kPollIntervalMs));
+}
+
+void DecoupledAudioTransport::ProcessRecordedAudio() {
+  const rtc::ArrayView<int16_t> buffer(record_buffer_.get(),
+                                       record_samples_per_10_ms_);
+  while (record_fifo_.Size() >= buffer.size()) {
+    record_fifo_.Read(buffer);
+    const uint32_t total_delay_ms =
+        total_delay_ms_.load(std::memory_order_relaxed) + BufferedMs();
+    uint32_t new_mic_level = 0;
+    const int32_t result = transport_->RecordedDataIsAvailable(
+        buffer.data(), record_parameters_.frames_per_10ms_buffer(),
+        record_parameters_.GetBytesPerFrame(), record_parameters_.channels(),
+        record_parameters_.sample_rate(), total_delay_ms,
+        clock_drift_.load(std::memory_order_relaxed),
+        current_mic_level_.load(std::memory_order_relaxed),
+        key_pressed_.load(std::memory_order_relaxed), new_mic_level);
+    if (result != -1 && new_mic_level != 0)
+      new_mic_level_.store(new_mic_level, std::memory_order_relaxed);
+  }
+}
+
+void DecoupledAudioTransport::ProcessPlayoutAudio() {
+  while (playout_fifo_.Size() < playout_target_size_) {
+    size_t samples_out = 0;
+    int64_t elapsed_time_ms = -1;
+    int64_t ntp_time_ms = -1;
+    if (transport_->NeedMorePlayData(
+            playout_parameters_.frames_per_10ms_buffer(),
+            playout_parameters_.GetBytesPerFrame(),
+            playout_parameters_.channels(), playout_parameters_.sample_rate(),
+            playout_buffer_.get(), samples_out, &elapsed_time_ms,
+            &ntp_time_ms) != 0) {
+      memset(playout_buffer_.get(), 0,
+             playout_samples_per_10_ms_ * sizeof(int16_t));
+    }
+    RTC_DCHECK_LE(samples_out, playout_samples_per_10_ms_);
+    playout_fifo_.Write(rtc::ArrayView<const int16_t>(
+        playout_buffer_.get(), playout_samples_per_10_ms_));
+  }
+}
+
+uint32_t DecoupledAudioTransport::BufferedMs() const {
+  return static_cast<uint32_t>(
+      10 * playout_fifo_.Size() / playout_samples_per_10_ms_ +
+      10 * record_fifo_.Size() / record_samples_per_10_ms_);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,149 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_DEVICE_DECOUPLED_AUDIO_TRANSPORT_H_
+#define MODULES_AUDIO_DEVICE_DECOUPLED_AUDIO_TRANSPORT_H_
+
+#include <atomic>
+#include <memory>
+
+#include "modules/audio_device/include/audio_device_defines.h"
+#include "modules/audio_device/lock_free_audio_fifo.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "typedefs.h"  // NOLINT(build/include)
+
+namespace webrtc {
+
+// An AudioTransport which decouples the native audio threads from the audio
+// engine. The audio device calls it like any other AudioTransport, but it
+// only copies audio to and from two lock-free FIFOs. A thread of its own
+// exchanges the audio with the wrapped |transport| in 10ms chunks, so that
+// the device threads never wait for locks taken by the engine, e.g. while it
+// decodes or mixes audio.
+//
+// This adds up to |buffer_ms| of latency in each direction. The delay given
+// to the engine with recorded audio includes the audio held in the FIFOs,
+// so that echo cancellation stays aligned. When the engine falls behind, the
+// device plays silence (an underrun) or recorded audio is dropped (an
+// overrun). Both are counted in GetStats().
+class DecoupledAudioTransport : public AudioTransport {
+ public:
+  struct Stats {
+    // Number of playout callbacks and how many of them got too little audio
+    // and played silence instead.
+    uint64_t playout_callbacks = 0;
+    uint64_t playout_underruns = 0;
+    // Number of recording callbacks and how many of them had their audio
+    // dropped since the FIFO was full.
+    uint64_t record_callbacks = 0;
+    uint64_t record_overruns = 0;
+  };
+
+  // |transport| must outlive this object. The parameters give the sample
+  // rate and number of channels that the device uses in each direction, and
+  // |buffer_ms| is the amount of audio buffered for playout and the most
+  // recorded audio that is held at once. It must be at least 20ms and larger
+  // than the buffers that the device asks for or delivers.
+  DecoupledAudioTransport(AudioTransport* transport,
+                          const AudioParameters& playout_parameters,
+                          const AudioParameters& record_parameters,
+                          int buffer_ms);
+  ~DecoupledAudioTransport() override;
+
+  // Starts and stops exchanging audio with |transport|. Start() clears the
+  // FIFOs and must be called before the device starts calling this object.
+  void Start();
+  void Stop();
+
+  Stats GetStats() const;
+
+  // AudioTransport implementation. RecordedDataIsAvailable() is called on the
+  // recording thread and NeedMorePlayData() on the playout thread.
+  int32_t RecordedDataIsAvailable(const void* audioSamples,
+                                  const size_t nSamples,
+                                  const size_t nBytesPerSample,
+                                  const size_t nChannels,
+                                  const uint32_t samplesPerSec,
+                                  const uint32_t totalDelayMS,
+                                  const int32_t clockDrift,
+                                  const uint32_t currentMicLevel,
+                                  const bool keyPressed,
+                                  uint32_t& newMicLevel) override;
+  int32_t NeedMorePlayData(const size_t nSamples,
+                           const size_t nBytesPerSample,
+                           const size_t nChannels,
+                           const uint32_t samplesPerSec,
+                           void* audioSamples,
+                           size_t& nSamplesOut,
+                           int64_t* elapsed_time_ms,
+                           int64_t* ntp_time_ms) override;
+  void PushCaptureData(int voe_channel,
+                       const void* audio_data,
+                       int bits_per_sample,
+                       int sample_rate,
+                       size_t number_of_channels,
+                       size_t number_of_frames) override;
+  void PullRenderData(int bits_per_sample,
+                      int sample_rate,
+                      size_t number_of_channels,
+                      size_t number_of_frames,
+                      void* audio_data,
+                      int64_t* elapsed_time_ms,
+                      int64_t* ntp_time_ms) override;
+
+ private:
+  static void Run(void* obj);
+  // Delivers all complete 10ms chunks of recorded audio to |transport_|.
+  void ProcessRecordedAudio();
+  // Asks |transport_| for audio until |buffer_ms| of it is buffered.
+  void ProcessPlayoutAudio();
+  // Returns how much audio is held in the FIFOs.
+  uint32_t BufferedMs() const;
+
+  AudioTransport* const transport_;
+  const AudioParameters playout_parameters_;
+  const AudioParameters record_parameters_;
+  // Number of samples, over all channels, in 10ms of audio.
+  const size_t playout_samples_per_10_ms_;
+  const size_t record_samples_per_10_ms_;
+  // Number of samples that ProcessPlayoutAudio() keeps in |playout_fifo_|.
+  const size_t playout_target_size_;
+
+  LockFreeAudioFifo playout_fifo_;
+  LockFreeAudioFifo record_fifo_;
+  // 10ms of audio on its way between the FIFOs and |transport_|. Only used on
+  // |thread_|.
+  std::unique_ptr<int16_t[]> playout_buffer_;
+  std::unique_ptr<int16_t[]> record_buffer_;
+
+  // The latest values that the recording thread got from the device, and the
+  // latest mic level from |transport_| that has not been returned yet.
+  std::atomic<uint32_t> total_delay_ms_;
+  std::atomic<int32_t> clock_drift_;
+  std::atomic<uint32_t> current_mic_level_;
+  std::atomic<bool> key_pressed_;
+  std::atomic<uint32_t> new_mic_level_;
+
+  std::atomic<uint64_t> playout_callbacks_;
+  std::atomic<uint64_t> playout_underruns_;
+  std::atomic<uint64_t> record_callbacks_;
+  std::atomic<uint64_t> record_overruns_;
+
+  rtc::Event stop_event_;
+  std::unique_ptr<rtc::PlatformThread> thread_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(DecoupledAudioTransport);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_DEVICE_DECOUPLED_AUDIO_TRANSPORT_H_
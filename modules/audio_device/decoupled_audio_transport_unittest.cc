@@ -0,0 +1,283 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_device/decoupled_audio_transport.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "modules/audio_device/include/mock_audio_transport.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/timeutils.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+using ::testing::StrictMock;
+
+namespace webrtc {
+
+namespace {
+
+const int kSampleRate = 48000;
+const size_t kChannels = 2;
+// Neither buffer size is a multiple of 10ms.
+const size_t kPlayoutFrames = 256;
+const size_t kRecordFrames = 720;
+const int kBufferMs = 60;
+const uint32_t kDeviceDelayMs = 20;
+const uint32_t kNewMicLevel = 77;
+// The audio is a ramp which skips zero, so that silence stands out.
+const int16_t kMaxRampValue = 30000;
+
+int16_t NextRampValue(int16_t value) {
+  return value == kMaxRampValue ? 1 : value + 1;
+}
+
+// An audio engine which plays out a ramp, checks that the recorded audio is a
+// ramp too, and now and then stalls as if it was waiting for a lock.
+class FakeEngine : public AudioTransport {
+ public:
+  int32_t RecordedDataIsAvailable(const void* audioSamples,
+                                  const size_t nSamples,
+                                  const size_t nBytesPerSample,
+                                  const size_t nChannels,
+                                  const uint32_t samplesPerSec,
+                                  const uint32_t totalDelayMS,
+                                  const int32_t clockDrift,
+                                  const uint32_t currentMicLevel,
+                                  const bool keyPressed,
+                                  uint32_t& newMicLevel) override {
+    EXPECT_EQ(kSampleRate / 100, static_cast<int>(nSamples));
+    EXPECT_EQ(kChannels, nChannels);
+    EXPECT_GE(totalDelayMS, kDeviceDelayMs);
+    const int16_t* samples = static_cast<const int16_t*>(audioSamples);
+    for (size_t i = 0; i < nSamples * nChannels; ++i) {
+      // Overruns drop recorded audio, which makes the ramp jump.
+      if (samples[i] != next_recorded_)
+        ++recorded_jumps_;
+      next_recorded_ = NextRampValue(samples[i]);
+    }
+    newMicLevel = kNewMicLevel;
+    Stall();
+    return 0;
+  }
+
+  int32_t NeedMorePlayData(const size_t nSamples,
+                           const size_t nBytesPerSample,
+                           const size_t nChannels,
+                           const uint32_t samplesPerSec,
+                           void* audioSamples,
+                           size_t& nSamplesOut,
+                           int64_t* elapsed_time_ms,
+                           int64_t* ntp_time_ms) override {
+    EXPECT_EQ(kSampleRate / 100, static_cast<int>(nSamples));
+    int16_t* samples = static_cast<int16_t*>(audioSamples);
+    for (size_t i = 0; i < nSamples * nChannels; ++i) {
+      samples[i] = next_played_;
+      next_played_ = NextRampValue(next_played_);
+    }
+    nSamplesOut = nSamples * nChannels;
+    Stall();
+    return 0;
+  }
+
+  void PushCaptureData(int voe_channel,
+                       const void* audio_data,
+                       int bits_per_sample,
+                       int sample_rate,
+                       size_t number_of_channels,
+                       size_t number_of_frames) override {}
+
+  void PullRenderData(int bits_per_sample,
+                      int sample_rate,
+                      size_t number_of_channels,
+                      size_t number_of_frames,
+                      void* audio_data,
+                      int64_t* elapsed_time_ms,
+                      int64_t* ntp_time_ms) override {}
+
+  int recorded_jumps() const { return recorded_jumps_; }
+
+ private:
+  void Stall() {
+    if (++num_calls_ % 50 == 0)
+      SleepMs(15);
+  }
+
+  int num_calls_ = 0;
+  int16_t next_played_ = 1;
+  int16_t next_recorded_ = 1;
+  int recorded_jumps_ = 0;
+};
+
+// Acts like the native audio threads, which ask for or deliver a buffer of
+// audio at a fixed rate.
+struct FakeDevice {
+  DecoupledAudioTransport* transport;
+  int duration_ms;
+  // Results of the playout thread.
+  int silent_callbacks = 0;
+  int played_jumps = 0;
+  int played_callbacks = 0;
+  // Results of the recording thread.
+  bool got_new_mic_level = false;
+};
+
+// Calls |callback| every |frames| frames of audio for |duration_ms|.
+template <typename Callback>
+void RunAtAudioRate(size_t frames, int duration_ms, Callback callback) {
+  const int64_t period_us = frames * rtc::kNumMicrosecsPerSec / kSampleRate;
+  const int64_t start_us = rtc::TimeMicros();
+  int64_t next_us = start_us;
+  while (next_us - start_us < duration_ms * rtc::kNumMicrosecsPerMillisec) {
+    callback();
+    next_us += period_us;
+    const int64_t wait_us = next_us - rtc::TimeMicros();
+    if (wait_us > 0)
+      SleepMs(static_cast<int>(wait_us / rtc::kNumMicrosecsPerMillisec));
+  }
+}
+
+void RunPlayoutDevice(void* obj) {
+  FakeDevice* device = static_cast<FakeDevice*>(obj);
+  std::vector<int16_t> buffer(kPlayoutFrames * kChannels);
+  int16_t expected = 1;
+  RunAtAudioRate(kPlayoutFrames, device->duration_ms, [&] {
+    size_t samples_out = 0;
+    int64_t elapsed_time_ms = 0;
+    int64_t ntp_time_ms = 0;
+    device->transport->NeedMorePlayData(
+        kPlayoutFrames, kChannels * sizeof(int16_t), kChannels, kSampleRate,
+        buffer.data(), samples_out, &elapsed_time_ms, &ntp_time_ms);
+    ++device->played_callbacks;
+    if (buffer[0] == 0) {
+      ++device->silent_callbacks;
+      return;
+    }
+    // Played audio is never dropped, so the ramp only pauses at underruns.
+    for (int16_t sample : buffer) {
+      if (sample != expected)
+        ++device->played_jumps;
+      expected = NextRampValue(sample);
+    }
+  });
+}
+
+void RunRecordDevice(void* obj) {
+  FakeDevice* device = static_cast<FakeDevice*>(obj);
+  std::vector<int16_t> buffer(kRecordFrames * kChannels);
+  int16_t next = 1;
+  RunAtAudioRate(kRecordFrames, device->duration_ms, [&] {
+    for (int16_t& sample : buffer) {
+      sample = next;
+      next = NextRampValue(next);
+    }
+    uint32_t new_mic_level = 0;
+    device->transport->RecordedDataIsAvailable(
+        buffer.data(), kRecordFrames, kChannels * sizeof(int16_t), kChannels,
+        kSampleRate, kDeviceDelayMs, 0, 50, false, new_mic_level);
+    if (new_mic_level == kNewMicLevel)
+      device->got_new_mic_level = true;
+  });
+}
+
+// Keeps a CPU core busy until |*stop| is set.
+void BurnCpu(void* obj) {
+  std::atomic<bool>* stop = static_cast<std::atomic<bool>*>(obj);
+  volatile int dummy = 0;
+  while (!stop->load())
+    dummy = dummy + 1;
+}
+
+}  // namespace
+
+TEST(DecoupledAudioTransportTest, CountsUnderrunsAndOverruns) {
+  // The engine is never called while the transport is stopped.
+  StrictMock<test::MockAudioTransport> engine;
+  DecoupledAudioTransport transport(
+      &engine, AudioParameters(kSampleRate, kChannels, kPlayoutFrames),
+      AudioParameters(kSampleRate, kChannels, kRecordFrames), kBufferMs);
+
+  std::vector<int16_t> buffer(kRecordFrames * kChannels, 1);
+  size_t samples_out = 0;
+  int64_t elapsed_time_ms = 0;
+  int64_t ntp_time_ms = 0;
+  EXPECT_EQ(0, transport.NeedMorePlayData(
+                   kPlayoutFrames, kChannels * sizeof(int16_t), kChannels,
+                   kSampleRate, buffer.data(), samples_out, &elapsed_time_ms,
+                   &ntp_time_ms));
+  EXPECT_EQ(kPlayoutFrames * kChannels, samples_out);
+  EXPECT_EQ(0, buffer[0]);
+  EXPECT_EQ(0, buffer[samples_out - 1]);
+
+  // At least 60ms of audio fit, but not seven 15ms buffers.
+  for (int i = 0; i < 7; ++i) {
+    uint32_t new_mic_level = 1;
+    EXPECT_EQ(0, transport.RecordedDataIsAvailable(
+                     buffer.data(), kRecordFrames, kChannels * sizeof(int16_t),
+                     kChannels, kSampleRate, 0, 0, 0, false, new_mic_level));
+    EXPECT_EQ(0u, new_mic_level);
+  }
+
+  DecoupledAudioTransport::Stats stats = transport.GetStats();
+  EXPECT_EQ(1u, stats.playout_callbacks);
+  EXPECT_EQ(1u, stats.playout_underruns);
+  EXPECT_EQ(7u, stats.record_callbacks);
+  EXPECT_EQ(2u, stats.record_overruns);
+}
+
+TEST(DecoupledAudioTransportTest, KeepsAudioInOrderUnderCpuContention) {
+  const int kNumBurners = 4;
+  FakeEngine engine;
+  DecoupledAudioTransport transport(
+      &engine, AudioParameters(kSampleRate, kChannels, kPlayoutFrames),
+      AudioParameters(kSampleRate, kChannels, kRecordFrames), kBufferMs);
+  FakeDevice device;
+  device.transport = &transport;
+  device.duration_ms = 1000;
+
+  std::atomic<bool> stop_burners(false);
+  std::vector<std::unique_ptr<rtc::PlatformThread>> burners;
+  for (int i = 0; i < kNumBurners; ++i) {
+    burners.emplace_back(
+        new rtc::PlatformThread(&BurnCpu, &stop_burners, "Burner"));
+    burners.back()->Start();
+  }
+  transport.Start();
+  rtc::PlatformThread playout(&RunPlayoutDevice, &device, "Playout",
+                              rtc::kRealtimePriority);
+  rtc::PlatformThread record(&RunRecordDevice, &device, "Record",
+                             rtc::kRealtimePriority);
+  playout.Start();
+  record.Start();
+  playout.Stop();
+  record.Stop();
+  transport.Stop();
+  stop_burners.store(true);
+  for (auto& burner : burners)
+    burner->Stop();
+
+  // Audio may be late, but never corrupted or reordered.
+  const DecoupledAudioTransport::Stats stats = transport.GetStats();
+  EXPECT_EQ(0, device.played_jumps);
+  EXPECT_EQ(static_cast<uint64_t>(device.silent_callbacks),
+            stats.playout_underruns);
+  EXPECT_EQ(static_cast<uint64_t>(device.played_callbacks),
+            stats.playout_callbacks);
+  EXPECT_LT(device.silent_callbacks, device.played_callbacks);
+  EXPECT_LE(static_cast<uint64_t>(engine.recorded_jumps()),
+            stats.record_overruns);
+  EXPECT_GT(stats.record_callbacks, stats.record_overruns);
+  EXPECT_TRUE(device.got_new_mic_level);
+}
+
+}  // namespace webrtc
@@ -13,6 +13,7 @@
 #include <memory.h>
 #include <stdio.h>
 #include <algorithm>
+#include <vector>
 
 #include "modules/audio_device/audio_device_buffer.h"
 #include "rtc_base/checks.h"
@@ -20,72 +21,105 @@
 
 namespace webrtc {
 
+namespace {
+
+// Views a buffer of 16-bit samples, which the audio layers hand over as bytes.
+rtc::ArrayView<int16_t> AsSamples(rtc::ArrayView<int8_t> audio_buffer) {
+  RTC_DCHECK_EQ(0, audio_buffer.size() % sizeof(int16_t));
+  return rtc::ArrayView<int16_t>(
+      reinterpret_cast<int16_t*>(audio_buffer.data()),
+      audio_buffer.size() / sizeof(int16_t));
+}
+
+rtc::ArrayView<const int16_t> AsSamples(
+    rtc::ArrayView<const int8_t> audio_buffer) {
+  RTC_DCHECK_EQ(0, audio_buffer.size() % sizeof(int16_t));
+  return rtc::ArrayView<const int16_t>(
+      reinterpret_cast<const int16_t*>(audio_buffer.data()),
+      audio_buffer.size() / sizeof(int16_t));
+}
+
+// Replaces |fifo| with a larger one holding the same samples, unless it can
+// hold |size| samples already. This only happens if the audio layer uses
+// larger buffers than the capacity given at construction, e.g. on iOS while
+// the screen is locked.
+void EnsureCapacity(size_t size, std::unique_ptr<LockFreeAudioFifo>* fifo) {
+  if ((*fifo)->capacity() >= size)
+    return;
+  LOG(LS_WARNING) << "Growing FineAudioBuffer to " << size << " samples";
+  std::unique_ptr<LockFreeAudioFifo> larger_fifo(new LockFreeAudioFifo(size));
+  std::vector<int16_t> samples((*fifo)->Size());
+  (*fifo)->Read(samples);
+  larger_fifo->Write(samples);
+  *fifo = std::move(larger_fifo);
+}
+
+}  // namespace
+
 FineAudioBuffer::FineAudioBuffer(AudioDeviceBuffer* device_buffer,
                                  int sample_rate,
                                  size_t capacity)
     : device_buffer_(device_buffer),
       sample_rate_(sample_rate),
       samples_per_10_ms_(static_cast<size_t>(sample_rate_ * 10 / 1000)),
-      bytes_per_10_ms_(samples_per_10_ms_ * sizeof(int16_t)),
-      playout_buffer_(0, capacity),
-      record_buffer_(0, capacity) {
+      // Less than 10ms of audio remains between calls, so there is always
+      // room for what one call adds.
+      playout_buffer_(new LockFreeAudioFifo(capacity / sizeof(int16_t) +
+                                            samples_per_10_ms_)),
+      record_buffer_(new LockFreeAudioFifo(capacity / sizeof(int16_t) +
+                                           samples_per_10_ms_)),
+      buffer_10_ms_(new int16_t[samples_per_10_ms_]) {
   LOG(INFO) << "samples_per_10_ms_:" << samples_per_10_ms_;
 }
 
 FineAudioBuffer::~FineAudioBuffer() {}
 
 void FineAudioBuffer::ResetPlayout() {
-  playout_buffer_.Clear();
+  playout_buffer_->Clear();
 }
 
 void FineAudioBuffer::ResetRecord() {
-  record_buffer_.Clear();
+  record_buffer_->Clear();
 }
 
 void FineAudioBuffer::GetPlayoutData(rtc::ArrayView<int8_t> audio_buffer) {
+  const rtc::ArrayView<int16_t> samples = AsSamples(audio_buffer);
+  EnsureCapacity(samples.size() + samples_per_10_ms_, &playout_buffer_);
+  const rtc::ArrayView<const int16_t> buffer_10_ms(buffer_10_ms_.get(),
+                                                   samples_per_10_ms_);
   // Ask WebRTC for new data in chunks of 10ms until we have enough to
   // fulfill the request. It is possible that the buffer already contains
   // enough samples from the last round.
-  const size_t num_bytes = audio_buffer.size();
-  while (playout_buffer_.size() < num_bytes) {
+  while (playout_buffer_->Size() < samples.size()) {
     // Get 10ms decoded audio from WebRTC.
     device_buffer_->RequestPlayoutData(samples_per_10_ms_);
-    // Append |bytes_per_10_ms_| elements to the end of the buffer.
-    const size_t bytes_written = playout_buffer_.AppendData(
-        bytes_per_10_ms_, [&](rtc::ArrayView<int8_t> buf) {
-          const size_t samples_per_channel =
-              device_buffer_->GetPlayoutData(buf.data());
-          // TODO(henrika): this class is only used on mobile devices and is
-          // currently limited to mono. Modifications are needed for stereo.
-          return sizeof(int16_t) * samples_per_channel;
-        });
-    RTC_DCHECK_EQ(bytes_per_10_ms_, bytes_written);
+    // TODO(henrika): this class is only used on mobile devices and is
+    // currently limited to mono. Modifications are needed for stereo.
+    const size_t samples_per_channel =
+        device_buffer_->GetPlayoutData(buffer_10_ms_.get());
+    RTC_DCHECK_EQ(samples_per_10_ms_, samples_per_channel);
+    playout_buffer_->Write(buffer_10_ms);
   }
-  // Provide the requested number of bytes to the consumer.
-  memcpy(audio_buffer.data(), playout_buffer_.data(), num_bytes);
-  // Move remaining samples to start of buffer to prepare for next round.
-  memmove(playout_buffer_.data(), playout_buffer_.data() + num_bytes,
-          playout_buffer_.size() - num_bytes);
-  playout_buffer_.SetSize(playout_buffer_.size() - num_bytes);
+  // Provide the requested number of samples to the consumer.
+  playout_buffer_->Read(samples);
 }
 
 void FineAudioBuffer::DeliverRecordedData(
     rtc::ArrayView<const int8_t> audio_buffer,
     int playout_delay_ms,
     int record_delay_ms) {
+  const rtc::ArrayView<const int16_t> samples = AsSamples(audio_buffer);
   // Always append new data and grow the buffer if needed.
-  record_buffer_.AppendData(audio_buffer.data(), audio_buffer.size());
+  EnsureCapacity(record_buffer_->Size() + samples.size(), &record_buffer_);
+  record_buffer_->Write(samples);
   // Consume samples from buffer in chunks of 10ms until there is not
-  // enough data left. The number of remaining bytes in the cache is given by
-  // the new size of the buffer.
-  while (record_buffer_.size() >= bytes_per_10_ms_) {
-    device_buffer_->SetRecordedBuffer(record_buffer_.data(),
-                                      samples_per_10_ms_);
+  // enough data left.
+  const rtc::ArrayView<int16_t> buffer_10_ms(buffer_10_ms_.get(),
+                                             samples_per_10_ms_);
+  while (record_buffer_->Read(buffer_10_ms)) {
+    device_buffer_->SetRecordedBuffer(buffer_10_ms_.get(), samples_per_10_ms_);
     device_buffer_->SetVQEData(playout_delay_ms, record_delay_ms, 0);
     device_buffer_->DeliverRecordedData();
-    memmove(record_buffer_.data(), record_buffer_.data() + bytes_per_10_ms_,
-            record_buffer_.size() - bytes_per_10_ms_);
-    record_buffer_.SetSize(record_buffer_.size() - bytes_per_10_ms_);
   }
 }
 
@@ -14,7 +14,7 @@
 #include <memory>
 
 #include "api/array_view.h"
-#include "rtc_base/buffer.h"
+#include "modules/audio_device/lock_free_audio_fifo.h"
 #include "typedefs.h"  // NOLINT(build/include)
 
 namespace webrtc {
@@ -35,8 +35,10 @@ class FineAudioBuffer {
   // |device_buffer| is a buffer that provides 10ms of audio data.
   // |sample_rate| is the sample rate of the audio data. This is needed because
   // |device_buffer| delivers 10ms of data. Given the sample rate the number
-  // of samples can be calculated. The |capacity| ensures that the buffer size
-  // can be increased to at least capacity without further reallocation.
+  // of samples can be calculated. |capacity| is the largest buffer size in
+  // bytes that is expected to be requested or delivered. Memory for that is
+  // allocated here, so that the audio callbacks only allocate if a larger
+  // buffer comes along.
   FineAudioBuffer(AudioDeviceBuffer* device_buffer,
                   int sample_rate,
                   size_t capacity);
@@ -76,14 +78,14 @@ class FineAudioBuffer {
   const int sample_rate_;
   // Number of audio samples per 10ms.
   const size_t samples_per_10_ms_;
-  // Number of audio bytes per 10ms.
-  const size_t bytes_per_10_ms_;
   // Storage for output samples from which a consumer can read audio buffers
   // in any size using GetPlayoutData().
-  rtc::BufferT<int8_t> playout_buffer_;
+  std::unique_ptr<LockFreeAudioFifo> playout_buffer_;
   // Storage for input samples that are about to be delivered to the WebRTC
   // ADB or remains from the last successful delivery of a 10ms audio buffer.
-  rtc::BufferT<int8_t> record_buffer_;
+  std::unique_ptr<LockFreeAudioFifo> record_buffer_;
+  // Holds 10ms of audio on its way between the ADB and the buffers above.
+  std::unique_ptr<int16_t[]> buffer_10_ms_;
 };
 
 }  // namespace webrtc
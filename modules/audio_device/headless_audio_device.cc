@@ -0,0 +1,314 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_device/headless_audio_device.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kTickIntervalMs = 10;
+const int kMaxLagMs = 100;
+
+}  // namespace
+
+// A thread of the clock and the devices that it processes.
+class HeadlessAudioClock::Worker {
+ public:
+  explicit Worker(Clock* clock)
+      : clock_(clock),
+        first_tick_ms_(clock_->TimeInMilliseconds() + kTickIntervalMs),
+        stop_event_(false, false),
+        skipped_ticks_(0),
+        thread_(&Worker::Run, this, "HeadlessAudioClock",
+                rtc::kHighPriority) {
+    thread_.Start();
+  }
+
+  ~Worker() {
+    stop_event_.Set();
+    thread_.Stop();
+    RTC_DCHECK(devices_.empty());
+  }
+
+  void AddDevice(HeadlessAudioDevice* device) {
+    rtc::CritScope cs(&lock_);
+    devices_.push_back(device);
+  }
+
+  bool RemoveDevice(HeadlessAudioDevice* device) {
+    rtc::CritScope cs(&lock_);
+    auto it = std::find(devices_.begin(), devices_.end(), device);
+    if (it == devices_.end())
+      return false;
+    devices_.erase(it);
+    return true;
+  }
+
+  size_t num_devices() const {
+    rtc::CritScope cs(&lock_);
+    return devices_.size();
+  }
+
+  int64_t skipped_ticks() const {
+    return skipped_ticks_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static void Run(void* obj) { static_cast<Worker*>(obj)->Loop(); }
+
+  void Loop() {
+    int64_t next_tick_ms = first_tick_ms_;
+    // The wait is never longer than a tick, in case |clock_| is simulated
+    // and runs ahead of real time.
+    while (!stop_event_.Wait(static_cast<int>(std::min<int64_t>(
+        kTickIntervalMs,
+        std::max<int64_t>(0, next_tick_ms - clock_->TimeInMilliseconds()))))) {
+      if (clock_->TimeInMilliseconds() < next_tick_ms)
+        continue;
+      {
+        rtc::CritScope cs(&lock_);
+        for (HeadlessAudioDevice* device : devices_)
+          device->Process();
+      }
+      next_tick_ms += kTickIntervalMs;
+      const int64_t lag_ms = clock_->TimeInMilliseconds() - next_tick_ms;
+      if (lag_ms > kMaxLagMs) {
+        const int64_t skipped = lag_ms / kTickIntervalMs;
+        skipped_ticks_.fetch_add(skipped, std::memory_order_relaxed);
+        next_tick_ms += skipped * kTickIntervalMs;
+      }
+    }
+  }
+
+  Clock* const clock_;
+  // Set before the thread starts, so that the ticks do not depend on when it
+  // gets to run.
+  const int64_t first_tick_ms_;
+  rtc::CriticalSection lock_;
+  std::vector<HeadlessAudioDevice*> devices_ RTC_GUARDED_BY(lock_);
+  rtc::Event stop_event_;
+  std::atomic<int64_t> skipped_ticks_;
+  rtc::PlatformThread thread_;
+};
+
+HeadlessAudioClock::HeadlessAudioClock(size_t num_threads)
+    : HeadlessAudioClock(num_threads, Clock::GetRealTimeClock()) {}
+
+HeadlessAudioClock::HeadlessAudioClock(size_t num_threads, Clock* clock) {
+  RTC_DCHECK_GT(num_threads, 0);
+  RTC_DCHECK(clock);
+  for (size_t i = 0; i < num_threads; ++i)
+    workers_.emplace_back(new Worker(clock));
+}
+
+HeadlessAudioClock::~HeadlessAudioClock() = default;
+
+void HeadlessAudioClock::AddDevice(HeadlessAudioDevice* device) {
+  // Give the device to the thread with the fewest devices.
+  Worker* least_loaded = workers_[0].get();
+  for (const auto& worker : workers_) {
+    if (worker->num_devices() < least_loaded->num_devices())
+      least_loaded = worker.get();
+  }
+  least_loaded->AddDevice(device);
+}
+
+void HeadlessAudioClock::RemoveDevice(HeadlessAudioDevice* device) {
+  for (const auto& worker : workers_) {
+    if (worker->RemoveDevice(device))
+      return;
+  }
+  RTC_NOTREACHED();
+}
+
+int64_t HeadlessAudioClock::skipped_ticks() const {
+  int64_t skipped_ticks = 0;
+  for (const auto& worker : workers_)
+    skipped_ticks += worker->skipped_ticks();
+  return skipped_ticks;
+}
+
+HeadlessAudioDevice::HeadlessAudioDevice(HeadlessAudioClock* clock,
+                                         int sample_rate_hz,
+                                         size_t num_channels,
+                                         int buffer_ms)
+    : clock_(clock),
+      sample_rate_hz_(sample_rate_hz),
+      num_channels_(num_channels),
+      frames_per_10_ms_(rtc::CheckedDivExact(sample_rate_hz, 100)),
+      samples_per_10_ms_(frames_per_10_ms_ * num_channels),
+      capture_fifo_(buffer_ms * samples_per_10_ms_ / 10),
+      playout_fifo_(buffer_ms * samples_per_10_ms_ / 10),
+      audio_callback_(nullptr),
+      playing_(false),
+      recording_(false),
+      mic_level_(0),
+      buffer_(samples_per_10_ms_) {
+  RTC_DCHECK(num_channels_ == 1 || num_channels_ == 2);
+  RTC_DCHECK_GE(buffer_ms, kTickIntervalMs);
+  if (clock_)
+    clock_->AddDevice(this);
+}
+
+HeadlessAudioDevice::~HeadlessAudioDevice() {
+  if (clock_)
+    clock_->RemoveDevice(this);
+}
+
+bool HeadlessAudioDevice::PushCaptureAudio(
+    rtc::ArrayView<const int16_t> samples) {
+  RTC_DCHECK_EQ(0, samples.size() % num_channels_);
+  return capture_fifo_.Write(samples);
+}
+
+bool HeadlessAudioDevice::PullPlayoutAudio(rtc::ArrayView<int16_t> samples) {
+  RTC_DCHECK_EQ(0, samples.size() % num_channels_);
+  return playout_fifo_.Read(samples);
+}
+
+void HeadlessAudioDevice::Process() {
+  rtc::CritScope cs(&lock_);
+  if (!audio_callback_)
+    return;
+  if (recording_) {
+    if (!capture_fifo_.Read(buffer_)) {
+      std::fill(buffer_.begin(), buffer_.end(), 0);
+      ++stats_.capture_underruns;
+    }
+    ++stats_.captured_blocks;
+    uint32_t new_mic_level = 0;
+    const uint32_t total_delay_ms =
+        BufferedMs(capture_fifo_) + BufferedMs(playout_fifo_);
+    if (audio_callback_->RecordedDataIsAvailable(
+            buffer_.data(), frames_per_10_ms_, num_channels_ * sizeof(int16_t),
+            num_channels_, sample_rate_hz_, total_delay_ms, 0, mic_level_,
+            false, new_mic_level) == 0 &&
+        new_mic_level != 0) {
+      mic_level_ = new_mic_level;
+    }
+  }
+  if (playing_) {
+    size_t samples_out = 0;
+    int64_t elapsed_time_ms = -1;
+    int64_t ntp_time_ms = -1;
+    if (audio_callback_->NeedMorePlayData(
+            frames_per_10_ms_, num_channels_ * sizeof(int16_t), num_channels_,
+            sample_rate_hz_, buffer_.data(), samples_out, &elapsed_time_ms,
+            &ntp_time_ms) != 0) {
+      std::fill(buffer_.begin(), buffer_.end(), 0);
+    }
+    ++stats_.played_blocks;
+    if (!playout_fifo_.Write(buffer_))
+      ++stats_.playout_overruns;
+  }
+}
+
+HeadlessAudioDevice::Stats HeadlessAudioDevice::GetStats() const {
+  rtc::CritScope cs(&lock_);
+  return stats_;
+}
+
+int32_t HeadlessAudioDevice::RegisterAudioCallback(
+    AudioTransport* audio_callback) {
+  rtc::CritScope cs(&lock_);
+  audio_callback_ = audio_callback;
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::StartPlayout() {
+  rtc::CritScope cs(&lock_);
+  playing_ = true;
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::StopPlayout() {
+  rtc::CritScope cs(&lock_);
+  playing_ = false;
+  return 0;
+}
+
+bool HeadlessAudioDevice::Playing() const {
+  rtc::CritScope cs(&lock_);
+  return playing_;
+}
+
+int32_t HeadlessAudioDevice::StartRecording() {
+  rtc::CritScope cs(&lock_);
+  recording_ = true;
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::StopRecording() {
+  rtc::CritScope cs(&lock_);
+  recording_ = false;
+  return 0;
+}
+
+bool HeadlessAudioDevice::Recording() const {
+  rtc::CritScope cs(&lock_);
+  return recording_;
+}
+
+int32_t HeadlessAudioDevice::StereoPlayoutIsAvailable(bool* available) const {
+  *available = num_channels_ == 2;
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::StereoPlayout(bool* enabled) const {
+  *enabled = num_channels_ == 2;
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::StereoRecordingIsAvailable(
+    bool* available) const {
+  *available = num_channels_ == 2;
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::StereoRecording(bool* enabled) const {
+  *enabled = num_channels_ == 2;
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::PlayoutDelay(uint16_t* delay_ms) const {
+  *delay_ms = BufferedMs(playout_fifo_);
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::RecordingDelay(uint16_t* delay_ms) const {
+  *delay_ms = BufferedMs(capture_fifo_);
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::RecordingSampleRate(
+    uint32_t* samples_per_sec) const {
+  *samples_per_sec = sample_rate_hz_;
+  return 0;
+}
+
+int32_t HeadlessAudioDevice::PlayoutSampleRate(
+    uint32_t* samples_per_sec) const {
+  *samples_per_sec = sample_rate_hz_;
+  return 0;
+}
+
+uint16_t HeadlessAudioDevice::BufferedMs(const LockFreeAudioFifo& fifo) const {
+  return static_cast<uint16_t>(10 * fifo.Size() / samples_per_10_ms_);
+}
+
+}  // namespace webrtc
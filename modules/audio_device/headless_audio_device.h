@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_DEVICE_HEADLESS_AUDIO_DEVICE_H_
+#define MODULES_AUDIO_DEVICE_HEADLESS_AUDIO_DEVICE_H_
+
+#include <memory>
+#include <vector>
+
+#include "api/array_view.h"
+#include "modules/audio_device/include/fake_audio_device.h"
+#include "modules/audio_device/lock_free_audio_fifo.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/thread_annotations.h"
+#include "system_wrappers/include/clock.h"
+#include "typedefs.h"  // NOLINT(build/include)
+
+namespace webrtc {
+
+class HeadlessAudioDevice;
+
+// Drives any number of HeadlessAudioDevices from a few threads. Every 10ms
+// each thread calls HeadlessAudioDevice::Process() on the devices assigned to
+// it, one after the other. The ticks are scheduled at fixed times from when
+// the clock was created, so that delays in one tick do not add up over time. A
+// thread which falls more than 100ms behind skips the ticks it missed.
+class HeadlessAudioClock {
+ public:
+  // Starts |num_threads| threads, which each get a share of the devices.
+  explicit HeadlessAudioClock(size_t num_threads);
+  // Same as above, but the ticks are scheduled by |clock|, which must outlive
+  // this object. With a SimulatedClock the threads tick as the time is
+  // advanced, within 10ms of real time.
+  HeadlessAudioClock(size_t num_threads, Clock* clock);
+  // Stops the threads. All devices must have been destroyed.
+  ~HeadlessAudioClock();
+
+  // Called by HeadlessAudioDevice. When RemoveDevice() returns, |device| is
+  // not being processed and will not be processed again.
+  void AddDevice(HeadlessAudioDevice* device);
+  void RemoveDevice(HeadlessAudioDevice* device);
+
+  // Returns the number of ticks that were skipped since a thread fell too far
+  // behind.
+  int64_t skipped_ticks() const;
+
+ private:
+  class Worker;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(HeadlessAudioClock);
+};
+
+// An audio device module without any audio devices, for servers which run
+// many audio engines in one process. Instead of recording from a microphone
+// it reads 10ms of audio from a FIFO at each call to Process(), which the
+// embedder fills using PushCaptureAudio(). Likewise, the audio which the
+// engine wants to play out is written to a FIFO that the embedder drains
+// using PullPlayoutAudio(). Process() is called by a HeadlessAudioClock, or
+// by the embedder if it has a clock of its own.
+//
+// The FIFOs are lock-free, so the embedder can push and pull audio from a
+// thread of its own without waiting for the engine. Audio is interleaved if
+// there is more than one channel. If too little captured audio has been
+// pushed, the engine gets silence. If the embedder does not pull the played
+// audio fast enough, the newest audio is dropped. Both are counted in
+// GetStats().
+//
+// Like FakeAudioDeviceModule, this object is not reference counted, and the
+// embedder must keep it alive for as long as the audio engine uses it.
+class HeadlessAudioDevice : public FakeAudioDeviceModule {
+ public:
+  struct Stats {
+    // Number of 10ms blocks which were recorded and played out.
+    uint64_t captured_blocks = 0;
+    uint64_t played_blocks = 0;
+    // Number of recorded blocks which were silence since PushCaptureAudio()
+    // had not provided enough audio.
+    uint64_t capture_underruns = 0;
+    // Number of played blocks which were dropped since PullPlayoutAudio()
+    // had not made room for them.
+    uint64_t playout_overruns = 0;
+  };
+
+  // |clock| may be null, in which case Process() must be called every 10ms
+  // by the embedder. Each FIFO holds up to |buffer_ms| of audio.
+  HeadlessAudioDevice(HeadlessAudioClock* clock,
+                      int sample_rate_hz,
+                      size_t num_channels,
+                      int buffer_ms);
+  ~HeadlessAudioDevice() override;
+
+  // Appends captured audio, which must be a whole number of frames. Returns
+  // false, and drops all of |samples|, if there is no room for them. Must
+  // only be called on one thread at a time.
+  bool PushCaptureAudio(rtc::ArrayView<const int16_t> samples);
+
+  // Reads played audio into all of |samples|, which must be a whole number
+  // of frames. Returns false, and reads nothing, if less audio is available.
+  // Must only be called on one thread at a time.
+  bool PullPlayoutAudio(rtc::ArrayView<int16_t> samples);
+
+  // Records and plays out 10ms of audio.
+  void Process();
+
+  Stats GetStats() const;
+
+  // AudioDeviceModule implementation.
+  int32_t RegisterAudioCallback(AudioTransport* audio_callback) override;
+  int32_t StartPlayout() override;
+  int32_t StopPlayout() override;
+  bool Playing() const override;
+  int32_t StartRecording() override;
+  int32_t StopRecording() override;
+  bool Recording() const override;
+  int32_t StereoPlayoutIsAvailable(bool* available) const override;
+  int32_t StereoPlayout(bool* enabled) const override;
+  int32_t StereoRecordingIsAvailable(bool* available) const override;
+  int32_t StereoRecording(bool* enabled) const override;
+  int32_t PlayoutDelay(uint16_t* delay_ms) const override;
+  int32_t RecordingDelay(uint16_t* delay_ms) const override;
+  int32_t RecordingSampleRate(uint32_t* samples_per_sec) const override;
+  int32_t PlayoutSampleRate(uint32_t* samples_per_sec) const override;
+
+ private:
+  // Returns the amount of audio in |fifo| in milliseconds.
+  uint16_t BufferedMs(const LockFreeAudioFifo& fifo) const;
+
+  HeadlessAudioClock* const clock_;
+  const int sample_rate_hz_;
+  const size_t num_channels_;
+  // Number of frames and samples, over all channels, in 10ms of audio.
+  const size_t frames_per_10_ms_;
+  const size_t samples_per_10_ms_;
+
+  LockFreeAudioFifo capture_fifo_;
+  LockFreeAudioFifo playout_fifo_;
+
+  rtc::CriticalSection lock_;
+  AudioTransport* audio_callback_ RTC_GUARDED_BY(lock_);
+  bool playing_ RTC_GUARDED_BY(lock_);
+  bool recording_ RTC_GUARDED_BY(lock_);
+  uint32_t mic_level_ RTC_GUARDED_BY(lock_);
+  Stats stats_ RTC_GUARDED_BY(lock_);
+  // 10ms of audio on its way between the FIFOs and |audio_callback_|.
+  std::vector<int16_t> buffer_ RTC_GUARDED_BY(lock_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(HeadlessAudioDevice);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_DEVICE_HEADLESS_AUDIO_DEVICE_H_
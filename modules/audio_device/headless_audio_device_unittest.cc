@@ -0,0 +1,194 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_device/headless_audio_device.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kSampleRate = 16000;
+const size_t kSamplesPer10Ms = kSampleRate / 100;
+
+// Plays out 10ms blocks which are filled with the number of the block, and
+// keeps the first sample of each recorded block.
+class FakeEngine : public AudioTransport {
+ public:
+  int32_t RecordedDataIsAvailable(const void* audioSamples,
+                                  const size_t nSamples,
+                                  const size_t nBytesPerSample,
+                                  const size_t nChannels,
+                                  const uint32_t samplesPerSec,
+                                  const uint32_t totalDelayMS,
+                                  const int32_t clockDrift,
+                                  const uint32_t currentMicLevel,
+                                  const bool keyPressed,
+                                  uint32_t& newMicLevel) override {
+    EXPECT_EQ(kSamplesPer10Ms, nSamples);
+    recorded_.push_back(static_cast<const int16_t*>(audioSamples)[0]);
+    last_total_delay_ms_ = totalDelayMS;
+    ++num_callbacks_;
+    return 0;
+  }
+
+  int32_t NeedMorePlayData(const size_t nSamples,
+                           const size_t nBytesPerSample,
+                           const size_t nChannels,
+                           const uint32_t samplesPerSec,
+                           void* audioSamples,
+                           size_t& nSamplesOut,
+                           int64_t* elapsed_time_ms,
+                           int64_t* ntp_time_ms) override {
+    EXPECT_EQ(kSamplesPer10Ms, nSamples);
+    int16_t* samples = static_cast<int16_t*>(audioSamples);
+    std::fill(samples, samples + nSamples * nChannels, ++num_played_);
+    nSamplesOut = nSamples * nChannels;
+    ++num_callbacks_;
+    return 0;
+  }
+
+  void PushCaptureData(int voe_channel,
+                       const void* audio_data,
+                       int bits_per_sample,
+                       int sample_rate,
+                       size_t number_of_channels,
+                       size_t number_of_frames) override {}
+
+  void PullRenderData(int bits_per_sample,
+                      int sample_rate,
+                      size_t number_of_channels,
+                      size_t number_of_frames,
+                      void* audio_data,
+                      int64_t* elapsed_time_ms,
+                      int64_t* ntp_time_ms) override {}
+
+  const std::vector<int16_t>& recorded() const { return recorded_; }
+  uint32_t last_total_delay_ms() const { return last_total_delay_ms_; }
+  int num_callbacks() const { return num_callbacks_.load(); }
+
+ private:
+  std::vector<int16_t> recorded_;
+  uint32_t last_total_delay_ms_ = 0;
+  int16_t num_played_ = 0;
+  std::atomic<int> num_callbacks_{0};
+};
+
+// Waits for up to a second for all of |engines| to have been called
+// |num_callbacks| times.
+bool WaitForCallbacks(const std::vector<std::unique_ptr<FakeEngine>>& engines,
+                      int num_callbacks) {
+  for (int i = 0; i < 1000; ++i) {
+    if (std::all_of(engines.begin(), engines.end(),
+                    [num_callbacks](const std::unique_ptr<FakeEngine>& engine) {
+                      return engine->num_callbacks() >= num_callbacks;
+                    })) {
+      return true;
+    }
+    SleepMs(1);
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(HeadlessAudioDeviceTest, PassesAudioThroughFifos) {
+  FakeEngine engine;
+  HeadlessAudioDevice device(nullptr, kSampleRate, 1, 30);
+  device.RegisterAudioCallback(&engine);
+  EXPECT_EQ(0, device.StartRecording());
+  EXPECT_EQ(0, device.StartPlayout());
+  EXPECT_TRUE(device.Recording());
+  EXPECT_TRUE(device.Playing());
+
+  // 20ms of captured audio, in two blocks of 1 and 2.
+  std::vector<int16_t> captured(kSamplesPer10Ms, 1);
+  EXPECT_TRUE(device.PushCaptureAudio(captured));
+  std::fill(captured.begin(), captured.end(), 2);
+  EXPECT_TRUE(device.PushCaptureAudio(captured));
+  for (int i = 0; i < 3; ++i)
+    device.Process();
+  // The third block had no captured audio.
+  EXPECT_EQ(std::vector<int16_t>({1, 2, 0}), engine.recorded());
+
+  // The FIFO holds at least 30ms, so the fourth block is dropped.
+  uint16_t delay_ms = 0;
+  EXPECT_EQ(0, device.PlayoutDelay(&delay_ms));
+  EXPECT_EQ(30, delay_ms);
+  device.Process();
+  std::vector<int16_t> played(2 * kSamplesPer10Ms);
+  EXPECT_TRUE(device.PullPlayoutAudio(played));
+  EXPECT_EQ(1, played[0]);
+  EXPECT_EQ(2, played.back());
+  EXPECT_FALSE(device.PullPlayoutAudio(played));
+
+  HeadlessAudioDevice::Stats stats = device.GetStats();
+  EXPECT_EQ(4u, stats.captured_blocks);
+  EXPECT_EQ(4u, stats.played_blocks);
+  EXPECT_EQ(2u, stats.capture_underruns);
+  EXPECT_EQ(1u, stats.playout_overruns);
+
+  // Stopped devices do not call the engine.
+  device.StopRecording();
+  device.StopPlayout();
+  const int num_callbacks = engine.num_callbacks();
+  device.Process();
+  EXPECT_EQ(num_callbacks, engine.num_callbacks());
+}
+
+TEST(HeadlessAudioDeviceTest, ClockTicksManyDevicesEvery10Ms) {
+  const int kNumDevices = 100;
+  const int kNumThreads = 2;
+  SimulatedClock simulated_clock(1000000);
+  HeadlessAudioClock clock(kNumThreads, &simulated_clock);
+  std::vector<std::unique_ptr<FakeEngine>> engines;
+  std::vector<std::unique_ptr<HeadlessAudioDevice>> devices;
+  for (int i = 0; i < kNumDevices; ++i) {
+    engines.emplace_back(new FakeEngine());
+    devices.emplace_back(
+        new HeadlessAudioDevice(&clock, kSampleRate, 1, 1000));
+    devices.back()->RegisterAudioCallback(engines.back().get());
+    devices.back()->StartPlayout();
+  }
+
+  // Every device is processed once per 10ms of simulated time, and not while
+  // the time stands still.
+  for (int i = 1; i <= 20; ++i) {
+    simulated_clock.AdvanceTimeMilliseconds(10);
+    EXPECT_TRUE(WaitForCallbacks(engines, i));
+  }
+  SleepMs(30);
+  for (const auto& engine : engines)
+    EXPECT_EQ(20, engine->num_callbacks());
+  EXPECT_EQ(0, clock.skipped_ticks());
+
+  // A thread 200ms behind is more than 100ms late after one tick, and skips
+  // to the current time, where it ticks again.
+  simulated_clock.AdvanceTimeMilliseconds(200);
+  EXPECT_TRUE(WaitForCallbacks(engines, 22));
+  SleepMs(30);
+  for (const auto& engine : engines)
+    EXPECT_EQ(22, engine->num_callbacks());
+  EXPECT_EQ(kNumThreads * 18, clock.skipped_ticks());
+
+  for (auto& device : devices)
+    device->StopPlayout();
+  devices.clear();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_device/lock_free_audio_fifo.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t power_of_two = 1;
+  while (power_of_two < value)
+    power_of_two *= 2;
+  return power_of_two;
+}
+
+}  // namespace
+
+LockFreeAudioFifo::LockFreeAudioFifo(size_t capacity)
+    : capacity_(RoundUpToPowerOfTwo(capacity)),
+      buffer_(new int16_t[capacity_]),
+      write_position_(0),
+      read_position_(0) {
+  RTC_DCHECK_GT(capacity, 0);
+}
+
+LockFreeAudioFifo::~LockFreeAudioFifo() = default;
+
+bool LockFreeAudioFifo::Write(rtc::ArrayView<const int16_t> samples) {
+  const size_t write_position =
+      write_position_.load(std::memory_order_relaxed);
+  const size_t read_position = read_position_.load(std::memory_order_acquire);
+  if (capacity_ - (write_position - read_position) < samples.size())
+    return false;
+
+  // Copy in up to two parts, the second one starting at the beginning of the
+  // ring buffer.
+  const size_t index = write_position & (capacity_ - 1);
+  const size_t first_part = std::min(samples.size(), capacity_ - index);
+  memcpy(&buffer_[index], samples.data(), first_part * sizeof(int16_t));
+  memcpy(&buffer_[0], samples.data() + first_part,
+         (samples.size() - first_part) * sizeof(int16_t));
+  write_position_.store(write_position + samples.size(),
+                        std::memory_order_release);
+  return true;
+}
+
+bool LockFreeAudioFifo::Read(rtc::ArrayView<int16_t> samples) {
+  const size_t read_position = read_position_.load(std::memory_order_relaxed);
+  const size_t write_position =
+      write_position_.load(std::memory_order_acquire);
+  if (write_position - read_position < samples.size())
+    return false;
+
+  const size_t index = read_position & (capacity_ - 1);
+  const size_t first_part = std::min(samples.size(), capacity_ - index);
+  memcpy(samples.data(), &buffer_[index], first_part * sizeof(int16_t));
+  memcpy(samples.data() + first_part, &buffer_[0],
+         (samples.size() - first_part) * sizeof(int16_t));
+  read_position_.store(read_position + samples.size(),
+                       std::memory_order_release);
+  return true;
+}
+
+size_t LockFreeAudioFifo::Size() const {
+  // Load the read position first. It can only grow until the write position
+  // is loaded, which keeps the difference within the capacity.
+  const size_t read_position = read_position_.load(std::memory_order_acquire);
+  return write_position_.load(std::memory_order_acquire) - read_position;
+}
+
+size_t LockFreeAudioFifo::FreeSpace() const {
+  const size_t write_position =
+      write_position_.load(std::memory_order_acquire);
+  return capacity_ -
+         (write_position - read_position_.load(std::memory_order_acquire));
+}
+
+void LockFreeAudioFifo::Clear() {
+  write_position_.store(0);
+  read_position_.store(0);
+}
+
+}  // namespace webrtc
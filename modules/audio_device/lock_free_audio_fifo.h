@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_DEVICE_LOCK_FREE_AUDIO_FIFO_H_
+#define MODULES_AUDIO_DEVICE_LOCK_FREE_AUDIO_FIFO_H_
+
+#include <atomic>
+#include <memory>
+
+#include "api/array_view.h"
+#include "rtc_base/constructormagic.h"
+#include "typedefs.h"  // NOLINT(build/include)
+
+namespace webrtc {
+
+// A FIFO of 16-bit audio samples with a fixed capacity, backed by a ring
+// buffer which is allocated at construction. One thread may write to it while
+// another thread reads from it. Neither side ever blocks, takes a lock or
+// allocates memory, which makes the FIFO suitable for passing audio to and
+// from native audio threads.
+class LockFreeAudioFifo {
+ public:
+  // Room is made for at least |capacity| samples.
+  explicit LockFreeAudioFifo(size_t capacity);
+  ~LockFreeAudioFifo();
+
+  // Called on the writing thread. Appends all of |samples| and returns true,
+  // or appends nothing and returns false if there is not room for them all.
+  bool Write(rtc::ArrayView<const int16_t> samples);
+
+  // Called on the reading thread. Fills all of |samples| and returns true, or
+  // reads nothing and returns false if fewer samples are available.
+  bool Read(rtc::ArrayView<int16_t> samples);
+
+  // Returns the number of samples that can be read. This is exact on the
+  // reading thread and a lower bound on any other thread.
+  size_t Size() const;
+
+  // Returns the number of samples that can be written. This is exact on the
+  // writing thread and a lower bound on any other thread.
+  size_t FreeSpace() const;
+
+  size_t capacity() const { return capacity_; }
+
+  // Drops all samples. Must not be called while either side is in use.
+  void Clear();
+
+ private:
+  // The capacity is a power of two, so that the positions below can wrap
+  // around without breaking the index and size calculations.
+  const size_t capacity_;
+  const std::unique_ptr<int16_t[]> buffer_;
+  // Total number of samples written and read. Each is only modified by its
+  // own side, which publishes it to the other side with release semantics.
+  std::atomic<size_t> write_position_;
+  std::atomic<size_t> read_position_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(LockFreeAudioFifo);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_DEVICE_LOCK_FREE_AUDIO_FIFO_H_
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_device/lock_free_audio_fifo.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "rtc_base/platform_thread.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+// Fills |samples| with consecutive values, starting at |*next|.
+void FillRamp(int16_t* next, std::vector<int16_t>* samples) {
+  for (int16_t& sample : *samples)
+    sample = (*next)++;
+}
+
+}  // namespace
+
+TEST(LockFreeAudioFifoTest, RoundsCapacityUpToPowerOfTwo) {
+  EXPECT_EQ(1u, LockFreeAudioFifo(1).capacity());
+  EXPECT_EQ(512u, LockFreeAudioFifo(441).capacity());
+  EXPECT_EQ(1024u, LockFreeAudioFifo(1024).capacity());
+}
+
+TEST(LockFreeAudioFifoTest, ReadsAndWritesAllOrNothing) {
+  LockFreeAudioFifo fifo(8);
+  std::vector<int16_t> in(6);
+  std::vector<int16_t> out(6);
+  int16_t next = 0;
+  FillRamp(&next, &in);
+  EXPECT_TRUE(fifo.Write(in));
+  EXPECT_EQ(6u, fifo.Size());
+  EXPECT_EQ(2u, fifo.FreeSpace());
+  // Neither fits, and nothing changes.
+  EXPECT_FALSE(fifo.Write(in));
+  std::vector<int16_t> too_many(7);
+  EXPECT_FALSE(fifo.Read(too_many));
+  EXPECT_EQ(6u, fifo.Size());
+
+  EXPECT_TRUE(fifo.Read(out));
+  EXPECT_EQ(in, out);
+  EXPECT_EQ(0u, fifo.Size());
+  EXPECT_FALSE(fifo.Read(out));
+}
+
+TEST(LockFreeAudioFifoTest, WrapsAround) {
+  LockFreeAudioFifo fifo(8);
+  std::vector<int16_t> in(5);
+  std::vector<int16_t> out(5);
+  int16_t next = 0;
+  for (int i = 0; i < 10; ++i) {
+    FillRamp(&next, &in);
+    ASSERT_TRUE(fifo.Write(in));
+    ASSERT_TRUE(fifo.Read(out));
+    EXPECT_EQ(in, out);
+  }
+  fifo.Clear();
+  EXPECT_EQ(0u, fifo.Size());
+  EXPECT_EQ(8u, fifo.FreeSpace());
+}
+
+namespace {
+
+const int kNumSamples = 200000;
+
+// Writes a ramp of |kNumSamples| samples to the FIFO in chunks of varying
+// size, retrying whenever the FIFO is full.
+void WriteRamp(void* obj) {
+  LockFreeAudioFifo* fifo = static_cast<LockFreeAudioFifo*>(obj);
+  int16_t next = 0;
+  std::vector<int16_t> chunk;
+  for (int written = 0; written < kNumSamples;) {
+    chunk.resize(std::min(1 + written % 97, kNumSamples - written));
+    FillRamp(&next, &chunk);
+    while (!fifo->Write(chunk))
+      SleepMs(0);
+    written += chunk.size();
+  }
+}
+
+}  // namespace
+
+TEST(LockFreeAudioFifoTest, PassesRampBetweenThreads) {
+  LockFreeAudioFifo fifo(1024);
+  rtc::PlatformThread writer(&WriteRamp, &fifo, "Writer");
+  writer.Start();
+  int16_t expected = 0;
+  std::vector<int16_t> chunk;
+  for (int read = 0; read < kNumSamples;) {
+    chunk.resize(std::min(1 + read % 61, kNumSamples - read));
+    if (!fifo.Read(chunk)) {
+      SleepMs(0);
+      continue;
+    }
+    for (int16_t sample : chunk)
+      ASSERT_EQ(expected++, sample);
+    read += chunk.size();
+  }
+  writer.Stop();
+  EXPECT_EQ(0u, fifo.Size());
+}
+
+}  // namespace webrtc
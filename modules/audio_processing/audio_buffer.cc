@@ -91,6 +91,20 @@ AudioBuffer::AudioBuffer(size_t input_num_frames,
     }
   }
 
+  // Allocate all the intermediate buffers up front, so that processing a
+  // frame never allocates.
+  if ((num_input_channels_ > 1 && num_proc_channels_ == 1) ||
+      input_num_frames_ != proc_num_frames_) {
+    input_buffer_.reset(
+        new IFChannelBuffer(input_num_frames_, num_proc_channels_));
+  }
+  if (num_proc_channels_ > 1) {
+    mixed_low_pass_channels_.reset(
+        new ChannelBuffer<int16_t>(num_split_frames_, 1));
+  }
+  low_pass_reference_channels_.reset(
+      new ChannelBuffer<int16_t>(num_split_frames_, num_proc_channels_));
+
   if (num_bands_ > 1) {
     split_data_.reset(new IFChannelBuffer(proc_num_frames_,
                                           num_proc_channels_,
@@ -108,14 +122,8 @@ void AudioBuffer::CopyFrom(const float* const* data,
   RTC_DCHECK_EQ(stream_config.num_frames(), input_num_frames_);
   RTC_DCHECK_EQ(stream_config.num_channels(), num_input_channels_);
   InitForNewData();
-  // Initialized lazily because there's a different condition in
-  // DeinterleaveFrom.
   const bool need_to_downmix =
       num_input_channels_ > 1 && num_proc_channels_ == 1;
-  if (need_to_downmix && !input_buffer_) {
-    input_buffer_.reset(
-        new IFChannelBuffer(input_num_frames_, num_proc_channels_));
-  }
 
   if (stream_config.has_keyboard()) {
     keyboard_data_ = data[KeyboardChannelIndex(stream_config)];
@@ -314,11 +322,6 @@ const int16_t* AudioBuffer::mixed_low_pass_data() {
   }
 
   if (!mixed_low_pass_valid_) {
-    if (!mixed_low_pass_channels_.get()) {
-      mixed_low_pass_channels_.reset(
-          new ChannelBuffer<int16_t>(num_split_frames_, 1));
-    }
-
     DownmixToMono<int16_t, int32_t>(split_channels_const(kBand0To8kHz),
                                     num_split_frames_, num_channels_,
                                     mixed_low_pass_channels_->channels()[0]);
@@ -381,11 +384,6 @@ void AudioBuffer::DeinterleaveFrom(AudioFrame* frame) {
   RTC_DCHECK_EQ(frame->num_channels_, num_input_channels_);
   RTC_DCHECK_EQ(frame->samples_per_channel_, input_num_frames_);
   InitForNewData();
-  // Initialized lazily because there's a different condition in CopyFrom.
-  if ((input_num_frames_ != proc_num_frames_) && !input_buffer_) {
-    input_buffer_.reset(
-        new IFChannelBuffer(input_num_frames_, num_proc_channels_));
-  }
   activity_ = frame->vad_activity_;
 
   int16_t* const* deinterleaved;
@@ -450,12 +448,6 @@ void AudioBuffer::InterleaveTo(AudioFrame* frame, bool data_changed) const {
 
 void AudioBuffer::CopyLowPassToReference() {
   reference_copied_ = true;
-  if (!low_pass_reference_channels_.get() ||
-      low_pass_reference_channels_->num_channels() != num_channels_) {
-    low_pass_reference_channels_.reset(
-        new ChannelBuffer<int16_t>(num_split_frames_,
-                                   num_proc_channels_));
-  }
   for (size_t i = 0; i < num_proc_channels_; i++) {
     memcpy(low_pass_reference_channels_->channels()[i],
            split_bands_const(i)[kBand0To8kHz],
@@ -19,7 +19,10 @@
 
 #include "common_audio/window_generator.h"
 #include "modules/audio_processing/beamformer/covariance_matrix_generator.h"
+#include "modules/audio_processing/beamformer/planar_kernels.h"
 #include "rtc_base/arraysize.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
 
 namespace webrtc {
 namespace {
@@ -122,19 +125,6 @@ size_t Round(float x) {
   return static_cast<size_t>(std::floor(x + 0.5f));
 }
 
-// Calculates the sum of squares of a complex matrix.
-float SumSquares(const ComplexMatrix<float>& mat) {
-  float sum_squares = 0.f;
-  const complex<float>* const* mat_els = mat.elements();
-  for (size_t i = 0; i < mat.num_rows(); ++i) {
-    for (size_t j = 0; j < mat.num_columns(); ++j) {
-      float abs_value = std::abs(mat_els[i][j]);
-      sum_squares += abs_value * abs_value;
-    }
-  }
-  return sum_squares;
-}
-
 // Does |out| = |in|.' * conj(|in|) for row vector |in|.
 void TransposedConjugatedProduct(const ComplexMatrix<float>& in,
                                  ComplexMatrix<float>* out) {
@@ -171,6 +161,65 @@ const float NonlinearBeamformer::kHalfBeamWidthRadians = DegreesToRadians(20.f);
 // static
 const size_t NonlinearBeamformer::kNumFreqBins;
 
+// Calculates the postfilter masks of a range of frequency bins on its own
+// thread, once per block.
+class NonlinearBeamformer::MaskWorker {
+ public:
+  explicit MaskWorker(NonlinearBeamformer* beamformer)
+      : beamformer_(beamformer),
+        eig_m_(2 * PlanarSize(beamformer->num_input_channels_)),
+        start_event_(false, false),
+        done_event_(false, false),
+        thread_(&MaskWorker::Run,
+                this,
+                "BeamformerMask",
+                rtc::kRealtimePriority) {
+    thread_.Start();
+  }
+
+  ~MaskWorker() {
+    stopping_ = true;
+    start_event_.Set();
+    thread_.Stop();
+  }
+
+  // Starts calculating the masks of the bins in [|first_bin|, |end_bin|).
+  void Start(const complex_f* const* input, size_t first_bin, size_t end_bin) {
+    input_ = input;
+    first_bin_ = first_bin;
+    end_bin_ = end_bin;
+    start_event_.Set();
+  }
+
+  // Waits until the masks requested by Start() have been calculated.
+  void Wait() { done_event_.Wait(rtc::Event::kForever); }
+
+ private:
+  static void Run(void* obj) {
+    MaskWorker* worker = static_cast<MaskWorker*>(obj);
+    while (true) {
+      worker->start_event_.Wait(rtc::Event::kForever);
+      // The events order the accesses to the members below.
+      if (worker->stopping_)
+        return;
+      worker->beamformer_->CalculatePostfilterMasks(
+          worker->input_, worker->first_bin_, worker->end_bin_,
+          worker->eig_m_.data());
+      worker->done_event_.Set();
+    }
+  }
+
+  NonlinearBeamformer* const beamformer_;
+  std::vector<float> eig_m_;
+  const complex_f* const* input_ = nullptr;
+  size_t first_bin_ = 0;
+  size_t end_bin_ = 0;
+  bool stopping_ = false;
+  rtc::Event start_event_;
+  rtc::Event done_event_;
+  rtc::PlatformThread thread_;
+};
+
 PostFilterTransform::PostFilterTransform(size_t num_channels,
                                          size_t chunk_length,
                                          float* window,
@@ -208,7 +257,8 @@ void PostFilterTransform::ProcessAudioBlock(const complex<float>* const* input,
 NonlinearBeamformer::NonlinearBeamformer(
     const std::vector<Point>& array_geometry,
     size_t num_postfilter_channels,
-    SphericalPointf target_direction)
+    SphericalPointf target_direction,
+    size_t num_worker_threads)
     : num_input_channels_(array_geometry.size()),
       num_postfilter_channels_(num_postfilter_channels),
       array_geometry_(GetCenteredArray(array_geometry)),
@@ -218,8 +268,12 @@ NonlinearBeamformer::NonlinearBeamformer(
       away_radians_(std::min(
           static_cast<float>(M_PI),
           std::max(kMinAwayRadians,
-                   kAwaySlope * static_cast<float>(M_PI) / min_mic_spacing_))) {
+                   kAwaySlope * static_cast<float>(M_PI) / min_mic_spacing_))),
+      eig_m_(2 * PlanarSize(num_input_channels_)) {
   WindowGenerator::KaiserBesselDerived(kKbdAlpha, kFftSize, window_);
+  for (size_t i = 0; i < num_worker_threads; ++i) {
+    mask_workers_.emplace_back(new MaskWorker(this));
+  }
 }
 
 NonlinearBeamformer::~NonlinearBeamformer() = default;
@@ -394,6 +448,27 @@ void NonlinearBeamformer::NormalizeCovMats() {
   }
 }
 
+void NonlinearBeamformer::InitSteeringData() {
+  const size_t vector_size = 2 * PlanarSize(num_input_channels_);
+  const size_t matrix_size = num_input_channels_ * vector_size;
+  steering_data_stride_ =
+      vector_size + (1 + interf_angles_radians_.size()) * matrix_size;
+  steering_data_.resize(kNumFreqBins * steering_data_stride_);
+  for (size_t i = 0; i < kNumFreqBins; ++i) {
+    float* data = &steering_data_[i * steering_data_stride_];
+    ToPlanar(delay_sum_masks_[i].elements(), 1, num_input_channels_, data);
+    data += vector_size;
+    ToPlanar(target_cov_mats_[i].elements(), num_input_channels_,
+             num_input_channels_, data);
+    data += matrix_size;
+    for (size_t j = 0; j < interf_angles_radians_.size(); ++j) {
+      ToPlanar(interf_cov_mats_[i][j]->elements(), num_input_channels_,
+               num_input_channels_, data);
+      data += matrix_size;
+    }
+  }
+}
+
 void NonlinearBeamformer::AnalyzeChunk(const ChannelBuffer<float>& data) {
   RTC_DCHECK_EQ(data.num_channels(), num_input_channels_);
   RTC_DCHECK_EQ(data.num_frames_per_band(), chunk_length_);
@@ -433,6 +508,7 @@ void NonlinearBeamformer::AimAt(const SphericalPointf& target_direction) {
   InitTargetCovMats();
   InitInterfCovMats();
   NormalizeCovMats();
+  InitSteeringData();
 }
 
 bool NonlinearBeamformer::IsInBeam(const SphericalPointf& spherical_point) {
@@ -453,54 +529,83 @@ void NonlinearBeamformer::ProcessAudioBlock(const complex_f* const* input,
   RTC_CHECK_EQ(num_input_channels_, num_input_channels);
   RTC_CHECK_EQ(0, num_output_channels);
 
-  // Calculating the post-filter masks. Note that we need two for each
-  // frequency bin to account for the positive and negative interferer
-  // angle.
-  for (size_t i = low_mean_start_bin_; i <= high_mean_end_bin_; ++i) {
-    eig_m_.CopyFromColumn(input, i, num_input_channels_);
-    float eig_m_norm_factor = std::sqrt(SumSquares(eig_m_));
+  // Calculating the post-filter masks, splitting the bins between the
+  // workers and this thread.
+  const size_t num_bins = high_mean_end_bin_ + 1 - low_mean_start_bin_;
+  const size_t num_parts = mask_workers_.size() + 1;
+  size_t first_bin = low_mean_start_bin_;
+  for (size_t i = 0; i < mask_workers_.size(); ++i) {
+    const size_t end_bin = low_mean_start_bin_ + (i + 1) * num_bins / num_parts;
+    mask_workers_[i]->Start(input, first_bin, end_bin);
+    first_bin = end_bin;
+  }
+  CalculatePostfilterMasks(input, first_bin, high_mean_end_bin_ + 1,
+                           eig_m_.data());
+  for (const auto& worker : mask_workers_) {
+    worker->Wait();
+  }
+
+  ApplyMaskTimeSmoothing();
+  EstimateTargetPresence();
+  ApplyLowFrequencyCorrection();
+  ApplyHighFrequencyCorrection();
+  ApplyMaskFrequencySmoothing();
+}
+
+void NonlinearBeamformer::CalculatePostfilterMasks(
+    const complex_f* const* input,
+    size_t first_bin,
+    size_t end_bin,
+    float* eig_m) {
+  const size_t vector_size = 2 * PlanarSize(num_input_channels_);
+  const size_t matrix_size = num_input_channels_ * vector_size;
+  // Note that we need two masks for each frequency bin to account for the
+  // positive and negative interferer angle.
+  for (size_t i = first_bin; i < end_bin; ++i) {
+    const float* delay_sum_mask = &steering_data_[i * steering_data_stride_];
+    const float* target_cov_mat = delay_sum_mask + vector_size;
+    const float* interf_cov_mats = target_cov_mat + matrix_size;
+
+    ColumnToPlanar(input, i, num_input_channels_, eig_m);
+    float eig_m_norm_factor =
+        std::sqrt(PlanarSumSquares(eig_m, num_input_channels_));
     if (eig_m_norm_factor != 0.f) {
-      eig_m_.Scale(1.f / eig_m_norm_factor);
+      PlanarScale(1.f / eig_m_norm_factor, num_input_channels_, eig_m);
     }
 
-    float rxim = Norm(target_cov_mats_[i], eig_m_);
+    float rxim = std::max(
+        PlanarQuadraticForm(target_cov_mat, eig_m, num_input_channels_), 0.f);
     float ratio_rxiw_rxim = 0.f;
     if (rxim > 0.f) {
       ratio_rxiw_rxim = rxiws_[i] / rxim;
     }
 
-    complex_f rmw = abs(ConjugateDotProduct(delay_sum_masks_[i], eig_m_));
+    complex_f rmw = abs(
+        PlanarConjugateDotProduct(delay_sum_mask, eig_m, num_input_channels_));
     rmw *= rmw;
     float rmw_r = rmw.real();
 
-    new_mask_[i] = CalculatePostfilterMask(*interf_cov_mats_[i][0],
-                                           rpsiws_[i][0],
-                                           ratio_rxiw_rxim,
+    new_mask_[i] = CalculatePostfilterMask(interf_cov_mats, eig_m,
+                                           rpsiws_[i][0], ratio_rxiw_rxim,
                                            rmw_r);
     for (size_t j = 1; j < interf_angles_radians_.size(); ++j) {
-      float tmp_mask = CalculatePostfilterMask(*interf_cov_mats_[i][j],
-                                               rpsiws_[i][j],
-                                               ratio_rxiw_rxim,
-                                               rmw_r);
+      float tmp_mask = CalculatePostfilterMask(
+          interf_cov_mats + j * matrix_size, eig_m, rpsiws_[i][j],
+          ratio_rxiw_rxim, rmw_r);
       if (tmp_mask < new_mask_[i]) {
         new_mask_[i] = tmp_mask;
       }
     }
   }
-
-  ApplyMaskTimeSmoothing();
-  EstimateTargetPresence();
-  ApplyLowFrequencyCorrection();
-  ApplyHighFrequencyCorrection();
-  ApplyMaskFrequencySmoothing();
 }
 
-float NonlinearBeamformer::CalculatePostfilterMask(
-    const ComplexMatrixF& interf_cov_mat,
-    float rpsiw,
-    float ratio_rxiw_rxim,
-    float rmw_r) {
-  float rpsim = Norm(interf_cov_mat, eig_m_);
+float NonlinearBeamformer::CalculatePostfilterMask(const float* interf_cov_mat,
+                                                   const float* eig_m,
+                                                   float rpsiw,
+                                                   float ratio_rxiw_rxim,
+                                                   float rmw_r) {
+  float rpsim = std::max(
+      PlanarQuadraticForm(interf_cov_mat, eig_m, num_input_channels_), 0.f);
 
   float ratio = 0.f;
   if (rpsim > 0.f) {
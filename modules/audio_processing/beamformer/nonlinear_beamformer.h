@@ -58,11 +58,16 @@ class NonlinearBeamformer : public LappedTransform::Callback {
  public:
   static const float kHalfBeamWidthRadians;
 
+  // The postfilter masks of each block are calculated by the processing thread
+  // and |num_worker_threads| additional threads, each taking an equal share of
+  // the frequency bins. This only pays off for large arrays, where the
+  // per-bin products dominate the processing time.
   explicit NonlinearBeamformer(
       const std::vector<Point>& array_geometry,
       size_t num_postfilter_channels = 1u,
       SphericalPointf target_direction =
-          SphericalPointf(static_cast<float>(M_PI) / 2.f, 0.f, 1.f));
+          SphericalPointf(static_cast<float>(M_PI) / 2.f, 0.f, 1.f),
+      size_t num_worker_threads = 0u);
   ~NonlinearBeamformer() override;
 
   // Sample rate corresponds to the lower band.
@@ -102,6 +107,8 @@ class NonlinearBeamformer : public LappedTransform::Callback {
   FRIEND_TEST_ALL_PREFIXES(NonlinearBeamformerTest,
                            InterfAnglesTakeAmbiguityIntoAccount);
 
+  class MaskWorker;
+
   typedef Matrix<float> MatrixF;
   typedef ComplexMatrix<float> ComplexMatrixF;
   typedef complex<float> complex_f;
@@ -114,10 +121,21 @@ class NonlinearBeamformer : public LappedTransform::Callback {
   void InitDiffuseCovMats();
   void InitInterfCovMats();
   void NormalizeCovMats();
+  void InitSteeringData();
+
+  // Calculates |new_mask_| for the frequency bins in [|first_bin|,
+  // |end_bin|), using |eig_m| as scratch space for a planar vector of
+  // |num_input_channels_| elements. Can be called from several threads at
+  // once, for disjoint ranges of bins.
+  void CalculatePostfilterMasks(const complex_f* const* input,
+                                size_t first_bin,
+                                size_t end_bin,
+                                float* eig_m);
 
   // Calculates postfilter masks that minimize the mean squared error of our
   // estimation of the desired signal.
-  float CalculatePostfilterMask(const ComplexMatrixF& interf_cov_mat,
+  float CalculatePostfilterMask(const float* interf_cov_mat,
+                                const float* eig_m,
                                 float rpsiw,
                                 float ratio_rxiw_rxim,
                                 float rmxi_r);
@@ -207,8 +225,17 @@ class NonlinearBeamformer : public LappedTransform::Callback {
   // The vector has a size equal to the number of interferer scenarios.
   std::vector<float> rpsiws_[kNumFreqBins];
 
-  // The microphone normalization factor.
-  ComplexMatrixF eig_m_;
+  // Planar copies of |delay_sum_masks_|, |target_cov_mats_| and
+  // |interf_cov_mats_| for the kernels in planar_kernels.h, updated by AimAt().
+  // For each frequency bin, |steering_data_stride_| floats hold the
+  // delay-and-sum mask, the target covariance matrix and the interferer
+  // covariance matrices, in that order.
+  std::vector<float> steering_data_;
+  size_t steering_data_stride_;
+
+  // The normalized microphone signals of one frequency bin, as a planar
+  // vector. Only used by the processing thread.
+  std::vector<float> eig_m_;
 
   // For processing the high-frequency input signal.
   float high_pass_postfilter_mask_;
@@ -221,6 +248,10 @@ class NonlinearBeamformer : public LappedTransform::Callback {
   size_t hold_target_blocks_;
   // Number of blocks since the last mask that passed |kMaskSignalThreshold|.
   size_t interference_blocks_count_;
+
+  // Declared last, so that the threads are stopped before anything they use
+  // is destroyed.
+  std::vector<std::unique_ptr<MaskWorker>> mask_workers_;
 };
 
 }  // namespace webrtc
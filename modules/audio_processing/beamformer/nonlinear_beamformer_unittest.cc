@@ -19,6 +19,7 @@
 #include "modules/audio_processing/audio_buffer.h"
 #include "modules/audio_processing/test/audio_buffer_tools.h"
 #include "modules/audio_processing/test/bitexactness_tools.h"
+#include "rtc_base/random.h"
 #include "test/gtest.h"
 
 namespace webrtc {
@@ -169,6 +170,41 @@ TEST(NonlinearBeamformerTest, AimingModifiesBeam) {
   AimAndVerify(&bf, static_cast<float>(M_PI));
 }
 
+// The worker threads only split the frequency bins between them, so they
+// should not change the output at all.
+TEST(NonlinearBeamformerTest, WorkerThreadsDoNotChangeOutput) {
+  const size_t kNumMics = 8;
+  const size_t kNumFrames = kSampleRateHz * kChunkSizeMs / 1000;
+  std::vector<Point> array_geometry;
+  for (size_t i = 0; i < kNumMics; ++i) {
+    array_geometry.push_back(Point(0.03f * i, 0.f, 0.f));
+  }
+  const SphericalPointf kTargetDirection = AzimuthToSphericalPoint(1.2f);
+  NonlinearBeamformer bf(array_geometry, 1u, kTargetDirection);
+  NonlinearBeamformer threaded_bf(array_geometry, 1u, kTargetDirection, 3u);
+  bf.Initialize(kChunkSizeMs, kSampleRateHz);
+  threaded_bf.Initialize(kChunkSizeMs, kSampleRateHz);
+
+  ChannelBuffer<float> data(kNumFrames, kNumMics);
+  ChannelBuffer<float> threaded_data(kNumFrames, kNumMics);
+  Random random(42);
+  for (int chunk = 0; chunk < 100; ++chunk) {
+    for (size_t ch = 0; ch < kNumMics; ++ch) {
+      for (size_t i = 0; i < kNumFrames; ++i) {
+        data.channels()[ch][i] = threaded_data.channels()[ch][i] =
+            1000.f * random.Rand<float>() - 500.f;
+      }
+    }
+    bf.AnalyzeChunk(data);
+    bf.PostFilter(&data);
+    threaded_bf.AnalyzeChunk(threaded_data);
+    threaded_bf.PostFilter(&threaded_data);
+    for (size_t i = 0; i < kNumFrames; ++i) {
+      ASSERT_EQ(data.channels()[0][i], threaded_data.channels()[0][i]);
+    }
+  }
+}
+
 TEST(NonlinearBeamformerTest, InterfAnglesTakeAmbiguityIntoAccount) {
   {
     // For linear arrays there is ambiguity.
@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/beamformer/planar_kernels.h"
+
+#include <string.h>
+
+#include "typedefs.h"  // NOLINT(build/include)
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace webrtc {
+namespace {
+
+// The number of floats in a SIMD vector, which the planar vectors are padded
+// to a multiple of.
+const size_t kSimdWidth = 4;
+
+}  // namespace
+
+size_t PlanarSize(size_t num_elements) {
+  return (num_elements + kSimdWidth - 1) / kSimdWidth * kSimdWidth;
+}
+
+void ToPlanar(const std::complex<float>* const* elements,
+              size_t num_rows,
+              size_t num_columns,
+              float* planar) {
+  const size_t size = PlanarSize(num_columns);
+  memset(planar, 0, num_rows * 2 * size * sizeof(*planar));
+  for (size_t i = 0; i < num_rows; ++i) {
+    float* row = planar + i * 2 * size;
+    for (size_t j = 0; j < num_columns; ++j) {
+      row[j] = elements[i][j].real();
+      row[size + j] = elements[i][j].imag();
+    }
+  }
+}
+
+void ColumnToPlanar(const std::complex<float>* const* elements,
+                    size_t column,
+                    size_t num_rows,
+                    float* planar) {
+  const size_t size = PlanarSize(num_rows);
+  memset(planar, 0, 2 * size * sizeof(*planar));
+  for (size_t i = 0; i < num_rows; ++i) {
+    planar[i] = elements[i][column].real();
+    planar[size + i] = elements[i][column].imag();
+  }
+}
+
+float PlanarSumSquares(const float* x, size_t num_elements) {
+  const size_t size = PlanarSize(num_elements);
+  float sum_squares = 0.f;
+  for (size_t i = 0; i < 2 * size; ++i) {
+    sum_squares += x[i] * x[i];
+  }
+  return sum_squares;
+}
+
+void PlanarScale(float scale, size_t num_elements, float* x) {
+  const size_t size = PlanarSize(num_elements);
+  for (size_t i = 0; i < 2 * size; ++i) {
+    x[i] *= scale;
+  }
+}
+
+std::complex<float> PlanarConjugateDotProduct(const float* lhs,
+                                              const float* rhs,
+                                              size_t num_elements) {
+  const size_t size = PlanarSize(num_elements);
+  const float* lhs_re = lhs;
+  const float* lhs_im = lhs + size;
+  const float* rhs_re = rhs;
+  const float* rhs_im = rhs + size;
+  float result_re = 0.f;
+  float result_im = 0.f;
+  for (size_t i = 0; i < num_elements; ++i) {
+    result_re += lhs_re[i] * rhs_re[i] + lhs_im[i] * rhs_im[i];
+    result_im += lhs_re[i] * rhs_im[i] - lhs_im[i] * rhs_re[i];
+  }
+  return std::complex<float>(result_re, result_im);
+}
+
+// Computes the row vector w = conjugate(x) * mat a SIMD vector of columns at a
+// time, accumulating conjugate(x[j]) * mat[j] over the rows j, and sums the
+// real part of w * transpose(x) along the way. This way each matrix row is
+// read from contiguous memory, and w never leaves the registers.
+float PlanarQuadraticForm(const float* mat,
+                          const float* x,
+                          size_t num_elements) {
+  const size_t size = PlanarSize(num_elements);
+  const float* x_re = x;
+  const float* x_im = x + size;
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  __m128 result = _mm_setzero_ps();
+  for (size_t i = 0; i < size; i += kSimdWidth) {
+    __m128 w_re = _mm_setzero_ps();
+    __m128 w_im = _mm_setzero_ps();
+    for (size_t j = 0; j < num_elements; ++j) {
+      const float* row = mat + j * 2 * size;
+      const __m128 a = _mm_set1_ps(x_re[j]);
+      const __m128 b = _mm_set1_ps(x_im[j]);
+      const __m128 m_re = _mm_loadu_ps(row + i);
+      const __m128 m_im = _mm_loadu_ps(row + size + i);
+      w_re = _mm_add_ps(w_re,
+                        _mm_add_ps(_mm_mul_ps(a, m_re), _mm_mul_ps(b, m_im)));
+      w_im = _mm_add_ps(w_im,
+                        _mm_sub_ps(_mm_mul_ps(a, m_im), _mm_mul_ps(b, m_re)));
+    }
+    result = _mm_add_ps(
+        result, _mm_sub_ps(_mm_mul_ps(w_re, _mm_loadu_ps(x_re + i)),
+                           _mm_mul_ps(w_im, _mm_loadu_ps(x_im + i))));
+  }
+  float sums[kSimdWidth];
+  _mm_storeu_ps(sums, result);
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#elif defined(WEBRTC_HAS_NEON)
+  float32x4_t result = vdupq_n_f32(0.f);
+  for (size_t i = 0; i < size; i += kSimdWidth) {
+    float32x4_t w_re = vdupq_n_f32(0.f);
+    float32x4_t w_im = vdupq_n_f32(0.f);
+    for (size_t j = 0; j < num_elements; ++j) {
+      const float* row = mat + j * 2 * size;
+      const float32x4_t m_re = vld1q_f32(row + i);
+      const float32x4_t m_im = vld1q_f32(row + size + i);
+      w_re = vmlaq_n_f32(w_re, m_re, x_re[j]);
+      w_re = vmlaq_n_f32(w_re, m_im, x_im[j]);
+      w_im = vmlaq_n_f32(w_im, m_im, x_re[j]);
+      w_im = vmlsq_n_f32(w_im, m_re, x_im[j]);
+    }
+    result = vmlaq_f32(result, w_re, vld1q_f32(x_re + i));
+    result = vmlsq_f32(result, w_im, vld1q_f32(x_im + i));
+  }
+  float sums[kSimdWidth];
+  vst1q_f32(sums, result);
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#else
+  float result = 0.f;
+  for (size_t i = 0; i < num_elements; ++i) {
+    float w_re = 0.f;
+    float w_im = 0.f;
+    for (size_t j = 0; j < num_elements; ++j) {
+      const float* row = mat + j * 2 * size;
+      w_re += x_re[j] * row[i] + x_im[j] * row[size + i];
+      w_im += x_re[j] * row[size + i] - x_im[j] * row[i];
+    }
+    result += w_re * x_re[i] - w_im * x_im[i];
+  }
+  return result;
+#endif
+}
+
+}  // namespace webrtc
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_BEAMFORMER_PLANAR_KERNELS_H_
+#define MODULES_AUDIO_PROCESSING_BEAMFORMER_PLANAR_KERNELS_H_
+
+#include <stddef.h>
+
+#include <complex>
+
+namespace webrtc {
+
+// Kernels for the per-frequency-bin products of the NonlinearBeamformer. They
+// work on complex vectors and matrices in a "planar" layout:
+//
+// - A row vector of N complex elements is stored as 2 * PlanarSize(N) floats:
+//   the real parts followed by the imaginary parts, each zero-padded to
+//   PlanarSize(N) floats.
+// - An N x N matrix is stored as N such row vectors, one after the other.
+//
+// The padding lets the SIMD versions process whole vectors only. The results
+// may differ from the ComplexMatrix versions by rounding errors, since the
+// products are summed in a different order.
+
+// Returns the number of floats that the real or the imaginary parts of a
+// vector of |num_elements| complex elements are padded to.
+size_t PlanarSize(size_t num_elements);
+
+// Copies the |num_rows| x |num_columns| matrix |elements| to |planar|, which
+// must have room for |num_rows| planar vectors of |num_columns| elements.
+void ToPlanar(const std::complex<float>* const* elements,
+              size_t num_rows,
+              size_t num_columns,
+              float* planar);
+
+// Copies column |column| of the matrix |elements|, with |num_rows| rows, to
+// the planar row vector |planar|.
+void ColumnToPlanar(const std::complex<float>* const* elements,
+                    size_t column,
+                    size_t num_rows,
+                    float* planar);
+
+// Returns the sum of the squared absolute values of the elements of |x|.
+float PlanarSumSquares(const float* x, size_t num_elements);
+
+// Multiplies all elements of |x| by |scale|.
+void PlanarScale(float scale, size_t num_elements, float* x);
+
+// Does conjugate(|lhs|) * transpose(|rhs|) for row vectors |lhs| and |rhs|.
+std::complex<float> PlanarConjugateDotProduct(const float* lhs,
+                                              const float* rhs,
+                                              size_t num_elements);
+
+// Returns the real part of conjugate(|x|) * |mat| * transpose(|x|) for the
+// row vector |x| and the square matrix |mat|.
+float PlanarQuadraticForm(const float* mat,
+                          const float* x,
+                          size_t num_elements);
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_BEAMFORMER_PLANAR_KERNELS_H_
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/beamformer/planar_kernels.h"
+
+#include <vector>
+
+#include "modules/audio_processing/beamformer/complex_matrix.h"
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+const float kTolerance = 1e-5f;
+
+void Randomize(Random* random, ComplexMatrix<float>* mat) {
+  complex<float>* const* elements = mat->elements();
+  for (size_t i = 0; i < mat->num_rows(); ++i) {
+    for (size_t j = 0; j < mat->num_columns(); ++j) {
+      elements[i][j] = complex<float>(2.f * random->Rand<float>() - 1.f,
+                                      2.f * random->Rand<float>() - 1.f);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(PlanarKernelsTest, PadsToWholeSimdVectors) {
+  EXPECT_EQ(4u, PlanarSize(1));
+  EXPECT_EQ(4u, PlanarSize(4));
+  EXPECT_EQ(8u, PlanarSize(5));
+  EXPECT_EQ(16u, PlanarSize(16));
+}
+
+TEST(PlanarKernelsTest, MatchComplexMatrixProducts) {
+  Random random(42);
+  for (size_t n = 1; n <= 16; ++n) {
+    const size_t vector_size = 2 * PlanarSize(n);
+    ComplexMatrix<float> mat(n, n);
+    ComplexMatrix<float> columns(n, 2);
+    Randomize(&random, &mat);
+    Randomize(&random, &columns);
+
+    std::vector<float> planar_mat(n * vector_size);
+    std::vector<float> x(vector_size);
+    std::vector<float> y(vector_size);
+    ToPlanar(mat.elements(), n, n, planar_mat.data());
+    ColumnToPlanar(columns.elements(), 0, n, x.data());
+    ColumnToPlanar(columns.elements(), 1, n, y.data());
+
+    // The same products with std::complex.
+    const complex<float>* const* m = mat.elements();
+    const complex<float>* const* c = columns.elements();
+    float sum_squares = 0.f;
+    complex<float> dot_product(0.f, 0.f);
+    complex<float> quadratic_form(0.f, 0.f);
+    for (size_t i = 0; i < n; ++i) {
+      sum_squares += std::norm(c[i][0]);
+      dot_product += conj(c[i][0]) * c[i][1];
+      for (size_t j = 0; j < n; ++j) {
+        quadratic_form += conj(c[i][0]) * m[i][j] * c[j][0];
+      }
+    }
+
+    EXPECT_NEAR(sum_squares, PlanarSumSquares(x.data(), n),
+                kTolerance * n);
+    const complex<float> planar_dot_product =
+        PlanarConjugateDotProduct(x.data(), y.data(), n);
+    EXPECT_NEAR(dot_product.real(), planar_dot_product.real(), kTolerance * n);
+    EXPECT_NEAR(dot_product.imag(), planar_dot_product.imag(), kTolerance * n);
+    EXPECT_NEAR(quadratic_form.real(),
+                PlanarQuadraticForm(planar_mat.data(), x.data(), n),
+                kTolerance * n * n);
+
+    PlanarScale(0.5f, n, x.data());
+    EXPECT_NEAR(0.25f * sum_squares, PlanarSumSquares(x.data(), n),
+                kTolerance * n);
+  }
+}
+
+}  // namespace webrtc
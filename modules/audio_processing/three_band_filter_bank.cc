@@ -38,6 +38,13 @@
 #include <cmath>
 
 #include "rtc_base/checks.h"
+#include "typedefs.h"  // NOLINT(build/include)
+
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace webrtc {
 namespace {
@@ -103,14 +110,50 @@ void Upsample(const float* in, size_t split_length, size_t offset, float* out) {
   }
 }
 
+// Accumulates |scale| * |in| in |out|. Vectorized if |use_simd| is true, but
+// with the same float operations per sample as the scalar loop, so the result
+// is bit-exact.
+void ScaleAndAccumulate(const float* in,
+                        float scale,
+                        size_t length,
+                        bool use_simd,
+                        float* out) {
+  size_t i = 0;
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  if (use_simd) {
+    const __m128 scale_128 = _mm_set1_ps(scale);
+    for (; i + 4 <= length; i += 4) {
+      _mm_storeu_ps(out + i,
+                    _mm_add_ps(_mm_loadu_ps(out + i),
+                               _mm_mul_ps(scale_128, _mm_loadu_ps(in + i))));
+    }
+  }
+#elif defined(WEBRTC_HAS_NEON)
+  if (use_simd) {
+    const float32x4_t scale_128 = vdupq_n_f32(scale);
+    for (; i + 4 <= length; i += 4) {
+      vst1q_f32(out + i, vaddq_f32(vld1q_f32(out + i),
+                                   vmulq_f32(scale_128, vld1q_f32(in + i))));
+    }
+  }
+#endif
+  for (; i < length; ++i) {
+    out[i] += scale * in[i];
+  }
+}
+
 }  // namespace
 
 // Because the low-pass filter prototype has half bandwidth it is possible to
 // use a DCT to shift it in both directions at the same time, to the center
 // frequencies [1 / 12, 3 / 12, 5 / 12].
 ThreeBandFilterBank::ThreeBandFilterBank(size_t length)
+    : ThreeBandFilterBank(length, true) {}
+
+ThreeBandFilterBank::ThreeBandFilterBank(size_t length, bool use_simd)
     : in_buffer_(rtc::CheckedDivExact(length, kNumBands)),
-      out_buffer_(in_buffer_.size()) {
+      out_buffer_(in_buffer_.size()),
+      use_simd_(use_simd) {
   for (size_t i = 0; i < kSparsity; ++i) {
     for (size_t j = 0; j < kNumBands; ++j) {
       analysis_filters_.push_back(
@@ -191,9 +234,8 @@ void ThreeBandFilterBank::DownModulate(const float* in,
                                        size_t offset,
                                        float* const* out) {
   for (size_t i = 0; i < kNumBands; ++i) {
-    for (size_t j = 0; j < split_length; ++j) {
-      out[i][j] += dct_modulation_[offset][i] * in[j];
-    }
+    ScaleAndAccumulate(in, dct_modulation_[offset][i], split_length, use_simd_,
+                       out[i]);
   }
 }
 
@@ -207,9 +249,8 @@ void ThreeBandFilterBank::UpModulate(const float* const* in,
                                      float* out) {
   memset(out, 0, split_length * sizeof(*out));
   for (size_t i = 0; i < kNumBands; ++i) {
-    for (size_t j = 0; j < split_length; ++j) {
-      out[j] += dct_modulation_[offset][i] * in[i][j];
-    }
+    ScaleAndAccumulate(in[i], dct_modulation_[offset][i], split_length,
+                       use_simd_, out);
   }
 }
 
@@ -48,6 +48,12 @@ class ThreeBandFilterBank final {
   void Synthesis(const float* const* in, size_t split_length, float* out);
 
  private:
+  friend class ThreeBandFilterBankTest;
+
+  // If |use_simd| is false the modulation always runs the scalar code, which
+  // is only useful to compare it with the SSE2 and NEON code in tests.
+  ThreeBandFilterBank(size_t length, bool use_simd);
+
   void DownModulate(const float* in,
                     size_t split_length,
                     size_t offset,
@@ -62,6 +68,7 @@ class ThreeBandFilterBank final {
   std::vector<std::unique_ptr<SparseFIRFilter>> analysis_filters_;
   std::vector<std::unique_ptr<SparseFIRFilter>> synthesis_filters_;
   std::vector<std::vector<float>> dct_modulation_;
+  const bool use_simd_;
 };
 
 }  // namespace webrtc
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/three_band_filter_bank.h"
+
+#include <vector>
+
+#include "common_audio/channel_buffer.h"
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+const size_t kNumBands = 3;
+const int kNumFrames = 100;
+
+}  // namespace
+
+class ThreeBandFilterBankTest : public ::testing::Test {
+ protected:
+  void VerifySimdIsBitExact(size_t length);
+};
+
+// Runs |kNumFrames| of random audio through the analysis and synthesis of a
+// vectorized and a scalar filter bank and checks that the bands and the merged
+// output are bit-exact. |length| is the number of samples per frame.
+void ThreeBandFilterBankTest::VerifySimdIsBitExact(size_t length) {
+  Random random(42);
+  ThreeBandFilterBank simd_bank(length);
+  ThreeBandFilterBank scalar_bank(length, false);
+  std::vector<float> in(length);
+  ChannelBuffer<float> simd_bands(length, 1, kNumBands);
+  ChannelBuffer<float> scalar_bands(length, 1, kNumBands);
+  std::vector<float> simd_out(length);
+  std::vector<float> scalar_out(length);
+  const size_t split_length = length / kNumBands;
+
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    for (float& sample : in)
+      sample = random.Rand(-32768, 32767) + random.Rand(0, 99) / 100.f;
+
+    simd_bank.Analysis(in.data(), length, simd_bands.bands(0));
+    scalar_bank.Analysis(in.data(), length, scalar_bands.bands(0));
+    for (size_t band = 0; band < kNumBands; ++band) {
+      for (size_t i = 0; i < split_length; ++i) {
+        ASSERT_EQ(scalar_bands.bands(0)[band][i], simd_bands.bands(0)[band][i])
+            << "frame " << frame << ", band " << band << ", sample " << i;
+      }
+    }
+
+    // Synthesize the same bands in both, so that a difference in the analysis
+    // doesn't show up again here.
+    simd_bank.Synthesis(scalar_bands.bands(0), split_length, simd_out.data());
+    scalar_bank.Synthesis(scalar_bands.bands(0), split_length,
+                          scalar_out.data());
+    for (size_t i = 0; i < length; ++i) {
+      ASSERT_EQ(scalar_out[i], simd_out[i])
+          << "frame " << frame << ", sample " << i;
+    }
+  }
+}
+
+TEST_F(ThreeBandFilterBankTest, SimdModulationIsBitExact) {
+  VerifySimdIsBitExact(480);
+}
+
+// The split length of 161 is not a multiple of the vector width, so the scalar
+// tail of the modulation is also run.
+TEST_F(ThreeBandFilterBankTest, SimdModulationIsBitExactWithScalarTail) {
+  VerifySimdIsBitExact(kNumBands * 161);
+}
+
+}  // namespace webrtc
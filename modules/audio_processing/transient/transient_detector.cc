@@ -33,6 +33,8 @@ TransientDetector::TransientDetector(int sample_rate_hz)
     : samples_per_chunk_(sample_rate_hz * ts::kChunkSizeMs / 1000),
       last_first_moment_(),
       last_second_moment_(),
+      previous_results_(kChunksAtStartupLeftToDelete, 0.f),
+      oldest_result_index_(0),
       chunks_at_startup_left_to_delete_(kChunksAtStartupLeftToDelete),
       reference_energy_(1.f),
       using_reference_(false) {
@@ -60,10 +62,6 @@ TransientDetector::TransientDetector(int sample_rate_hz)
 
   first_moments_.reset(new float[tree_leaves_data_length_]);
   second_moments_.reset(new float[tree_leaves_data_length_]);
-
-  for (int i = 0; i < kChunksAtStartupLeftToDelete; ++i) {
-    previous_results_.push_back(0.f);
-  }
 }
 
 TransientDetector::~TransientDetector() {}
@@ -132,8 +130,8 @@ float TransientDetector::Detect(const float* data,
     result *= result;
   }
 
-  previous_results_.pop_front();
-  previous_results_.push_back(result);
+  previous_results_[oldest_result_index_] = result;
+  oldest_result_index_ = (oldest_result_index_ + 1) % previous_results_.size();
 
   // In the current implementation we return the max of the current result and
   // the previous results, so the high results have a width equals to
@@ -11,8 +11,8 @@
 #ifndef MODULES_AUDIO_PROCESSING_TRANSIENT_TRANSIENT_DETECTOR_H_
 #define MODULES_AUDIO_PROCESSING_TRANSIENT_TRANSIENT_DETECTOR_H_
 
-#include <deque>
 #include <memory>
+#include <vector>
 
 #include "modules/audio_processing/transient/moving_moments.h"
 #include "modules/audio_processing/transient/wpd_tree.h"
@@ -70,7 +70,9 @@ class TransientDetector {
 
   // We keep track of the previous results from the previous chunks, so it can
   // be used to effectively give results according to the |transient_length|.
-  std::deque<float> previous_results_;
+  // A circular buffer, where the oldest result is at |oldest_result_index_|.
+  std::vector<float> previous_results_;
+  size_t oldest_result_index_;
 
   // Number of chunks that are going to return only zeros at the beginning of
   // the detection. It helps to avoid infs and nans due to the lack of
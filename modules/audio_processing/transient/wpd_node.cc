@@ -13,26 +13,73 @@
 #include <math.h>
 #include <string.h>
 
-#include "common_audio/fir_filter.h"
-#include "modules/audio_processing/transient/dyadic_decimator.h"
 #include "rtc_base/checks.h"
 
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace webrtc {
+namespace {
+
+// Returns the dot product of the |length| samples at |in| and |coefficients|.
+// |length| must be a multiple of four and |coefficients| 16-byte aligned. The
+// products are summed in the same order as by the SIMD FIRFilter versions, so
+// that the results are the same.
+float DotProduct(const float* in, const float* coefficients, size_t length) {
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(__SSE2__)
+  __m128 sum = _mm_setzero_ps();
+  for (size_t j = 0; j < length; j += 4) {
+    sum = _mm_add_ps(
+        sum, _mm_mul_ps(_mm_loadu_ps(in + j), _mm_load_ps(coefficients + j)));
+  }
+  sum = _mm_add_ps(_mm_movehl_ps(sum, sum), sum);
+  return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+#elif defined(WEBRTC_HAS_NEON)
+  float32x4_t sum = vmovq_n_f32(0);
+  for (size_t j = 0; j < length; j += 4) {
+    sum = vmlaq_f32(sum, vld1q_f32(in + j), vld1q_f32(coefficients + j));
+  }
+  float32x2_t half = vadd_f32(vget_high_f32(sum), vget_low_f32(sum));
+  return vget_lane_f32(vpadd_f32(half, half), 0);
+#else
+  float sum = 0.f;
+  for (size_t j = 0; j < length; ++j) {
+    sum += in[j] * coefficients[j];
+  }
+  return sum;
+#endif
+}
+
+}  // namespace
 
 WPDNode::WPDNode(size_t length,
                  const float* coefficients,
                  size_t coefficients_length)
-    : // The data buffer has parent data length to be able to contain and filter
-      // it.
-      data_(new float[2 * length + 1]),
+    : data_(new float[length]),
       length_(length),
-      filter_(FIRFilter::Create(coefficients,
-                                coefficients_length,
-                                2 * length + 1)) {
+      coefficients_length_((coefficients_length + 3) & ~0x03),
+      coefficients_(static_cast<float*>(
+          AlignedMalloc(sizeof(float) * coefficients_length_, 16))),
+      // Has room for the filter state and the parent data.
+      history_(static_cast<float*>(AlignedMalloc(
+          sizeof(float) * (coefficients_length_ - 1 + 2 * length + 1),
+          16))) {
   RTC_DCHECK_GT(length, 0);
   RTC_DCHECK(coefficients);
   RTC_DCHECK_GT(coefficients_length, 0);
-  memset(data_.get(), 0.f, (2 * length + 1) * sizeof(data_[0]));
+  memset(data_.get(), 0, length_ * sizeof(data_[0]));
+  // The coefficients are reversed to compensate for the order in which the
+  // input samples are acquired (most recent last).
+  const size_t padding = coefficients_length_ - coefficients_length;
+  memset(coefficients_.get(), 0, padding * sizeof(coefficients_[0]));
+  for (size_t i = 0; i < coefficients_length; ++i) {
+    coefficients_[i + padding] = coefficients[coefficients_length - i - 1];
+  }
+  memset(history_.get(), 0,
+         (coefficients_length_ - 1) * sizeof(history_[0]));
 }
 
 WPDNode::~WPDNode() {}
@@ -42,22 +89,21 @@ int WPDNode::Update(const float* parent_data, size_t parent_data_length) {
     return -1;
   }
 
-  // Filter data.
-  filter_->Filter(parent_data, parent_data_length, data_.get());
-
-  // Decimate data.
-  const bool kOddSequence = true;
-  size_t output_samples = DyadicDecimate(
-      data_.get(), parent_data_length, kOddSequence, data_.get(), length_);
-  if (output_samples != length_) {
-    return -1;
-  }
+  const size_t state_length = coefficients_length_ - 1;
+  memcpy(&history_[state_length], parent_data,
+         parent_data_length * sizeof(*parent_data));
 
-  // Get abs to all values.
+  // Filter the odd samples, which are the ones that survive the decimation,
+  // and get their absolute values.
   for (size_t i = 0; i < length_; ++i) {
-    data_[i] = fabs(data_[i]);
+    data_[i] = fabs(DotProduct(&history_[2 * i + 1], coefficients_.get(),
+                               coefficients_length_));
   }
 
+  // Update the filter state.
+  memmove(history_.get(), &history_[parent_data_length],
+          state_length * sizeof(history_[0]));
+
   return 0;
 }
 
@@ -13,13 +13,16 @@
 
 #include <memory>
 
+#include "system_wrappers/include/aligned_malloc.h"
 #include "typedefs.h"  // NOLINT(build/include)
 
 namespace webrtc {
 
-class FIRFilter;
-
 // A single node of a Wavelet Packet Decomposition (WPD) tree.
+//
+// The node filters the data of its parent and keeps every other sample. Since
+// the even samples would be thrown away, the filter is only evaluated at the
+// odd ones, and the absolute value is taken in the same pass.
 class WPDNode {
  public:
   // Creates a WPDNode. The data vector will contain zeros. The filter will have
@@ -39,7 +42,15 @@ class WPDNode {
  private:
   std::unique_ptr<float[]> data_;
   size_t length_;
-  std::unique_ptr<FIRFilter> filter_;
+  // Closest multiple of four not smaller than the number of filter
+  // coefficients.
+  const size_t coefficients_length_;
+  // The filter coefficients, reversed and zero-padded at the front to
+  // |coefficients_length_|.
+  std::unique_ptr<float[], AlignedFreeDeleter> coefficients_;
+  // The last |coefficients_length_| - 1 samples of the previous parent data,
+  // followed by the current parent data.
+  std::unique_ptr<float[], AlignedFreeDeleter> history_;
 };
 
 }  // namespace webrtc
@@ -10,8 +10,14 @@
 
 #include "modules/audio_processing/transient/wpd_node.h"
 
+#include <math.h>
 #include <string.h>
 
+#include <memory>
+
+#include "common_audio/fir_filter.h"
+#include "modules/audio_processing/transient/daubechies_8_wavelet_coeffs.h"
+#include "modules/audio_processing/transient/dyadic_decimator.h"
 #include "test/gtest.h"
 
 namespace webrtc {
@@ -54,6 +60,32 @@ TEST(WPDNodeTest, UpdateWithArbitraryDataAndArbitraryFilter) {
   EXPECT_NEAR(0.94f, node.data()[4], kTolerance);
 }
 
+// The node only evaluates the filter at the samples that survive the
+// decimation, which should give the same result as filtering everything.
+TEST(WPDNodeTest, UpdateMatchesFilteringAndDecimating) {
+  const size_t kLength = 40;
+  WPDNode node(kLength, kDaubechies8HighPassCoefficients,
+               kDaubechies8CoefficientsLength);
+  std::unique_ptr<FIRFilter> filter(
+      FIRFilter::Create(kDaubechies8HighPassCoefficients,
+                        kDaubechies8CoefficientsLength, 2 * kLength));
+  float parent_data[2 * kLength];
+  float filtered[2 * kLength];
+  float expected[kLength];
+  for (int block = 0; block < 10; ++block) {
+    for (size_t i = 0; i < 2 * kLength; ++i) {
+      parent_data[i] = sinf(0.1f * (block * 2 * kLength + i)) * (i % 7);
+    }
+    filter->Filter(parent_data, 2 * kLength, filtered);
+    DyadicDecimate(filtered, 2 * kLength, true, expected, kLength);
+
+    ASSERT_EQ(0, node.Update(parent_data, 2 * kLength));
+    for (size_t i = 0; i < kLength; ++i) {
+      EXPECT_NEAR(fabs(expected[i]), node.data()[i], kTolerance);
+    }
+  }
+}
+
 TEST(WPDNodeTest, ExpectedErrorReturnValue) {
   WPDNode node(kDataLength, kCoefficients, kCoefficientsLength);
   EXPECT_EQ(-1, node.Update(kParentData, kParentDataLength - 1));
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "modules/desktop_capture/desktop_capture_options.h"
+#include "modules/desktop_capture/desktop_capturer.h"
+#include "modules/desktop_capture/desktop_frame.h"
+#include "modules/desktop_capture/desktop_region.h"
+#include "modules/desktop_capture/rgba_color.h"
+#include "modules/desktop_capture/screen_drawer.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+const int kNumCaptures = 100;
+// The size of the rectangle drawn before each capture, about a text editor
+// window with a blinking cursor and some typing.
+const int kDrawnRectSize = 256;
+
+class FrameCollector : public DesktopCapturer::Callback {
+ public:
+  void OnCaptureResult(DesktopCapturer::Result result,
+                       std::unique_ptr<DesktopFrame> frame) override {
+    result_ = result;
+    frame_ = std::move(frame);
+  }
+
+  DesktopCapturer::Result result() const { return result_; }
+  const DesktopFrame* frame() const { return frame_.get(); }
+
+ private:
+  DesktopCapturer::Result result_ = DesktopCapturer::Result::ERROR_TEMPORARY;
+  std::unique_ptr<DesktopFrame> frame_;
+};
+
+int64_t Area(const DesktopRegion& region) {
+  int64_t area = 0;
+  for (DesktopRegion::Iterator it(region); !it.IsAtEnd(); it.Advance())
+    area += static_cast<int64_t>(it.rect().width()) * it.rect().height();
+  return area;
+}
+
+// Captures the screen |kNumCaptures| times, with or without XDamage, and
+// prints the average time of a capture and the number of bytes copied into
+// the frame by it. With |draw|, a rectangle of a new color is drawn on the
+// screen before each capture. The numbers without drawing are only
+// meaningful on an idle display, e.g. Xvfb.
+void RunCaptures(const std::string& trace, bool use_damage, bool draw) {
+  DesktopCaptureOptions options(DesktopCaptureOptions::CreateDefault());
+  options.set_use_update_notifications(use_damage);
+  std::unique_ptr<DesktopCapturer> capturer =
+      DesktopCapturer::CreateScreenCapturer(options);
+  if (!capturer) {
+    LOG(LS_WARNING) << "No screen capturer, e.g. no X display.";
+    return;
+  }
+  std::unique_ptr<ScreenDrawer> drawer;
+  DesktopRect drawn_rect;
+  if (draw) {
+    drawer = ScreenDrawer::Create();
+    if (!drawer || drawer->DrawableRegion().width() < kDrawnRectSize ||
+        drawer->DrawableRegion().height() < kDrawnRectSize) {
+      LOG(LS_WARNING) << "No ScreenDrawer with a large enough region.";
+      return;
+    }
+    drawn_rect = DesktopRect::MakeOriginSize(
+        drawer->DrawableRegion().top_left(),
+        DesktopSize(kDrawnRectSize, kDrawnRectSize));
+  }
+
+  FrameCollector collector;
+  capturer->Start(&collector);
+  // The first capture is always of the whole screen.
+  capturer->CaptureFrame();
+  ASSERT_EQ(DesktopCapturer::Result::SUCCESS, collector.result());
+  DesktopRegion previous_updated_region = collector.frame()->updated_region();
+
+  int64_t capture_time_ns = 0;
+  int64_t bytes_copied = 0;
+  for (int i = 0; i < kNumCaptures; ++i) {
+    if (drawer) {
+      drawer->DrawRectangle(drawn_rect,
+                            RgbaColor(i * 16 & 0xFF, i * 32 & 0xFF, 0xFF));
+      drawer->WaitForPendingDraws();
+    }
+    const int64_t start_ns = rtc::TimeNanos();
+    capturer->CaptureFrame();
+    capture_time_ns += rtc::TimeNanos() - start_ns;
+    ASSERT_EQ(DesktopCapturer::Result::SUCCESS, collector.result());
+
+    // The capturer copies the updated region from the X server. With
+    // XDamage, it also copies the region updated by the previous capture
+    // from the other of its two buffers.
+    const DesktopRegion& updated_region = collector.frame()->updated_region();
+    int64_t area = Area(updated_region);
+    if (use_damage) {
+      DesktopRegion synchronized_region(previous_updated_region);
+      synchronized_region.Subtract(updated_region);
+      area += Area(synchronized_region);
+    }
+    bytes_copied += area * DesktopFrame::kBytesPerPixel;
+    previous_updated_region = updated_region;
+  }
+
+  test::PrintResult("screen_capturer", "_capture_time", trace,
+                    static_cast<size_t>(capture_time_ns /
+                                        rtc::kNumNanosecsPerMicrosec /
+                                        kNumCaptures),
+                    "us", true);
+  test::PrintResult("screen_capturer", "_bytes_copied", trace,
+                    static_cast<size_t>(bytes_copied / kNumCaptures), "bytes",
+                    true);
+}
+
+}  // namespace
+
+TEST(ScreenCapturerPerformanceTest, FullScreenCapture) {
+  RunCaptures("full_screen_drawing", false, true);
+}
+
+TEST(ScreenCapturerPerformanceTest, DamageCapture) {
+  RunCaptures("damage_drawing", true, true);
+}
+
+TEST(ScreenCapturerPerformanceTest, DamageCaptureOfIdleScreen) {
+  RunCaptures("damage_idle", true, false);
+}
+
+}  // namespace webrtc
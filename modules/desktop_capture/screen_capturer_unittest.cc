@@ -8,6 +8,8 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string.h>
+
 #include <memory>
 
 #include "modules/desktop_capture/desktop_capture_options.h"
@@ -151,6 +153,42 @@ TEST_F(ScreenCapturerTest, MAYBE_Capture) {
   EXPECT_TRUE(it.IsAtEnd());
 }
 
+#if defined(WEBRTC_LINUX)
+// With XDamage, a capture of an unchanged screen reports an empty updated
+// region and still returns the whole screen. Needs an X display without any
+// activity, e.g. Xvfb.
+TEST_F(ScreenCapturerTest, DISABLED_CaptureUnchangedScreenWithXDamage) {
+  DesktopCaptureOptions options(DesktopCaptureOptions::CreateDefault());
+  options.set_use_update_notifications(true);
+  capturer_ = DesktopCapturer::CreateScreenCapturer(options);
+  ASSERT_TRUE(capturer_);
+
+  std::unique_ptr<DesktopFrame> first_frame;
+  std::unique_ptr<DesktopFrame> second_frame;
+  EXPECT_CALL(callback_,
+              OnCaptureResultPtr(DesktopCapturer::Result::SUCCESS, _))
+      .WillOnce(SaveUniquePtrArg(&first_frame))
+      .WillOnce(SaveUniquePtrArg(&second_frame));
+
+  capturer_->Start(&callback_);
+  capturer_->CaptureFrame();
+  capturer_->CaptureFrame();
+
+  ASSERT_TRUE(first_frame);
+  ASSERT_TRUE(second_frame);
+  EXPECT_FALSE(first_frame->updated_region().is_empty());
+  EXPECT_TRUE(second_frame->updated_region().is_empty());
+  ASSERT_TRUE(first_frame->size().equals(second_frame->size()));
+  const int row_bytes =
+      first_frame->size().width() * DesktopFrame::kBytesPerPixel;
+  for (int y = 0; y < first_frame->size().height(); ++y) {
+    ASSERT_EQ(0, memcmp(first_frame->GetFrameDataAtPos(DesktopVector(0, y)),
+                        second_frame->GetFrameDataAtPos(DesktopVector(0, y)),
+                        row_bytes));
+  }
+}
+#endif  // defined(WEBRTC_LINUX)
+
 #if defined(WEBRTC_WIN)
 
 TEST_F(ScreenCapturerTest, UseSharedBuffers) {
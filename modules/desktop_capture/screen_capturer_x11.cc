@@ -22,8 +22,8 @@
 #include "modules/desktop_capture/desktop_capture_options.h"
 #include "modules/desktop_capture/desktop_capturer.h"
 #include "modules/desktop_capture/desktop_frame.h"
+#include "modules/desktop_capture/desktop_region.h"
 #include "modules/desktop_capture/screen_capture_frame_queue.h"
-#include "modules/desktop_capture/screen_capturer_helper.h"
 #include "modules/desktop_capture/shared_desktop_frame.h"
 #include "modules/desktop_capture/x11/x_server_pixel_buffer.h"
 #include "rtc_base/checks.h"
@@ -36,11 +36,11 @@ namespace {
 
 // A class to perform video frame capturing for Linux.
 //
-// If XDamage is used, this class sets DesktopFrame::updated_region() according
-// to the areas reported by XDamage. Otherwise this class does not detect
-// DesktopFrame::updated_region(), the field is always set to the entire frame
-// rectangle. ScreenCapturerDifferWrapper should be used if that functionality
-// is necessary.
+// If XDamage is used, this class captures only the areas reported by XDamage,
+// and sets DesktopFrame::updated_region() to exactly those areas. Otherwise
+// this class does not detect DesktopFrame::updated_region(), the field is
+// always set to the entire frame rectangle. ScreenCapturerDifferWrapper should
+// be used if that functionality is necessary.
 class ScreenCapturerLinux : public DesktopCapturer,
                             public SharedXDisplay::XEventHandler {
  public:
@@ -65,21 +65,21 @@ class ScreenCapturerLinux : public DesktopCapturer,
   void InitXDamage();
 
   // Capture screen pixels to the current buffer in the queue. In the DAMAGE
-  // case, the ScreenCapturerHelper already holds the list of invalid rectangles
-  // from HandleXEvent(). In the non-DAMAGE case, this captures the
-  // whole screen, then calculates some invalid rectangles that include any
-  // differences between this and the previous capture.
+  // case, only the damaged area is captured and the rest of the buffer is
+  // brought up to date from the previous buffer. In the non-DAMAGE case, this
+  // captures the whole screen.
   std::unique_ptr<DesktopFrame> CaptureScreen();
 
   // Called when the screen configuration is changed.
   void ScreenConfigurationChanged();
 
-  // Synchronize the current buffer with |last_buffer_|, by copying pixels from
-  // the area of |last_invalid_rects|.
+  // Synchronize the current buffer with the previous one, by copying pixels
+  // from the area of |last_invalid_region_| that is not in |captured_region|,
+  // which is about to be captured anyway.
   // Note this only works on the assumption that kNumBuffers == 2, as
-  // |last_invalid_rects| holds the differences from the previous buffer and
+  // |last_invalid_region_| holds the differences from the previous buffer and
   // the one prior to that (which will then be the current buffer).
-  void SynchronizeFrame();
+  void SynchronizeFrame(const DesktopRegion& captured_region);
 
   void DeinitXlib();
 
@@ -106,10 +106,6 @@ class ScreenCapturerLinux : public DesktopCapturer,
   // Access to the X Server's pixel buffer.
   XServerPixelBuffer x_server_pixel_buffer_;
 
-  // A thread-safe list of invalid rectangles, and the size of the most
-  // recently captured screen.
-  ScreenCapturerHelper helper_;
-
   // Queue of the frames buffers.
   ScreenCaptureFrameQueue<SharedDesktopFrame> queue_;
 
@@ -120,9 +116,7 @@ class ScreenCapturerLinux : public DesktopCapturer,
   RTC_DISALLOW_COPY_AND_ASSIGN(ScreenCapturerLinux);
 };
 
-ScreenCapturerLinux::ScreenCapturerLinux() {
-  helper_.SetLogGridSize(4);
-}
+ScreenCapturerLinux::ScreenCapturerLinux() {}
 
 ScreenCapturerLinux::~ScreenCapturerLinux() {
   options_.x_display()->RemoveEventHandler(ConfigureNotify, this);
@@ -294,20 +288,13 @@ std::unique_ptr<DesktopFrame> ScreenCapturerLinux::CaptureScreen() {
   std::unique_ptr<SharedDesktopFrame> frame = queue_.current_frame()->Share();
   RTC_DCHECK(x_server_pixel_buffer_.window_size().equals(frame->size()));
 
-  // Pass the screen size to the helper, so it can clip the invalid region if it
-  // expands that region to a grid.
-  helper_.set_size_most_recent(frame->size());
-
-  // In the DAMAGE case, ensure the frame is up-to-date with the previous frame
-  // if any.  If there isn't a previous frame, that means a screen-resolution
-  // change occurred, and |invalid_rects| will be updated to include the whole
-  // screen.
-  if (use_damage_ && queue_.previous_frame())
-    SynchronizeFrame();
-
+  // The frame may have been captured before, so reset its updated region.
   DesktopRegion* updated_region = frame->mutable_updated_region();
+  updated_region->Clear();
 
-  x_server_pixel_buffer_.Synchronize();
+  // In the DAMAGE case, only capture the damaged area, and copy the rest from
+  // the previous frame. If there isn't a previous frame, that means a
+  // screen-resolution change occurred, and the whole screen is captured.
   if (use_damage_ && queue_.previous_frame()) {
     // Atomically fetch and clear the damage region.
     XDamageSubtract(display(), damage_handle_, None, damage_region_);
@@ -320,10 +307,6 @@ std::unique_ptr<DesktopFrame> ScreenCapturerLinux::CaptureScreen() {
           rects[i].x, rects[i].y, rects[i].width, rects[i].height));
     }
     XFree(rects);
-    helper_.InvalidateRegion(*updated_region);
-
-    // Capture the damaged portions of the desktop.
-    helper_.TakeInvalidRegion(updated_region);
 
     // Clip the damaged portions to the current screen size, just in case some
     // spurious XDamage notifications were received for a previous (larger)
@@ -331,14 +314,24 @@ std::unique_ptr<DesktopFrame> ScreenCapturerLinux::CaptureScreen() {
     updated_region->IntersectWith(
         DesktopRect::MakeSize(x_server_pixel_buffer_.window_size()));
 
-    for (DesktopRegion::Iterator it(*updated_region);
-         !it.IsAtEnd(); it.Advance()) {
-      if (!x_server_pixel_buffer_.CaptureRect(it.rect(), frame.get()))
-        return nullptr;
-    }
+    SynchronizeFrame(*updated_region);
+
+    // Nothing changed, so the frame is already up to date.
+    if (updated_region->is_empty())
+      return std::move(frame);
+
+    // Capture the damaged portions of the desktop.
+    x_server_pixel_buffer_.Synchronize();
+    if (!x_server_pixel_buffer_.CaptureRegion(*updated_region, frame.get()))
+      return nullptr;
   } else {
     // Doing full-screen polling, or this is the first capture after a
     // screen-resolution change.  In either case, need a full-screen capture.
+    // Discard the damage so far, so that the next capture reports only the
+    // changes since this one.
+    if (use_damage_)
+      XDamageSubtract(display(), damage_handle_, None, None);
+    x_server_pixel_buffer_.Synchronize();
     DesktopRect screen_rect = DesktopRect::MakeSize(frame->size());
     if (!x_server_pixel_buffer_.CaptureRect(screen_rect, frame.get()))
       return nullptr;
@@ -352,29 +345,26 @@ void ScreenCapturerLinux::ScreenConfigurationChanged() {
   // Make sure the frame buffers will be reallocated.
   queue_.Reset();
 
-  helper_.ClearInvalidRegion();
   if (!x_server_pixel_buffer_.Init(display(), DefaultRootWindow(display()))) {
     LOG(LS_ERROR) << "Failed to initialize pixel buffer after screen "
         "configuration change.";
   }
 }
 
-void ScreenCapturerLinux::SynchronizeFrame() {
+void ScreenCapturerLinux::SynchronizeFrame(
+    const DesktopRegion& captured_region) {
   // Synchronize the current buffer with the previous one since we do not
   // capture the entire desktop. Note that encoder may be reading from the
   // previous buffer at this time so thread access complaints are false
   // positives.
-
-  // TODO(hclam): We can reduce the amount of copying here by subtracting
-  // |capturer_helper_|s region from |last_invalid_region_|.
-  // http://crbug.com/92354
   RTC_DCHECK(queue_.previous_frame());
 
   DesktopFrame* current = queue_.current_frame();
   DesktopFrame* last = queue_.previous_frame();
   RTC_DCHECK(current != last);
-  for (DesktopRegion::Iterator it(last_invalid_region_);
-       !it.IsAtEnd(); it.Advance()) {
+  DesktopRegion copy_region(last_invalid_region_);
+  copy_region.Subtract(captured_region);
+  for (DesktopRegion::Iterator it(copy_region); !it.IsAtEnd(); it.Advance()) {
     current->CopyPixelsFrom(*last, it.rect().top_left(), it.rect());
   }
 }
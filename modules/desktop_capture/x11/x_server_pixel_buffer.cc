@@ -14,6 +14,7 @@
 #include <sys/shm.h>
 
 #include "modules/desktop_capture/desktop_frame.h"
+#include "modules/desktop_capture/desktop_region.h"
 #include "modules/desktop_capture/x11/window_list_utils.h"
 #include "modules/desktop_capture/x11/x_error_trap.h"
 #include "rtc_base/checks.h"
@@ -129,6 +130,17 @@ void SlowBlit(XImage* x_image,
   }
 }
 
+void Blit(XImage* x_image,
+          uint8_t* src_pos,
+          const DesktopRect& rect,
+          DesktopFrame* frame) {
+  if (IsXImageRGBFormat(x_image)) {
+    FastBlit(x_image, src_pos, rect, frame);
+  } else {
+    SlowBlit(x_image, src_pos, rect, frame);
+  }
+}
+
 }  // namespace
 
 XServerPixelBuffer::XServerPixelBuffer() {}
@@ -315,9 +327,6 @@ bool XServerPixelBuffer::CaptureRect(const DesktopRect& rect,
   RTC_DCHECK_LE(rect.right(), window_rect_.width());
   RTC_DCHECK_LE(rect.bottom(), window_rect_.height());
 
-  XImage* image;
-  uint8_t* data;
-
   if (shm_segment_info_ && (shm_pixmap_ || xshm_get_image_succeeded_)) {
     if (shm_pixmap_) {
       XCopyArea(display_, window_, shm_pixmap_, shm_gc_,
@@ -325,31 +334,53 @@ bool XServerPixelBuffer::CaptureRect(const DesktopRect& rect,
                 rect.left(), rect.top());
       XSync(display_, False);
     }
+    BlitFromShmImage(rect, frame);
+    return true;
+  }
 
-    image = x_shm_image_;
-    data = reinterpret_cast<uint8_t*>(image->data) +
-           rect.top() * image->bytes_per_line +
-           rect.left() * image->bits_per_pixel / 8;
+  if (x_image_)
+    XDestroyImage(x_image_);
+  x_image_ = XGetImage(display_, window_, rect.left(), rect.top(),
+                       rect.width(), rect.height(), AllPlanes, ZPixmap);
+  if (!x_image_)
+    return false;
 
-  } else {
-    if (x_image_)
-      XDestroyImage(x_image_);
-    x_image_ = XGetImage(display_, window_, rect.left(), rect.top(),
-                         rect.width(), rect.height(), AllPlanes, ZPixmap);
-    if (!x_image_)
-      return false;
+  Blit(x_image_, reinterpret_cast<uint8_t*>(x_image_->data), rect, frame);
+  return true;
+}
 
-    image = x_image_;
-    data = reinterpret_cast<uint8_t*>(image->data);
+bool XServerPixelBuffer::CaptureRegion(const DesktopRegion& region,
+                                       DesktopFrame* frame) {
+  if (!shm_pixmap_) {
+    for (DesktopRegion::Iterator it(region); !it.IsAtEnd(); it.Advance()) {
+      if (!CaptureRect(it.rect(), frame))
+        return false;
+    }
+    return true;
   }
 
-  if (IsXImageRGBFormat(image)) {
-    FastBlit(image, data, rect, frame);
-  } else {
-    SlowBlit(image, data, rect, frame);
+  // Queue the copies of all the rectangles before waiting for the X server,
+  // so that the whole region costs a single round trip.
+  for (DesktopRegion::Iterator it(region); !it.IsAtEnd(); it.Advance()) {
+    const DesktopRect& rect = it.rect();
+    RTC_DCHECK_LE(rect.right(), window_rect_.width());
+    RTC_DCHECK_LE(rect.bottom(), window_rect_.height());
+    XCopyArea(display_, window_, shm_pixmap_, shm_gc_,
+              rect.left(), rect.top(), rect.width(), rect.height(),
+              rect.left(), rect.top());
   }
-
+  XSync(display_, False);
+  for (DesktopRegion::Iterator it(region); !it.IsAtEnd(); it.Advance())
+    BlitFromShmImage(it.rect(), frame);
   return true;
 }
 
+void XServerPixelBuffer::BlitFromShmImage(const DesktopRect& rect,
+                                          DesktopFrame* frame) {
+  uint8_t* data = reinterpret_cast<uint8_t*>(x_shm_image_->data) +
+                  rect.top() * x_shm_image_->bytes_per_line +
+                  rect.left() * x_shm_image_->bits_per_pixel / 8;
+  Blit(x_shm_image_, data, rect, frame);
+}
+
 }  // namespace webrtc
@@ -22,6 +22,7 @@
 namespace webrtc {
 
 class DesktopFrame;
+class DesktopRegion;
 
 // A class to allow the X server's pixel buffer to be accessed as efficiently
 // as possible.
@@ -60,12 +61,20 @@ class XServerPixelBuffer {
   // that |rect| is not larger than window_size().
   bool CaptureRect(const DesktopRect& rect, DesktopFrame* frame);
 
+  // Captures every rectangle of |region| into |frame|. When a shared memory
+  // pixmap is used, all the rectangles are copied with one round trip to the
+  // X server, instead of one per rectangle.
+  bool CaptureRegion(const DesktopRegion& region, DesktopFrame* frame);
+
  private:
   void ReleaseSharedMemorySegment();
 
   void InitShm(const XWindowAttributes& attributes);
   bool InitPixmaps(int depth);
 
+  // Copies |rect| from |x_shm_image_|, which must be up to date, to |frame|.
+  void BlitFromShmImage(const DesktopRect& rect, DesktopFrame* frame);
+
   Display* display_ = nullptr;
   Window window_ = 0;
   DesktopRect window_rect_;
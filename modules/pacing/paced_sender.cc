@@ -22,6 +22,7 @@
 #include "modules/pacing/interval_budget.h"
 #include "modules/utility/include/process_thread.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/location.h"
 #include "rtc_base/logging.h"
 #include "system_wrappers/include/clock.h"
 #include "system_wrappers/include/field_trial.h"
@@ -69,13 +70,13 @@ PacedSender::PacedSender(const Clock* clock,
 PacedSender::~PacedSender() {}
 
 void PacedSender::CreateProbeCluster(int bitrate_bps) {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   prober_->CreateProbeCluster(bitrate_bps, clock_->TimeInMilliseconds());
 }
 
 void PacedSender::Pause() {
   {
-    rtc::CritScope cs(&critsect_);
+    rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
     if (!paused_)
       LOG(LS_INFO) << "PacedSender paused.";
     paused_ = true;
@@ -89,7 +90,7 @@ void PacedSender::Pause() {
 
 void PacedSender::Resume() {
   {
-    rtc::CritScope cs(&critsect_);
+    rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
     if (paused_)
       LOG(LS_INFO) << "PacedSender resumed.";
     paused_ = false;
@@ -103,14 +104,14 @@ void PacedSender::Resume() {
 
 void PacedSender::SetProbingEnabled(bool enabled) {
   RTC_CHECK_EQ(0, packet_counter_);
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   prober_->SetEnabled(enabled);
 }
 
 void PacedSender::SetEstimatedBitrate(uint32_t bitrate_bps) {
   if (bitrate_bps == 0)
     LOG(LS_ERROR) << "PacedSender is not designed to handle 0 bitrate.";
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   estimated_bitrate_bps_ = bitrate_bps;
   padding_budget_->set_target_rate_kbps(
       std::min(estimated_bitrate_bps_ / 1000, max_padding_bitrate_kbps_));
@@ -122,7 +123,7 @@ void PacedSender::SetEstimatedBitrate(uint32_t bitrate_bps) {
 
 void PacedSender::SetSendBitrateLimits(int min_send_bitrate_bps,
                                        int padding_bitrate) {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   min_send_bitrate_kbps_ = min_send_bitrate_bps / 1000;
   pacing_bitrate_kbps_ =
       std::max(min_send_bitrate_kbps_, estimated_bitrate_bps_ / 1000) *
@@ -138,7 +139,7 @@ void PacedSender::InsertPacket(RtpPacketSender::Priority priority,
                                int64_t capture_time_ms,
                                size_t bytes,
                                bool retransmission) {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   RTC_DCHECK(estimated_bitrate_bps_ > 0)
         << "SetEstimatedBitrate must be called before InsertPacket.";
 
@@ -154,7 +155,7 @@ void PacedSender::InsertPacket(RtpPacketSender::Priority priority,
 }
 
 int64_t PacedSender::ExpectedQueueTimeMs() const {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   RTC_DCHECK_GT(pacing_bitrate_kbps_, 0);
   return static_cast<int64_t>(packets_->SizeInBytes() * 8 /
                               pacing_bitrate_kbps_);
@@ -162,22 +163,22 @@ int64_t PacedSender::ExpectedQueueTimeMs() const {
 
 rtc::Optional<int64_t> PacedSender::GetApplicationLimitedRegionStartTime()
     const {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   return alr_detector_->GetApplicationLimitedRegionStartTime();
 }
 
 size_t PacedSender::QueueSizePackets() const {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   return packets_->SizeInPackets();
 }
 
 int64_t PacedSender::FirstSentPacketTimeMs() const {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   return first_sent_packet_ms_;
 }
 
 int64_t PacedSender::QueueInMs() const {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
 
   int64_t oldest_packet = packets_->OldestEnqueueTimeMs();
   if (oldest_packet == 0)
@@ -187,13 +188,13 @@ int64_t PacedSender::QueueInMs() const {
 }
 
 int64_t PacedSender::AverageQueueTimeMs() {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   packets_->UpdateQueueTime(clock_->TimeInMilliseconds());
   return packets_->AverageQueueTimeMs();
 }
 
 int64_t PacedSender::TimeUntilNextProcess() {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   int64_t elapsed_time_us = clock_->TimeInMicroseconds() - time_last_update_us_;
   int64_t elapsed_time_ms = (elapsed_time_us + 500) / 1000;
   // When paused we wake up every 500 ms to send a padding packet to ensure
@@ -211,7 +212,7 @@ int64_t PacedSender::TimeUntilNextProcess() {
 
 void PacedSender::Process() {
   int64_t now_us = clock_->TimeInMicroseconds();
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   int64_t elapsed_time_ms = std::min(
       kMaxIntervalTimeMs, (now_us - time_last_update_us_ + 500) / 1000);
   int target_bitrate_kbps = pacing_bitrate_kbps_;
@@ -357,12 +358,12 @@ void PacedSender::UpdateBudgetWithBytesSent(size_t bytes_sent) {
 }
 
 void PacedSender::SetPacingFactor(float pacing_factor) {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   pacing_factor_ = pacing_factor;
 }
 
 void PacedSender::SetQueueTimeLimit(int limit_ms) {
-  rtc::CritScope cs(&critsect_);
+  rtc::CritScope cs(&critsect_, RTC_FROM_HERE);
   queue_time_limit = limit_ms;
 }
 
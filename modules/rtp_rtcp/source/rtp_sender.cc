@@ -26,6 +26,7 @@
 #include "modules/rtp_rtcp/source/time_util.h"
 #include "rtc_base/arraysize.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/location.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/ptr_util.h"
 #include "rtc_base/rate_limiter.h"
@@ -178,7 +179,7 @@ rtc::ArrayView<const RtpExtensionSize> RTPSender::FecExtensionSizes() {
 }
 
 uint16_t RTPSender::ActualSendBitrateKbit() const {
-  rtc::CritScope cs(&statistics_crit_);
+  rtc::CritScope cs(&statistics_crit_, RTC_FROM_HERE);
   return static_cast<uint16_t>(
       total_bitrate_sent_.Rate(clock_->TimeInMilliseconds()).value_or(0) /
       1000);
@@ -199,23 +200,23 @@ uint32_t RTPSender::FecOverheadRate() const {
 }
 
 uint32_t RTPSender::NackOverheadRate() const {
-  rtc::CritScope cs(&statistics_crit_);
+  rtc::CritScope cs(&statistics_crit_, RTC_FROM_HERE);
   return nack_bitrate_sent_.Rate(clock_->TimeInMilliseconds()).value_or(0);
 }
 
 int32_t RTPSender::RegisterRtpHeaderExtension(RTPExtensionType type,
                                               uint8_t id) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   return rtp_header_extension_map_.RegisterByType(id, type) ? 0 : -1;
 }
 
 bool RTPSender::IsRtpHeaderExtensionRegistered(RTPExtensionType type) const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   return rtp_header_extension_map_.IsRegistered(type);
 }
 
 int32_t RTPSender::DeregisterRtpHeaderExtension(RTPExtensionType type) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   return rtp_header_extension_map_.Deregister(type);
 }
 
@@ -226,7 +227,7 @@ int32_t RTPSender::RegisterPayload(
     size_t channels,
     uint32_t rate) {
   RTC_DCHECK_LT(strlen(payload_name), RTP_PAYLOAD_NAME_SIZE);
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
 
   std::map<int8_t, RtpUtility::Payload*>::iterator it =
       payload_type_map_.find(payload_number);
@@ -270,7 +271,7 @@ int32_t RTPSender::RegisterPayload(
 }
 
 int32_t RTPSender::DeRegisterSendPayload(int8_t payload_type) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
 
   std::map<int8_t, RtpUtility::Payload*>::iterator it =
       payload_type_map_.find(payload_type);
@@ -286,14 +287,14 @@ int32_t RTPSender::DeRegisterSendPayload(int8_t payload_type) {
 
 // TODO(nisse): Delete this method, only used internally and by test code.
 void RTPSender::SetSendPayloadType(int8_t payload_type) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   payload_type_ = payload_type;
 }
 
 void RTPSender::SetMaxRtpPacketSize(size_t max_packet_size) {
   RTC_DCHECK_GE(max_packet_size, 100);
   RTC_DCHECK_LE(max_packet_size, IP_PACKET_SIZE);
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   max_packet_size_ = max_packet_size;
 }
 
@@ -302,29 +303,29 @@ size_t RTPSender::MaxRtpPacketSize() const {
 }
 
 void RTPSender::SetRtxStatus(int mode) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   rtx_ = mode;
 }
 
 int RTPSender::RtxStatus() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   return rtx_;
 }
 
 void RTPSender::SetRtxSsrc(uint32_t ssrc) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   ssrc_rtx_.emplace(ssrc);
 }
 
 uint32_t RTPSender::RtxSsrc() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   RTC_DCHECK(ssrc_rtx_);
   return *ssrc_rtx_;
 }
 
 void RTPSender::SetRtxPayloadType(int payload_type,
                                   int associated_payload_type) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   RTC_DCHECK_LE(payload_type, 127);
   RTC_DCHECK_LE(associated_payload_type, 127);
   if (payload_type < 0) {
@@ -337,7 +338,7 @@ void RTPSender::SetRtxPayloadType(int payload_type,
 
 int32_t RTPSender::CheckPayloadType(int8_t payload_type,
                                     RtpVideoCodecTypes* video_type) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
 
   if (payload_type < 0) {
     LOG(LS_ERROR) << "Invalid payload_type " << payload_type << ".";
@@ -382,7 +383,7 @@ bool RTPSender::SendOutgoingData(FrameType frame_type,
   uint32_t rtp_timestamp;
   {
     // Drop this packet if we're not sending media packets.
-    rtc::CritScope lock(&send_critsect_);
+    rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
     RTC_DCHECK(ssrc_);
 
     ssrc = *ssrc_;
@@ -437,7 +438,7 @@ bool RTPSender::SendOutgoingData(FrameType frame_type,
                                expected_retransmission_time_ms);
   }
 
-  rtc::CritScope cs(&statistics_crit_);
+  rtc::CritScope cs(&statistics_crit_, RTC_FROM_HERE);
   // Note: This is currently only counting for video.
   if (frame_type == kVideoFrameKey) {
     ++frame_counts_.key_frames;
@@ -454,7 +455,7 @@ bool RTPSender::SendOutgoingData(FrameType frame_type,
 size_t RTPSender::TrySendRedundantPayloads(size_t bytes_to_send,
                                            const PacedPacketInfo& pacing_info) {
   {
-    rtc::CritScope lock(&send_critsect_);
+    rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
     if (!sending_media_)
       return 0;
     if ((rtx_ & kRtxRedundantPayloads) == 0)
@@ -503,7 +504,7 @@ size_t RTPSender::SendPadData(size_t bytes,
     int payload_type;
     bool over_rtx;
     {
-      rtc::CritScope lock(&send_critsect_);
+      rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
       if (!sending_media_)
         break;
       timestamp = last_rtp_timestamp_;
@@ -784,7 +785,7 @@ bool RTPSender::PrepareAndSendPacket(std::unique_ptr<RtpPacketToSend> packet,
     return false;
 
   {
-    rtc::CritScope lock(&send_critsect_);
+    rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
     media_has_been_sent_ = true;
   }
   UpdateRtpStats(*packet_to_send, send_over_rtx, is_retransmit);
@@ -796,7 +797,7 @@ void RTPSender::UpdateRtpStats(const RtpPacketToSend& packet,
                                bool is_retransmit) {
   int64_t now_ms = clock_->TimeInMilliseconds();
 
-  rtc::CritScope lock(&statistics_crit_);
+  rtc::CritScope lock(&statistics_crit_, RTC_FROM_HERE);
   StreamDataCounters* counters = is_rtx ? &rtx_rtp_stats_ : &rtp_stats_;
 
   total_bitrate_sent_.Update(packet.size(), now_ms);
@@ -916,7 +917,7 @@ bool RTPSender::SendToNetwork(std::unique_ptr<RtpPacketToSend> packet,
 
   if (sent) {
     {
-      rtc::CritScope lock(&send_critsect_);
+      rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
       media_has_been_sent_ = true;
     }
     UpdateRtpStats(*packet, false, false);
@@ -943,13 +944,13 @@ void RTPSender::UpdateDelayStatistics(int64_t capture_time_ms, int64_t now_ms) {
   int64_t avg_delay_ms = 0;
   int max_delay_ms = 0;
   {
-    rtc::CritScope lock(&send_critsect_);
+    rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
     if (!ssrc_)
       return;
     ssrc = *ssrc_;
   }
   {
-    rtc::CritScope cs(&statistics_crit_);
+    rtc::CritScope cs(&statistics_crit_, RTC_FROM_HERE);
     // TODO(holmer): Compute this iteratively instead.
     send_delays_[now_ms] = now_ms - capture_time_ms;
     send_delays_.erase(send_delays_.begin(),
@@ -985,19 +986,19 @@ void RTPSender::ProcessBitrate() {
   int64_t now_ms = clock_->TimeInMilliseconds();
   uint32_t ssrc;
   {
-    rtc::CritScope lock(&send_critsect_);
+    rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
     if (!ssrc_)
       return;
     ssrc = *ssrc_;
   }
 
-  rtc::CritScope lock(&statistics_crit_);
+  rtc::CritScope lock(&statistics_crit_, RTC_FROM_HERE);
   bitrate_callback_->Notify(total_bitrate_sent_.Rate(now_ms).value_or(0),
                             nack_bitrate_sent_.Rate(now_ms).value_or(0), ssrc);
 }
 
 size_t RTPSender::RtpHeaderLength() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   size_t rtp_header_length = kRtpHeaderLength;
   rtp_header_length += sizeof(uint32_t) * csrcs_.size();
   rtp_header_length +=
@@ -1006,7 +1007,7 @@ size_t RTPSender::RtpHeaderLength() const {
 }
 
 uint16_t RTPSender::AllocateSequenceNumber(uint16_t packets_to_send) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   uint16_t first_allocated_sequence_number = sequence_number_;
   sequence_number_ += packets_to_send;
   return first_allocated_sequence_number;
@@ -1014,13 +1015,13 @@ uint16_t RTPSender::AllocateSequenceNumber(uint16_t packets_to_send) {
 
 void RTPSender::GetDataCounters(StreamDataCounters* rtp_stats,
                                 StreamDataCounters* rtx_stats) const {
-  rtc::CritScope lock(&statistics_crit_);
+  rtc::CritScope lock(&statistics_crit_, RTC_FROM_HERE);
   *rtp_stats = rtp_stats_;
   *rtx_stats = rtx_rtp_stats_;
 }
 
 std::unique_ptr<RtpPacketToSend> RTPSender::AllocatePacket() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   std::unique_ptr<RtpPacketToSend> packet(
       new RtpPacketToSend(&rtp_header_extension_map_, max_packet_size_));
   RTC_DCHECK(ssrc_);
@@ -1038,7 +1039,7 @@ std::unique_ptr<RtpPacketToSend> RTPSender::AllocatePacket() const {
 }
 
 bool RTPSender::AssignSequenceNumber(RtpPacketToSend* packet) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   if (!sending_media_)
     return false;
   RTC_DCHECK(packet->Ssrc() == ssrc_);
@@ -1058,7 +1059,7 @@ bool RTPSender::UpdateTransportSequenceNumber(RtpPacketToSend* packet,
                                               int* packet_id) const {
   RTC_DCHECK(packet);
   RTC_DCHECK(packet_id);
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   if (!rtp_header_extension_map_.IsRegistered(TransportSequenceNumber::kId))
     return false;
 
@@ -1074,28 +1075,28 @@ bool RTPSender::UpdateTransportSequenceNumber(RtpPacketToSend* packet,
 }
 
 void RTPSender::SetSendingMediaStatus(bool enabled) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   sending_media_ = enabled;
 }
 
 bool RTPSender::SendingMedia() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   return sending_media_;
 }
 
 void RTPSender::SetTimestampOffset(uint32_t timestamp) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   timestamp_offset_ = timestamp;
 }
 
 uint32_t RTPSender::TimestampOffset() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   return timestamp_offset_;
 }
 
 void RTPSender::SetSSRC(uint32_t ssrc) {
   // This is configured via the API.
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
 
   if (ssrc_ == ssrc) {
     return;  // Since it's same ssrc, don't reset anything.
@@ -1107,7 +1108,7 @@ void RTPSender::SetSSRC(uint32_t ssrc) {
 }
 
 uint32_t RTPSender::SSRC() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   RTC_DCHECK(ssrc_);
   return *ssrc_;
 }
@@ -1121,18 +1122,18 @@ rtc::Optional<uint32_t> RTPSender::FlexfecSsrc() const {
 
 void RTPSender::SetCsrcs(const std::vector<uint32_t>& csrcs) {
   RTC_DCHECK_LE(csrcs.size(), kRtpCsrcSize);
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   csrcs_ = csrcs;
 }
 
 void RTPSender::SetSequenceNumber(uint16_t seq) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   sequence_number_forced_ = true;
   sequence_number_ = seq;
 }
 
 uint16_t RTPSender::SequenceNumber() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   return sequence_number_;
 }
 
@@ -1178,7 +1179,7 @@ std::unique_ptr<RtpPacketToSend> RTPSender::BuildRtxPacket(
   // Add original RTP header.
   rtx_packet->CopyHeaderFrom(packet);
   {
-    rtc::CritScope lock(&send_critsect_);
+    rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
     if (!sending_media_)
       return nullptr;
 
@@ -1212,22 +1213,22 @@ std::unique_ptr<RtpPacketToSend> RTPSender::BuildRtxPacket(
 
 void RTPSender::RegisterRtpStatisticsCallback(
     StreamDataCountersCallback* callback) {
-  rtc::CritScope cs(&statistics_crit_);
+  rtc::CritScope cs(&statistics_crit_, RTC_FROM_HERE);
   rtp_stats_callback_ = callback;
 }
 
 StreamDataCountersCallback* RTPSender::GetRtpStatisticsCallback() const {
-  rtc::CritScope cs(&statistics_crit_);
+  rtc::CritScope cs(&statistics_crit_, RTC_FROM_HERE);
   return rtp_stats_callback_;
 }
 
 uint32_t RTPSender::BitrateSent() const {
-  rtc::CritScope cs(&statistics_crit_);
+  rtc::CritScope cs(&statistics_crit_, RTC_FROM_HERE);
   return total_bitrate_sent_.Rate(clock_->TimeInMilliseconds()).value_or(0);
 }
 
 void RTPSender::SetRtpState(const RtpState& rtp_state) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   sequence_number_ = rtp_state.sequence_number;
   sequence_number_forced_ = true;
   timestamp_offset_ = rtp_state.start_timestamp;
@@ -1238,7 +1239,7 @@ void RTPSender::SetRtpState(const RtpState& rtp_state) {
 }
 
 RtpState RTPSender::GetRtpState() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
 
   RtpState state;
   state.sequence_number = sequence_number_;
@@ -1252,12 +1253,12 @@ RtpState RTPSender::GetRtpState() const {
 }
 
 void RTPSender::SetRtxRtpState(const RtpState& rtp_state) {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   sequence_number_rtx_ = rtp_state.sequence_number;
 }
 
 RtpState RTPSender::GetRtxRtpState() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
 
   RtpState state;
   state.sequence_number = sequence_number_rtx_;
@@ -1286,7 +1287,7 @@ void RTPSender::UpdateRtpOverhead(const RtpPacketToSend& packet) {
     return;
   size_t overhead_bytes_per_packet;
   {
-    rtc::CritScope lock(&send_critsect_);
+    rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
     if (rtp_overhead_bytes_per_packet_ == packet.headers_size()) {
       return;
     }
@@ -1297,7 +1298,7 @@ void RTPSender::UpdateRtpOverhead(const RtpPacketToSend& packet) {
 }
 
 int64_t RTPSender::LastTimestampTimeMs() const {
-  rtc::CritScope lock(&send_critsect_);
+  rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
   return last_timestamp_time_ms_;
 }
 
@@ -1307,7 +1308,7 @@ void RTPSender::SendKeepAlive(uint8_t payload_type) {
   // Set marker bit and timestamps in the same manner as plain padding packets.
   packet->SetMarker(false);
   {
-    rtc::CritScope lock(&send_critsect_);
+    rtc::CritScope lock(&send_critsect_, RTC_FROM_HERE);
     packet->SetTimestamp(last_rtp_timestamp_);
     packet->set_capture_time_ms(capture_time_ms_);
   }
@@ -243,10 +243,11 @@ int32_t DeviceInfoLinux::FillCapabilities(int fd)
     video_fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     video_fmt.fmt.pix.sizeimage = 0;
 
-    int totalFmts = 4;
+    int totalFmts = 5;
     unsigned int videoFormats[] = {
         V4L2_PIX_FMT_MJPEG,
         V4L2_PIX_FMT_YUV420,
+        V4L2_PIX_FMT_NV12,
         V4L2_PIX_FMT_YUYV,
         V4L2_PIX_FMT_UYVY };
 
@@ -282,6 +283,10 @@ int32_t DeviceInfoLinux::FillCapabilities(int fd)
                     {
                       cap.videoType = VideoType::kI420;
                     }
+                    else if (videoFormats[fmts] == V4L2_PIX_FMT_NV12)
+                    {
+                      cap.videoType = VideoType::kNV12;
+                    }
                     else if (videoFormats[fmts] == V4L2_PIX_FMT_MJPEG)
                     {
                       cap.videoType = VideoType::kMJPEG;
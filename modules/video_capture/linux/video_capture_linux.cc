@@ -24,6 +24,8 @@
 #include <new>
 
 #include "media/base/videocommon.h"
+#include "rtc_base/atomicops.h"
+#include "rtc_base/event.h"
 #include "rtc_base/refcount.h"
 #include "rtc_base/refcountedobject.h"
 #include "rtc_base/scoped_ref_ptr.h"
@@ -52,7 +54,8 @@ VideoCaptureModuleV4L2::VideoCaptureModuleV4L2()
       _currentFrameRate(-1),
       _captureStarted(false),
       _captureVideoType(VideoType::kI420),
-      _pool(NULL) {}
+      _pool(NULL),
+      _pendingConversions(0) {}
 
 int32_t VideoCaptureModuleV4L2::Init(const char* deviceUniqueIdUTF8)
 {
@@ -139,20 +142,22 @@ int32_t VideoCaptureModuleV4L2::StartCapture(
     // Supported video formats in preferred order.
     // If the requested resolution is larger than VGA, we prefer MJPEG. Go for
     // I420 otherwise.
-    const int nFormats = 5;
+    const int nFormats = 6;
     unsigned int fmts[nFormats];
     if (capability.width > 640 || capability.height > 480) {
         fmts[0] = V4L2_PIX_FMT_MJPEG;
         fmts[1] = V4L2_PIX_FMT_YUV420;
-        fmts[2] = V4L2_PIX_FMT_YUYV;
-        fmts[3] = V4L2_PIX_FMT_UYVY;
-        fmts[4] = V4L2_PIX_FMT_JPEG;
+        fmts[2] = V4L2_PIX_FMT_NV12;
+        fmts[3] = V4L2_PIX_FMT_YUYV;
+        fmts[4] = V4L2_PIX_FMT_UYVY;
+        fmts[5] = V4L2_PIX_FMT_JPEG;
     } else {
         fmts[0] = V4L2_PIX_FMT_YUV420;
-        fmts[1] = V4L2_PIX_FMT_YUYV;
-        fmts[2] = V4L2_PIX_FMT_UYVY;
-        fmts[3] = V4L2_PIX_FMT_MJPEG;
-        fmts[4] = V4L2_PIX_FMT_JPEG;
+        fmts[1] = V4L2_PIX_FMT_NV12;
+        fmts[2] = V4L2_PIX_FMT_YUYV;
+        fmts[3] = V4L2_PIX_FMT_UYVY;
+        fmts[4] = V4L2_PIX_FMT_MJPEG;
+        fmts[5] = V4L2_PIX_FMT_JPEG;
     }
 
     // Enumerate image formats.
@@ -196,6 +201,8 @@ int32_t VideoCaptureModuleV4L2::StartCapture(
       _captureVideoType = VideoType::kYUY2;
     else if (video_fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_YUV420)
       _captureVideoType = VideoType::kI420;
+    else if (video_fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_NV12)
+      _captureVideoType = VideoType::kNV12;
     else if (video_fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_UYVY)
       _captureVideoType = VideoType::kUYVY;
     else if (video_fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_MJPEG ||
@@ -254,6 +261,13 @@ int32_t VideoCaptureModuleV4L2::StartCapture(
         return -1;
     }
 
+    // Start the conversion queue before the capture thread posts to it.
+    if (!_conversionQueue)
+    {
+        _conversionQueue.reset(new rtc::TaskQueue(
+            "V4L2Conversion", rtc::TaskQueue::Priority::HIGH));
+    }
+
     //start capture thread;
     if (!_captureThread)
     {
@@ -283,6 +297,14 @@ int32_t VideoCaptureModuleV4L2::StopCapture()
         _captureThread->Stop();
         _captureThread.reset();
     }
+    if (_conversionQueue) {
+        // Wait for the frames that are being converted, since they point into
+        // the mapped driver buffers.
+        rtc::Event done(false, false);
+        _conversionQueue->PostTask([&done] { done.Set(); });
+        done.Wait(rtc::Event::kForever);
+        _conversionQueue.reset();
+    }
 
     rtc::CritScope cs(&_captureCritSect);
     if (_captureStarted)
@@ -429,24 +451,57 @@ bool VideoCaptureModuleV4L2::CaptureProcess()
                 return true;
             }
         }
+        if (rtc::AtomicOps::AcquireLoad(&_pendingConversions) >=
+            kMaxPendingConversions)
+        {
+            // The conversion is falling behind. Drop the frame rather than
+            // leaving the driver without buffers to capture into.
+            if (ioctl(_deviceFd, VIDIOC_QBUF, &buf) == -1)
+            {
+                LOG(LS_INFO) << "Failed to enqueue capture buffer";
+            }
+            return true;
+        }
+
         VideoCaptureCapability frameInfo;
         frameInfo.width = _currentWidth;
         frameInfo.height = _currentHeight;
         frameInfo.videoType = _captureVideoType;
 
-        // convert to to I420 if needed
-        IncomingFrame((unsigned char*) _pool[buf.index].start,
-                      buf.bytesused, frameInfo);
-        // enqueue the buffer again
-        if (ioctl(_deviceFd, VIDIOC_QBUF, &buf) == -1)
-        {
-            LOG(LS_INFO) << "Failed to enqueue capture buffer";
-        }
+        // Convert and deliver the frame on the conversion queue, which gives
+        // the buffer back to the driver when done. Meanwhile this thread can
+        // dequeue the next frame.
+        rtc::AtomicOps::Increment(&_pendingConversions);
+        _conversionQueue->PostTask([this, buf, frameInfo] {
+            ConvertFrame(buf.index, buf.bytesused, frameInfo);
+        });
     }
     usleep(0);
     return true;
 }
 
+void VideoCaptureModuleV4L2::ConvertFrame(
+    uint32_t index,
+    size_t length,
+    const VideoCaptureCapability& frameInfo)
+{
+    // convert to to I420 if needed
+    IncomingFrame(static_cast<uint8_t*>(_pool[index].start), length,
+                  frameInfo);
+
+    // enqueue the buffer again
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(struct v4l2_buffer));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+    if (ioctl(_deviceFd, VIDIOC_QBUF, &buf) == -1)
+    {
+        LOG(LS_INFO) << "Failed to enqueue capture buffer";
+    }
+    rtc::AtomicOps::Decrement(&_pendingConversions);
+}
+
 int32_t VideoCaptureModuleV4L2::CaptureSettings(VideoCaptureCapability& settings)
 {
     settings.width = _currentWidth;
@@ -17,6 +17,7 @@
 #include "modules/video_capture/video_capture_impl.h"
 #include "rtc_base/criticalsection.h"
 #include "rtc_base/platform_thread.h"
+#include "rtc_base/task_queue.h"
 
 namespace webrtc
 {
@@ -35,15 +36,26 @@ public:
 
 private:
     enum {kNoOfV4L2Bufffers=4};
+    // Frames handed to the conversion queue are not given back to the driver
+    // until they are converted, so keep some buffers for the driver.
+    enum {kMaxPendingConversions=kNoOfV4L2Bufffers-2};
 
     static bool CaptureThread(void*);
     bool CaptureProcess();
     bool AllocateVideoBuffers();
     bool DeAllocateVideoBuffers();
+    // Converts the frame in driver buffer |index| to I420, delivers it and
+    // gives the buffer back to the driver. Runs on |_conversionQueue|.
+    void ConvertFrame(uint32_t index,
+                      size_t length,
+                      const VideoCaptureCapability& frameInfo);
 
     // TODO(pbos): Stop using unique_ptr and resetting the thread.
     std::unique_ptr<rtc::PlatformThread> _captureThread;
     rtc::CriticalSection _captureCritSect;
+    // Converts and delivers the captured frames, so that the capture thread
+    // only dequeues buffers from the driver.
+    std::unique_ptr<rtc::TaskQueue> _conversionQueue;
 
     int32_t _deviceId;
     int32_t _deviceFd;
@@ -60,6 +72,9 @@ private:
         size_t length;
     };
     Buffer *_pool;
+    // Number of driver buffers posted to |_conversionQueue| and not yet
+    // given back to the driver.
+    volatile int _pendingConversions;
 };
 }  // namespace videocapturemodule
 }  // namespace webrtc
@@ -13,6 +13,7 @@
 #include <map>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "api/video/i420_buffer.h"
 #include "api/video/video_frame.h"
@@ -129,6 +130,11 @@ class TestVideoCaptureCallback
                                         frame.video_frame_buffer());
   }
 
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> last_frame_buffer() {
+    rtc::CritScope cs(&capture_cs_);
+    return last_frame_;
+  }
+
   void SetExpectedCaptureRotation(webrtc::VideoRotation rotation) {
     rtc::CritScope cs(&capture_cs_);
     rotate_frame_ = rotation;
@@ -398,6 +404,28 @@ TEST_F(VideoCaptureExternalTest, TestExternalCapture) {
   EXPECT_TRUE(capture_callback_.CompareLastFrame(*test_frame_));
 }
 
+// Captured frames are converted into pooled buffers, which are reused once
+// the previous frames have been released.
+TEST_F(VideoCaptureExternalTest, ReusesReleasedFrameBuffers) {
+  size_t length = webrtc::CalcBufferSize(
+      webrtc::VideoType::kI420, test_frame_->width(), test_frame_->height());
+  std::unique_ptr<uint8_t[]> test_buffer(new uint8_t[length]);
+  webrtc::ExtractBuffer(*test_frame_, length, test_buffer.get());
+
+  std::vector<const uint8_t*> frame_data;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(0, capture_input_interface_->IncomingFrame(test_buffer.get(),
+        length, capture_callback_.capability(), 0));
+    EXPECT_TRUE(capture_callback_.CompareLastFrame(*test_frame_));
+    frame_data.push_back(
+        capture_callback_.last_frame_buffer()->GetI420()->DataY());
+  }
+  // The callback holds on to the last frame only, so two buffers are enough.
+  EXPECT_NE(frame_data[0], frame_data[1]);
+  EXPECT_EQ(frame_data[0], frame_data[2]);
+  EXPECT_EQ(frame_data[1], frame_data[3]);
+}
+
 TEST_F(VideoCaptureExternalTest, Rotation) {
   EXPECT_EQ(0, capture_module_->SetCaptureRotation(webrtc::kVideoRotation_0));
   size_t length = webrtc::CalcBufferSize(
@@ -142,8 +142,6 @@ int32_t VideoCaptureImpl::IncomingFrame(
       return -1;
     }
 
-    int stride_y = width;
-    int stride_uv = (width + 1) / 2;
     int target_width = width;
     int target_height = height;
 
@@ -163,9 +161,10 @@ int32_t VideoCaptureImpl::IncomingFrame(
     // In Windows, the image starts bottom left, instead of top left.
     // Setting a negative source height, inverts the image (within LibYuv).
 
-    // TODO(nisse): Use a pool?
-    rtc::scoped_refptr<I420Buffer> buffer = I420Buffer::Create(
-        target_width, abs(target_height), stride_y, stride_uv, stride_uv);
+    // Reuse the buffers of frames that have been released downstream, rather
+    // than allocating a new buffer for every captured frame.
+    rtc::scoped_refptr<I420Buffer> buffer =
+        buffer_pool_.CreateBuffer(target_width, abs(target_height));
     const int conversionResult = ConvertToI420(
         frameInfo.videoType, videoFrame, 0, 0,  // No cropping
         width, height, videoFrameLength,
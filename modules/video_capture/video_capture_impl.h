@@ -16,6 +16,7 @@
  */
 
 #include "api/video/video_frame.h"
+#include "common_video/include/i420_buffer_pool.h"
 #include "common_video/libyuv/include/webrtc_libyuv.h"
 #include "modules/video_capture/video_capture.h"
 #include "modules/video_capture/video_capture_config.h"
@@ -114,6 +115,9 @@ private:
 
     // Indicate whether rotation should be applied before delivered externally.
     bool apply_rotation_;
+
+    // Buffers for the converted frames. Only used under |_apiCs|.
+    I420BufferPool buffer_pool_;
 };
 }  // namespace videocapturemodule
 }  // namespace webrtc
@@ -13,6 +13,7 @@
 
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "third_party/openh264/src/codec/api/svc/codec_api.h"
 #include "third_party/openh264/src/codec/api/svc/codec_app_def.h"
@@ -381,9 +382,17 @@ int32_t H264EncoderImpl::Encode(const VideoFrame& input_frame,
   // Encoder can skip frames to save bandwidth in which case
   // |encoded_image_._length| == 0.
   if (encoded_image_._length > 0) {
-    // Parse QP.
-    h264_bitstream_parser_.ParseBitstream(encoded_image_._buffer,
-                                          encoded_image_._length);
+    // Parse QP. The NAL units were already located by RtpFragmentize(), so
+    // reuse those instead of scanning the bitstream for start codes again.
+    std::vector<H264::NaluIndex> nalu_indices(
+        frag_header.fragmentationVectorSize);
+    for (size_t i = 0; i < nalu_indices.size(); ++i) {
+      nalu_indices[i].start_offset =
+          frag_header.fragmentationOffset[i] - H264::kNaluLongStartSequenceSize;
+      nalu_indices[i].payload_start_offset = frag_header.fragmentationOffset[i];
+      nalu_indices[i].payload_size = frag_header.fragmentationLength[i];
+    }
+    h264_bitstream_parser_.ParseBitstream(encoded_image_._buffer, nalu_indices);
     h264_bitstream_parser_.GetLastSliceQp(&encoded_image_.qp_);
 
     // Deliver encoded image.
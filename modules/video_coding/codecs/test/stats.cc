@@ -60,6 +60,21 @@ size_t Stats::size() const {
   return stats_.size();
 }
 
+int Stats::AverageSpatialLayerEncodeTimeUs(int spatial_idx) const {
+  RTC_CHECK_GE(spatial_idx, 0);
+  RTC_CHECK_LT(spatial_idx, kMaxSpatialLayers);
+  int64_t total_encode_time_us = 0;
+  int num_frames = 0;
+  for (const FrameStatistic& stat : stats_) {
+    if (spatial_idx < stat.num_spatial_layers) {
+      total_encode_time_us += stat.spatial_layer_encode_time_us[spatial_idx];
+      ++num_frames;
+    }
+  }
+  return num_frames > 0 ? static_cast<int>(total_encode_time_us / num_frames)
+                        : 0;
+}
+
 void Stats::PrintSummary() const {
   if (stats_.empty()) {
     printf("No frame statistics have been logged yet.\n");
@@ -99,6 +114,16 @@ void Stats::PrintSummary() const {
          frame_it->frame_number);
   printf("  Average : %7d us\n",
          static_cast<int>(total_encoding_time_us / stats_.size()));
+  int max_num_spatial_layers = 1;
+  for (const FrameStatistic& stat : stats_)
+    max_num_spatial_layers =
+        std::max(max_num_spatial_layers, stat.num_spatial_layers);
+  if (max_num_spatial_layers > 1) {
+    for (int i = 0; i < max_num_spatial_layers; ++i) {
+      printf("  Average spatial layer %d: %7d us\n", i,
+             AverageSpatialLayerEncodeTimeUs(i));
+    }
+  }
 
   // Decoding stats.
   printf("Decoding time:\n");
@@ -35,6 +35,13 @@ struct FrameStatistic {
   // H264 specific.
   rtc::Optional<size_t> max_nalu_length;
 
+  // VP9 SVC specific. The spatial layers of a frame are encoded one after the
+  // other; the encode time of a layer is counted from the end of the layer
+  // below it.
+  int num_spatial_layers = 1;
+  int spatial_layer_encode_time_us[kMaxSpatialLayers] = {0};
+  size_t spatial_layer_size_bytes[kMaxSpatialLayers] = {0};
+
   // Decoding.
   int64_t decode_start_ns = 0;
   int decode_return_code = 0;
@@ -66,6 +73,10 @@ class Stats {
 
   size_t size() const;
 
+  // Returns the average encode time of |spatial_idx| over the frames that
+  // have it, or 0 if none has.
+  int AverageSpatialLayerEncodeTimeUs(int spatial_idx) const;
+
   // TODO(brandtr): Add output as CSV.
   void PrintSummary() const;
 
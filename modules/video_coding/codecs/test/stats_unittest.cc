@@ -39,5 +39,21 @@ TEST(StatsTest, AddMultipleFrames) {
   stats.PrintSummary();  // Should not crash.
 }
 
+TEST(StatsTest, AverageSpatialLayerEncodeTime) {
+  Stats stats;
+  for (int i = 0; i < 4; ++i) {
+    FrameStatistic* frame_stat = stats.AddFrame();
+    frame_stat->num_spatial_layers = (i == 3) ? 1 : 2;
+    frame_stat->spatial_layer_encode_time_us[0] = 1000 * (i + 1);
+    frame_stat->spatial_layer_encode_time_us[1] = 3000;
+  }
+  EXPECT_EQ(2500, stats.AverageSpatialLayerEncodeTimeUs(0));
+  // The last frame has no second layer.
+  EXPECT_EQ(3000, stats.AverageSpatialLayerEncodeTimeUs(1));
+  EXPECT_EQ(0, stats.AverageSpatialLayerEncodeTimeUs(2));
+
+  stats.PrintSummary();  // Should not crash.
+}
+
 }  // namespace test
 }  // namespace webrtc
@@ -174,6 +174,8 @@ VideoProcessor::VideoProcessor(webrtc::VideoEncoder* encoder,
       last_encoded_frame_num_(-1),
       last_decoded_frame_num_(-1),
       first_key_frame_has_been_excluded_(false),
+      superframe_type_(kVideoFrameDelta),
+      last_layer_encode_stop_ns_(0),
       last_decoded_frame_buffer_(analysis_frame_reader->FrameLength()),
       stats_(stats),
       rate_update_index_(-1) {
@@ -203,6 +205,8 @@ void VideoProcessor::Init() {
   // Initialize the encoder and decoder.
   uint32_t num_cores =
       config_.use_single_core ? 1 : CpuInfo::DetectNumberOfCores();
+  if (config_.num_cores > 0)
+    num_cores = config_.num_cores;
   RTC_CHECK_EQ(
       encoder_->InitEncode(&config_.codec_settings, num_cores,
                            config_.networking_config.max_payload_size_in_bytes),
@@ -311,8 +315,8 @@ std::vector<int> VideoProcessor::NumberSpatialResizesPerRateUpdate() const {
   return num_spatial_resizes_;
 }
 
-void VideoProcessor::FrameEncoded(webrtc::VideoCodecType codec,
-                                  const EncodedImage& encoded_image) {
+void VideoProcessor::FrameEncoded(const CodecSpecificInfo& codec_specific,
+                                  const EncodedImage& layer_image) {
   RTC_DCHECK_CALLED_SEQUENTIALLY(&sequence_checker_);
 
   // For the highest measurement accuracy of the encode time, the start/stop
@@ -320,11 +324,41 @@ void VideoProcessor::FrameEncoded(webrtc::VideoCodecType codec,
   int64_t encode_stop_ns = rtc::TimeNanos();
 
   // Take the opportunity to verify the QP bitstream parser.
-  VerifyQpParser(encoded_image, config_);
+  VerifyQpParser(layer_image, config_);
+
+  const webrtc::VideoCodecType codec = codec_specific.codecType;
+  const int frame_number = rtp_timestamp_to_frame_num_[layer_image._timeStamp];
+
+  // With VP9 SVC, the encoder delivers the spatial layers of a frame one by
+  // one, from the bottom. Collect them, and carry on with the whole frame once
+  // the top layer is here.
+  EncodedImage encoded_image = layer_image;
+  const CodecSpecificInfoVP9& vp9_info = codec_specific.codecSpecific.VP9;
+  if (codec == kVideoCodecVP9 && vp9_info.num_spatial_layers > 1 &&
+      !vp9_info.flexible_mode) {
+    const int spatial_idx = vp9_info.spatial_idx;
+    RTC_CHECK_LT(spatial_idx, kMaxSpatialLayers);
+    FrameStatistic* frame_stat = stats_->GetFrame(frame_number);
+    if (spatial_idx == 0) {
+      superframe_buffer_.Clear();
+      superframe_type_ = layer_image._frameType;
+      last_layer_encode_stop_ns_ = frame_stat->encode_start_ns;
+    }
+    frame_stat->num_spatial_layers = spatial_idx + 1;
+    frame_stat->spatial_layer_encode_time_us[spatial_idx] =
+        GetElapsedTimeMicroseconds(last_layer_encode_stop_ns_, encode_stop_ns);
+    frame_stat->spatial_layer_size_bytes[spatial_idx] = layer_image._length;
+    last_layer_encode_stop_ns_ = encode_stop_ns;
+    superframe_buffer_.AppendData(layer_image._buffer, layer_image._length);
+    if (spatial_idx + 1 < vp9_info.num_spatial_layers)
+      return;
+    encoded_image._buffer = superframe_buffer_.data();
+    encoded_image._length = superframe_buffer_.size();
+    encoded_image._size = superframe_buffer_.size();
+    encoded_image._frameType = superframe_type_;
+  }
 
   // Check for dropped frames.
-  const int frame_number =
-      rtp_timestamp_to_frame_num_[encoded_image._timeStamp];
   bool last_frame_missing = false;
   if (frame_number > 0) {
     RTC_DCHECK_GE(last_encoded_frame_num_, 0);
@@ -82,6 +82,10 @@ struct TestConfig {
   // If set to false, the maximum number of available cores will be used.
   bool use_single_core = false;
 
+  // If > 0, the number of cores given to the encoder and decoder. Overrides
+  // |use_single_core|.
+  int num_cores = 0;
+
   // If > 0: forces the encoder to create a keyframe every Nth frame.
   // Note that the encoder may create a keyframe in other locations in addition
   // to this setting. Forcing key frames may also affect encoder planning
@@ -184,8 +188,7 @@ class VideoProcessor {
         return Result(Result::OK, 0);
       }
 
-      video_processor_->FrameEncoded(codec_specific_info->codecType,
-                                     encoded_image);
+      video_processor_->FrameEncoded(*codec_specific_info, encoded_image);
       return Result(Result::OK, 0);
     }
 
@@ -203,8 +206,7 @@ class VideoProcessor {
       }
 
       bool Run() override {
-        video_processor_->FrameEncoded(codec_specific_info_.codecType,
-                                       encoded_image_);
+        video_processor_->FrameEncoded(codec_specific_info_, encoded_image_);
         return true;
       }
 
@@ -253,8 +255,9 @@ class VideoProcessor {
     rtc::TaskQueue* const task_queue_;
   };
 
-  // Invoked by the callback adapter when a frame has completed encoding.
-  void FrameEncoded(webrtc::VideoCodecType codec,
+  // Invoked by the callback adapter when a frame, or a spatial layer of a
+  // frame, has completed encoding.
+  void FrameEncoded(const webrtc::CodecSpecificInfo& codec_specific,
                     const webrtc::EncodedImage& encodedImage);
 
   // Invoked by the callback adapter when a frame has completed decoding.
@@ -299,6 +302,12 @@ class VideoProcessor {
   // Keep track of if we have excluded the first key frame from packet loss.
   bool first_key_frame_has_been_excluded_ RTC_GUARDED_BY(sequence_checker_);
 
+  // The spatial layers of the VP9 SVC frame being encoded. Like on a receiver,
+  // they are decoded together once the top layer has been encoded.
+  rtc::Buffer superframe_buffer_ RTC_GUARDED_BY(sequence_checker_);
+  webrtc::FrameType superframe_type_ RTC_GUARDED_BY(sequence_checker_);
+  int64_t last_layer_encode_stop_ns_ RTC_GUARDED_BY(sequence_checker_);
+
   // Keep track of the last successfully decoded frame, since we write that
   // frame to disk when decoding fails.
   rtc::Buffer last_decoded_frame_buffer_ RTC_GUARDED_BY(sequence_checker_);
@@ -0,0 +1,382 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/codecs/test/videoprocessor_benchmark.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "common_video/include/video_frame_buffer.h"
+#include "common_video/libyuv/include/webrtc_libyuv.h"
+#include "media/base/mediaconstants.h"
+#include "media/engine/internaldecoderfactory.h"
+#include "media/engine/internalencoderfactory.h"
+#include "modules/video_coding/codecs/test/packet_manipulator.h"
+#include "modules/video_coding/codecs/test/stats.h"
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/json.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/ptr_util.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/timeutils.h"
+#include "test/testsupport/frame_reader.h"
+#include "test/testsupport/frame_writer.h"
+#include "test/testsupport/packet_reader.h"
+
+namespace webrtc {
+namespace test {
+
+namespace {
+
+// Hands out the frames of the frame cache.
+class CachedFrameReader : public FrameReader {
+ public:
+  CachedFrameReader(const std::vector<rtc::scoped_refptr<I420Buffer>>* frames,
+                    int width,
+                    int height)
+      : frames_(frames),
+        frame_length_(CalcBufferSize(VideoType::kI420, width, height)) {}
+
+  bool Init() override { return true; }
+  rtc::scoped_refptr<I420Buffer> ReadFrame() override {
+    if (next_frame_ >= frames_->size())
+      return nullptr;
+    return (*frames_)[next_frame_++];
+  }
+  void Close() override {}
+  size_t FrameLength() override { return frame_length_; }
+  int NumberOfFrames() override { return static_cast<int>(frames_->size()); }
+
+ private:
+  const std::vector<rtc::scoped_refptr<I420Buffer>>* const frames_;
+  const size_t frame_length_;
+  size_t next_frame_ = 0;
+};
+
+// Compares the decoded frames written by the VideoProcessor with the input
+// frames, instead of writing them to a file for I420MetricsFromFiles().
+class QualityAnalyzingFrameWriter : public FrameWriter {
+ public:
+  QualityAnalyzingFrameWriter(
+      const std::vector<rtc::scoped_refptr<I420Buffer>>* reference_frames,
+      int width,
+      int height)
+      : reference_frames_(reference_frames), width_(width), height_(height) {}
+
+  bool Init() override { return true; }
+  bool WriteFrame(uint8_t* frame_buffer) override {
+    if (num_frames_ >= reference_frames_->size())
+      return false;
+    const int chroma_width = (width_ + 1) / 2;
+    const uint8_t* y = frame_buffer;
+    const uint8_t* u = y + width_ * height_;
+    const uint8_t* v = u + chroma_width * ((height_ + 1) / 2);
+    // The frame is only used during this call, so it needn't be copied.
+    rtc::scoped_refptr<I420BufferInterface> frame =
+        WrapI420Buffer(width_, height_, y, width_, u, chroma_width, v,
+                       chroma_width, rtc::Callback0<void>());
+    const I420Buffer& reference = *(*reference_frames_)[num_frames_++];
+    const double psnr = I420PSNR(reference, *frame);
+    const double ssim = I420SSIM(reference, *frame);
+    sum_psnr_ += psnr;
+    sum_ssim_ += ssim;
+    min_psnr_ = std::min(min_psnr_, psnr);
+    min_ssim_ = std::min(min_ssim_, ssim);
+    return true;
+  }
+  void Close() override {}
+  size_t FrameLength() override {
+    return CalcBufferSize(VideoType::kI420, width_, height_);
+  }
+
+  void GetMetrics(RateDistortionPoint* point) const {
+    point->num_decoded_frames = static_cast<int>(num_frames_);
+    if (num_frames_ == 0)
+      return;
+    point->avg_psnr = sum_psnr_ / num_frames_;
+    point->min_psnr = min_psnr_;
+    point->avg_ssim = sum_ssim_ / num_frames_;
+    point->min_ssim = min_ssim_;
+  }
+
+ private:
+  const std::vector<rtc::scoped_refptr<I420Buffer>>* const reference_frames_;
+  const int width_;
+  const int height_;
+  size_t num_frames_ = 0;
+  double sum_psnr_ = 0.0;
+  double sum_ssim_ = 0.0;
+  double min_psnr_ = kPerfectPSNR;
+  double min_ssim_ = 1.0;
+};
+
+cricket::VideoCodec CreateCricketCodec(const TestConfig& config) {
+  switch (config.codec_settings.codecType) {
+    case kVideoCodecVP8:
+      return cricket::VideoCodec(cricket::kVp8CodecName);
+    case kVideoCodecVP9:
+      return cricket::VideoCodec(cricket::kVp9CodecName);
+    case kVideoCodecH264: {
+      cricket::VideoCodec codec(cricket::kH264CodecName);
+      codec.SetParam(cricket::kH264FmtpPacketizationMode,
+                     config.packetization_mode ==
+                             H264PacketizationMode::NonInterleaved
+                         ? "1"
+                         : "0");
+      return codec;
+    }
+    default:
+      RTC_NOTREACHED();
+      return cricket::VideoCodec();
+  }
+}
+
+double FramesPerSecond(int num_frames, int64_t total_time_us) {
+  if (total_time_us <= 0)
+    return 0.0;
+  return num_frames * static_cast<double>(rtc::kNumMicrosecsPerSec) /
+         total_time_us;
+}
+
+}  // namespace
+
+VideoProcessorBenchmark::VideoProcessorBenchmark(int num_threads)
+    : num_threads_(std::max(num_threads, 1)) {}
+
+VideoProcessorBenchmark::~VideoProcessorBenchmark() = default;
+
+std::vector<BenchmarkResult> VideoProcessorBenchmark::Run(
+    const std::vector<BenchmarkConfig>& configs) {
+  std::vector<BenchmarkResult> results(configs.size());
+  jobs_.clear();
+  for (size_t i = 0; i < configs.size(); ++i) {
+    const BenchmarkConfig& config = configs[i];
+    LoadFrames(config.test_config);
+    BenchmarkResult& result = results[i];
+    result.label = config.label;
+    result.codec_type = config.test_config.codec_settings.codecType;
+    result.width = config.test_config.codec_settings.width;
+    result.height = config.test_config.codec_settings.height;
+    result.framerate_fps = config.framerate_fps;
+    result.points.resize(config.bitrates_kbps.size());
+    for (size_t j = 0; j < config.bitrates_kbps.size(); ++j)
+      jobs_.push_back({&config, config.bitrates_kbps[j], &result.points[j]});
+  }
+
+  {
+    rtc::CritScope lock(&lock_);
+    next_job_ = 0;
+  }
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  const int num_threads =
+      std::min(num_threads_, std::max(static_cast<int>(jobs_.size()), 1));
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back(
+        new rtc::PlatformThread(&WorkerThread, this, "VidProcBenchmark"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+  jobs_.clear();
+  return results;
+}
+
+void VideoProcessorBenchmark::WriteResults(
+    FILE* output,
+    const std::vector<BenchmarkResult>& results) {
+  // The labels are chosen by the caller, so let JsonCpp escape them.
+  Json::Value configurations(Json::arrayValue);
+  for (const BenchmarkResult& result : results) {
+    Json::Value configuration(Json::objectValue);
+    configuration["label"] = result.label;
+    configuration["codec"] = CodecTypeToPayloadString(result.codec_type);
+    configuration["width"] = result.width;
+    configuration["height"] = result.height;
+    configuration["framerate"] = result.framerate_fps;
+    Json::Value points(Json::arrayValue);
+    for (const RateDistortionPoint& point : result.points) {
+      Json::Value json_point(Json::objectValue);
+      json_point["target_kbps"] = point.target_kbps;
+      json_point["actual_kbps"] = point.actual_kbps;
+      json_point["decoded_frames"] = point.num_decoded_frames;
+      json_point["dropped_frames"] = point.num_dropped_frames;
+      json_point["avg_psnr"] = point.avg_psnr;
+      json_point["min_psnr"] = point.min_psnr;
+      json_point["avg_ssim"] = point.avg_ssim;
+      json_point["min_ssim"] = point.min_ssim;
+      json_point["encode_fps"] = point.encode_fps;
+      json_point["decode_fps"] = point.decode_fps;
+      Json::Value encode_times_us(Json::arrayValue);
+      for (int encode_time_us : point.spatial_layer_encode_time_us)
+        encode_times_us.append(encode_time_us);
+      json_point["spatial_layer_encode_time_us"] = encode_times_us;
+      points.append(json_point);
+    }
+    configuration["points"] = points;
+    configurations.append(configuration);
+  }
+  Json::Value json(Json::objectValue);
+  json["configurations"] = configurations;
+  const std::string output_string = Json::StyledWriter().write(json);
+  fwrite(output_string.data(), 1, output_string.size(), output);
+}
+
+void VideoProcessorBenchmark::WorkerThread(void* obj) {
+  static_cast<VideoProcessorBenchmark*>(obj)->RunJobs();
+}
+
+void VideoProcessorBenchmark::RunJobs() {
+  while (true) {
+    size_t job_index;
+    {
+      rtc::CritScope lock(&lock_);
+      if (next_job_ == jobs_.size())
+        return;
+      job_index = next_job_++;
+    }
+    const Job& job = jobs_[job_index];
+    *job.result = RunJob(*job.config, job.bitrate_kbps);
+  }
+}
+
+RateDistortionPoint VideoProcessorBenchmark::RunJob(
+    const BenchmarkConfig& config,
+    int bitrate_kbps) const {
+  TestConfig test_config = config.test_config;
+  if (num_threads_ > 1 && test_config.num_cores == 0)
+    test_config.use_single_core = true;
+  test_config.codec_settings.minBitrate = 0;
+  test_config.codec_settings.startBitrate = bitrate_kbps;
+  test_config.codec_settings.maxFramerate = config.framerate_fps;
+  const int width = test_config.codec_settings.width;
+  const int height = test_config.codec_settings.height;
+
+  const Frames& frames = frame_cache_.at(GetFrameCacheKey(test_config)).frames;
+  const int num_frames =
+      std::min(test_config.num_frames, static_cast<int>(frames.size()));
+  CachedFrameReader frame_reader(&frames, width, height);
+  QualityAnalyzingFrameWriter frame_writer(&frames, width, height);
+
+  const cricket::VideoCodec codec = CreateCricketCodec(test_config);
+  cricket::InternalEncoderFactory encoder_factory;
+  cricket::InternalDecoderFactory decoder_factory;
+  std::unique_ptr<VideoEncoder> encoder(
+      encoder_factory.CreateVideoEncoder(codec));
+  std::unique_ptr<VideoDecoder> decoder(
+      decoder_factory.CreateVideoDecoderWithParams(
+          codec, cricket::VideoDecoderParams()));
+  RTC_CHECK(encoder) << "Encoder not successfully created.";
+  RTC_CHECK(decoder) << "Decoder not successfully created.";
+
+  PacketReader packet_reader;
+  PacketManipulatorImpl packet_manipulator(
+      &packet_reader, test_config.networking_config, test_config.verbose);
+  Stats stats;
+  std::unique_ptr<VideoProcessor> processor;
+  std::vector<int> num_dropped_frames;
+
+  // As in VideoProcessorIntegrationTest, everything runs on a task queue.
+  rtc::TaskQueue task_queue("VidProcBenchmark TQ");
+  rtc::Event done(false, false);
+  task_queue.PostTask([&] {
+    processor = rtc::MakeUnique<VideoProcessor>(
+        encoder.get(), decoder.get(), &frame_reader, &frame_writer,
+        &packet_manipulator, test_config, &stats, nullptr, nullptr);
+    processor->Init();
+    processor->SetRates(bitrate_kbps, config.framerate_fps);
+  });
+  // One task per frame, so that codec callbacks posted back to the task queue
+  // run in between.
+  for (int i = 0; i < num_frames; ++i)
+    task_queue.PostTask([&processor] { processor->ProcessFrame(); });
+  task_queue.PostTask([&] {
+    processor->Release();
+    num_dropped_frames = processor->NumberDroppedFramesPerRateUpdate();
+    processor.reset();
+    done.Set();
+  });
+  done.Wait(rtc::Event::kForever);
+
+  RateDistortionPoint point;
+  point.target_kbps = bitrate_kbps;
+  frame_writer.GetMetrics(&point);
+  for (int dropped_frames : num_dropped_frames)
+    point.num_dropped_frames += dropped_frames;
+
+  size_t encoded_bytes = 0;
+  int num_encoded_frames = 0;
+  int num_decoded_frames = 0;
+  int64_t encode_time_us = 0;
+  int64_t decode_time_us = 0;
+  for (size_t i = 0; i < stats.size(); ++i) {
+    const FrameStatistic* frame_stat = stats.GetFrame(static_cast<int>(i));
+    encoded_bytes += frame_stat->encoded_frame_size_bytes;
+    if (frame_stat->encoding_successful) {
+      ++num_encoded_frames;
+      encode_time_us += frame_stat->encode_time_us;
+    }
+    if (frame_stat->decoding_successful) {
+      ++num_decoded_frames;
+      decode_time_us += frame_stat->decode_time_us;
+    }
+  }
+  if (num_frames > 0) {
+    point.actual_kbps = encoded_bytes * 8.0 * config.framerate_fps /
+                        (num_frames * 1000.0);
+  }
+  point.encode_fps = FramesPerSecond(num_encoded_frames, encode_time_us);
+  point.decode_fps = FramesPerSecond(num_decoded_frames, decode_time_us);
+  if (test_config.codec_settings.codecType == kVideoCodecVP9) {
+    const int num_spatial_layers =
+        test_config.codec_settings.VP9()->numberOfSpatialLayers;
+    for (int i = 0; num_spatial_layers > 1 && i < num_spatial_layers; ++i) {
+      point.spatial_layer_encode_time_us.push_back(
+          stats.AverageSpatialLayerEncodeTimeUs(i));
+    }
+  }
+  return point;
+}
+
+void VideoProcessorBenchmark::LoadFrames(const TestConfig& test_config) {
+  CachedFrames* cached = &frame_cache_[GetFrameCacheKey(test_config)];
+  Frames* frames = &cached->frames;
+  if (cached->end_of_file ||
+      static_cast<int>(frames->size()) >= test_config.num_frames) {
+    return;
+  }
+  YuvFrameReaderImpl frame_reader(test_config.input_filename,
+                                  test_config.codec_settings.width,
+                                  test_config.codec_settings.height);
+  RTC_CHECK(frame_reader.Init())
+      << "Failed to open " << test_config.input_filename;
+  // The reader can't seek, so read past the frames that are cached already.
+  for (int i = 0; i < test_config.num_frames; ++i) {
+    rtc::scoped_refptr<I420Buffer> frame = frame_reader.ReadFrame();
+    if (!frame) {
+      cached->end_of_file = true;
+      break;
+    }
+    if (i >= static_cast<int>(frames->size()))
+      frames->push_back(frame);
+  }
+  frame_reader.Close();
+}
+
+VideoProcessorBenchmark::FrameCacheKey
+VideoProcessorBenchmark::GetFrameCacheKey(const TestConfig& test_config) {
+  return FrameCacheKey(test_config.input_filename,
+                       test_config.codec_settings.width,
+                       test_config.codec_settings.height);
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_VIDEO_CODING_CODECS_TEST_VIDEOPROCESSOR_BENCHMARK_H_
+#define MODULES_VIDEO_CODING_CODECS_TEST_VIDEOPROCESSOR_BENCHMARK_H_
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "api/video/i420_buffer.h"
+#include "common_types.h"  // NOLINT(build/include)
+#include "modules/video_coding/codecs/test/videoprocessor.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/scoped_ref_ptr.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+namespace test {
+
+// One codec configuration to benchmark, encoded at each of |bitrates_kbps|.
+struct BenchmarkConfig {
+  // Identifies the configuration in the results, e.g. "vp8_tl3_denoising".
+  std::string label;
+  // The input file, number of frames, codec settings and so on. The
+  // |output_filename| is not used: the decoded frames are compared with the
+  // input frames in memory.
+  TestConfig test_config;
+  int framerate_fps = 30;
+  std::vector<int> bitrates_kbps;
+};
+
+// The result of encoding one configuration at one bitrate.
+struct RateDistortionPoint {
+  int target_kbps = 0;
+  double actual_kbps = 0.0;
+  int num_decoded_frames = 0;
+  int num_dropped_frames = 0;
+  double avg_psnr = 0.0;
+  double min_psnr = 0.0;
+  double avg_ssim = 0.0;
+  double min_ssim = 0.0;
+  // Frames per second of encoding and decoding time, i.e. excluding the time
+  // spent reading, comparing and waiting for frames.
+  double encode_fps = 0.0;
+  double decode_fps = 0.0;
+  // Average encode time of each spatial layer, for VP9 SVC.
+  std::vector<int> spatial_layer_encode_time_us;
+};
+
+// The rate-distortion curve of one configuration, in order of
+// |BenchmarkConfig::bitrates_kbps|.
+struct BenchmarkResult {
+  std::string label;
+  VideoCodecType codec_type = kVideoCodecUnknown;
+  int width = 0;
+  int height = 0;
+  int framerate_fps = 0;
+  std::vector<RateDistortionPoint> points;
+};
+
+// Runs many VideoProcessor configurations, e.g. a sweep over codecs, temporal
+// layers, resolutions and denoising settings, on a pool of threads.
+//
+// Every (configuration, bitrate) pair is an independent job: it gets its own
+// software encoder, decoder, packet manipulator and task queue, and the
+// configured number of frames is processed as fast as possible. The input
+// frames of all configurations are read once, before any job starts, and
+// shared between the jobs; the decoded frames are compared with them in
+// memory instead of being written to disk.
+//
+// Since the jobs run in parallel, each encoder and decoder is restricted to a
+// single core when more than one thread is used, unless
+// |TestConfig::num_cores| says otherwise.
+class VideoProcessorBenchmark {
+ public:
+  explicit VideoProcessorBenchmark(int num_threads);
+  ~VideoProcessorBenchmark();
+
+  // Blocks until all configurations have been run.
+  std::vector<BenchmarkResult> Run(const std::vector<BenchmarkConfig>& configs);
+
+  // Writes |results| to |output| as a JSON object with one rate-distortion
+  // curve per configuration.
+  static void WriteResults(FILE* output,
+                           const std::vector<BenchmarkResult>& results);
+
+ private:
+  using Frames = std::vector<rtc::scoped_refptr<I420Buffer>>;
+
+  // The same file may be read at several resolutions.
+  using FrameCacheKey = std::tuple<std::string, int, int>;
+  struct CachedFrames {
+    Frames frames;
+    // Set once the whole file has been read, so that files with fewer
+    // frames than asked for are not read again for every configuration.
+    bool end_of_file = false;
+  };
+
+  struct Job {
+    const BenchmarkConfig* config;
+    int bitrate_kbps;
+    RateDistortionPoint* result;
+  };
+
+  static void WorkerThread(void* obj);
+  void RunJobs();
+  RateDistortionPoint RunJob(const BenchmarkConfig& config,
+                             int bitrate_kbps) const;
+  void LoadFrames(const TestConfig& test_config);
+  static FrameCacheKey GetFrameCacheKey(const TestConfig& test_config);
+
+  const int num_threads_;
+  // Input frames, read and converted to I420Buffers once for all jobs and
+  // calls to Run(). Only written to before the jobs are started.
+  std::map<FrameCacheKey, CachedFrames> frame_cache_;
+
+  rtc::CriticalSection lock_;
+  std::vector<Job> jobs_;
+  size_t next_job_ RTC_GUARDED_BY(lock_) = 0;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(VideoProcessorBenchmark);
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // MODULES_VIDEO_CODING_CODECS_TEST_VIDEOPROCESSOR_BENCHMARK_H_
@@ -0,0 +1,125 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/codecs/test/videoprocessor_benchmark.h"
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "test/gtest.h"
+#include "test/testsupport/fileutils.h"
+#include "test/video_codec_settings.h"
+
+namespace webrtc {
+namespace test {
+
+namespace {
+
+const int kNumFrames = 30;
+const int kNumThreads = 4;
+
+BenchmarkConfig CreateConfig(VideoCodecType codec_type,
+                             int num_temporal_layers,
+                             bool denoising_on) {
+  BenchmarkConfig config;
+  config.label = std::string(CodecTypeToPayloadString(codec_type)) + "_tl" +
+                 std::to_string(num_temporal_layers) +
+                 (denoising_on ? "_denoising" : "");
+  config.framerate_fps = 30;
+  config.bitrates_kbps = {100, 300, 700};
+
+  TestConfig& test_config = config.test_config;
+  test_config.filename = "foreman_176x144";
+  test_config.input_filename = ResourcePath(test_config.filename, "yuv");
+  test_config.num_frames = kNumFrames;
+  test_config.verbose = false;
+  CodecSettings(codec_type, &test_config.codec_settings);
+  test_config.codec_settings.width = 176;
+  test_config.codec_settings.height = 144;
+  if (codec_type == kVideoCodecVP8) {
+    test_config.codec_settings.VP8()->numberOfTemporalLayers =
+        num_temporal_layers;
+    test_config.codec_settings.VP8()->denoisingOn = denoising_on;
+  } else if (codec_type == kVideoCodecVP9) {
+    test_config.codec_settings.VP9()->numberOfTemporalLayers =
+        num_temporal_layers;
+    test_config.codec_settings.VP9()->denoisingOn = denoising_on;
+  }
+  return config;
+}
+
+}  // namespace
+
+// Sweeps a few VP8 and VP9 settings in parallel, and writes the
+// rate-distortion curves to the output directory.
+TEST(VideoProcessorBenchmarkTest, SweepsConfigurationsInParallel) {
+  std::vector<BenchmarkConfig> configs = {
+      CreateConfig(kVideoCodecVP8, 1, false),
+      CreateConfig(kVideoCodecVP8, 3, false),
+      CreateConfig(kVideoCodecVP8, 1, true),
+      CreateConfig(kVideoCodecVP9, 1, false)};
+
+  VideoProcessorBenchmark benchmark(kNumThreads);
+  std::vector<BenchmarkResult> results = benchmark.Run(configs);
+
+  ASSERT_EQ(configs.size(), results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    EXPECT_EQ(configs[i].label, result.label);
+    ASSERT_EQ(configs[i].bitrates_kbps.size(), result.points.size());
+    for (size_t j = 0; j < result.points.size(); ++j) {
+      const RateDistortionPoint& point = result.points[j];
+      EXPECT_EQ(configs[i].bitrates_kbps[j], point.target_kbps);
+      EXPECT_GT(point.num_decoded_frames, 0) << result.label;
+      EXPECT_GT(point.avg_psnr, 25.0) << result.label;
+      EXPECT_GT(point.encode_fps, 0.0) << result.label;
+      EXPECT_GT(point.decode_fps, 0.0) << result.label;
+      // More bits should not give a noticeably worse quality.
+      if (j > 0)
+        EXPECT_GT(point.avg_psnr, result.points[j - 1].avg_psnr - 0.5);
+    }
+  }
+
+  const std::string results_filename =
+      OutputPath() + "videoprocessor_benchmark.json";
+  FILE* results_file = fopen(results_filename.c_str(), "w");
+  ASSERT_TRUE(results_file);
+  VideoProcessorBenchmark::WriteResults(results_file, results);
+  fclose(results_file);
+}
+
+TEST(VideoProcessorBenchmarkTest, WriteResultsEscapesLabels) {
+  BenchmarkResult result;
+  result.label = "quote\" backslash\\";
+  result.codec_type = kVideoCodecVP8;
+  result.points.resize(1);
+
+  const std::string results_filename =
+      TempFilename(OutputPath(), "videoprocessor_benchmark_escaping");
+  FILE* results_file = fopen(results_filename.c_str(), "w");
+  ASSERT_TRUE(results_file);
+  VideoProcessorBenchmark::WriteResults(results_file, {result});
+  fclose(results_file);
+
+  std::ifstream json(results_filename);
+  const std::string contents((std::istreambuf_iterator<char>(json)),
+                             std::istreambuf_iterator<char>());
+  EXPECT_NE(std::string::npos,
+            contents.find("\"quote\\\" backslash\\\\\""))
+      << contents;
+  remove(results_filename.c_str());
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+#include <vector>
+
+#include "modules/video_coding/codecs/test/videoprocessor_benchmark.h"
+#include "test/gtest.h"
+#include "test/testsupport/fileutils.h"
+#include "test/testsupport/perf_test.h"
+#include "test/video_codec_settings.h"
+
+namespace webrtc {
+namespace test {
+
+#if !defined(RTC_DISABLE_VP9)
+// Encodes 720p VP9 with three spatial layers, giving the encoder 1 to 8
+// cores, and reports the encode fps and the time spent on each spatial layer.
+// The configurations run one at a time so that they don't compete for cores.
+TEST(VideoProcessorBenchmarkPerformanceTest, Vp9SvcEncodeFpsPerNumberOfCores) {
+  const int kNumSpatialLayers = 3;
+  std::vector<BenchmarkConfig> configs;
+  for (int num_cores : {1, 2, 4, 8}) {
+    BenchmarkConfig config;
+    config.label = "vp9_svc3_cores" + std::to_string(num_cores);
+    config.framerate_fps = 30;
+    config.bitrates_kbps = {1500};
+    TestConfig& test_config = config.test_config;
+    test_config.filename = "ConferenceMotion_1280_720_50";
+    test_config.input_filename = ResourcePath(test_config.filename, "yuv");
+    test_config.num_frames = 30;
+    test_config.num_cores = num_cores;
+    test_config.verbose = false;
+    CodecSettings(kVideoCodecVP9, &test_config.codec_settings);
+    test_config.codec_settings.width = 1280;
+    test_config.codec_settings.height = 720;
+    test_config.codec_settings.maxBitrate = 2000;
+    test_config.codec_settings.VP9()->numberOfTemporalLayers = 1;
+    test_config.codec_settings.VP9()->denoisingOn = false;
+    test_config.codec_settings.VP9()->numberOfSpatialLayers =
+        kNumSpatialLayers;
+    configs.push_back(config);
+  }
+
+  VideoProcessorBenchmark benchmark(1);
+  std::vector<BenchmarkResult> results = benchmark.Run(configs);
+
+  ASSERT_EQ(configs.size(), results.size());
+  for (const BenchmarkResult& result : results) {
+    ASSERT_EQ(1u, result.points.size());
+    const RateDistortionPoint& point = result.points[0];
+    EXPECT_GT(point.num_decoded_frames, 0) << result.label;
+    EXPECT_GT(point.avg_psnr, 30.0) << result.label;
+    PrintResult("vp9_svc_encode_fps", "", result.label,
+                static_cast<size_t>(point.encode_fps), "fps", false);
+    ASSERT_EQ(static_cast<size_t>(kNumSpatialLayers),
+              point.spatial_layer_encode_time_us.size());
+    for (int i = 0; i < kNumSpatialLayers; ++i) {
+      PrintResult("vp9_svc_layer_encode_time", "_sl" + std::to_string(i),
+                  result.label,
+                  static_cast<size_t>(point.spatial_layer_encode_time_us[i]),
+                  "us", false);
+    }
+  }
+}
+#endif  // !defined(RTC_DISABLE_VP9)
+
+}  // namespace test
+}  // namespace webrtc
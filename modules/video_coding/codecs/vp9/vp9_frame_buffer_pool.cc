@@ -15,12 +15,136 @@
 #include "vpx/vpx_decoder.h"
 #include "vpx/vpx_frame_buffer.h"
 
+#include "rtc_base/atomicops.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
-#include "rtc_base/refcountedobject.h"
 
 namespace webrtc {
 
+namespace {
+
+// Free buffers are grouped in size classes, four per octave from 4 KiB, so a
+// recycled buffer is at most 25 % larger than needed.
+const size_t kMinSizeClassBytes = 4096;
+const int kNumSizeClasses = 4 * 14;
+// A decoder holds on to at most 8 reference buffers, plus the frames being
+// decoded and rendered.
+const int kMaxFreeBuffersPerSizeClass = 12;
+
+size_t SizeClassBytes(int size_class) {
+  const size_t octave_bytes = kMinSizeClassBytes << (size_class / 4);
+  return octave_bytes + octave_bytes / 4 * (size_class % 4);
+}
+
+// Returns -1 if |size| is larger than the largest size class; such buffers
+// are not recycled.
+int SizeClass(size_t size) {
+  for (int size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+    if (size <= SizeClassBytes(size_class))
+      return size_class;
+  }
+  return -1;
+}
+
+}  // namespace
+
+// Each size class has a fixed number of slots for free buffers. A buffer is
+// pushed by swapping it into an empty slot, and popped by swapping a non-empty
+// slot with null, so no locks are needed and a buffer can't be handed out
+// twice.
+class Vp9FrameBufferPool::FreeLists {
+ public:
+  FreeLists() {
+    for (auto& free_list : free_lists_) {
+      for (auto& slot : free_list)
+        slot = nullptr;
+    }
+  }
+
+  void AddRef() { rtc::AtomicOps::Increment(&ref_count_); }
+  void Release() {
+    if (rtc::AtomicOps::Decrement(&ref_count_) == 0)
+      delete this;
+  }
+
+  // Returns a free buffer of |size_class|, or null.
+  Vp9FrameBuffer* Pop(int size_class) {
+    for (Vp9FrameBuffer* volatile& slot : free_lists_[size_class]) {
+      Vp9FrameBuffer* buffer = rtc::AtomicOps::AcquireLoadPtr(&slot);
+      if (buffer &&
+          rtc::AtomicOps::CompareAndSwapPtr(&slot, buffer,
+                                            static_cast<Vp9FrameBuffer*>(
+                                                nullptr)) == buffer) {
+        return buffer;
+      }
+    }
+    return nullptr;
+  }
+
+  // Called when the last reference to |buffer| has been released.
+  void Return(Vp9FrameBuffer* buffer) {
+    rtc::AtomicOps::Decrement(&num_buffers_in_use_);
+    if (rtc::AtomicOps::AcquireLoad(&closed_) || buffer->size_class_ < 0 ||
+        !Push(buffer)) {
+      Delete(buffer);
+    }
+  }
+
+  // Deletes all free buffers, and with |close| also the buffers returned
+  // from now on.
+  void Clear(bool close) {
+    if (close)
+      rtc::AtomicOps::ReleaseStore(&closed_, 1);
+    for (int size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+      while (Vp9FrameBuffer* buffer = Pop(size_class))
+        Delete(buffer);
+    }
+  }
+
+  Vp9FrameBuffer* Create(int size_class, size_t min_size) {
+    rtc::AtomicOps::Increment(&num_buffers_);
+    return new Vp9FrameBuffer(
+        this, size_class,
+        size_class >= 0 ? SizeClassBytes(size_class) : min_size);
+  }
+
+  volatile int num_buffers_ = 0;
+  volatile int num_buffers_in_use_ = 0;
+  volatile int num_requests_ = 0;
+  volatile int num_reused_ = 0;
+
+ private:
+  ~FreeLists() { Clear(true); }
+
+  bool Push(Vp9FrameBuffer* buffer) {
+    for (Vp9FrameBuffer* volatile& slot : free_lists_[buffer->size_class_]) {
+      if (rtc::AtomicOps::CompareAndSwapPtr(
+              &slot, static_cast<Vp9FrameBuffer*>(nullptr), buffer) ==
+          nullptr) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Delete(Vp9FrameBuffer* buffer) {
+    rtc::AtomicOps::Decrement(&num_buffers_);
+    delete buffer;
+  }
+
+  Vp9FrameBuffer* volatile free_lists_[kNumSizeClasses]
+                                      [kMaxFreeBuffersPerSizeClass];
+  volatile int ref_count_ = 1;
+  volatile int closed_ = 0;
+};
+
+Vp9FrameBufferPool::Vp9FrameBuffer::Vp9FrameBuffer(FreeLists* free_lists,
+                                                   int size_class,
+                                                   size_t capacity)
+    : free_lists_(free_lists), size_class_(size_class), data_(0, capacity) {}
+
+Vp9FrameBufferPool::Vp9FrameBuffer::~Vp9FrameBuffer() = default;
+
 uint8_t* Vp9FrameBufferPool::Vp9FrameBuffer::GetData() {
   return data_.data<uint8_t>();
 }
@@ -33,6 +157,32 @@ void Vp9FrameBufferPool::Vp9FrameBuffer::SetSize(size_t size) {
   data_.SetSize(size);
 }
 
+int Vp9FrameBufferPool::Vp9FrameBuffer::AddRef() const {
+  return rtc::AtomicOps::Increment(&ref_count_);
+}
+
+int Vp9FrameBufferPool::Vp9FrameBuffer::Release() const {
+  const int count = rtc::AtomicOps::Decrement(&ref_count_);
+  if (count == 0) {
+    // The buffer may be deleted by Return(), and the free lists by Release().
+    FreeLists* free_lists = free_lists_;
+    free_lists->Return(const_cast<Vp9FrameBuffer*>(this));
+    free_lists->Release();
+  }
+  return count;
+}
+
+bool Vp9FrameBufferPool::Vp9FrameBuffer::HasOneRef() const {
+  return rtc::AtomicOps::AcquireLoad(&ref_count_) == 1;
+}
+
+Vp9FrameBufferPool::Vp9FrameBufferPool() : free_lists_(new FreeLists()) {}
+
+Vp9FrameBufferPool::~Vp9FrameBufferPool() {
+  free_lists_->Clear(true);
+  free_lists_->Release();
+}
+
 bool Vp9FrameBufferPool::InitializeVpxUsePool(
     vpx_codec_ctx* vpx_codec_context) {
   RTC_DCHECK(vpx_codec_context);
@@ -55,50 +205,54 @@ bool Vp9FrameBufferPool::InitializeVpxUsePool(
 rtc::scoped_refptr<Vp9FrameBufferPool::Vp9FrameBuffer>
 Vp9FrameBufferPool::GetFrameBuffer(size_t min_size) {
   RTC_DCHECK_GT(min_size, 0);
-  rtc::scoped_refptr<Vp9FrameBuffer> available_buffer = nullptr;
-  {
-    rtc::CritScope cs(&buffers_lock_);
-    // Do we have a buffer we can recycle?
-    for (const auto& buffer : allocated_buffers_) {
-      if (buffer->HasOneRef()) {
-        available_buffer = buffer;
-        break;
-      }
-    }
+  rtc::AtomicOps::Increment(&free_lists_->num_requests_);
+  const int size_class = SizeClass(min_size);
+  // Do we have a buffer we can recycle?
+  Vp9FrameBuffer* buffer =
+      size_class >= 0 ? free_lists_->Pop(size_class) : nullptr;
+  if (buffer) {
+    rtc::AtomicOps::Increment(&free_lists_->num_reused_);
+  } else {
     // Otherwise create one.
-    if (available_buffer == nullptr) {
-      available_buffer = new rtc::RefCountedObject<Vp9FrameBuffer>();
-      allocated_buffers_.push_back(available_buffer);
-      if (allocated_buffers_.size() > max_num_buffers_) {
-        LOG(LS_WARNING)
-            << allocated_buffers_.size() << " Vp9FrameBuffers have been "
-            << "allocated by a Vp9FrameBufferPool (exceeding what is "
-            << "considered reasonable, " << max_num_buffers_ << ").";
-
-        // TODO(phoglund): this limit is being hit in tests since Oct 5 2016.
-        // See https://bugs.chromium.org/p/webrtc/issues/detail?id=6484.
-        // RTC_NOTREACHED();
-      }
+    buffer = free_lists_->Create(size_class, min_size);
+    const int num_buffers =
+        rtc::AtomicOps::AcquireLoad(&free_lists_->num_buffers_);
+    if (static_cast<size_t>(num_buffers) > max_num_buffers_) {
+      LOG(LS_WARNING) << num_buffers << " Vp9FrameBuffers have been "
+                      << "allocated by a Vp9FrameBufferPool (exceeding what "
+                      << "is considered reasonable, " << max_num_buffers_
+                      << ").";
+
+      // TODO(phoglund): this limit is being hit in tests since Oct 5 2016.
+      // See https://bugs.chromium.org/p/webrtc/issues/detail?id=6484.
+      // RTC_NOTREACHED();
     }
   }
+  // The buffer keeps the free lists alive until it is returned.
+  free_lists_->AddRef();
+  rtc::AtomicOps::Increment(&free_lists_->num_buffers_in_use_);
 
-  available_buffer->SetSize(min_size);
-  return available_buffer;
+  buffer->SetSize(min_size);
+  return buffer;
 }
 
 int Vp9FrameBufferPool::GetNumBuffersInUse() const {
-  int num_buffers_in_use = 0;
-  rtc::CritScope cs(&buffers_lock_);
-  for (const auto& buffer : allocated_buffers_) {
-    if (!buffer->HasOneRef())
-      ++num_buffers_in_use;
-  }
-  return num_buffers_in_use;
+  return rtc::AtomicOps::AcquireLoad(&free_lists_->num_buffers_in_use_);
+}
+
+Vp9FrameBufferPool::Stats Vp9FrameBufferPool::GetStats() const {
+  Stats stats;
+  stats.num_buffers = rtc::AtomicOps::AcquireLoad(&free_lists_->num_buffers_);
+  stats.num_buffers_in_use =
+      rtc::AtomicOps::AcquireLoad(&free_lists_->num_buffers_in_use_);
+  stats.num_requests =
+      rtc::AtomicOps::AcquireLoad(&free_lists_->num_requests_);
+  stats.num_reused = rtc::AtomicOps::AcquireLoad(&free_lists_->num_reused_);
+  return stats;
 }
 
 void Vp9FrameBufferPool::ClearPool() {
-  rtc::CritScope cs(&buffers_lock_);
-  allocated_buffers_.clear();
+  free_lists_->Clear(false);
 }
 
 // static
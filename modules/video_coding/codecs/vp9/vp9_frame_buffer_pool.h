@@ -16,7 +16,7 @@
 
 #include "rtc_base/basictypes.h"
 #include "rtc_base/buffer.h"
-#include "rtc_base/criticalsection.h"
+#include "rtc_base/constructormagic.h"
 #include "rtc_base/refcount.h"
 #include "rtc_base/scoped_ref_ptr.h"
 
@@ -51,7 +51,15 @@ namespace webrtc {
 //
 //    // Destroying the codec will make libvpx release any buffers it was using.
 //    vpx_codec_destroy(decoder_ctx);
+//
+// Free buffers are kept in lock-free free lists, one per size class, so that
+// getting and releasing buffers doesn't contend with other threads and a
+// buffer is only reused for frames of about its size. The number of free
+// buffers per size class is bounded; surplus ones are deleted.
 class Vp9FrameBufferPool {
+ private:
+  class FreeLists;
+
  public:
   class Vp9FrameBuffer : public rtc::RefCountInterface {
    public:
@@ -59,23 +67,51 @@ class Vp9FrameBufferPool {
     size_t GetDataSize() const;
     void SetSize(size_t size);
 
-    virtual bool HasOneRef() const = 0;
+    // rtc::RefCountInterface. When the last reference is released, the
+    // buffer goes back to the free list of its pool.
+    int AddRef() const override;
+    int Release() const override;
+
+    bool HasOneRef() const;
 
    private:
+    friend class Vp9FrameBufferPool;
+    friend class Vp9FrameBufferPool::FreeLists;
+
+    Vp9FrameBuffer(FreeLists* free_lists, int size_class, size_t capacity);
+    ~Vp9FrameBuffer() override;
+
+    FreeLists* const free_lists_;
+    const int size_class_;
+    mutable volatile int ref_count_ = 0;
     // Data as an easily resizable buffer.
     rtc::Buffer data_;
   };
 
+  struct Stats {
+    // Buffers allocated by the pool, in use or free.
+    int num_buffers = 0;
+    int num_buffers_in_use = 0;
+    // Calls to GetFrameBuffer(), and how many of them were served with a free
+    // buffer rather than a new allocation.
+    int num_requests = 0;
+    int num_reused = 0;
+  };
+
+  Vp9FrameBufferPool();
+  ~Vp9FrameBufferPool();
+
   // Configures libvpx to, in the specified context, use this memory pool for
   // buffers used to decompress frames. This is only supported for VP9.
   bool InitializeVpxUsePool(vpx_codec_ctx* vpx_codec_context);
 
   // Gets a frame buffer of at least |min_size|, recycling an available one or
   // creating a new one. When no longer referenced from the outside the buffer
-  // becomes recyclable.
+  // becomes recyclable. Can be called on any thread.
   rtc::scoped_refptr<Vp9FrameBuffer> GetFrameBuffer(size_t min_size);
   // Gets the number of buffers currently in use (not ready to be recycled).
   int GetNumBuffersInUse() const;
+  Stats GetStats() const;
   // Releases allocated buffers, deleting available buffers. Buffers in use are
   // not deleted until they are no longer referenced.
   void ClearPool();
@@ -102,11 +138,8 @@ class Vp9FrameBufferPool {
                                        vpx_codec_frame_buffer* fb);
 
  private:
-  // Protects |allocated_buffers_|.
-  rtc::CriticalSection buffers_lock_;
-  // All buffers, in use or ready to be recycled.
-  std::vector<rtc::scoped_refptr<Vp9FrameBuffer>> allocated_buffers_
-      RTC_GUARDED_BY(buffers_lock_);
+  // Shared with the buffers in use, which may outlive the pool.
+  FreeLists* const free_lists_;
   // If more buffers than this are allocated we print warnings and crash if in
   // debug mode. VP9 is defined to have 8 reference buffers, of which 3 can be
   // referenced by any frame, see
@@ -117,6 +150,8 @@ class Vp9FrameBufferPool {
   // then the application has ~1 second to e.g. render each frame of a 60 fps
   // video.
   static const size_t max_num_buffers_ = 68;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(Vp9FrameBufferPool);
 };
 
 }  // namespace webrtc
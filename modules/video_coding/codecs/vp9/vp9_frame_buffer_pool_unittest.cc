@@ -0,0 +1,160 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/codecs/vp9/vp9_frame_buffer_pool.h"
+
+#include <memory>
+#include <vector>
+
+#include "vpx/vpx_frame_buffer.h"
+
+#include "rtc_base/platform_thread.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+const size_t k720pFrameSize = 1280 * 720 * 3 / 2;
+
+}  // namespace
+
+TEST(Vp9FrameBufferPoolTest, ReusesReleasedBuffers) {
+  Vp9FrameBufferPool pool;
+  rtc::scoped_refptr<Vp9FrameBufferPool::Vp9FrameBuffer> buffer =
+      pool.GetFrameBuffer(k720pFrameSize);
+  EXPECT_EQ(k720pFrameSize, buffer->GetDataSize());
+  EXPECT_EQ(1, pool.GetNumBuffersInUse());
+  const uint8_t* data = buffer->GetData();
+  buffer = nullptr;
+  EXPECT_EQ(0, pool.GetNumBuffersInUse());
+
+  // A slightly different size is in the same size class.
+  buffer = pool.GetFrameBuffer(k720pFrameSize + 1000);
+  EXPECT_EQ(data, buffer->GetData());
+  EXPECT_EQ(k720pFrameSize + 1000, buffer->GetDataSize());
+
+  Vp9FrameBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(1, stats.num_buffers);
+  EXPECT_EQ(1, stats.num_buffers_in_use);
+  EXPECT_EQ(2, stats.num_requests);
+  EXPECT_EQ(1, stats.num_reused);
+}
+
+TEST(Vp9FrameBufferPoolTest, DoesNotReuseBuffersOfOtherSizes) {
+  Vp9FrameBufferPool pool;
+  pool.GetFrameBuffer(k720pFrameSize);
+  // Much smaller and much larger frames get buffers of their own.
+  pool.GetFrameBuffer(k720pFrameSize / 4);
+  pool.GetFrameBuffer(k720pFrameSize * 2);
+  Vp9FrameBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(3, stats.num_buffers);
+  EXPECT_EQ(0, stats.num_reused);
+
+  pool.GetFrameBuffer(k720pFrameSize / 4);
+  EXPECT_EQ(1, pool.GetStats().num_reused);
+  pool.ClearPool();
+  EXPECT_EQ(0, pool.GetStats().num_buffers);
+}
+
+TEST(Vp9FrameBufferPoolTest, BoundsNumberOfFreeBuffers) {
+  Vp9FrameBufferPool pool;
+  std::vector<rtc::scoped_refptr<Vp9FrameBufferPool::Vp9FrameBuffer>> buffers;
+  for (int i = 0; i < 50; ++i)
+    buffers.push_back(pool.GetFrameBuffer(k720pFrameSize));
+  EXPECT_EQ(50, pool.GetStats().num_buffers);
+  buffers.clear();
+  EXPECT_EQ(0, pool.GetNumBuffersInUse());
+  EXPECT_LT(pool.GetStats().num_buffers, 50);
+}
+
+TEST(Vp9FrameBufferPoolTest, BufferInUseOutlivesPool) {
+  rtc::scoped_refptr<Vp9FrameBufferPool::Vp9FrameBuffer> buffer;
+  {
+    Vp9FrameBufferPool pool;
+    buffer = pool.GetFrameBuffer(k720pFrameSize);
+  }
+  buffer->GetData()[k720pFrameSize - 1] = 0;
+  buffer = nullptr;
+}
+
+TEST(Vp9FrameBufferPoolTest, VpxCallbacksKeepBufferInUse) {
+  Vp9FrameBufferPool pool;
+  vpx_codec_frame_buffer fb;
+  EXPECT_EQ(0,
+            Vp9FrameBufferPool::VpxGetFrameBuffer(&pool, k720pFrameSize, &fb));
+  EXPECT_EQ(k720pFrameSize, fb.size);
+  EXPECT_EQ(1, pool.GetNumBuffersInUse());
+  EXPECT_EQ(0, Vp9FrameBufferPool::VpxReleaseFrameBuffer(&pool, &fb));
+  EXPECT_EQ(0, pool.GetNumBuffersInUse());
+  // Releasing twice is harmless.
+  EXPECT_EQ(0, Vp9FrameBufferPool::VpxReleaseFrameBuffer(&pool, &fb));
+  EXPECT_EQ(0, pool.GetNumBuffersInUse());
+}
+
+namespace {
+
+// Acts like a decoder thread, which gets a buffer per frame and holds on to
+// the last few as reference frames. Every other buffer comes from the pool of
+// another decoder, so that each pool is used by two threads at once.
+struct DecoderThreadParams {
+  Vp9FrameBufferPool* pool;
+  Vp9FrameBufferPool* other_pool;
+  size_t frame_size;
+};
+
+void DecodeFrames(void* obj) {
+  DecoderThreadParams* params = static_cast<DecoderThreadParams*>(obj);
+  const int kNumFrames = 2000;
+  const size_t kNumReferenceFrames = 8;
+  std::vector<rtc::scoped_refptr<Vp9FrameBufferPool::Vp9FrameBuffer>> frames;
+  for (int i = 0; i < kNumFrames; ++i) {
+    Vp9FrameBufferPool* pool = (i % 2 == 0) ? params->pool : params->other_pool;
+    rtc::scoped_refptr<Vp9FrameBufferPool::Vp9FrameBuffer> buffer =
+        pool->GetFrameBuffer(params->frame_size);
+    // Write to the buffer; a buffer handed out twice would be corrupted.
+    buffer->GetData()[0] = static_cast<uint8_t>(i);
+    frames.push_back(buffer);
+    if (frames.size() > kNumReferenceFrames)
+      frames.erase(frames.begin());
+    ASSERT_EQ(static_cast<uint8_t>(i), buffer->GetData()[0]);
+  }
+}
+
+}  // namespace
+
+TEST(Vp9FrameBufferPoolTest, ManyDecodersInParallel) {
+  const int kNumDecoders = 16;
+  std::vector<std::unique_ptr<Vp9FrameBufferPool>> pools;
+  for (int i = 0; i < kNumDecoders; ++i)
+    pools.emplace_back(new Vp9FrameBufferPool());
+  std::vector<DecoderThreadParams> params(kNumDecoders);
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 0; i < kNumDecoders; ++i) {
+    params[i].pool = pools[i].get();
+    params[i].other_pool = pools[(i + 1) % kNumDecoders].get();
+    params[i].frame_size = (i % 2 == 0) ? k720pFrameSize : k720pFrameSize / 4;
+    threads.emplace_back(
+        new rtc::PlatformThread(&DecodeFrames, &params[i], "Decoder"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Stop();
+
+  for (const auto& pool : pools) {
+    Vp9FrameBufferPool::Stats stats = pool->GetStats();
+    EXPECT_EQ(0, stats.num_buffers_in_use);
+    EXPECT_EQ(2000, stats.num_requests);
+    // Nearly all frames reuse a buffer.
+    EXPECT_GT(stats.num_reused, 1900);
+  }
+}
+
+}  // namespace webrtc
@@ -377,9 +377,12 @@ int VP9EncoderImpl::InitEncode(const VideoCodec* inst,
 int VP9EncoderImpl::NumberOfThreads(int width,
                                     int height,
                                     int number_of_cores) {
-  // Keep the number of encoder threads equal to the possible number of column
-  // tiles, which is (1, 2, 4, 8). See comments below for VP9E_SET_TILE_COLUMNS.
-  if (width * height >= 1280 * 720 && number_of_cores > 4) {
+  // Row based multithreading (see VP9E_SET_ROW_MT below) lets several threads
+  // encode the superblock rows of the same tile column, so the number of
+  // threads does not have to be limited to the number of tile columns.
+  if (width * height >= 1920 * 1080 && number_of_cores > 8) {
+    return 8;
+  } else if (width * height >= 1280 * 720 && number_of_cores > 4) {
     return 4;
   } else if (width * height >= 640 * 360 && number_of_cores > 2) {
     return 2;
@@ -389,6 +392,18 @@ int VP9EncoderImpl::NumberOfThreads(int width,
   }
 }
 
+int VP9EncoderImpl::NumberOfTileColumnsLog2(int width, int number_of_threads) {
+  // At most one tile column per thread, and tile columns are at least 256
+  // pixels wide.
+  const int kMinTileWidth = 256;
+  int tile_columns_log2 = 0;
+  while ((2 << tile_columns_log2) <= number_of_threads &&
+         (width >> (tile_columns_log2 + 1)) >= kMinTileWidth) {
+    ++tile_columns_log2;
+  }
+  return tile_columns_log2;
+}
+
 int VP9EncoderImpl::InitAndSetControlSettings(const VideoCodec* inst) {
   // Set QP-min/max per spatial and temporal layer.
   int tot_num_layers = num_spatial_layers_ * num_temporal_layers_;
@@ -445,8 +460,10 @@ int VP9EncoderImpl::InitAndSetControlSettings(const VideoCodec* inst) {
   // Control function to set the number of column tiles in encoding a frame, in
   // log2 unit: e.g., 0 = 1 tile column, 1 = 2 tile columns, 2 = 4 tile columns.
   // The number tile columns will be capped by the encoder based on image size
-  // (minimum width of tile column is 256 pixels, maximum is 4096).
-  vpx_codec_control(encoder_, VP9E_SET_TILE_COLUMNS, (config_->g_threads >> 1));
+  // (minimum width of tile column is 256 pixels, maximum is 4096). With
+  // spatial layers, the lower layers get fewer tile columns this way.
+  vpx_codec_control(encoder_, VP9E_SET_TILE_COLUMNS,
+                    NumberOfTileColumnsLog2(config_->g_w, config_->g_threads));
 
   // Turn on row-based multithreading.
   vpx_codec_control(encoder_, VP9E_SET_ROW_MT, 1);
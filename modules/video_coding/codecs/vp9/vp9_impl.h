@@ -68,6 +68,8 @@ class VP9EncoderImpl : public VP9Encoder {
  private:
   // Determine number of encoder threads to use.
   int NumberOfThreads(int width, int height, int number_of_cores);
+  // Determine number of tile columns, in log2 units, for |number_of_threads|.
+  int NumberOfTileColumnsLog2(int width, int number_of_threads);
 
   // Call encoder initialize function and set control settings.
   int InitAndSetControlSettings(const VideoCodec* inst);
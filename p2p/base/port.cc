@@ -615,7 +615,7 @@ void Port::SendBindingResponse(StunMessage* request,
   response.AddFingerprint();
 
   // Send the response message.
-  rtc::ByteBufferWriter buf;
+  rtc::ByteBufferWriter buf(nullptr, kStunHeaderSize + response.length());
   response.Write(&buf);
   rtc::PacketOptions options(DefaultDscpValue());
   auto err = SendTo(buf.Data(), buf.Length(), addr, options, false);
@@ -665,7 +665,7 @@ void Port::SendBindingErrorResponse(StunMessage* request,
   response.AddFingerprint();
 
   // Send the response message.
-  rtc::ByteBufferWriter buf;
+  rtc::ByteBufferWriter buf(nullptr, kStunHeaderSize + response.length());
   response.Write(&buf);
   rtc::PacketOptions options(DefaultDscpValue());
   SendTo(buf.Data(), buf.Length(), addr, options, false);
@@ -229,7 +229,7 @@ bool StunMessage::AddMessageIntegrity(const char* key,
   AddAttribute(std::move(msg_integrity_attr_ptr));
 
   // Calculate the HMAC for the message.
-  ByteBufferWriter buf;
+  ByteBufferWriter buf(nullptr, kStunHeaderSize + length());
   if (!Write(&buf))
     return false;
 
@@ -291,7 +291,7 @@ bool StunMessage::AddFingerprint() {
   AddAttribute(std::move(fingerprint_attr_ptr));
 
   // Calculate the CRC-32 for the message and insert it.
-  ByteBufferWriter buf;
+  ByteBufferWriter buf(nullptr, kStunHeaderSize + length());
   if (!Write(&buf))
     return false;
 
@@ -0,0 +1,115 @@
+/*
+ *  Copyright 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string>
+
+#include "p2p/base/stun.h"
+#include "rtc_base/bytebuffer.h"
+#include "rtc_base/ptr_util.h"
+#include "rtc_base/socketaddress.h"
+#include "rtc_base/timeutils.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+constexpr int kNumIterations = 100000;
+const char kPassword[] = "VOkJxbRl1RmTxUk/WvJxBt";
+const char kTransactionId[] = "0123456789ab";
+
+// Builds the body of an ICE binding response, as sent by
+// Port::SendBindingResponse() for every connectivity check received.
+void FillBindingResponse(StunMessage* response) {
+  response->SetType(STUN_BINDING_RESPONSE);
+  response->SetTransactionID(kTransactionId);
+  response->AddAttribute(rtc::MakeUnique<StunXorAddressAttribute>(
+      STUN_ATTR_XOR_MAPPED_ADDRESS, rtc::SocketAddress("192.168.1.7", 4321)));
+}
+
+}  // namespace
+
+// Breaks down the cost of sending a binding response into the three
+// serializations (for MESSAGE-INTEGRITY, FINGERPRINT and the send itself) and
+// the HMAC and CRC-32 computed over them, and counts the bytes serialized.
+TEST(StunPerformanceTest, BindingResponseSerialization) {
+  size_t message_size = 0;
+  int64_t write_ns = 0;
+  int64_t integrity_ns = 0;
+  int64_t fingerprint_ns = 0;
+  for (int i = 0; i < kNumIterations; ++i) {
+    StunMessage response;
+    FillBindingResponse(&response);
+    int64_t start_ns = rtc::TimeNanos();
+    EXPECT_TRUE(response.AddMessageIntegrity(kPassword));
+    int64_t end_ns = rtc::TimeNanos();
+    integrity_ns += end_ns - start_ns;
+
+    start_ns = end_ns;
+    EXPECT_TRUE(response.AddFingerprint());
+    end_ns = rtc::TimeNanos();
+    fingerprint_ns += end_ns - start_ns;
+
+    start_ns = end_ns;
+    rtc::ByteBufferWriter buf(nullptr, kStunHeaderSize + response.length());
+    EXPECT_TRUE(response.Write(&buf));
+    end_ns = rtc::TimeNanos();
+    write_ns += end_ns - start_ns;
+    message_size = buf.Length();
+  }
+
+  // Each of AddMessageIntegrity() and AddFingerprint() serializes the message
+  // once, like the final Write().
+  const size_t bytes_serialized = 3 * message_size;
+  webrtc::test::PrintResult("stun_binding_response", "", "message_size",
+                            message_size, "bytes", false);
+  webrtc::test::PrintResult("stun_binding_response", "", "bytes_serialized",
+                            bytes_serialized, "bytes", false);
+  webrtc::test::PrintResult("stun_binding_response", "", "write",
+                            static_cast<size_t>(write_ns / kNumIterations),
+                            "ns", true);
+  webrtc::test::PrintResult("stun_binding_response", "",
+                            "add_message_integrity",
+                            static_cast<size_t>(integrity_ns / kNumIterations),
+                            "ns", true);
+  webrtc::test::PrintResult(
+      "stun_binding_response", "", "add_fingerprint",
+      static_cast<size_t>(fingerprint_ns / kNumIterations), "ns", true);
+}
+
+// Until a TURN channel is bound, data is sent in Send indications, without
+// MESSAGE-INTEGRITY or FINGERPRINT. The payload is copied into the DATA
+// attribute and once more by the single Write().
+TEST(StunPerformanceTest, SendIndicationSerialization) {
+  const std::string payload(1200, 'x');
+  int64_t write_ns = 0;
+  size_t message_size = 0;
+  for (int i = 0; i < kNumIterations / 10; ++i) {
+    TurnMessage msg;
+    msg.SetType(TURN_SEND_INDICATION);
+    msg.SetTransactionID(kTransactionId);
+    msg.AddAttribute(rtc::MakeUnique<StunXorAddressAttribute>(
+        STUN_ATTR_XOR_PEER_ADDRESS, rtc::SocketAddress("192.168.1.7", 4321)));
+    const int64_t start_ns = rtc::TimeNanos();
+    msg.AddAttribute(rtc::MakeUnique<StunByteStringAttribute>(
+        STUN_ATTR_DATA, payload.data(), payload.size()));
+    rtc::ByteBufferWriter buf(nullptr, kStunHeaderSize + msg.length());
+    EXPECT_TRUE(msg.Write(&buf));
+    write_ns += rtc::TimeNanos() - start_ns;
+    message_size = buf.Length();
+  }
+  webrtc::test::PrintResult("turn_send_indication", "", "message_size",
+                            message_size, "bytes", false);
+  webrtc::test::PrintResult(
+      "turn_send_indication", "", "write",
+      static_cast<size_t>(write_ns / (kNumIterations / 10)), "ns", true);
+}
+
+}  // namespace cricket
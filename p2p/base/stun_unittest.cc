@@ -1329,6 +1329,24 @@ TEST_F(StunTest, AddFingerprint) {
       reinterpret_cast<const char*>(buf1.Data()), buf1.Length()));
 }
 
+// Senders size their ByteBufferWriter from the message length, so writing a
+// message must never need to grow a buffer sized that way.
+TEST_F(StunTest, WriteFitsHeaderPlusMessageLength) {
+  IceMessage msg;
+  rtc::ByteBufferReader buf(
+      reinterpret_cast<const char*>(kRfc5769SampleRequestWithoutMI),
+      sizeof(kRfc5769SampleRequestWithoutMI));
+  EXPECT_TRUE(msg.Read(&buf));
+  EXPECT_TRUE(msg.AddMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_TRUE(msg.AddFingerprint());
+
+  const size_t expected_size = kStunHeaderSize + msg.length();
+  rtc::ByteBufferWriter out(nullptr, expected_size);
+  EXPECT_TRUE(msg.Write(&out));
+  EXPECT_EQ(expected_size, out.Length());
+  EXPECT_EQ(expected_size, out.Capacity());
+}
+
 // Sample "GTURN" relay message.
 static const unsigned char kRelayMessage[] = {
   0x00, 0x01, 0x00, 88,    // message header
@@ -233,7 +233,7 @@ void StunRequest::OnMessage(rtc::Message* pmsg) {
 
   tstamp_ = rtc::TimeMillis();
 
-  rtc::ByteBufferWriter buf;
+  rtc::ByteBufferWriter buf(nullptr, kStunHeaderSize + msg_->length());
   msg_->Write(&buf);
   manager_->SignalSendPacket(buf.Data(), buf.Length(), this);
 
@@ -72,7 +72,7 @@ void StunServer::SendErrorResponse(
 
 void StunServer::SendResponse(
     const StunMessage& msg, const rtc::SocketAddress& addr) {
-  rtc::ByteBufferWriter buf;
+  rtc::ByteBufferWriter buf(nullptr, kStunHeaderSize + msg.length());
   msg.Write(&buf);
   rtc::PacketOptions options;
   if (socket_->SendTo(buf.Data(), buf.Length(), addr, options) < 0)
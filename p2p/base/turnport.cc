@@ -1558,7 +1558,6 @@ void TurnEntry::SendChannelBindRequest(int delay) {
 
 int TurnEntry::Send(const void* data, size_t size, bool payload,
                     const rtc::PacketOptions& options) {
-  rtc::ByteBufferWriter buf;
   if (state_ != STATE_BOUND ||
       !port_->TurnCustomizerAllowChannelData(data, size, payload)) {
     // If we haven't bound the channel yet, we have to use a Send Indication.
@@ -1574,6 +1573,7 @@ int TurnEntry::Send(const void* data, size_t size, bool payload,
 
     port_->TurnCustomizerMaybeModifyOutgoingStunMessage(&msg);
 
+    rtc::ByteBufferWriter buf(nullptr, kStunHeaderSize + msg.length());
     const bool success = msg.Write(&buf);
     RTC_DCHECK(success);
 
@@ -1582,12 +1582,14 @@ int TurnEntry::Send(const void* data, size_t size, bool payload,
       SendChannelBindRequest(0);
       state_ = STATE_BINDING;
     }
-  } else {
-    // If the channel is bound, we can send the data as a Channel Message.
-    buf.WriteUInt16(channel_id_);
-    buf.WriteUInt16(static_cast<uint16_t>(size));
-    buf.WriteBytes(reinterpret_cast<const char*>(data), size);
+    return port_->Send(buf.Data(), buf.Length(), options);
   }
+
+  // If the channel is bound, we can send the data as a Channel Message.
+  rtc::ByteBufferWriter buf(nullptr, TURN_CHANNEL_HEADER_SIZE + size);
+  buf.WriteUInt16(channel_id_);
+  buf.WriteUInt16(static_cast<uint16_t>(size));
+  buf.WriteBytes(reinterpret_cast<const char*>(data), size);
   return port_->Send(buf.Data(), buf.Length(), options);
 }
 
@@ -496,12 +496,12 @@ void TurnServer::SendErrorResponseWithAlternateServer(
 }
 
 void TurnServer::SendStun(TurnServerConnection* conn, StunMessage* msg) {
-  rtc::ByteBufferWriter buf;
   // Add a SOFTWARE attribute if one is set.
   if (!software_.empty()) {
     msg->AddAttribute(rtc::MakeUnique<StunByteStringAttribute>(
         STUN_ATTR_SOFTWARE, software_));
   }
+  rtc::ByteBufferWriter buf(nullptr, kStunHeaderSize + msg->length());
   msg->Write(&buf);
   Send(conn, buf);
 }
@@ -813,7 +813,7 @@ void TurnServerAllocation::OnExternalPacket(
   Channel* channel = FindChannel(addr);
   if (channel) {
     // There is a channel bound to this address. Send as a channel message.
-    rtc::ByteBufferWriter buf;
+    rtc::ByteBufferWriter buf(nullptr, TURN_CHANNEL_HEADER_SIZE + size);
     buf.WriteUInt16(channel->id());
     buf.WriteUInt16(static_cast<uint16_t>(size));
     buf.WriteBytes(data, size);
@@ -13,10 +13,31 @@
 #include "rtc_base/checks.h"
 #include "rtc_base/platform_thread.h"
 
+#if defined(WEBRTC_LOCK_PROFILING)
+#include "rtc_base/lockprofiler.h"
+#include "rtc_base/timeutils.h"
+
+#if defined(WEBRTC_WIN)
+#include <intrin.h>
+#define RTC_CALLER_ADDRESS() _ReturnAddress()
+#else
+#define RTC_CALLER_ADDRESS() __builtin_return_address(0)
+#endif
+#endif  // defined(WEBRTC_LOCK_PROFILING)
+
 // TODO(tommi): Split this file up to per-platform implementation files.
 
 namespace rtc {
 
+#if defined(WEBRTC_LOCK_PROFILING)
+namespace {
+// Reading the clock costs about as much as an uncontended acquisition, so the
+// hold time is measured for one in this many outermost acquisitions and
+// scaled up.
+const uint32_t kHoldTimeSamplingInterval = 16;
+}  // namespace
+#endif
+
 CriticalSection::CriticalSection() {
 #if defined(WEBRTC_WIN)
   InitializeCriticalSection(&crit_);
@@ -57,6 +78,76 @@ CriticalSection::~CriticalSection() {
 }
 
 void CriticalSection::Enter() const RTC_EXCLUSIVE_LOCK_FUNCTION() {
+#if defined(WEBRTC_LOCK_PROFILING)
+  ProfiledEnter(RTC_CALLER_ADDRESS(), nullptr);
+#else
+  EnterInternal();
+#endif
+}
+
+void CriticalSection::Enter(const Location& location) const
+    RTC_EXCLUSIVE_LOCK_FUNCTION() {
+#if defined(WEBRTC_LOCK_PROFILING)
+  ProfiledEnter(location.file_and_line(), &location);
+#else
+  EnterInternal();
+#endif
+}
+
+bool CriticalSection::TryEnter() const RTC_EXCLUSIVE_TRYLOCK_FUNCTION(true) {
+#if defined(WEBRTC_LOCK_PROFILING)
+  if (!TryEnterInternal())
+    return false;
+  OnProfiledAcquire(RTC_CALLER_ADDRESS(), nullptr, 0, false);
+  return true;
+#else
+  return TryEnterInternal();
+#endif
+}
+
+#if defined(WEBRTC_LOCK_PROFILING)
+void CriticalSection::ProfiledEnter(const void* site_key,
+                                    const Location* location) const
+    RTC_EXCLUSIVE_LOCK_FUNCTION() {
+  // Only measure time when the lock is actually contended, so that
+  // uncontended acquisitions stay cheap.
+  if (TryEnterInternal()) {
+    OnProfiledAcquire(site_key, location, 0, false);
+    return;
+  }
+  const int64_t wait_start_ns = SystemTimeNanos();
+  EnterInternal();
+  OnProfiledAcquire(site_key, location, SystemTimeNanos() - wait_start_ns,
+                    true);
+}
+
+void CriticalSection::OnProfiledAcquire(const void* site_key,
+                                        const Location* location,
+                                        int64_t wait_ns,
+                                        bool contended) const {
+  if (site_key != profile_last_site_key_) {
+    profile_last_site_key_ = site_key;
+    profile_last_site_ = LockProfiler::RegisterSite(site_key, location);
+  }
+  if (!profile_lock_registered_) {
+    // Locks are identified by the site they're first taken at.
+    profile_lock_ = LockProfiler::RegisterLock(site_key, location);
+    profile_lock_registered_ = true;
+  }
+  LockProfiler::RecordAcquisition(profile_last_site_, profile_lock_, wait_ns,
+                                  contended);
+  // Hold time is attributed to the site of the outermost acquisition.
+  if (profile_recursion_++ == 0) {
+    profile_site_ = profile_last_site_;
+    profile_hold_sampled_ =
+        profile_outermost_acquisitions_++ % kHoldTimeSamplingInterval == 0;
+    if (profile_hold_sampled_)
+      profile_acquire_time_ns_ = SystemTimeNanos();
+  }
+}
+#endif  // defined(WEBRTC_LOCK_PROFILING)
+
+void CriticalSection::EnterInternal() const RTC_EXCLUSIVE_LOCK_FUNCTION() {
 #if defined(WEBRTC_WIN)
   EnterCriticalSection(&crit_);
 #elif defined(WEBRTC_POSIX)
@@ -115,7 +206,8 @@ void CriticalSection::Enter() const RTC_EXCLUSIVE_LOCK_FUNCTION() {
 #endif
 }
 
-bool CriticalSection::TryEnter() const RTC_EXCLUSIVE_TRYLOCK_FUNCTION(true) {
+bool CriticalSection::TryEnterInternal() const
+    RTC_EXCLUSIVE_TRYLOCK_FUNCTION(true) {
 #if defined(WEBRTC_WIN)
   return TryEnterCriticalSection(&crit_) != FALSE;
 #elif defined(WEBRTC_POSIX)
@@ -150,6 +242,13 @@ bool CriticalSection::TryEnter() const RTC_EXCLUSIVE_TRYLOCK_FUNCTION(true) {
 
 void CriticalSection::Leave() const RTC_UNLOCK_FUNCTION() {
   RTC_DCHECK(CurrentThreadIsOwner());
+#if defined(WEBRTC_LOCK_PROFILING)
+  if (--profile_recursion_ == 0 && profile_hold_sampled_) {
+    const int64_t hold_ns = SystemTimeNanos() - profile_acquire_time_ns_;
+    LockProfiler::RecordRelease(profile_site_, profile_lock_,
+                                hold_ns * kHoldTimeSamplingInterval);
+  }
+#endif
 #if defined(WEBRTC_WIN)
   LeaveCriticalSection(&crit_);
 #elif defined(WEBRTC_POSIX)
@@ -195,7 +294,18 @@ bool CriticalSection::CurrentThreadIsOwner() const {
 #endif
 }
 
-CritScope::CritScope(const CriticalSection* cs) : cs_(cs) { cs_->Enter(); }
+CritScope::CritScope(const CriticalSection* cs) : cs_(cs) {
+#if defined(WEBRTC_LOCK_PROFILING)
+  // Attribute the acquisition to our caller rather than to this constructor.
+  cs_->ProfiledEnter(RTC_CALLER_ADDRESS(), nullptr);
+#else
+  cs_->Enter();
+#endif
+}
+CritScope::CritScope(const CriticalSection* cs, const Location& location)
+    : cs_(cs) {
+  cs_->Enter(location);
+}
 CritScope::~CritScope() { cs_->Leave(); }
 
 TryCritScope::TryCritScope(const CriticalSection* cs)
@@ -14,6 +14,7 @@
 #include "rtc_base/atomicops.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/constructormagic.h"
+#include "rtc_base/location.h"
 #include "rtc_base/platform_thread_types.h"
 #include "rtc_base/thread_annotations.h"
 #include "typedefs.h"  // NOLINT(build/include)
@@ -52,16 +53,34 @@ namespace rtc {
 // Locking methods (Enter, TryEnter, Leave)are const to permit protecting
 // members inside a const context without requiring mutable CriticalSections
 // everywhere.
+// In builds with WEBRTC_LOCK_PROFILING defined, every acquisition is recorded
+// by rtc::LockProfiler, see rtc_base/lockprofiler.h.
 class RTC_LOCKABLE CriticalSection {
  public:
   CriticalSection();
   ~CriticalSection();
 
   void Enter() const RTC_EXCLUSIVE_LOCK_FUNCTION();
+  // Same as Enter(), but attributes the acquisition to |location| rather than
+  // to the calling code's address when lock profiling is enabled.
+  void Enter(const Location& location) const RTC_EXCLUSIVE_LOCK_FUNCTION();
   bool TryEnter() const RTC_EXCLUSIVE_TRYLOCK_FUNCTION(true);
   void Leave() const RTC_UNLOCK_FUNCTION();
 
  private:
+  friend class CritScope;
+
+  void EnterInternal() const RTC_EXCLUSIVE_LOCK_FUNCTION();
+  bool TryEnterInternal() const RTC_EXCLUSIVE_TRYLOCK_FUNCTION(true);
+#if defined(WEBRTC_LOCK_PROFILING)
+  void ProfiledEnter(const void* site_key, const Location* location) const
+      RTC_EXCLUSIVE_LOCK_FUNCTION();
+  void OnProfiledAcquire(const void* site_key,
+                         const Location* location,
+                         int64_t wait_ns,
+                         bool contended) const;
+#endif
+
   // Use only for RTC_DCHECKing.
   bool CurrentThreadIsOwner() const;
 
@@ -88,12 +107,34 @@ class RTC_LOCKABLE CriticalSection {
 #else  // !defined(WEBRTC_WIN) && !defined(WEBRTC_POSIX)
 # error Unsupported platform.
 #endif
+#if defined(WEBRTC_LOCK_PROFILING)
+  // Only accessed by the thread that owns the lock.
+  mutable int profile_recursion_ = 0;
+  // This lock's slot in the LockProfiler lock table, assigned on the first
+  // acquisition.
+  mutable bool profile_lock_registered_ = false;
+  mutable int profile_lock_ = -1;
+  // The last acquisition site, so that a lock taken repeatedly at the same
+  // site doesn't need a site table lookup every time.
+  mutable const void* profile_last_site_key_ = nullptr;
+  mutable int profile_last_site_ = -1;
+  // Site of the outermost acquisition, which the hold time is attributed to.
+  mutable int profile_site_ = -1;
+  // Hold time is only measured for one in kHoldTimeSamplingInterval outermost
+  // acquisitions.
+  mutable uint32_t profile_outermost_acquisitions_ = 0;
+  mutable bool profile_hold_sampled_ = false;
+  mutable int64_t profile_acquire_time_ns_ = 0;
+#endif
 };
 
 // CritScope, for serializing execution through a scope.
 class RTC_SCOPED_LOCKABLE CritScope {
  public:
   explicit CritScope(const CriticalSection* cs) RTC_EXCLUSIVE_LOCK_FUNCTION(cs);
+  // Attributes the acquisition to |location| when lock profiling is enabled.
+  CritScope(const CriticalSection* cs, const Location& location)
+      RTC_EXCLUSIVE_LOCK_FUNCTION(cs);
   ~CritScope() RTC_UNLOCK_FUNCTION();
 
  private:
@@ -0,0 +1,281 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/lockprofiler.h"
+
+#if defined(WEBRTC_LOCK_PROFILING)
+#if defined(WEBRTC_WIN)
+#include <windows.h>
+#elif defined(WEBRTC_POSIX)
+#include <dlfcn.h>
+#endif
+#endif  // defined(WEBRTC_LOCK_PROFILING)
+
+#include <algorithm>
+#include <atomic>
+
+#include "rtc_base/location.h"
+#include "rtc_base/stringutils.h"
+
+namespace rtc {
+
+namespace {
+
+// Number of distinct acquisition sites, and of distinct locks, that can be
+// tracked. Acquisitions beyond this are not recorded.
+const int kMaxSlots = 4096;
+
+// All members are constant-initialized to zero, so the tables below need no
+// static initializer.
+struct Slot {
+  std::atomic<const void*> key;
+  std::atomic<const char*> function_name;
+  std::atomic<const char*> file_and_line;
+  // Only used in the lock table.
+  std::atomic<int64_t> instances;
+  std::atomic<int64_t> acquisitions;
+  std::atomic<int64_t> contentions;
+  std::atomic<int64_t> total_wait_ns;
+  std::atomic<int64_t> max_wait_ns;
+  std::atomic<int64_t> total_hold_ns;
+};
+
+Slot g_sites[kMaxSlots];
+Slot g_locks[kMaxSlots];
+
+int FindOrInsert(Slot* table, const void* key, const Location* location) {
+  const uintptr_t hash = reinterpret_cast<uintptr_t>(key);
+  // Open addressing with linear probing. Slots are never freed, so a lookup
+  // can stop at the first empty slot.
+  for (int probe = 0; probe < kMaxSlots; ++probe) {
+    const int index =
+        static_cast<int>(((hash >> 3) * 2654435761u + probe) % kMaxSlots);
+    Slot& slot = table[index];
+    const void* current = slot.key.load(std::memory_order_acquire);
+    if (current == key)
+      return index;
+    if (current == nullptr) {
+      if (slot.key.compare_exchange_strong(current, key,
+                                           std::memory_order_acq_rel)) {
+        if (location) {
+          slot.function_name.store(location->function_name(),
+                                   std::memory_order_release);
+          slot.file_and_line.store(location->file_and_line(),
+                                   std::memory_order_release);
+        }
+        return index;
+      }
+      // Lost the race for this slot; it may have been taken by our own key.
+      if (current == key)
+        return index;
+    }
+  }
+  return -1;
+}
+
+// Formats a return address as "module+0xoffset", which stays meaningful when
+// the module is loaded at a randomized address.
+// Without lock profiling no sites are recorded, so the symbolization, and the
+// dependency on libdl that comes with it, is left out.
+std::string FormatAddress(const void* address) {
+  char buf[256];
+  const char* module_path = nullptr;
+  uintptr_t module_base = 0;
+#if defined(WEBRTC_LOCK_PROFILING) && defined(WEBRTC_WIN)
+  HMODULE module = nullptr;
+  char path[MAX_PATH];
+  if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                             GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                         static_cast<LPCSTR>(address), &module) &&
+      GetModuleFileNameA(module, path, sizeof(path)) != 0) {
+    module_path = path;
+    module_base = reinterpret_cast<uintptr_t>(module);
+  }
+#elif defined(WEBRTC_LOCK_PROFILING) && defined(WEBRTC_POSIX)
+  Dl_info info;
+  if (dladdr(address, &info) != 0 && info.dli_fname) {
+    module_path = info.dli_fname;
+    module_base = reinterpret_cast<uintptr_t>(info.dli_fbase);
+  }
+#endif
+  if (!module_path) {
+    sprintfn(buf, sizeof(buf), "%p", address);
+    return buf;
+  }
+  const char* module_name = module_path;
+  for (const char* p = module_path; *p; ++p) {
+    if (*p == '/' || *p == '\\')
+      module_name = p + 1;
+  }
+  sprintfn(buf, sizeof(buf), "%s+0x%llx", module_name,
+           static_cast<unsigned long long>(
+               reinterpret_cast<uintptr_t>(address) - module_base));
+  return buf;
+}
+
+std::string FormatSite(const Slot& slot, const void* key) {
+  const char* file_and_line =
+      slot.file_and_line.load(std::memory_order_acquire);
+  if (!file_and_line)
+    return FormatAddress(key);
+  char buf[256];
+  sprintfn(buf, sizeof(buf), "%s@%s",
+           slot.function_name.load(std::memory_order_acquire), file_and_line);
+  return buf;
+}
+
+// Reads the counters of |slot| into |stats|, which is a LockSiteStats or a
+// LockStats.
+template <typename Stats>
+void ReadCounters(const Slot& slot, Stats* stats) {
+  stats->acquisitions = slot.acquisitions.load(std::memory_order_relaxed);
+  stats->contentions = slot.contentions.load(std::memory_order_relaxed);
+  stats->total_wait_ns = slot.total_wait_ns.load(std::memory_order_relaxed);
+  stats->max_wait_ns = slot.max_wait_ns.load(std::memory_order_relaxed);
+  stats->total_hold_ns = slot.total_hold_ns.load(std::memory_order_relaxed);
+}
+
+void AddAcquisition(Slot* slot, int64_t wait_ns, bool contended) {
+  slot->acquisitions.fetch_add(1, std::memory_order_relaxed);
+  if (!contended)
+    return;
+  slot->contentions.fetch_add(1, std::memory_order_relaxed);
+  slot->total_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+  int64_t max_wait_ns = slot->max_wait_ns.load(std::memory_order_relaxed);
+  while (wait_ns > max_wait_ns &&
+         !slot->max_wait_ns.compare_exchange_weak(max_wait_ns, wait_ns,
+                                                  std::memory_order_relaxed)) {
+  }
+}
+
+void ResetCounters(Slot* table) {
+  for (int i = 0; i < kMaxSlots; ++i) {
+    table[i].acquisitions.store(0, std::memory_order_relaxed);
+    table[i].contentions.store(0, std::memory_order_relaxed);
+    table[i].total_wait_ns.store(0, std::memory_order_relaxed);
+    table[i].max_wait_ns.store(0, std::memory_order_relaxed);
+    table[i].total_hold_ns.store(0, std::memory_order_relaxed);
+  }
+}
+
+template <typename Stats>
+bool IsHotter(const Stats& a, const Stats& b) {
+  if (a.total_wait_ns != b.total_wait_ns)
+    return a.total_wait_ns > b.total_wait_ns;
+  if (a.contentions != b.contentions)
+    return a.contentions > b.contentions;
+  return a.total_hold_ns > b.total_hold_ns;
+}
+
+template <typename Stats>
+void AppendRow(const Stats& stats, const std::string& name, std::string* out) {
+  char line[512];
+  sprintfn(line, sizeof(line), "%14lld %11lld %9.1f %12.1f %9.1f  %s\n",
+           static_cast<long long>(stats.acquisitions),
+           static_cast<long long>(stats.contentions),
+           stats.total_wait_ns / 1e6, stats.max_wait_ns / 1e3,
+           stats.total_hold_ns / 1e6, name.c_str());
+  *out += line;
+}
+
+}  // namespace
+
+bool LockProfiler::IsEnabled() {
+#if defined(WEBRTC_LOCK_PROFILING)
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::vector<LockSiteStats> LockProfiler::GetReport() {
+  std::vector<LockSiteStats> report;
+  for (const Slot& slot : g_sites) {
+    const void* key = slot.key.load(std::memory_order_acquire);
+    if (!key || slot.acquisitions.load(std::memory_order_relaxed) == 0)
+      continue;
+    LockSiteStats stats;
+    ReadCounters(slot, &stats);
+    stats.site = FormatSite(slot, key);
+    report.push_back(stats);
+  }
+  std::sort(report.begin(), report.end(), &IsHotter<LockSiteStats>);
+  return report;
+}
+
+std::vector<LockStats> LockProfiler::GetLockReport() {
+  std::vector<LockStats> report;
+  for (const Slot& slot : g_locks) {
+    const void* key = slot.key.load(std::memory_order_acquire);
+    if (!key || slot.acquisitions.load(std::memory_order_relaxed) == 0)
+      continue;
+    LockStats stats;
+    ReadCounters(slot, &stats);
+    stats.instances = slot.instances.load(std::memory_order_relaxed);
+    stats.first_site = FormatSite(slot, key);
+    report.push_back(stats);
+  }
+  std::sort(report.begin(), report.end(), &IsHotter<LockStats>);
+  return report;
+}
+
+std::string LockProfiler::ReportToString(size_t max_entries) {
+  const char kHeader[] =
+      "  acquisitions   contended   wait_ms  max_wait_us   hold_ms  ";
+  std::string result = std::string(kHeader) + "site\n";
+  const std::vector<LockSiteStats> sites = GetReport();
+  for (size_t i = 0; i < sites.size() && i < max_entries; ++i)
+    AppendRow(sites[i], sites[i].site, &result);
+
+  result += std::string("\n") + kHeader + "lock (instances, first site)\n";
+  const std::vector<LockStats> locks = GetLockReport();
+  for (size_t i = 0; i < locks.size() && i < max_entries; ++i) {
+    AppendRow(locks[i],
+              "(" + std::to_string(locks[i].instances) + ") " +
+                  locks[i].first_site,
+              &result);
+  }
+  return result;
+}
+
+void LockProfiler::Reset() {
+  ResetCounters(g_sites);
+  ResetCounters(g_locks);
+}
+
+int LockProfiler::RegisterSite(const void* key, const Location* location) {
+  return FindOrInsert(g_sites, key, location);
+}
+
+int LockProfiler::RegisterLock(const void* key, const Location* location) {
+  const int lock = FindOrInsert(g_locks, key, location);
+  if (lock >= 0)
+    g_locks[lock].instances.fetch_add(1, std::memory_order_relaxed);
+  return lock;
+}
+
+void LockProfiler::RecordAcquisition(int site,
+                                     int lock,
+                                     int64_t wait_ns,
+                                     bool contended) {
+  if (site >= 0)
+    AddAcquisition(&g_sites[site], wait_ns, contended);
+  if (lock >= 0)
+    AddAcquisition(&g_locks[lock], wait_ns, contended);
+}
+
+void LockProfiler::RecordRelease(int site, int lock, int64_t hold_ns) {
+  if (site >= 0)
+    g_sites[site].total_hold_ns.fetch_add(hold_ns, std::memory_order_relaxed);
+  if (lock >= 0)
+    g_locks[lock].total_hold_ns.fetch_add(hold_ns, std::memory_order_relaxed);
+}
+
+}  // namespace rtc
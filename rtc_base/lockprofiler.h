@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_LOCKPROFILER_H_
+#define RTC_BASE_LOCKPROFILER_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace rtc {
+
+class Location;
+
+// Aggregated statistics for one lock acquisition site.
+struct LockSiteStats {
+  // "function@file:line" for acquisitions made with an rtc::Location, and
+  // otherwise the return address of the acquiring code as "module+0xoffset"
+  // (resolve it with e.g. addr2line -e module offset).
+  std::string site;
+  // Number of times a lock was taken at this site, including recursive
+  // acquisitions.
+  int64_t acquisitions = 0;
+  // Number of acquisitions that had to wait for another thread.
+  int64_t contentions = 0;
+  // Time spent waiting for the lock, summed over all contended acquisitions.
+  int64_t total_wait_ns = 0;
+  int64_t max_wait_ns = 0;
+  // Estimated time the lock was held, summed over all outermost acquisitions.
+  // Only one in 16 outermost acquisitions is timed.
+  int64_t total_hold_ns = 0;
+};
+
+// Aggregated statistics for all CriticalSections that were first acquired at
+// the same site, which typically are the same member of different instances of
+// a class.
+struct LockStats {
+  // Site of the first acquisition, formatted like LockSiteStats::site.
+  std::string first_site;
+  // Number of CriticalSections aggregated here.
+  int64_t instances = 0;
+  // Same as in LockSiteStats, summed over all sites the locks were taken at.
+  int64_t acquisitions = 0;
+  int64_t contentions = 0;
+  int64_t total_wait_ns = 0;
+  int64_t max_wait_ns = 0;
+  int64_t total_hold_ns = 0;
+};
+
+// Contention profiling for rtc::CriticalSection.
+//
+// When WebRTC is built with rtc_enable_lock_profiling=true (which defines
+// WEBRTC_LOCK_PROFILING), every CriticalSection records how often it was
+// taken, how often it was contended and for how long it was waited for and
+// held, both per acquisition site and per lock. Sites are identified by the
+// rtc::Location passed to CritScope or CriticalSection::Enter, or by the
+// caller's return address when no location is given. Statistics are kept in
+// fixed-size tables updated with atomic operations only, so recording never
+// takes a lock or allocates.
+//
+// Profiling adds two relaxed atomic increments to an uncontended acquisition,
+// plus a site table lookup when a lock is taken at a different site than the
+// last time; see criticalsection_performance_unittest.cc for the cost. In
+// regular builds nothing is recorded and the reports are always empty.
+class LockProfiler {
+ public:
+  // True if lock profiling was compiled in.
+  static bool IsEnabled();
+
+  // Returns the statistics of all sites seen since the last Reset(), hottest
+  // first: ordered by total wait time, then by number of contentions.
+  static std::vector<LockSiteStats> GetReport();
+
+  // Returns the statistics of all locks seen since the last Reset(), ordered
+  // like GetReport().
+  static std::vector<LockStats> GetLockReport();
+
+  // Formats the |max_entries| hottest sites of GetReport() and the
+  // |max_entries| hottest locks of GetLockReport() as two tables.
+  static std::string ReportToString(size_t max_entries);
+
+  // Clears all recorded statistics. Sites and locks already seen keep their
+  // slots.
+  static void Reset();
+
+  // Used by CriticalSection; not meant to be called directly.
+  // Returns the slot of the site identified by |key|, which must be unique to
+  // the site and stay valid for the lifetime of the process, or -1 if the
+  // site table is full. |location| may be null.
+  static int RegisterSite(const void* key, const Location* location);
+  // Returns the slot for a lock first acquired at the site identified by
+  // |key|, or -1 if the lock table is full.
+  static int RegisterLock(const void* key, const Location* location);
+  static void RecordAcquisition(int site,
+                                int lock,
+                                int64_t wait_ns,
+                                bool contended);
+  static void RecordRelease(int site, int lock, int64_t hold_ns);
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_LOCKPROFILER_H_
@@ -0,0 +1,158 @@
+/*
+ *  Copyright 2017 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/lockprofiler.h"
+
+#include <string>
+#include <vector>
+
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/platform_thread.h"
+
+namespace rtc {
+
+namespace {
+
+const LockSiteStats* FindSite(const std::vector<LockSiteStats>& report,
+                              const std::string& function_name) {
+  for (const LockSiteStats& stats : report) {
+    if (stats.site.compare(0, function_name.size() + 1,
+                           function_name + "@") == 0) {
+      return &stats;
+    }
+  }
+  return nullptr;
+}
+
+const LockStats* FindLock(const std::vector<LockStats>& report,
+                          const std::string& function_name) {
+  for (const LockStats& stats : report) {
+    if (stats.first_site.compare(0, function_name.size() + 1,
+                                 function_name + "@") == 0) {
+      return &stats;
+    }
+  }
+  return nullptr;
+}
+
+void LockFromOtherThread(void* obj) {
+  CritScope cs(static_cast<CriticalSection*>(obj),
+               Location("ContendedSite", "test.cc:2"));
+}
+
+}  // namespace
+
+TEST(LockProfilerTest, RecordsAcquisitionsPerLocation) {
+  LockProfiler::Reset();
+  CriticalSection lock;
+  for (int i = 0; i < 3; ++i) {
+    CritScope cs(&lock, Location("FirstSite", "test.cc:1"));
+  }
+  {
+    // Recursive acquisitions count, but hold time is only measured once.
+    CritScope outer(&lock, Location("FirstSite", "test.cc:1"));
+    CritScope inner(&lock, Location("FirstSite", "test.cc:1"));
+  }
+
+  const std::vector<LockSiteStats> report = LockProfiler::GetReport();
+  const LockSiteStats* site = FindSite(report, "FirstSite");
+  if (!LockProfiler::IsEnabled()) {
+    EXPECT_TRUE(report.empty());
+    return;
+  }
+  ASSERT_TRUE(site);
+  EXPECT_EQ("FirstSite@test.cc:1", site->site);
+  EXPECT_EQ(5, site->acquisitions);
+  EXPECT_EQ(0, site->contentions);
+  EXPECT_EQ(0, site->total_wait_ns);
+  EXPECT_GE(site->total_hold_ns, 0);
+}
+
+TEST(LockProfilerTest, RecordsPerLockCounters) {
+  LockProfiler::Reset();
+  CriticalSection first_lock;
+  CriticalSection second_lock;
+  for (CriticalSection* lock : {&first_lock, &second_lock}) {
+    CritScope cs(lock, Location("Constructor", "test.cc:3"));
+  }
+  for (int i = 0; i < 4; ++i) {
+    CritScope cs(&first_lock, Location("Method", "test.cc:4"));
+  }
+
+  const std::vector<LockStats> report = LockProfiler::GetLockReport();
+  if (!LockProfiler::IsEnabled()) {
+    EXPECT_TRUE(report.empty());
+    return;
+  }
+  // Both locks were first taken in "Constructor", so they're aggregated.
+  const LockStats* lock = FindLock(report, "Constructor");
+  ASSERT_TRUE(lock);
+  EXPECT_EQ(2, lock->instances);
+  EXPECT_EQ(6, lock->acquisitions);
+  EXPECT_FALSE(FindLock(report, "Method"));
+
+  const std::vector<LockSiteStats> sites = LockProfiler::GetReport();
+  ASSERT_TRUE(FindSite(sites, "Constructor"));
+  ASSERT_TRUE(FindSite(sites, "Method"));
+  EXPECT_EQ(2, FindSite(sites, "Constructor")->acquisitions);
+  EXPECT_EQ(4, FindSite(sites, "Method")->acquisitions);
+}
+
+TEST(LockProfilerTest, ReportsAddressesRelativeToModule) {
+  LockProfiler::Reset();
+  CriticalSection lock;
+  {
+    CritScope cs(&lock);
+  }
+
+  const std::vector<LockSiteStats> report = LockProfiler::GetReport();
+  if (!LockProfiler::IsEnabled()) {
+    EXPECT_TRUE(report.empty());
+    return;
+  }
+  ASSERT_FALSE(report.empty());
+  // E.g. "rtc_unittests+0x1f2e3d".
+  for (const LockSiteStats& site : report)
+    EXPECT_NE(std::string::npos, site.site.find("+0x")) << site.site;
+}
+
+TEST(LockProfilerTest, RecordsContention) {
+  LockProfiler::Reset();
+  CriticalSection lock;
+  PlatformThread thread(&LockFromOtherThread, &lock, "LockProfilerTest");
+  {
+    CritScope cs(&lock);
+    thread.Start();
+    // Give the other thread time to block on the lock.
+    Event never_signaled(false, false);
+    never_signaled.Wait(50);
+  }
+  thread.Stop();
+
+  const std::vector<LockSiteStats> report = LockProfiler::GetReport();
+  if (!LockProfiler::IsEnabled()) {
+    EXPECT_TRUE(report.empty());
+    return;
+  }
+  const LockSiteStats* site = FindSite(report, "ContendedSite");
+  ASSERT_TRUE(site);
+  EXPECT_EQ(1, site->acquisitions);
+  EXPECT_EQ(1, site->contentions);
+  EXPECT_GT(site->total_wait_ns, 0);
+  EXPECT_EQ(site->total_wait_ns, site->max_wait_ns);
+  // The contended site waited the longest, so it's reported first.
+  EXPECT_EQ(site, &report[0]);
+  EXPECT_NE(std::string::npos,
+            LockProfiler::ReportToString(1).find("ContendedSite@test.cc:2"));
+}
+
+}  // namespace rtc
@@ -842,7 +842,7 @@ int VirtualSocketServer::SendUdp(VirtualSocket* socket,
   }
 
   // See if we want to drop this packet.
-  if (Random() < drop_prob_) {
+  if (!udp_network_ && Random() < drop_prob_) {
     LOG(LS_VERBOSE) << "Dropping packet: bad luck";
     return static_cast<int>(data_size);
   }
@@ -868,6 +868,12 @@ int VirtualSocketServer::SendUdp(VirtualSocket* socket,
     return -1;
   }
 
+  if (udp_network_) {
+    udp_network_->OnUdpPacketSent(GetSenderAddress(socket), remote_addr, data,
+                                  data_size);
+    return static_cast<int>(data_size);
+  }
+
   {
     CritScope cs(&socket->crit_);
 
@@ -951,6 +957,31 @@ void VirtualSocketServer::SendTcp(VirtualSocket* socket) {
   }
 }
 
+void VirtualSocketServer::DeliverUdpPacket(const SocketAddress& from,
+                                           const SocketAddress& to,
+                                           const char* data,
+                                           size_t size) {
+  VirtualSocket* recipient = LookupBinding(to);
+  if (!recipient) {
+    LOG(LS_VERBOSE) << "No one listening at " << to;
+    return;
+  }
+  msg_queue_->Post(RTC_FROM_HERE, recipient, MSG_ID_PACKET,
+                   new Packet(data, size, from));
+}
+
+SocketAddress VirtualSocketServer::GetSenderAddress(VirtualSocket* socket) {
+  // When the incoming packet is from a binding of the any address, translate it
+  // to the default route here such that the recipient will see the default
+  // route.
+  SocketAddress sender_addr = socket->local_addr_;
+  IPAddress default_ip = GetDefaultRoute(sender_addr.ipaddr().family());
+  if (sender_addr.IsAnyIP() && !IPIsUnspec(default_ip)) {
+    sender_addr.SetIP(default_ip);
+  }
+  return sender_addr;
+}
+
 void VirtualSocketServer::AddPacketToNetwork(VirtualSocket* sender,
                                              VirtualSocket* recipient,
                                              int64_t cur_time,
@@ -969,17 +1000,8 @@ void VirtualSocketServer::AddPacketToNetwork(VirtualSocket* sender,
   // Find the delay for crossing the many virtual hops of the network.
   uint32_t transit_delay = GetTransitDelay(sender);
 
-  // When the incoming packet is from a binding of the any address, translate it
-  // to the default route here such that the recipient will see the default
-  // route.
-  SocketAddress sender_addr = sender->local_addr_;
-  IPAddress default_ip = GetDefaultRoute(sender_addr.ipaddr().family());
-  if (sender_addr.IsAnyIP() && !IPIsUnspec(default_ip)) {
-    sender_addr.SetIP(default_ip);
-  }
-
   // Post the packet as a message to be delivered (on our own thread)
-  Packet* p = new Packet(data, data_size, sender_addr);
+  Packet* p = new Packet(data, data_size, GetSenderAddress(sender));
 
   int64_t ts = TimeAfter(send_delay + transit_delay);
   if (ordered) {
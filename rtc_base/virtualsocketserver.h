@@ -27,6 +27,22 @@ class Packet;
 class VirtualSocket;
 class SocketAddressPair;
 
+// Carries the UDP packets of a VirtualSocketServer in place of its own
+// bandwidth, delay and drop models, e.g. an emulated network with a topology
+// of its own. Runs on the thread of the server.
+class VirtualUdpNetwork {
+ public:
+  virtual ~VirtualUdpNetwork() {}
+
+  // Called for each UDP packet sent to a bound address. The network passes
+  // the packet to VirtualSocketServer::DeliverUdpPacket() once it arrives,
+  // or drops it.
+  virtual void OnUdpPacketSent(const SocketAddress& from,
+                               const SocketAddress& to,
+                               const char* data,
+                               size_t size) = 0;
+};
+
 // Simulates a network in the same manner as a loopback interface.  The
 // interface can create as many addresses as you want.  All of the sockets
 // created by this network will be able to communicate with one another, unless
@@ -102,6 +118,17 @@ class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
   // full, and test functionality related to EWOULDBLOCK/SignalWriteEvent.
   void SetSendingBlocked(bool blocked);
 
+  // Sends UDP packets through |network| instead of through the bandwidth,
+  // delay and drop models above, or through them again if null. TCP isn't
+  // affected. Must be called on the thread of the server.
+  void set_udp_network(VirtualUdpNetwork* network) { udp_network_ = network; }
+  // Delivers a UDP packet that was passed to the VirtualUdpNetwork to the
+  // socket bound to |to|, if any. Must be called on the thread of the server.
+  void DeliverUdpPacket(const SocketAddress& from,
+                        const SocketAddress& to,
+                        const char* data,
+                        size_t size);
+
   // SocketFactory:
   Socket* CreateSocket(int type) override;
   Socket* CreateSocket(int family, int type) override;
@@ -195,6 +222,9 @@ class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
   // Moves as much data as possible from the sender's buffer to the network
   void SendTcp(VirtualSocket* socket);
 
+  // The address the recipients of the packets of |socket| see them come from.
+  SocketAddress GetSenderAddress(VirtualSocket* socket);
+
   // Places a packet on the network.
   void AddPacketToNetwork(VirtualSocket* socket,
                           VirtualSocket* recipient,
@@ -290,6 +320,7 @@ class VirtualSocketServer : public SocketServer, public sigslot::has_slots<> {
 
   double drop_prob_;
   bool sending_blocked_ = false;
+  VirtualUdpNetwork* udp_network_ = nullptr;
   RTC_DISALLOW_COPY_AND_ASSIGN(VirtualSocketServer);
 };
 
@@ -11,12 +11,42 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
 
 #include "rtc_tools/frame_analyzer/video_quality_analysis.h"
 #include "rtc_tools/simple_command_line_parser.h"
+#include "system_wrappers/include/cpu_info.h"
+
+namespace {
+
+// Prints the same numbers as PrintMaxRepeatedAndSkippedFrames(), but from the
+// reference frame indices found by FindMatchingFrameIndices().
+void PrintMaxRepeatedAndSkippedFrames(const std::string& label,
+                                      const std::vector<int>& indices) {
+  int max_repeated_frames = 1;
+  int max_skipped_frames = 0;
+  int total_skipped_frames = 0;
+  int repeated_frames = 1;
+  for (size_t i = 1; i < indices.size(); ++i) {
+    if (indices[i] == indices[i - 1]) {
+      max_repeated_frames = std::max(max_repeated_frames, ++repeated_frames);
+      continue;
+    }
+    repeated_frames = 1;
+    int skipped_frames = std::max(indices[i] - indices[i - 1] - 1, 0);
+    max_skipped_frames = std::max(max_skipped_frames, skipped_frames);
+    total_skipped_frames += skipped_frames;
+  }
+  printf("RESULT Max_repeated: %s= %d\n", label.c_str(), max_repeated_frames);
+  printf("RESULT Max_skipped: %s= %d\n", label.c_str(), max_skipped_frames);
+  printf("RESULT Total_skipped: %s= %d\n", label.c_str(),
+         total_skipped_frames);
+}
+
+}  // namespace
 
 /*
  * A command line tool running PSNR and SSIM on a reference video and a test
@@ -33,6 +63,12 @@
  *
  * The max value for PSNR is 48.0 (between equal frames), as for SSIM it is 1.0.
  *
+ * With --align_frames, no stats files are needed: the frames are matched by
+ * comparing their contents, and the analysis runs on --num_threads threads.
+ * Y4M files are then recognized by their "YUV4MPEG2" signature. Without it,
+ * a reference file is read as Y4M if its name contains "y4m".
+ * With --json_output, the results are also written to a JSON file.
+ *
  * Usage:
  * frame_analyzer --label=<test_label> --reference_file=<name_of_file>
  * --test_file_ref=<name_of_file> --stats_file_test=<name_of_file>
@@ -62,7 +98,15 @@ int main(int argc, char** argv) {
       "  - reference_file(string): The reference YUV file to compare against."
       " Default: ref.yuv\n"
       "  - test_file(string): The test YUV file to run the analysis for."
-      " Default: test_file.yuv\n";
+      " Default: test_file.yuv\n"
+      "  - align_frames(bool): Match the test frames with the reference frames"
+      " by their contents instead of using the stats files. Default: false\n"
+      "  - search_window(int): With align_frames, the number of reference"
+      " frames each test frame is compared with. Default: 60\n"
+      "  - num_threads(int): With align_frames, the number of analysis"
+      " threads, 0 for one per core. Default: 0\n"
+      "  - json_output(string): A file to also write the results to, as JSON."
+      " Default: none\n";
 
   webrtc::test::CommandLineParser parser;
 
@@ -77,6 +121,10 @@ int main(int argc, char** argv) {
   parser.SetFlag("stats_file_test", "stats_test.txt");
   parser.SetFlag("reference_file", "ref.yuv");
   parser.SetFlag("test_file", "test.yuv");
+  parser.SetFlag("align_frames", "false");
+  parser.SetFlag("search_window", "60");
+  parser.SetFlag("num_threads", "0");
+  parser.SetFlag("json_output", "");
   parser.SetFlag("help", "false");
 
   parser.ProcessFlags();
@@ -95,16 +143,48 @@ int main(int argc, char** argv) {
   }
 
   webrtc::test::ResultsContainer results;
+  std::string label = parser.GetFlag("label");
 
-  webrtc::test::RunAnalysis(parser.GetFlag("reference_file").c_str(),
-                            parser.GetFlag("test_file").c_str(),
-                            parser.GetFlag("stats_file_ref").c_str(),
-                            parser.GetFlag("stats_file_test").c_str(), width,
-                            height, &results);
+  if (parser.GetFlag("align_frames") == "true") {
+    int search_window =
+        strtol((parser.GetFlag("search_window")).c_str(), NULL, 10);
+    int num_threads = strtol((parser.GetFlag("num_threads")).c_str(), NULL, 10);
+    if (num_threads <= 0)
+      num_threads = webrtc::CpuInfo::DetectNumberOfCores();
+    std::vector<int> indices = webrtc::test::FindMatchingFrameIndices(
+        parser.GetFlag("reference_file").c_str(),
+        parser.GetFlag("test_file").c_str(), width, height,
+        std::max(search_window, 1));
+    if (indices.empty()) {
+      fprintf(stderr, "Error: couldn't match the test and reference frames\n");
+      return -1;
+    }
+    webrtc::test::RunAlignedAnalysis(parser.GetFlag("reference_file").c_str(),
+                                     parser.GetFlag("test_file").c_str(),
+                                     indices, width, height, num_threads,
+                                     &results);
+    webrtc::test::PrintAnalysisResults(label, &results);
+    PrintMaxRepeatedAndSkippedFrames(label, indices);
+  } else {
+    webrtc::test::RunAnalysis(parser.GetFlag("reference_file").c_str(),
+                              parser.GetFlag("test_file").c_str(),
+                              parser.GetFlag("stats_file_ref").c_str(),
+                              parser.GetFlag("stats_file_test").c_str(), width,
+                              height, &results);
+    webrtc::test::PrintAnalysisResults(label, &results);
+    webrtc::test::PrintMaxRepeatedAndSkippedFrames(
+        label, parser.GetFlag("stats_file_ref"),
+        parser.GetFlag("stats_file_test"));
+  }
 
-  std::string label = parser.GetFlag("label");
-  webrtc::test::PrintAnalysisResults(label, &results);
-  webrtc::test::PrintMaxRepeatedAndSkippedFrames(
-      label, parser.GetFlag("stats_file_ref"),
-      parser.GetFlag("stats_file_test"));
+  std::string json_output = parser.GetFlag("json_output");
+  if (!json_output.empty()) {
+    FILE* json_file = fopen(json_output.c_str(), "w");
+    if (json_file == NULL) {
+      fprintf(stderr, "Couldn't open %s for writing\n", json_output.c_str());
+      return -1;
+    }
+    webrtc::test::PrintAnalysisResultsAsJson(json_file, label, results);
+    fclose(json_file);
+  }
 }
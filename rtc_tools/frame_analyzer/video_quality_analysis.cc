@@ -11,13 +11,26 @@
 #include "rtc_tools/frame_analyzer/video_quality_analysis.h"
 
 #include <assert.h>
+#include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory>
 #include <string>
 #include <map>
 #include <utility>
 
+#include "rtc_base/platform_thread.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#include "typedefs.h"  // NOLINT(build/include)
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+
 #define STATS_LINE_LENGTH 32
 #define Y4M_FILE_HEADER_MAX_SIZE 200
 #define Y4M_FRAME_DELIMITER "FRAME"
@@ -26,9 +39,357 @@
 namespace webrtc {
 namespace test {
 
+namespace {
+
+// Sums over an 8x8 block of two planes, from which its SSIM is computed.
+struct SsimSums {
+  int64_t sum_a = 0;
+  int64_t sum_b = 0;
+  int64_t sum_sq_a = 0;
+  int64_t sum_sq_b = 0;
+  int64_t sum_axb = 0;
+};
+
+typedef void (*SsimSumsFunction)(const uint8_t* src_a,
+                                 int stride_a,
+                                 const uint8_t* src_b,
+                                 int stride_b,
+                                 SsimSums* sums);
+
+void SsimSums8x8_C(const uint8_t* src_a,
+                   int stride_a,
+                   const uint8_t* src_b,
+                   int stride_b,
+                   SsimSums* sums) {
+  for (int i = 0; i < 8; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      sums->sum_a += src_a[j];
+      sums->sum_b += src_b[j];
+      sums->sum_sq_a += src_a[j] * src_a[j];
+      sums->sum_sq_b += src_b[j] * src_b[j];
+      sums->sum_axb += src_a[j] * src_b[j];
+    }
+    src_a += stride_a;
+    src_b += stride_b;
+  }
+}
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t HorizontalSum(__m128i values) {
+  values = _mm_add_epi32(values, _mm_srli_si128(values, 8));
+  values = _mm_add_epi32(values, _mm_srli_si128(values, 4));
+  return _mm_cvtsi128_si32(values);
+}
+
+void SsimSums8x8_SSE2(const uint8_t* src_a,
+                      int stride_a,
+                      const uint8_t* src_b,
+                      int stride_b,
+                      SsimSums* sums) {
+  const __m128i zero = _mm_setzero_si128();
+  // Eight rows of 8 bit values fit in the 16 bit lanes of the plain sums, and
+  // the squares are summed pairwise into 32 bit lanes by _mm_madd_epi16.
+  __m128i sum_a = zero;
+  __m128i sum_b = zero;
+  __m128i sum_sq_a = zero;
+  __m128i sum_sq_b = zero;
+  __m128i sum_axb = zero;
+  for (int i = 0; i < 8; ++i) {
+    const __m128i a = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_a)), zero);
+    const __m128i b = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_b)), zero);
+    sum_a = _mm_add_epi16(sum_a, a);
+    sum_b = _mm_add_epi16(sum_b, b);
+    sum_sq_a = _mm_add_epi32(sum_sq_a, _mm_madd_epi16(a, a));
+    sum_sq_b = _mm_add_epi32(sum_sq_b, _mm_madd_epi16(b, b));
+    sum_axb = _mm_add_epi32(sum_axb, _mm_madd_epi16(a, b));
+    src_a += stride_a;
+    src_b += stride_b;
+  }
+  const __m128i ones = _mm_set1_epi16(1);
+  sums->sum_a = HorizontalSum(_mm_madd_epi16(sum_a, ones));
+  sums->sum_b = HorizontalSum(_mm_madd_epi16(sum_b, ones));
+  sums->sum_sq_a = HorizontalSum(sum_sq_a);
+  sums->sum_sq_b = HorizontalSum(sum_sq_b);
+  sums->sum_axb = HorizontalSum(sum_axb);
+}
+#endif
+
+SsimSumsFunction GetSsimSumsFunction() {
+// If we know the minimum architecture at compile time, avoid CPU detection.
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(__SSE2__)
+  return SsimSums8x8_SSE2;
+#else
+  return WebRtc_GetCPUInfo(kSSE2) ? SsimSums8x8_SSE2 : SsimSums8x8_C;
+#endif
+#else
+  return SsimSums8x8_C;
+#endif
+}
+
+// Same computation as libyuv's Ssim8x8_C(), so the results are identical.
+double Ssim8x8(const SsimSums& sums) {
+  // (0.01 * 255)^2 and (0.03 * 255)^2 in 12 bit fixed point, scaled by the
+  // squared number of pixels.
+  const int64_t kCount = 64;
+  const int64_t kC1 = (26634 * kCount * kCount) >> 12;
+  const int64_t kC2 = (239708 * kCount * kCount) >> 12;
+  const int64_t sum_a_x_sum_b = sums.sum_a * sums.sum_b;
+  const int64_t ssim_n = (2 * sum_a_x_sum_b + kC1) *
+                         (2 * kCount * sums.sum_axb - 2 * sum_a_x_sum_b + kC2);
+  const int64_t sum_a_sq = sums.sum_a * sums.sum_a;
+  const int64_t sum_b_sq = sums.sum_b * sums.sum_b;
+  const int64_t ssim_d =
+      (sum_a_sq + sum_b_sq + kC1) *
+      (kCount * sums.sum_sq_a - sum_a_sq + kCount * sums.sum_sq_b - sum_b_sq +
+       kC2);
+  if (ssim_d == 0)
+    return DBL_MAX;
+  return ssim_n * 1.0 / ssim_d;
+}
+
+// Like libyuv::CalcFrameSsim(), averages the SSIM of 8x8 blocks every 4
+// pixels.
+double CalculatePlaneSsim(SsimSumsFunction sums_function,
+                          const uint8_t* src_a,
+                          int stride_a,
+                          const uint8_t* src_b,
+                          int stride_b,
+                          int width,
+                          int height) {
+  const int kBlockSize = 8;
+  const int kScanStep = 4;
+  double ssim_total = 0;
+  int samples = 0;
+  for (int i = 0; i < height - kBlockSize; i += kScanStep) {
+    for (int j = 0; j < width - kBlockSize; j += kScanStep) {
+      SsimSums sums;
+      sums_function(src_a + j, stride_a, src_b + j, stride_b, &sums);
+      ssim_total += Ssim8x8(sums);
+      ++samples;
+    }
+    src_a += stride_a * kScanStep;
+    src_b += stride_b * kScanStep;
+  }
+  return ssim_total / samples;
+}
+
+// Side of the square blocks averaged into one pixel of a thumbnail.
+const int kThumbnailScale = 4;
+
+// Downscales the luma plane of |frame| for FindMatchingFrameIndices().
+void CreateThumbnail(const uint8_t* frame,
+                     int width,
+                     int height,
+                     std::vector<uint8_t>* thumbnail) {
+  const int thumbnail_width = width / kThumbnailScale;
+  const int thumbnail_height = height / kThumbnailScale;
+  thumbnail->resize(thumbnail_width * thumbnail_height);
+  for (int y = 0; y < thumbnail_height; ++y) {
+    for (int x = 0; x < thumbnail_width; ++x) {
+      const uint8_t* block =
+          frame + y * kThumbnailScale * width + x * kThumbnailScale;
+      int sum = 0;
+      for (int i = 0; i < kThumbnailScale; ++i) {
+        for (int j = 0; j < kThumbnailScale; ++j)
+          sum += block[i * width + j];
+      }
+      (*thumbnail)[y * thumbnail_width + x] =
+          sum / (kThumbnailScale * kThumbnailScale);
+    }
+  }
+}
+
+int64_t SquaredError(const std::vector<uint8_t>& a,
+                     const std::vector<uint8_t>& b) {
+  int64_t error = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    const int diff = a[i] - b[i];
+    error += diff * diff;
+  }
+  return error;
+}
+
+struct FramePair {
+  int frame_number = 0;
+  std::vector<uint8_t> reference;
+  std::vector<uint8_t> test;
+  double psnr = 0;
+  double ssim = 0;
+};
+
+// The frames of a batch analyzed on one thread: every |step|th one, starting
+// at |first|.
+struct AnalysisJob {
+  std::vector<FramePair>* pairs;
+  size_t count;
+  size_t first;
+  size_t step;
+  int width;
+  int height;
+};
+
+void RunAnalysisJob(void* obj) {
+  AnalysisJob* job = static_cast<AnalysisJob*>(obj);
+  for (size_t i = job->first; i < job->count; i += job->step) {
+    FramePair& pair = (*job->pairs)[i];
+    pair.psnr = CalculateMetrics(kPSNR, pair.reference.data(), pair.test.data(),
+                                 job->width, job->height);
+    pair.ssim = CalculateMetrics(kSSIM, pair.reference.data(), pair.test.data(),
+                                 job->width, job->height);
+  }
+}
+
+void AnalyzeBatch(std::vector<FramePair>* pairs,
+                  size_t count,
+                  int width,
+                  int height,
+                  int num_threads,
+                  ResultsContainer* results) {
+  std::vector<AnalysisJob> jobs;
+  for (int i = 0; i < num_threads; ++i) {
+    jobs.push_back(AnalysisJob{pairs, count, static_cast<size_t>(i),
+                               static_cast<size_t>(num_threads), width,
+                               height});
+  }
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(
+        new rtc::PlatformThread(&RunAnalysisJob, &jobs[i], "FrameAnalyzer"));
+    threads.back()->Start();
+  }
+  RunAnalysisJob(&jobs[0]);
+  for (auto& thread : threads)
+    thread->Stop();
+
+  for (size_t i = 0; i < count; ++i) {
+    const FramePair& pair = (*pairs)[i];
+    results->frames.push_back(
+        AnalysisResult(pair.frame_number, pair.psnr, pair.ssim));
+  }
+}
+
+// Returns |value| quoted and escaped as a JSON string.
+std::string ToJsonString(const std::string& value) {
+  std::string json = "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      json += '\\';
+      json += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[7];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      json += escaped;
+    } else {
+      json += c;
+    }
+  }
+  return json + "\"";
+}
+
+void PrintJsonStatistics(FILE* output,
+                         const char* name,
+                         const std::vector<AnalysisResult>& frames,
+                         double AnalysisResult::*value) {
+  double sum = 0;
+  double min_value = std::numeric_limits<double>::max();
+  double max_value = std::numeric_limits<double>::lowest();
+  for (const AnalysisResult& frame : frames) {
+    sum += frame.*value;
+    min_value = std::min(min_value, frame.*value);
+    max_value = std::max(max_value, frame.*value);
+  }
+  fprintf(output,
+          "  \"%s\": {\"mean\": %f, \"min\": %f, \"max\": %f},\n", name,
+          sum / frames.size(), min_value, max_value);
+}
+
+}  // namespace
+
 ResultsContainer::ResultsContainer() {}
 ResultsContainer::~ResultsContainer() {}
 
+I420FileReader::I420FileReader(int width, int height)
+    : frame_size_(GetI420FrameSize(width, height)),
+      file_(nullptr),
+      y4m_(false),
+      next_frame_(0) {}
+
+I420FileReader::~I420FileReader() {
+  if (file_)
+    fclose(file_);
+}
+
+bool I420FileReader::Open(const std::string& file_name) {
+  if (file_)
+    fclose(file_);
+  file_ = fopen(file_name.c_str(), "rb");
+  if (!file_) {
+    fprintf(stderr, "Couldn't open input file for reading: %s\n",
+            file_name.c_str());
+    return false;
+  }
+  static const char kY4mSignature[] = "YUV4MPEG2";
+  char signature[sizeof(kY4mSignature) - 1];
+  y4m_ = fread(signature, 1, sizeof(signature), file_) == sizeof(signature) &&
+         memcmp(signature, kY4mSignature, sizeof(signature)) == 0;
+  frame_offsets_.clear();
+  next_frame_ = 0;
+  if (!y4m_)
+    return fseek(file_, 0, SEEK_SET) == 0;
+  if (!SkipHeaderLine()) {
+    fprintf(stderr, "Corrupted Y4M header in %s\n", file_name.c_str());
+    return false;
+  }
+  frame_offsets_.push_back(ftell(file_));
+  return true;
+}
+
+bool I420FileReader::ReadFrame(uint8_t* frame) {
+  if (!file_)
+    return false;
+  if (y4m_ && !SkipHeaderLine())
+    return false;
+  if (fread(frame, 1, frame_size_, file_) != frame_size_)
+    return false;
+  ++next_frame_;
+  if (y4m_ && frame_offsets_.size() == static_cast<size_t>(next_frame_))
+    frame_offsets_.push_back(ftell(file_));
+  return true;
+}
+
+bool I420FileReader::SeekToFrame(int frame_number) {
+  if (!file_ || frame_number < 0)
+    return false;
+  if (!y4m_) {
+    next_frame_ = frame_number;
+    return fseek(file_, static_cast<long>(frame_size_) * frame_number,
+                 SEEK_SET) == 0;
+  }
+  // Find the frames up to |frame_number| by skipping over them, parsing their
+  // headers the same way as ReadFrame() does.
+  while (frame_offsets_.size() <= static_cast<size_t>(frame_number)) {
+    if (fseek(file_, frame_offsets_.back(), SEEK_SET) != 0 ||
+        !SkipHeaderLine() ||
+        fseek(file_, static_cast<long>(frame_size_), SEEK_CUR) != 0) {
+      return false;
+    }
+    frame_offsets_.push_back(ftell(file_));
+  }
+  next_frame_ = frame_number;
+  return fseek(file_, frame_offsets_[frame_number], SEEK_SET) == 0;
+}
+
+bool I420FileReader::SkipHeaderLine() {
+  int c;
+  do {
+    c = fgetc(file_);
+  } while (c != EOF && c != '\n');
+  return c != EOF;
+}
+
 int GetI420FrameSize(int width, int height) {
   int half_width = (width + 1) >> 1;
   int half_height = (height + 1) >> 1;
@@ -212,12 +573,20 @@ double CalculateMetrics(VideoAnalysisMetricsType video_metrics_type,
       // In case of 0 mse in one frame, 128 can skew the results significantly.
       result = (result > 48.0) ? 48.0 : result;
       break;
-    case kSSIM:
-      result = libyuv::I420Ssim(src_y_a, stride_y, src_u_a, stride_uv,
-                                src_v_a, stride_uv, src_y_b, stride_y,
-                                src_u_b, stride_uv, src_v_b, stride_uv,
-                                width, height);
+    case kSSIM: {
+      // Weighted like in libyuv::I420Ssim().
+      static const SsimSumsFunction sums_function = GetSsimSumsFunction();
+      double ssim_y = CalculatePlaneSsim(sums_function, src_y_a, stride_y,
+                                         src_y_b, stride_y, width, height);
+      double ssim_u = CalculatePlaneSsim(sums_function, src_u_a, stride_uv,
+                                         src_u_b, stride_uv, half_width,
+                                         half_height);
+      double ssim_v = CalculatePlaneSsim(sums_function, src_v_a, stride_uv,
+                                         src_v_b, stride_uv, half_width,
+                                         half_height);
+      result = ssim_y * 0.8 + 0.1 * (ssim_u + ssim_v);
       break;
+    }
     default:
       assert(false);
   }
@@ -318,6 +687,145 @@ void RunAnalysis(const char* reference_file_name,
   delete[] reference_frame;
 }
 
+std::vector<int> FindMatchingFrameIndices(const char* reference_file_name,
+                                          const char* test_file_name,
+                                          int width,
+                                          int height,
+                                          int search_window) {
+  std::vector<int> indices;
+  I420FileReader reference_reader(width, height);
+  I420FileReader test_reader(width, height);
+  if (!reference_reader.Open(reference_file_name) ||
+      !test_reader.Open(test_file_name)) {
+    return indices;
+  }
+
+  std::vector<uint8_t> frame(GetI420FrameSize(width, height));
+  std::vector<uint8_t> test_thumbnail;
+  std::vector<uint8_t> reference_thumbnail;
+  // Thumbnails of the reference frames from |window_start| on; the reference
+  // reader is positioned right after them.
+  std::deque<std::vector<uint8_t>> window;
+  int window_start = 0;
+  while (test_reader.ReadFrame(frame.data())) {
+    CreateThumbnail(frame.data(), width, height, &test_thumbnail);
+    if (indices.empty()) {
+      // Search the whole reference video for the first frame.
+      int64_t best_error = std::numeric_limits<int64_t>::max();
+      for (int i = 0; reference_reader.ReadFrame(frame.data()); ++i) {
+        CreateThumbnail(frame.data(), width, height, &reference_thumbnail);
+        int64_t error = SquaredError(test_thumbnail, reference_thumbnail);
+        if (error < best_error) {
+          best_error = error;
+          window_start = i;
+        }
+      }
+      if (best_error == std::numeric_limits<int64_t>::max() ||
+          !reference_reader.SeekToFrame(window_start)) {
+        return indices;
+      }
+    } else {
+      while (window_start < indices.back()) {
+        window.pop_front();
+        ++window_start;
+      }
+    }
+    while (window.size() < static_cast<size_t>(search_window) &&
+           reference_reader.ReadFrame(frame.data())) {
+      window.emplace_back();
+      CreateThumbnail(frame.data(), width, height, &window.back());
+    }
+
+    int best_index = window_start;
+    int64_t best_error = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < window.size(); ++i) {
+      int64_t error = SquaredError(test_thumbnail, window[i]);
+      if (error < best_error) {
+        best_error = error;
+        best_index = window_start + static_cast<int>(i);
+      }
+    }
+    indices.push_back(best_index);
+  }
+  return indices;
+}
+
+void RunAlignedAnalysis(const char* reference_file_name,
+                        const char* test_file_name,
+                        const std::vector<int>& reference_frame_indices,
+                        int width,
+                        int height,
+                        int num_threads,
+                        ResultsContainer* results) {
+  I420FileReader reference_reader(width, height);
+  I420FileReader test_reader(width, height);
+  if (!reference_reader.Open(reference_file_name) ||
+      !test_reader.Open(test_file_name)) {
+    return;
+  }
+  num_threads = std::max(num_threads, 1);
+
+  // Frames are read in batches, which are then analyzed in parallel.
+  const int size = GetI420FrameSize(width, height);
+  std::vector<FramePair> batch(4 * num_threads);
+  for (FramePair& pair : batch) {
+    pair.reference.resize(size);
+    pair.test.resize(size);
+  }
+  size_t count = 0;
+  int next_reference_index = 0;
+  int previous_reference_index = -1;
+  for (size_t i = 0;
+       reference_frame_indices.empty() || i < reference_frame_indices.size();
+       ++i) {
+    FramePair& pair = batch[count];
+    if (!test_reader.ReadFrame(pair.test.data()))
+      break;
+    const int reference_index = reference_frame_indices.empty()
+                                    ? static_cast<int>(i)
+                                    : reference_frame_indices[i];
+    if (reference_index < 0 || reference_index == previous_reference_index)
+      continue;
+    previous_reference_index = reference_index;
+    if (reference_index != next_reference_index &&
+        !reference_reader.SeekToFrame(reference_index)) {
+      break;
+    }
+    if (!reference_reader.ReadFrame(pair.reference.data()))
+      break;
+    next_reference_index = reference_index + 1;
+    pair.frame_number = reference_index;
+    if (++count == batch.size()) {
+      AnalyzeBatch(&batch, count, width, height, num_threads, results);
+      count = 0;
+    }
+  }
+  AnalyzeBatch(&batch, count, width, height, num_threads, results);
+}
+
+void PrintAnalysisResultsAsJson(FILE* output,
+                                const std::string& label,
+                                const ResultsContainer& results) {
+  fprintf(output, "{\n  \"label\": %s,\n", ToJsonString(label).c_str());
+  fprintf(output, "  \"unique_frames_count\": %u,\n",
+          static_cast<unsigned int>(results.frames.size()));
+  if (!results.frames.empty()) {
+    PrintJsonStatistics(output, "psnr", results.frames,
+                        &AnalysisResult::psnr_value);
+    PrintJsonStatistics(output, "ssim", results.frames,
+                        &AnalysisResult::ssim_value);
+  }
+  fprintf(output, "  \"frames\": [");
+  for (size_t i = 0; i < results.frames.size(); ++i) {
+    const AnalysisResult& frame = results.frames[i];
+    fprintf(output,
+            "%s\n    {\"frame_number\": %d, \"psnr\": %f, \"ssim\": %f}",
+            i == 0 ? "" : ",", frame.frame_number, frame.psnr_value,
+            frame.ssim_value);
+  }
+  fprintf(output, "\n  ]\n}\n");
+}
+
 void PrintMaxRepeatedAndSkippedFrames(const std::string& label,
                                       const std::string& stats_file_ref_name,
                                       const std::string& stats_file_test_name) {
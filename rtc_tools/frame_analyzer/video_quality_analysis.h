@@ -11,6 +11,8 @@
 #ifndef RTC_TOOLS_FRAME_ANALYZER_VIDEO_QUALITY_ANALYSIS_H_
 #define RTC_TOOLS_FRAME_ANALYZER_VIDEO_QUALITY_ANALYSIS_H_
 
+#include <stdio.h>
+
 #include <string>
 #include <vector>
 #include <utility>
@@ -67,13 +69,47 @@ void RunAnalysis(const char* reference_file_name,
 // Compute PSNR or SSIM for an I420 frame (all planes). When we are calculating
 // PSNR values, the max return value (in the case where the test and reference
 // frames are exactly the same) will be 48. In the case of SSIM the max return
-// value will be 1.
+// value will be 1. SSIM is computed like libyuv::I420Ssim(), but with SSE2
+// where available.
 double CalculateMetrics(VideoAnalysisMetricsType video_metrics_type,
                         const uint8_t* ref_frame,
                         const uint8_t* test_frame,
                         int width,
                         int height);
 
+// Finds the reference frame shown by each test frame, without barcodes, by
+// comparing downscaled luma planes. The test video may start anywhere in the
+// reference video and repeat or skip frames, but is assumed to be in order:
+// the first test frame is matched against all reference frames, and each
+// following one against the |search_window| reference frames starting at the
+// previous match. Returns the index of the matching reference frame for each
+// test frame, or an empty vector if a file can't be read.
+std::vector<int> FindMatchingFrameIndices(const char* reference_file_name,
+                                          const char* test_file_name,
+                                          int width,
+                                          int height,
+                                          int search_window);
+
+// Like RunAnalysis(), but the reference frame shown by each test frame is
+// given by |reference_frame_indices| instead of stats files, e.g. from
+// FindMatchingFrameIndices(), or is the frame with the same index if
+// |reference_frame_indices| is empty. A test frame showing the same reference
+// frame as the one before it is skipped. Both files are read once, and the
+// metrics are computed on |num_threads| threads.
+void RunAlignedAnalysis(const char* reference_file_name,
+                        const char* test_file_name,
+                        const std::vector<int>& reference_frame_indices,
+                        int width,
+                        int height,
+                        int num_threads,
+                        ResultsContainer* results);
+
+// Writes the results of each frame, and their mean, minimum and maximum, as a
+// JSON object.
+void PrintAnalysisResultsAsJson(FILE* output,
+                                const std::string& label,
+                                const ResultsContainer& results);
+
 // Prints the result from the analysis in Chromium performance
 // numbers compatible format to stdout. If the results object contains no frames
 // no output will be written.
@@ -144,6 +180,39 @@ bool ExtractFrameFromY4mFile(const char* i420_file_name,
                              int frame_number,
                              uint8_t* result_frame);
 
+// Reads the frames of an I420 YUV or Y4M file in order, keeping the file open
+// in between, unlike ExtractFrameFromYuvFile() and ExtractFrameFromY4mFile().
+// Files starting with the "YUV4MPEG2" signature are read as Y4M, whatever
+// their name, and other files as raw I420.
+class I420FileReader {
+ public:
+  I420FileReader(int width, int height);
+  ~I420FileReader();
+
+  bool Open(const std::string& file_name);
+  // Reads the next frame into |frame|, which must hold GetI420FrameSize()
+  // bytes. Returns false at the end of the file.
+  bool ReadFrame(uint8_t* frame);
+  // Moves to frame |frame_number|, the first frame being 0. Seeking past the
+  // end of the file either fails or makes the next ReadFrame() fail.
+  bool SeekToFrame(int frame_number);
+
+  bool is_y4m() const { return y4m_; }
+
+ private:
+  // Skips the rest of a Y4M header line, i.e. the file header or a frame
+  // header with its optional parameters.
+  bool SkipHeaderLine();
+
+  const size_t frame_size_;
+  FILE* file_;
+  bool y4m_;
+  // Offsets of the Y4M frame headers read or skipped so far. They can't be
+  // computed, since the frame headers may have parameters.
+  std::vector<long> frame_offsets_;
+  int next_frame_;
+};
+
 }  // namespace test
 }  // namespace webrtc
 
@@ -12,9 +12,14 @@
 // to stdout by void functions, but it's still useful as it executes the code.
 
 #include <stdio.h>
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <string>
+#include <vector>
 
+#include "rtc_base/arraysize.h"
+#include "rtc_base/random.h"
 #include "rtc_tools/frame_analyzer/video_quality_analysis.h"
 #include "test/gtest.h"
 #include "test/testsupport/fileutils.h"
@@ -67,6 +72,151 @@ TEST_F(VideoQualityAnalysisTest, MatchExtractedY4mFrame) {
   delete[] expected_frame;
 }
 
+// Writes |frame_indices.size()| frames to a temporary YUV file, frame i being
+// random noise seeded with |frame_indices[i]|.
+std::string WriteNoiseFrames(const std::vector<int>& frame_indices,
+                             int width,
+                             int height) {
+  std::string file_name = TempFilename(OutputPath(), "noise.yuv");
+  FILE* file = fopen(file_name.c_str(), "wb");
+  std::vector<uint8_t> frame(GetI420FrameSize(width, height));
+  for (int frame_index : frame_indices) {
+    Random random(frame_index + 1);
+    for (uint8_t& value : frame)
+      value = random.Rand<uint8_t>();
+    fwrite(frame.data(), 1, frame.size(), file);
+  }
+  fclose(file);
+  return file_name;
+}
+
+TEST_F(VideoQualityAnalysisTest, SeeksInY4mWithFrameParameters) {
+  const int kWidth = 4;
+  const int kHeight = 2;
+  const size_t kFrameSize = GetI420FrameSize(kWidth, kHeight);
+  // Not named .y4m; the reader goes by the signature.
+  std::string file_name = TempFilename(OutputPath(), "frames");
+  FILE* file = fopen(file_name.c_str(), "wb");
+  ASSERT_TRUE(file != nullptr);
+  fprintf(file, "YUV4MPEG2 W%d H%d F30:1 C420\n", kWidth, kHeight);
+  const char* const kFrameHeaders[] = {"FRAME\n", "FRAME Ip\n",
+                                       "FRAME XCOMMENT=long\n", "FRAME\n"};
+  for (size_t i = 0; i < arraysize(kFrameHeaders); ++i) {
+    fputs(kFrameHeaders[i], file);
+    std::vector<uint8_t> frame(kFrameSize, static_cast<uint8_t>(i));
+    fwrite(frame.data(), 1, frame.size(), file);
+  }
+  fclose(file);
+
+  I420FileReader reader(kWidth, kHeight);
+  ASSERT_TRUE(reader.Open(file_name));
+  EXPECT_TRUE(reader.is_y4m());
+  std::vector<uint8_t> frame(kFrameSize);
+  ASSERT_TRUE(reader.SeekToFrame(3));
+  ASSERT_TRUE(reader.ReadFrame(frame.data()));
+  EXPECT_EQ(std::vector<uint8_t>(kFrameSize, 3), frame);
+  EXPECT_FALSE(reader.ReadFrame(frame.data()));
+  ASSERT_TRUE(reader.SeekToFrame(1));
+  ASSERT_TRUE(reader.ReadFrame(frame.data()));
+  EXPECT_EQ(std::vector<uint8_t>(kFrameSize, 1), frame);
+  ASSERT_TRUE(reader.ReadFrame(frame.data()));
+  EXPECT_EQ(std::vector<uint8_t>(kFrameSize, 2), frame);
+  EXPECT_FALSE(reader.SeekToFrame(5));
+  remove(file_name.c_str());
+}
+
+TEST_F(VideoQualityAnalysisTest, PrintAnalysisResultsAsJsonEscapesLabel) {
+  std::string file_name = TempFilename(OutputPath(), "results.json");
+  FILE* file = fopen(file_name.c_str(), "w");
+  ASSERT_TRUE(file != nullptr);
+  ResultsContainer results;
+  PrintAnalysisResultsAsJson(file, "a \"quoted\\label\"\n", results);
+  fclose(file);
+
+  std::ifstream json(file_name);
+  std::string contents((std::istreambuf_iterator<char>(json)),
+                       std::istreambuf_iterator<char>());
+  const char kExpected[] = "\"label\": \"a \\\"quoted\\\\label\\\"\\u000a\"";
+  EXPECT_NE(std::string::npos, contents.find(kExpected)) << contents;
+  remove(file_name.c_str());
+}
+
+TEST_F(VideoQualityAnalysisTest, SsimMatchesLibyuv) {
+  const int kWidth = 67;
+  const int kHeight = 45;
+  const int half_width = (kWidth + 1) / 2;
+  const int half_height = (kHeight + 1) / 2;
+  std::vector<uint8_t> reference(GetI420FrameSize(kWidth, kHeight));
+  std::vector<uint8_t> test(reference.size());
+  Random random(1234);
+  for (size_t i = 0; i < reference.size(); ++i) {
+    reference[i] = random.Rand<uint8_t>();
+    test[i] = std::min(255, reference[i] + random.Rand(0, 20));
+  }
+  const uint8_t* ref_u = reference.data() + kWidth * kHeight;
+  const uint8_t* ref_v = ref_u + half_width * half_height;
+  const uint8_t* test_u = test.data() + kWidth * kHeight;
+  const uint8_t* test_v = test_u + half_width * half_height;
+  double expected = libyuv::I420Ssim(
+      reference.data(), kWidth, ref_u, half_width, ref_v, half_width,
+      test.data(), kWidth, test_u, half_width, test_v, half_width, kWidth,
+      kHeight);
+  EXPECT_NEAR(expected,
+              CalculateMetrics(kSSIM, reference.data(), test.data(), kWidth,
+                               kHeight),
+              1e-9);
+}
+
+TEST_F(VideoQualityAnalysisTest, FindMatchingFrameIndices) {
+  const int kWidth = 32;
+  const int kHeight = 24;
+  std::vector<int> reference_frames;
+  for (int i = 0; i < 20; ++i)
+    reference_frames.push_back(i);
+  const std::vector<int> test_frames = {5, 5, 6, 8, 9, 9, 12, 19};
+  std::string reference_file =
+      WriteNoiseFrames(reference_frames, kWidth, kHeight);
+  std::string test_file = WriteNoiseFrames(test_frames, kWidth, kHeight);
+
+  EXPECT_EQ(test_frames,
+            FindMatchingFrameIndices(reference_file.c_str(), test_file.c_str(),
+                                     kWidth, kHeight, 10));
+  remove(reference_file.c_str());
+  remove(test_file.c_str());
+}
+
+TEST_F(VideoQualityAnalysisTest, RunAlignedAnalysisSkipsRepeatedFrames) {
+  const int kWidth = 32;
+  const int kHeight = 24;
+  std::vector<int> reference_frames;
+  for (int i = 0; i < 20; ++i)
+    reference_frames.push_back(i);
+  const std::vector<int> test_frames = {2, 3, 3, 4, 7, 8, 9, 10, 11, 12, 14};
+  std::string reference_file =
+      WriteNoiseFrames(reference_frames, kWidth, kHeight);
+  std::string test_file = WriteNoiseFrames(test_frames, kWidth, kHeight);
+
+  ResultsContainer results;
+  RunAlignedAnalysis(reference_file.c_str(), test_file.c_str(), test_frames,
+                     kWidth, kHeight, 3, &results);
+  ASSERT_EQ(test_frames.size() - 1, results.frames.size());
+  for (size_t i = 0; i < results.frames.size(); ++i) {
+    EXPECT_EQ(test_frames[i < 2 ? i : i + 1], results.frames[i].frame_number);
+    EXPECT_EQ(48.0, results.frames[i].psnr_value);
+    EXPECT_DOUBLE_EQ(1.0, results.frames[i].ssim_value);
+  }
+  PrintAnalysisResultsAsJson(logfile_, "Aligned", results);
+
+  // Without indices, frames are compared one by one.
+  results.frames.clear();
+  RunAlignedAnalysis(reference_file.c_str(), test_file.c_str(), {}, kWidth,
+                     kHeight, 2, &results);
+  ASSERT_EQ(test_frames.size(), results.frames.size());
+  EXPECT_LT(results.frames[0].psnr_value, 48.0);
+  remove(reference_file.c_str());
+  remove(test_file.c_str());
+}
+
 TEST_F(VideoQualityAnalysisTest, PrintAnalysisResultsEmpty) {
   ResultsContainer result;
   PrintAnalysisResults(logfile_, "Empty", &result);
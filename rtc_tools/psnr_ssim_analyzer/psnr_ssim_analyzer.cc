@@ -8,7 +8,6 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
-#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -18,55 +17,29 @@
 
 #include "rtc_tools/frame_analyzer/video_quality_analysis.h"
 #include "rtc_tools/simple_command_line_parser.h"
-
-#define MAX_NUM_FRAMES_PER_FILE INT_MAX
+#include "system_wrappers/include/cpu_info.h"
 
 void CompareFiles(const char* reference_file_name, const char* test_file_name,
-                  const char* results_file_name, int width, int height) {
-  // Check if the reference_file_name ends with "y4m".
-  bool y4m_mode = false;
-  if (std::string(reference_file_name).find("y4m") != std::string::npos) {
-    y4m_mode = true;
-  }
+                  const char* results_file_name, int width, int height,
+                  int num_threads) {
+  webrtc::test::ResultsContainer results;
+  // Without reference frame indices, frames are compared one by one.
+  webrtc::test::RunAlignedAnalysis(reference_file_name, test_file_name, {},
+                                   width, height, num_threads, &results);
 
   FILE* results_file = fopen(results_file_name, "w");
-
-  int size = webrtc::test::GetI420FrameSize(width, height);
-
-  // Allocate buffers for test and reference frames.
-  uint8_t* test_frame = new uint8_t[size];
-  uint8_t* ref_frame = new uint8_t[size];
-
-  bool read_result = true;
-  for (int frame_counter = 0; frame_counter < MAX_NUM_FRAMES_PER_FILE;
-      ++frame_counter) {
-    read_result &= (y4m_mode) ? webrtc::test::ExtractFrameFromY4mFile(
-        reference_file_name, width, height, frame_counter, ref_frame):
-        webrtc::test::ExtractFrameFromYuvFile(reference_file_name, width,
-                                              height, frame_counter, ref_frame);
-    read_result &=  webrtc::test::ExtractFrameFromYuvFile(test_file_name, width,
-        height, frame_counter, test_frame);
-
-    if (!read_result)
-      break;
-
-    // Calculate the PSNR and SSIM.
-    double result_psnr = webrtc::test::CalculateMetrics(
-        webrtc::test::kPSNR, ref_frame, test_frame, width, height);
-    double result_ssim = webrtc::test::CalculateMetrics(
-        webrtc::test::kSSIM, ref_frame, test_frame, width, height);
-    fprintf(results_file, "Frame: %d, PSNR: %f, SSIM: %f\n", frame_counter,
-            result_psnr, result_ssim);
+  for (const webrtc::test::AnalysisResult& result : results.frames) {
+    fprintf(results_file, "Frame: %d, PSNR: %f, SSIM: %f\n",
+            result.frame_number, result.psnr_value, result.ssim_value);
   }
-  delete[] test_frame;
-  delete[] ref_frame;
-
   fclose(results_file);
 }
 
 /*
  * A tool running PSNR and SSIM analysis on two videos - a reference video and a
- * test video. The two videos should be I420 YUV videos.
+ * test video. The two videos should be raw I420 YUV or Y4M videos. Files that
+ * start with the "YUV4MPEG2" signature are read as Y4M, whatever their name;
+ * their frame size is still taken from --width and --height.
  * The tool just runs PSNR and SSIM on the corresponding frames in the test and
  * the reference videos until either the first or the second video runs out of
  * frames. The result is written in a results text file in the format:
@@ -83,7 +56,8 @@ void CompareFiles(const char* reference_file_name, const char* test_file_name,
 int main(int argc, char** argv) {
   std::string program_name = argv[0];
   std::string usage = "Runs PSNR and SSIM on two I420 videos and write the"
-      "results in a file.\n"
+      "results in a file. The videos may be raw I420 or Y4M files, which are"
+      " recognized by their YUV4MPEG2 header.\n"
       "Example usage:\n" + program_name + " --reference_file=ref.yuv "
       "--test_file=test.yuv --results_file=results.txt --width=320 "
       "--height=240\n"
@@ -96,7 +70,9 @@ int main(int argc, char** argv) {
       "  - test_file(string): The test YUV file to run the analysis for."
       " Default: test_file.yuv\n"
       "  - results_file(string): The full name of the file where the results "
-      "will be written. Default: results.txt\n";
+      "will be written. Default: results.txt\n"
+      "  - num_threads(int): The number of analysis threads, 0 for one per "
+      "core. Default: 0\n";
 
   webrtc::test::CommandLineParser parser;
 
@@ -110,6 +86,7 @@ int main(int argc, char** argv) {
   parser.SetFlag("reference_file", "ref.yuv");
   parser.SetFlag("test_file", "test.yuv");
   parser.SetFlag("results_file", "results.txt");
+  parser.SetFlag("num_threads", "0");
   parser.SetFlag("help", "false");
 
   parser.ProcessFlags();
@@ -127,7 +104,12 @@ int main(int argc, char** argv) {
     return -1;
   }
 
+  int num_threads = strtol((parser.GetFlag("num_threads")).c_str(), NULL, 10);
+  if (num_threads <= 0)
+    num_threads = webrtc::CpuInfo::DetectNumberOfCores();
+
   CompareFiles(parser.GetFlag("reference_file").c_str(),
                parser.GetFlag("test_file").c_str(),
-               parser.GetFlag("results_file").c_str(), width, height);
+               parser.GetFlag("results_file").c_str(), width, height,
+               num_threads);
 }
@@ -1209,15 +1209,15 @@ bool MediaCodecVideoEncoder::DeliverPendingOutputs(JNIEnv* jni) {
           }
         }
       } else if (codec_type == kVideoCodecH264) {
-        h264_bitstream_parser_.ParseBitstream(payload, payload_size);
+        // For H.264 search for start codes.
+        const std::vector<H264::NaluIndex> nalu_idxs =
+            H264::FindNaluIndices(payload, payload_size);
+        h264_bitstream_parser_.ParseBitstream(payload, nalu_idxs);
         int qp;
         if (h264_bitstream_parser_.GetLastSliceQp(&qp)) {
           current_acc_qp_ += qp;
           image->qp_ = qp;
         }
-        // For H.264 search for start codes.
-        const std::vector<H264::NaluIndex> nalu_idxs =
-            H264::FindNaluIndices(payload, payload_size);
         if (nalu_idxs.empty()) {
           ALOGE << "Start code is not found!";
           ALOGE << "Data:" <<  image->_buffer[0] << " " << image->_buffer[1]
@@ -336,11 +336,10 @@ RTPFragmentationHeader VideoEncoderWrapper::ParseFragmentationHeader(
     const std::vector<uint8_t>& buffer) {
   RTPFragmentationHeader header;
   if (codec_settings_.codecType == kVideoCodecH264) {
-    h264_bitstream_parser_.ParseBitstream(buffer.data(), buffer.size());
-
     // For H.264 search for start codes.
     const std::vector<H264::NaluIndex> nalu_idxs =
         H264::FindNaluIndices(buffer.data(), buffer.size());
+    h264_bitstream_parser_.ParseBitstream(buffer.data(), nalu_idxs);
     if (nalu_idxs.empty()) {
       LOG(LS_ERROR) << "Start code is not found!";
       LOG(LS_ERROR) << "Data:" << buffer[0] << " " << buffer[1] << " "
@@ -12,6 +12,7 @@
 #define SDK_OBJC_FRAMEWORK_CLASSES_VIDEO_OBJCVIDEOTRACKSOURCE_H_
 
 #include "WebRTC/RTCMacros.h"
+#include "common_video/include/i420_buffer_pool.h"
 #include "media/base/adaptedvideotracksource.h"
 #include "rtc_base/timestampaligner.h"
 
@@ -45,6 +46,8 @@ class ObjcVideoTrackSource : public rtc::AdaptedVideoTrackSource {
  private:
   rtc::VideoBroadcaster broadcaster_;
   rtc::TimestampAligner timestamp_aligner_;
+  // Buffers for adapted I420 frames. Only used on the capture thread.
+  I420BufferPool buffer_pool_;
 };
 
 }  // namespace webrtc
@@ -58,19 +58,19 @@ void ObjcVideoTrackSource::OnCapturedFrame(RTCVideoFrame* frame) {
                       cropY:crop_y + rtcPixelBuffer.cropY]);
   } else {
     // Adapted I420 frame.
-    // TODO(magjed): Optimize this I420 path.
-    rtc::scoped_refptr<I420Buffer> i420_buffer = I420Buffer::Create(adapted_width, adapted_height);
+    rtc::scoped_refptr<I420Buffer> i420_buffer =
+        buffer_pool_.CreateBuffer(adapted_width, adapted_height);
     buffer = new rtc::RefCountedObject<ObjCFrameBuffer>(frame.buffer);
     i420_buffer->CropAndScaleFrom(*buffer->ToI420(), crop_x, crop_y, crop_width, crop_height);
     buffer = i420_buffer;
   }
 
   // Applying rotation is only supported for legacy reasons and performance is
-  // not critical here.
+  // not critical here. AdaptedVideoTrackSource rotates I420 frames into pooled
+  // buffers.
   webrtc::VideoRotation rotation = static_cast<webrtc::VideoRotation>(frame.rotation);
   if (apply_rotation() && rotation != kVideoRotation_0) {
-    buffer = I420Buffer::Rotate(*buffer->ToI420(), rotation);
-    rotation = kVideoRotation_0;
+    buffer = buffer->ToI420();
   }
 
   OnFrame(webrtc::VideoFrame(buffer, rotation, translated_timestamp_us));
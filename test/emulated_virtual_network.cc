@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/emulated_virtual_network.h"
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/timeutils.h"
+
+namespace webrtc {
+namespace test {
+
+EmulatedVirtualNetwork::EmulatedVirtualNetwork(
+    NetworkEmulation* emulation,
+    rtc::VirtualSocketServer* server,
+    rtc::Thread* thread)
+    : emulation_(emulation), server_(server), thread_(thread) {
+  RTC_DCHECK(thread_->IsCurrent());
+  server_->set_udp_network(this);
+  // Cross traffic may be due before the first packet is sent.
+  ScheduleProcess();
+}
+
+EmulatedVirtualNetwork::~EmulatedVirtualNetwork() {
+  RTC_DCHECK(thread_->IsCurrent());
+  server_->set_udp_network(nullptr);
+  for (const auto& endpoint : endpoints_)
+    endpoint.second->SetReceiver(nullptr);
+  thread_->Clear(this);
+}
+
+void EmulatedVirtualNetwork::AddEndpoint(const rtc::IPAddress& address,
+                                         EmulatedEndpoint* endpoint) {
+  RTC_DCHECK(thread_->IsCurrent());
+  endpoints_[address] = endpoint;
+  addresses_[endpoint->id()] = address;
+  endpoint->SetReceiver(this);
+}
+
+void EmulatedVirtualNetwork::OnUdpPacketSent(const rtc::SocketAddress& from,
+                                             const rtc::SocketAddress& to,
+                                             const char* data,
+                                             size_t size) {
+  RTC_DCHECK(thread_->IsCurrent());
+  auto sender = endpoints_.find(from.ipaddr());
+  auto receiver = endpoints_.find(to.ipaddr());
+  if (sender == endpoints_.end() || receiver == endpoints_.end()) {
+    LOG(LS_WARNING) << "Dropping packet from " << from.ToString() << " to "
+                    << to.ToString() << ": no emulated endpoint.";
+    return;
+  }
+  sender->second->SendPacket(from.port(), receiver->second->id(), to.port(),
+                             reinterpret_cast<const uint8_t*>(data), size);
+  // The packet may pass the network without delay.
+  emulation_->Process();
+  ScheduleProcess();
+}
+
+void EmulatedVirtualNetwork::OnPacketReceived(EmulatedPacket packet) {
+  auto from = addresses_.find(packet.from);
+  auto to = addresses_.find(packet.to);
+  RTC_DCHECK(to != addresses_.end());
+  // E.g. cross traffic, which isn't for any socket.
+  if (from == addresses_.end())
+    return;
+  server_->DeliverUdpPacket(
+      rtc::SocketAddress(from->second, packet.from_port),
+      rtc::SocketAddress(to->second, packet.to_port),
+      reinterpret_cast<const char*>(packet.data.cdata()), packet.size());
+}
+
+void EmulatedVirtualNetwork::OnMessage(rtc::Message* msg) {
+  emulation_->Process();
+  ScheduleProcess();
+}
+
+void EmulatedVirtualNetwork::ScheduleProcess() {
+  thread_->Clear(this);
+  rtc::Optional<int64_t> next_process_time_us =
+      emulation_->NextProcessTimeUs();
+  if (next_process_time_us) {
+    // Rounded up, so that the network has something to do when processed.
+    thread_->PostAt(RTC_FROM_HERE,
+                    (*next_process_time_us + rtc::kNumMicrosecsPerMillisec -
+                     1) / rtc::kNumMicrosecsPerMillisec,
+                    this);
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
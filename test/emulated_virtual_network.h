@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef TEST_EMULATED_VIRTUAL_NETWORK_H_
+#define TEST_EMULATED_VIRTUAL_NETWORK_H_
+
+#include <map>
+
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/ipaddress.h"
+#include "rtc_base/messagehandler.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/network_emulation.h"
+
+namespace rtc {
+class Thread;
+}  // namespace rtc
+
+namespace webrtc {
+namespace test {
+
+// Sends the UDP packets of a VirtualSocketServer through a NetworkEmulation,
+// e.g. for PeerConnection and ICE tests, the way EmulatedCallTransport does
+// for a Call. Each IP address of the server is an EmulatedEndpoint.
+//
+// |emulation| must run on rtc::TimeMicros() and |server| is the socket server
+// of |thread|, on which everything runs. With an rtc::ScopedFakeClock, the
+// network is processed as the clock is advanced past its events, e.g. by
+// SIMULATED_WAIT.
+class EmulatedVirtualNetwork : public rtc::VirtualUdpNetwork,
+                               public EmulatedNetworkReceiverInterface,
+                               public rtc::MessageHandler {
+ public:
+  EmulatedVirtualNetwork(NetworkEmulation* emulation,
+                         rtc::VirtualSocketServer* server,
+                         rtc::Thread* thread);
+  ~EmulatedVirtualNetwork() override;
+
+  // Sends and receives the packets of the sockets bound to |address| through
+  // |endpoint|.
+  void AddEndpoint(const rtc::IPAddress& address, EmulatedEndpoint* endpoint);
+
+  // rtc::VirtualUdpNetwork:
+  void OnUdpPacketSent(const rtc::SocketAddress& from,
+                       const rtc::SocketAddress& to,
+                       const char* data,
+                       size_t size) override;
+
+  // EmulatedNetworkReceiverInterface:
+  void OnPacketReceived(EmulatedPacket packet) override;
+
+  // rtc::MessageHandler:
+  void OnMessage(rtc::Message* msg) override;
+
+ private:
+  // Posts a message to process the network at its next event, if any.
+  void ScheduleProcess();
+
+  NetworkEmulation* const emulation_;
+  rtc::VirtualSocketServer* const server_;
+  rtc::Thread* const thread_;
+  std::map<rtc::IPAddress, EmulatedEndpoint*> endpoints_;
+  std::map<uint64_t, rtc::IPAddress> addresses_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(EmulatedVirtualNetwork);
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // TEST_EMULATED_VIRTUAL_NETWORK_H_
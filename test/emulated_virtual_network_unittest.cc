@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/emulated_virtual_network.h"
+
+#include <string.h>
+
+#include <memory>
+
+#include "rtc_base/asyncsocket.h"
+#include "rtc_base/fakeclock.h"
+#include "rtc_base/socketaddress.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/virtualsocketserver.h"
+#include "test/gtest.h"
+#include "test/network_emulation.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+const int kQueueDelayMs = 100;
+
+class EmulatedVirtualNetworkTest : public ::testing::Test {
+ protected:
+  EmulatedVirtualNetworkTest()
+      : server_(&fake_clock_),
+        thread_(&server_),
+        address_a_("1.1.1.1", 1000),
+        address_b_("2.2.2.2", 2000) {
+    // Time zero is special to some of rtc_base.
+    fake_clock_.AdvanceTime(rtc::TimeDelta::FromSeconds(1));
+    EmulatedLinkConfig config;
+    config.queue_delay_ms = kQueueDelayMs;
+    EmulatedNetworkNode* node = emulation_.CreateNode(config);
+    endpoint_a_ = emulation_.CreateEndpoint();
+    endpoint_b_ = emulation_.CreateEndpoint();
+    emulation_.CreateRoute(endpoint_a_, {node}, endpoint_b_);
+    emulation_.CreateRoute(endpoint_b_, {node}, endpoint_a_);
+    network_.reset(new EmulatedVirtualNetwork(&emulation_, &server_, &thread_));
+    network_->AddEndpoint(address_a_.ipaddr(), endpoint_a_);
+    network_->AddEndpoint(address_b_.ipaddr(), endpoint_b_);
+
+    socket_a_.reset(server_.CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+    socket_b_.reset(server_.CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+    EXPECT_EQ(0, socket_a_->Bind(address_a_));
+    EXPECT_EQ(0, socket_b_->Bind(address_b_));
+  }
+
+  void AdvanceTimeMs(int64_t duration_ms) {
+    fake_clock_.AdvanceTime(rtc::TimeDelta::FromMilliseconds(duration_ms));
+    thread_.ProcessMessages(0);
+  }
+
+  rtc::ScopedFakeClock fake_clock_;
+  rtc::VirtualSocketServer server_;
+  rtc::AutoSocketServerThread thread_;
+  NetworkEmulation emulation_;
+  EmulatedEndpoint* endpoint_a_;
+  EmulatedEndpoint* endpoint_b_;
+  std::unique_ptr<EmulatedVirtualNetwork> network_;
+  const rtc::SocketAddress address_a_;
+  const rtc::SocketAddress address_b_;
+  std::unique_ptr<rtc::AsyncSocket> socket_a_;
+  std::unique_ptr<rtc::AsyncSocket> socket_b_;
+};
+
+}  // namespace
+
+TEST_F(EmulatedVirtualNetworkTest, DeliversUdpThroughEmulatedNetwork) {
+  // The emulated network replaces the models of the server.
+  server_.set_drop_probability(1.0);
+
+  const char kData[] = "emulated";
+  EXPECT_EQ(static_cast<int>(sizeof(kData)),
+            socket_a_->SendTo(kData, sizeof(kData), address_b_));
+
+  char buffer[64];
+  rtc::SocketAddress from;
+  AdvanceTimeMs(kQueueDelayMs - 1);
+  EXPECT_LT(socket_b_->RecvFrom(buffer, sizeof(buffer), &from, nullptr), 0);
+  EXPECT_EQ(0u, endpoint_b_->received_packets());
+
+  AdvanceTimeMs(1);
+  EXPECT_EQ(1u, endpoint_b_->received_packets());
+  ASSERT_EQ(static_cast<int>(sizeof(kData)),
+            socket_b_->RecvFrom(buffer, sizeof(buffer), &from, nullptr));
+  EXPECT_EQ(address_a_, from);
+  EXPECT_EQ(0, memcmp(kData, buffer, sizeof(kData)));
+}
+
+TEST_F(EmulatedVirtualNetworkTest, DeliversRepliesToSendingPort) {
+  const char kData[] = "ping";
+  socket_a_->SendTo(kData, sizeof(kData), address_b_);
+  AdvanceTimeMs(kQueueDelayMs);
+  char buffer[64];
+  rtc::SocketAddress from;
+  ASSERT_EQ(static_cast<int>(sizeof(kData)),
+            socket_b_->RecvFrom(buffer, sizeof(buffer), &from, nullptr));
+
+  socket_b_->SendTo(buffer, sizeof(kData), from);
+  AdvanceTimeMs(kQueueDelayMs);
+  ASSERT_EQ(static_cast<int>(sizeof(kData)),
+            socket_a_->RecvFrom(buffer, sizeof(buffer), &from, nullptr));
+  EXPECT_EQ(address_b_, from);
+}
+
+TEST_F(EmulatedVirtualNetworkTest, DropsPacketsToAddressesWithoutEndpoint) {
+  const rtc::SocketAddress address_c("3.3.3.3", 3000);
+  std::unique_ptr<rtc::AsyncSocket> socket_c(
+      server_.CreateAsyncSocket(AF_INET, SOCK_DGRAM));
+  EXPECT_EQ(0, socket_c->Bind(address_c));
+
+  const char kData[] = "lost";
+  socket_a_->SendTo(kData, sizeof(kData), address_c);
+  AdvanceTimeMs(kQueueDelayMs);
+  char buffer[64];
+  EXPECT_LT(socket_c->RecvFrom(buffer, sizeof(buffer), nullptr, nullptr), 0);
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -0,0 +1,391 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/network_emulation.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "call/call.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ptr_util.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+namespace test {
+
+EmulatedPacket::EmulatedPacket(uint64_t from,
+                               uint64_t to,
+                               rtc::CopyOnWriteBuffer data,
+                               int64_t send_time_us)
+    : from(from),
+      to(to),
+      data(std::move(data)),
+      send_time_us(send_time_us),
+      arrival_time_us(send_time_us) {}
+
+EmulatedNetworkNode::EmulatedNetworkNode(Clock* clock,
+                                         const EmulatedLinkConfig& config,
+                                         uint64_t seed)
+    : clock_(clock), config_(config), random_(seed) {}
+
+EmulatedNetworkNode::~EmulatedNetworkNode() = default;
+
+void EmulatedNetworkNode::SetConfig(const EmulatedLinkConfig& config) {
+  rtc::CritScope crit(&lock_);
+  config_ = config;
+}
+
+void EmulatedNetworkNode::SetRoute(
+    uint64_t destination,
+    EmulatedNetworkReceiverInterface* receiver) {
+  RTC_DCHECK(receiver);
+  rtc::CritScope crit(&lock_);
+  routes_[destination] = receiver;
+}
+
+void EmulatedNetworkNode::RemoveRoute(uint64_t destination) {
+  rtc::CritScope crit(&lock_);
+  routes_.erase(destination);
+}
+
+void EmulatedNetworkNode::OnPacketReceived(EmulatedPacket packet) {
+  const int64_t now_us = clock_->TimeInMicroseconds();
+  rtc::CritScope crit(&lock_);
+  // Packets that have finished transmission have left the queue.
+  while (!link_departure_times_us_.empty() &&
+         link_departure_times_us_.front() <= now_us) {
+    link_departure_times_us_.pop_front();
+  }
+  if (config_.queue_length_packets > 0 &&
+      link_departure_times_us_.size() >= config_.queue_length_packets) {
+    ++dropped_packets_;
+    return;
+  }
+  if (ShouldDrop()) {
+    ++dropped_packets_;
+    return;
+  }
+
+  int64_t departure_time_us = now_us;
+  if (config_.link_capacity_kbps > 0) {
+    if (!link_departure_times_us_.empty())
+      departure_time_us = link_departure_times_us_.back();
+    departure_time_us +=
+        packet.size() * 8 * 1000 / config_.link_capacity_kbps;
+    link_departure_times_us_.push_back(departure_time_us);
+  }
+
+  int64_t delay_us = config_.queue_delay_ms * 1000;
+  if (config_.delay_standard_deviation_ms > 0) {
+    delay_us = std::max<int64_t>(
+        0, random_.Gaussian(config_.queue_delay_ms * 1000,
+                            config_.delay_standard_deviation_ms * 1000));
+  }
+  packet.arrival_time_us = departure_time_us + delay_us;
+
+  if (config_.allow_reordering || packets_.empty() ||
+      packets_.back().arrival_time_us <= packet.arrival_time_us) {
+    // Keep |packets_| ordered by arrival time.
+    auto it = std::upper_bound(
+        packets_.begin(), packets_.end(), packet.arrival_time_us,
+        [](int64_t arrival_time_us, const EmulatedPacket& other) {
+          return arrival_time_us < other.arrival_time_us;
+        });
+    packets_.insert(it, std::move(packet));
+  } else {
+    // No reordering: the packet can't overtake the ones before it.
+    packet.arrival_time_us = packets_.back().arrival_time_us;
+    packets_.push_back(std::move(packet));
+  }
+}
+
+size_t EmulatedNetworkNode::Process() {
+  const int64_t now_us = clock_->TimeInMicroseconds();
+  std::vector<std::pair<EmulatedNetworkReceiverInterface*, EmulatedPacket>>
+      to_deliver;
+  {
+    rtc::CritScope crit(&lock_);
+    while (!packets_.empty() && packets_.front().arrival_time_us <= now_us) {
+      auto route = routes_.find(packets_.front().to);
+      if (route == routes_.end()) {
+        ++dropped_packets_;
+      } else {
+        ++sent_packets_;
+        to_deliver.emplace_back(route->second, std::move(packets_.front()));
+      }
+      packets_.pop_front();
+    }
+  }
+  // Deliver without holding the lock, the next hop may be this node.
+  for (auto& delivery : to_deliver)
+    delivery.first->OnPacketReceived(std::move(delivery.second));
+  return to_deliver.size();
+}
+
+rtc::Optional<int64_t> EmulatedNetworkNode::NextProcessTimeUs() const {
+  rtc::CritScope crit(&lock_);
+  if (packets_.empty())
+    return rtc::Optional<int64_t>();
+  return rtc::Optional<int64_t>(packets_.front().arrival_time_us);
+}
+
+size_t EmulatedNetworkNode::sent_packets() const {
+  rtc::CritScope crit(&lock_);
+  return sent_packets_;
+}
+
+size_t EmulatedNetworkNode::dropped_packets() const {
+  rtc::CritScope crit(&lock_);
+  return dropped_packets_;
+}
+
+bool EmulatedNetworkNode::ShouldDrop() {
+  if (in_bad_state_) {
+    if (random_.Rand<double>() < config_.bad_to_good_probability)
+      in_bad_state_ = false;
+  } else {
+    if (random_.Rand<double>() < config_.good_to_bad_probability)
+      in_bad_state_ = true;
+  }
+  const double loss_probability = in_bad_state_
+                                      ? config_.loss_probability_bad
+                                      : config_.loss_probability_good;
+  return loss_probability > 0 && random_.Rand<double>() < loss_probability;
+}
+
+EmulatedEndpoint::EmulatedEndpoint(Clock* clock, uint64_t id)
+    : clock_(clock), id_(id) {}
+
+EmulatedEndpoint::~EmulatedEndpoint() = default;
+
+void EmulatedEndpoint::SetEgress(EmulatedNetworkReceiverInterface* egress) {
+  rtc::CritScope crit(&lock_);
+  egress_ = egress;
+}
+
+void EmulatedEndpoint::SetReceiver(
+    EmulatedNetworkReceiverInterface* receiver) {
+  rtc::CritScope crit(&lock_);
+  receiver_ = receiver;
+}
+
+void EmulatedEndpoint::SendPacket(uint64_t to,
+                                  const uint8_t* data,
+                                  size_t size) {
+  SendPacket(0, to, 0, data, size);
+}
+
+void EmulatedEndpoint::SendPacket(uint16_t from_port,
+                                  uint64_t to,
+                                  uint16_t to_port,
+                                  const uint8_t* data,
+                                  size_t size) {
+  EmulatedNetworkReceiverInterface* egress;
+  {
+    rtc::CritScope crit(&lock_);
+    egress = egress_;
+  }
+  RTC_CHECK(egress) << "No route from endpoint " << id_;
+  EmulatedPacket packet(id_, to, rtc::CopyOnWriteBuffer(data, size),
+                        clock_->TimeInMicroseconds());
+  packet.from_port = from_port;
+  packet.to_port = to_port;
+  egress->OnPacketReceived(std::move(packet));
+}
+
+void EmulatedEndpoint::OnPacketReceived(EmulatedPacket packet) {
+  RTC_DCHECK_EQ(id_, packet.to);
+  EmulatedNetworkReceiverInterface* receiver;
+  {
+    rtc::CritScope crit(&lock_);
+    ++received_packets_;
+    received_bytes_ += packet.size();
+    receiver = receiver_;
+  }
+  if (receiver)
+    receiver->OnPacketReceived(std::move(packet));
+}
+
+size_t EmulatedEndpoint::received_packets() const {
+  rtc::CritScope crit(&lock_);
+  return received_packets_;
+}
+
+size_t EmulatedEndpoint::received_bytes() const {
+  rtc::CritScope crit(&lock_);
+  return received_bytes_;
+}
+
+CrossTrafficSource::CrossTrafficSource(Clock* clock,
+                                       EmulatedEndpoint* endpoint,
+                                       uint64_t destination,
+                                       const Config& config)
+    : clock_(clock),
+      endpoint_(endpoint),
+      destination_(destination),
+      config_(config),
+      start_time_us_(clock->TimeInMicroseconds()),
+      next_send_time_us_(start_time_us_),
+      payload_(config.packet_size_bytes) {
+  RTC_DCHECK_GT(config_.packet_size_bytes, 0);
+}
+
+void CrossTrafficSource::Process() {
+  if (config_.bitrate_kbps <= 0)
+    return;
+  const int64_t now_us = clock_->TimeInMicroseconds();
+  const int64_t interval_us =
+      config_.packet_size_bytes * 8 * 1000 / config_.bitrate_kbps;
+  while (next_send_time_us_ <= now_us) {
+    if (IsOn(next_send_time_us_))
+      endpoint_->SendPacket(destination_, payload_.data(), payload_.size());
+    next_send_time_us_ += interval_us;
+  }
+}
+
+rtc::Optional<int64_t> CrossTrafficSource::NextProcessTimeUs() const {
+  if (config_.bitrate_kbps <= 0)
+    return rtc::Optional<int64_t>();
+  return rtc::Optional<int64_t>(next_send_time_us_);
+}
+
+bool CrossTrafficSource::IsOn(int64_t time_us) const {
+  if (config_.burst_on_ms <= 0 || config_.burst_off_ms <= 0)
+    return true;
+  const int64_t period_us = (config_.burst_on_ms + config_.burst_off_ms) * 1000;
+  return (time_us - start_time_us_) % period_us < config_.burst_on_ms * 1000;
+}
+
+NetworkEmulation::NetworkEmulation(SimulatedClock* clock)
+    : clock_(clock), simulated_clock_(clock) {}
+
+NetworkEmulation::NetworkEmulation()
+    : clock_(Clock::GetRealTimeClock()), simulated_clock_(nullptr) {}
+
+NetworkEmulation::~NetworkEmulation() = default;
+
+Clock* NetworkEmulation::clock() const {
+  return clock_;
+}
+
+EmulatedNetworkNode* NetworkEmulation::CreateNode(
+    const EmulatedLinkConfig& config) {
+  nodes_.push_back(
+      rtc::MakeUnique<EmulatedNetworkNode>(clock_, config, next_id_++));
+  return nodes_.back().get();
+}
+
+EmulatedEndpoint* NetworkEmulation::CreateEndpoint() {
+  endpoints_.push_back(rtc::MakeUnique<EmulatedEndpoint>(clock_, next_id_++));
+  return endpoints_.back().get();
+}
+
+CrossTrafficSource* NetworkEmulation::CreateCrossTraffic(
+    EmulatedEndpoint* from,
+    EmulatedEndpoint* to,
+    const CrossTrafficSource::Config& config) {
+  cross_traffic_.push_back(
+      rtc::MakeUnique<CrossTrafficSource>(clock_, from, to->id(), config));
+  return cross_traffic_.back().get();
+}
+
+void NetworkEmulation::CreateRoute(
+    EmulatedEndpoint* from,
+    const std::vector<EmulatedNetworkNode*>& nodes,
+    EmulatedEndpoint* to) {
+  if (nodes.empty()) {
+    from->SetEgress(to);
+    return;
+  }
+  from->SetEgress(nodes.front());
+  for (size_t i = 0; i + 1 < nodes.size(); ++i)
+    nodes[i]->SetRoute(to->id(), nodes[i + 1]);
+  nodes.back()->SetRoute(to->id(), to);
+}
+
+void NetworkEmulation::Process() {
+  size_t forwarded;
+  do {
+    for (auto& source : cross_traffic_)
+      source->Process();
+    forwarded = 0;
+    for (auto& node : nodes_)
+      forwarded += node->Process();
+  } while (forwarded > 0);
+}
+
+void NetworkEmulation::AdvanceTimeMs(int64_t duration_ms) {
+  RTC_CHECK(simulated_clock_);
+  const int64_t end_time_us = clock_->TimeInMicroseconds() + duration_ms * 1000;
+  Process();
+  for (rtc::Optional<int64_t> next_us = NextProcessTimeUs();
+       next_us && *next_us <= end_time_us; next_us = NextProcessTimeUs()) {
+    const int64_t now_us = clock_->TimeInMicroseconds();
+    if (*next_us > now_us)
+      simulated_clock_->AdvanceTimeMicroseconds(*next_us - now_us);
+    Process();
+  }
+  simulated_clock_->AdvanceTimeMicroseconds(end_time_us -
+                                            clock_->TimeInMicroseconds());
+  Process();
+}
+
+rtc::Optional<int64_t> NetworkEmulation::NextProcessTimeUs() const {
+  rtc::Optional<int64_t> next_us;
+  auto update = [&next_us](const rtc::Optional<int64_t>& time_us) {
+    if (time_us && (!next_us || *time_us < *next_us))
+      next_us = time_us;
+  };
+  for (const auto& node : nodes_)
+    update(node->NextProcessTimeUs());
+  for (const auto& source : cross_traffic_)
+    update(source->NextProcessTimeUs());
+  return next_us;
+}
+
+EmulatedCallTransport::EmulatedCallTransport(EmulatedEndpoint* endpoint,
+                                             uint64_t destination,
+                                             std::unique_ptr<Demuxer> demuxer)
+    : endpoint_(endpoint),
+      destination_(destination),
+      demuxer_(std::move(demuxer)) {
+  endpoint_->SetReceiver(this);
+}
+
+EmulatedCallTransport::~EmulatedCallTransport() {
+  endpoint_->SetReceiver(nullptr);
+}
+
+void EmulatedCallTransport::SetReceiver(PacketReceiver* receiver) {
+  demuxer_->SetReceiver(receiver);
+}
+
+bool EmulatedCallTransport::SendRtp(const uint8_t* data,
+                                    size_t length,
+                                    const PacketOptions& options) {
+  endpoint_->SendPacket(destination_, data, length);
+  return true;
+}
+
+bool EmulatedCallTransport::SendRtcp(const uint8_t* data, size_t length) {
+  endpoint_->SendPacket(destination_, data, length);
+  return true;
+}
+
+void EmulatedCallTransport::OnPacketReceived(EmulatedPacket packet) {
+  NetworkPacket network_packet(packet.data.cdata(), packet.size(),
+                               packet.send_time_us / 1000,
+                               packet.arrival_time_us / 1000);
+  demuxer_->DeliverPacket(&network_packet, PacketTime());
+}
+
+}  // namespace test
+}  // namespace webrtc
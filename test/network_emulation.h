@@ -0,0 +1,296 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef TEST_NETWORK_EMULATION_H_
+#define TEST_NETWORK_EMULATION_H_
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "api/call/transport.h"
+#include "api/optional.h"
+#include "rtc_base/constructormagic.h"
+#include "rtc_base/copyonwritebuffer.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/random.h"
+#include "rtc_base/thread_annotations.h"
+#include "test/fake_network_pipe.h"
+
+namespace webrtc {
+
+class Clock;
+class PacketReceiver;
+class SimulatedClock;
+
+namespace test {
+
+// Network emulation for tests. Unlike FakeNetworkPipe, which models a single
+// link, the classes below compose into topologies: endpoints send packets
+// through chains of nodes, each modelling one hop with its own capacity,
+// queue, delay, jitter, reordering and (bursty) loss. Several routes may share
+// a node, e.g. to model a bottleneck shared with cross traffic, and routes can
+// be changed while packets are in flight. NetworkEmulation owns the objects
+// and drives them on a SimulatedClock, so tests run faster than real time.
+
+struct EmulatedPacket {
+  EmulatedPacket(uint64_t from,
+                 uint64_t to,
+                 rtc::CopyOnWriteBuffer data,
+                 int64_t send_time_us);
+
+  size_t size() const { return data.size(); }
+
+  // Ids of the sending and receiving EmulatedEndpoint.
+  uint64_t from;
+  uint64_t to;
+  // Ports at the endpoints, for users that multiplex several sockets on an
+  // endpoint, like EmulatedVirtualNetwork. Zero otherwise.
+  uint16_t from_port = 0;
+  uint16_t to_port = 0;
+  rtc::CopyOnWriteBuffer data;
+  // Time the packet was sent by its endpoint.
+  int64_t send_time_us;
+  // Time the packet leaves the node it's in.
+  int64_t arrival_time_us;
+};
+
+class EmulatedNetworkReceiverInterface {
+ public:
+  virtual ~EmulatedNetworkReceiverInterface() = default;
+  virtual void OnPacketReceived(EmulatedPacket packet) = 0;
+};
+
+struct EmulatedLinkConfig {
+  // Queue length in number of packets, 0 for no limit.
+  size_t queue_length_packets = 0;
+  // Delay in addition to capacity induced delay.
+  int queue_delay_ms = 0;
+  // Standard deviation of the extra delay.
+  int delay_standard_deviation_ms = 0;
+  // Link capacity in kbps, 0 for no limit.
+  int link_capacity_kbps = 0;
+  // If packets are allowed to be reordered by the delay variation.
+  bool allow_reordering = false;
+  // Gilbert-Elliott loss model. Before each packet the link moves from the
+  // good to the bad state, or back, with the given probabilities, and the
+  // packet is then lost with the loss probability of the current state. The
+  // defaults model a lossless link; setting only |loss_probability_good|
+  // gives uniformly random loss.
+  double loss_probability_good = 0.0;
+  double loss_probability_bad = 0.0;
+  double good_to_bad_probability = 0.0;
+  double bad_to_good_probability = 1.0;
+};
+
+// One hop of the emulated network. Packets are forwarded to the receiver of
+// the route for their destination, and dropped if there is none.
+class EmulatedNetworkNode : public EmulatedNetworkReceiverInterface {
+ public:
+  EmulatedNetworkNode(Clock* clock,
+                      const EmulatedLinkConfig& config,
+                      uint64_t seed);
+  ~EmulatedNetworkNode() override;
+
+  // Sets a new configuration. This won't affect packets already in transit.
+  void SetConfig(const EmulatedLinkConfig& config);
+
+  // Forwards packets to |destination| to |receiver|. Changing a route takes
+  // effect for all packets leaving the node afterwards, including those
+  // already in transit.
+  void SetRoute(uint64_t destination,
+                EmulatedNetworkReceiverInterface* receiver);
+  void RemoveRoute(uint64_t destination);
+
+  void OnPacketReceived(EmulatedPacket packet) override;
+
+  // Forwards the packets that have passed the node by now. Returns the number
+  // of packets forwarded.
+  size_t Process();
+  // Time at which the next packet in transit leaves the node.
+  rtc::Optional<int64_t> NextProcessTimeUs() const;
+
+  size_t sent_packets() const;
+  size_t dropped_packets() const;
+
+ private:
+  bool ShouldDrop() RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  Clock* const clock_;
+  rtc::CriticalSection lock_;
+  EmulatedLinkConfig config_ RTC_GUARDED_BY(lock_);
+  Random random_ RTC_GUARDED_BY(lock_);
+  std::map<uint64_t, EmulatedNetworkReceiverInterface*> routes_
+      RTC_GUARDED_BY(lock_);
+  // Times at which the packets waiting for the link finish transmission.
+  std::deque<int64_t> link_departure_times_us_ RTC_GUARDED_BY(lock_);
+  // Packets in transit, ordered by arrival time.
+  std::deque<EmulatedPacket> packets_ RTC_GUARDED_BY(lock_);
+  bool in_bad_state_ RTC_GUARDED_BY(lock_) = false;
+  size_t sent_packets_ RTC_GUARDED_BY(lock_) = 0;
+  size_t dropped_packets_ RTC_GUARDED_BY(lock_) = 0;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(EmulatedNetworkNode);
+};
+
+// A network interface sending packets into the network and receiving the
+// packets addressed to its id.
+class EmulatedEndpoint : public EmulatedNetworkReceiverInterface {
+ public:
+  EmulatedEndpoint(Clock* clock, uint64_t id);
+  ~EmulatedEndpoint() override;
+
+  uint64_t id() const { return id_; }
+
+  // Sets the first hop of outgoing packets.
+  void SetEgress(EmulatedNetworkReceiverInterface* egress);
+  // Sets where incoming packets are delivered. May be null.
+  void SetReceiver(EmulatedNetworkReceiverInterface* receiver);
+
+  void SendPacket(uint64_t to, const uint8_t* data, size_t size);
+  void SendPacket(uint16_t from_port,
+                  uint64_t to,
+                  uint16_t to_port,
+                  const uint8_t* data,
+                  size_t size);
+
+  void OnPacketReceived(EmulatedPacket packet) override;
+
+  size_t received_packets() const;
+  size_t received_bytes() const;
+
+ private:
+  Clock* const clock_;
+  const uint64_t id_;
+  rtc::CriticalSection lock_;
+  EmulatedNetworkReceiverInterface* egress_ RTC_GUARDED_BY(lock_) = nullptr;
+  EmulatedNetworkReceiverInterface* receiver_ RTC_GUARDED_BY(lock_) = nullptr;
+  size_t received_packets_ RTC_GUARDED_BY(lock_) = 0;
+  size_t received_bytes_ RTC_GUARDED_BY(lock_) = 0;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(EmulatedEndpoint);
+};
+
+// Sends constant bitrate cross traffic from an endpoint, optionally in on/off
+// bursts.
+class CrossTrafficSource {
+ public:
+  struct Config {
+    int bitrate_kbps = 0;
+    size_t packet_size_bytes = 1200;
+    // If both are set, the source alternates between sending for
+    // |burst_on_ms| and being silent for |burst_off_ms|.
+    int burst_on_ms = 0;
+    int burst_off_ms = 0;
+  };
+
+  CrossTrafficSource(Clock* clock,
+                     EmulatedEndpoint* endpoint,
+                     uint64_t destination,
+                     const Config& config);
+
+  // Sends the packets that are due by now.
+  void Process();
+  rtc::Optional<int64_t> NextProcessTimeUs() const;
+
+ private:
+  bool IsOn(int64_t time_us) const;
+
+  Clock* const clock_;
+  EmulatedEndpoint* const endpoint_;
+  const uint64_t destination_;
+  const Config config_;
+  const int64_t start_time_us_;
+  int64_t next_send_time_us_;
+  std::vector<uint8_t> payload_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(CrossTrafficSource);
+};
+
+// Owns and runs an emulated network on a simulated clock.
+class NetworkEmulation {
+ public:
+  explicit NetworkEmulation(SimulatedClock* clock);
+  // Runs on rtc::TimeMicros(), which an rtc::ScopedFakeClock can advance,
+  // e.g. the one of a VirtualSocketServer connected with
+  // EmulatedVirtualNetwork. AdvanceTimeMs() can't be used; the owner of the
+  // clock calls Process() at NextProcessTimeUs() instead.
+  NetworkEmulation();
+  ~NetworkEmulation();
+
+  Clock* clock() const;
+
+  EmulatedNetworkNode* CreateNode(const EmulatedLinkConfig& config);
+  EmulatedEndpoint* CreateEndpoint();
+  CrossTrafficSource* CreateCrossTraffic(
+      EmulatedEndpoint* from,
+      EmulatedEndpoint* to,
+      const CrossTrafficSource::Config& config);
+
+  // Routes packets from |from| to |to| through |nodes|, in order. Calling it
+  // again for the same endpoints changes the route.
+  void CreateRoute(EmulatedEndpoint* from,
+                   const std::vector<EmulatedNetworkNode*>& nodes,
+                   EmulatedEndpoint* to);
+
+  // Processes everything that is due by now, including packets that pass
+  // several nodes without delay.
+  void Process();
+  // Advances the clock by |duration_ms|, stopping at each event on the way.
+  void AdvanceTimeMs(int64_t duration_ms);
+  // Time at which Process() next has something to do.
+  rtc::Optional<int64_t> NextProcessTimeUs() const;
+
+ private:
+  Clock* const clock_;
+  // Null if running on rtc::TimeMicros().
+  SimulatedClock* const simulated_clock_;
+  uint64_t next_id_ = 1;
+  std::vector<std::unique_ptr<EmulatedNetworkNode>> nodes_;
+  std::vector<std::unique_ptr<EmulatedEndpoint>> endpoints_;
+  std::vector<std::unique_ptr<CrossTrafficSource>> cross_traffic_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(NetworkEmulation);
+};
+
+// Connects a Call to an emulated network, in place of DirectTransport.
+// Outgoing packets are sent from |endpoint| to |destination|; packets arriving
+// at |endpoint| are passed to the receiver set with SetReceiver() through
+// |demuxer|.
+class EmulatedCallTransport : public Transport,
+                              public EmulatedNetworkReceiverInterface {
+ public:
+  EmulatedCallTransport(EmulatedEndpoint* endpoint,
+                        uint64_t destination,
+                        std::unique_ptr<Demuxer> demuxer);
+  ~EmulatedCallTransport() override;
+
+  void SetReceiver(PacketReceiver* receiver);
+
+  bool SendRtp(const uint8_t* data,
+               size_t length,
+               const PacketOptions& options) override;
+  bool SendRtcp(const uint8_t* data, size_t length) override;
+
+  void OnPacketReceived(EmulatedPacket packet) override;
+
+ private:
+  EmulatedEndpoint* const endpoint_;
+  const uint64_t destination_;
+  const std::unique_ptr<Demuxer> demuxer_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(EmulatedCallTransport);
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // TEST_NETWORK_EMULATION_H_
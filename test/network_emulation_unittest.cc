@@ -0,0 +1,241 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "test/network_emulation.h"
+
+#include <map>
+#include <vector>
+
+#include "call/call.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/ptr_util.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+class PacketRecorder : public EmulatedNetworkReceiverInterface {
+ public:
+  void OnPacketReceived(EmulatedPacket packet) override {
+    delays_ms.push_back((packet.arrival_time_us - packet.send_time_us) / 1000);
+  }
+
+  std::vector<int64_t> delays_ms;
+};
+
+// Records the time at which each RTP packet is delivered by an
+// EmulatedCallTransport, by sequence number.
+class RtpRecorder : public PacketReceiver {
+ public:
+  explicit RtpRecorder(Clock* clock) : clock_(clock) {}
+
+  DeliveryStatus DeliverPacket(MediaType media_type,
+                               const uint8_t* packet,
+                               size_t length,
+                               const PacketTime& packet_time) override {
+    RtpPacketReceived rtp_packet;
+    if (media_type != MediaType::VIDEO || !rtp_packet.Parse(packet, length))
+      return DELIVERY_PACKET_ERROR;
+    receive_times_ms[rtp_packet.SequenceNumber()] =
+        clock_->TimeInMilliseconds();
+    return DELIVERY_OK;
+  }
+
+  std::map<uint16_t, int64_t> receive_times_ms;
+
+ private:
+  Clock* const clock_;
+};
+
+class NetworkEmulationTest : public ::testing::Test {
+ protected:
+  NetworkEmulationTest() : clock_(12345000), network_(&clock_) {}
+
+  void SendPackets(EmulatedEndpoint* from,
+                   EmulatedEndpoint* to,
+                   int count,
+                   size_t size) {
+    std::vector<uint8_t> data(size);
+    for (int i = 0; i < count; ++i)
+      from->SendPacket(to->id(), data.data(), data.size());
+  }
+
+  SimulatedClock clock_;
+  NetworkEmulation network_;
+};
+
+TEST_F(NetworkEmulationTest, AddsDelayOfEachHop) {
+  EmulatedLinkConfig config;
+  config.queue_delay_ms = 20;
+  EmulatedNetworkNode* first = network_.CreateNode(config);
+  config.queue_delay_ms = 30;
+  EmulatedNetworkNode* second = network_.CreateNode(config);
+  EmulatedEndpoint* alice = network_.CreateEndpoint();
+  EmulatedEndpoint* bob = network_.CreateEndpoint();
+  PacketRecorder recorder;
+  bob->SetReceiver(&recorder);
+  network_.CreateRoute(alice, {first, second}, bob);
+
+  SendPackets(alice, bob, 1, 100);
+  network_.AdvanceTimeMs(49);
+  EXPECT_EQ(0u, bob->received_packets());
+  network_.AdvanceTimeMs(1);
+  EXPECT_EQ(1u, bob->received_packets());
+  ASSERT_EQ(1u, recorder.delays_ms.size());
+  EXPECT_EQ(50, recorder.delays_ms[0]);
+}
+
+TEST_F(NetworkEmulationTest, CrossTrafficSharesBottleneck) {
+  EmulatedLinkConfig config;
+  config.link_capacity_kbps = 1000;
+  EmulatedNetworkNode* bottleneck = network_.CreateNode(config);
+  EmulatedEndpoint* alice = network_.CreateEndpoint();
+  EmulatedEndpoint* bob = network_.CreateEndpoint();
+  EmulatedEndpoint* cross_sender = network_.CreateEndpoint();
+  EmulatedEndpoint* cross_receiver = network_.CreateEndpoint();
+  network_.CreateRoute(alice, {bottleneck}, bob);
+  network_.CreateRoute(cross_sender, {bottleneck}, cross_receiver);
+
+  // Alice sends 1250 byte (10 kbit) packets at the full 1000 kbps link
+  // capacity, i.e. one every 10 ms. Without cross traffic all of them pass.
+  for (int i = 0; i < 100; ++i) {
+    SendPackets(alice, bob, 1, 1250);
+    network_.AdvanceTimeMs(10);
+  }
+  EXPECT_EQ(100u, bob->received_packets());
+
+  // With another 500 kbps of cross traffic, the link is shared in proportion
+  // to the offered load and alice gets two thirds of it.
+  CrossTrafficSource::Config cross_config;
+  cross_config.bitrate_kbps = 500;
+  cross_config.packet_size_bytes = 1250;
+  network_.CreateCrossTraffic(cross_sender, cross_receiver, cross_config);
+  for (int i = 0; i < 100; ++i) {
+    SendPackets(alice, bob, 1, 1250);
+    network_.AdvanceTimeMs(10);
+  }
+  EXPECT_NEAR(167u, bob->received_packets(), 3);
+  EXPECT_GT(cross_receiver->received_packets(), 0u);
+}
+
+TEST_F(NetworkEmulationTest, GilbertElliottLossIsBursty) {
+  EmulatedLinkConfig config;
+  config.loss_probability_bad = 1.0;
+  config.good_to_bad_probability = 0.01;
+  config.bad_to_good_probability = 0.1;
+  EmulatedNetworkNode* node = network_.CreateNode(config);
+  EmulatedEndpoint* alice = network_.CreateEndpoint();
+  EmulatedEndpoint* bob = network_.CreateEndpoint();
+  network_.CreateRoute(alice, {node}, bob);
+
+  std::vector<bool> received;
+  std::vector<uint8_t> data(100);
+  for (int i = 0; i < 10000; ++i) {
+    size_t received_before = bob->received_packets();
+    alice->SendPacket(bob->id(), data.data(), data.size());
+    network_.Process();
+    received.push_back(bob->received_packets() > received_before);
+  }
+  int losses = 0;
+  int loss_bursts = 0;
+  for (size_t i = 0; i < received.size(); ++i) {
+    if (!received[i]) {
+      ++losses;
+      if (i == 0 || received[i - 1])
+        ++loss_bursts;
+    }
+  }
+  // Stationary loss rate 0.01 / (0.01 + 0.1) ~= 9 %, with a mean burst
+  // length of 10 packets.
+  EXPECT_NEAR(0.09, losses / 10000.0, 0.03);
+  EXPECT_GT(losses, 5 * loss_bursts);
+  EXPECT_EQ(static_cast<size_t>(losses), node->dropped_packets());
+}
+
+TEST_F(NetworkEmulationTest, RouteChangeAffectsPacketsInTransit) {
+  EmulatedLinkConfig config;
+  config.queue_delay_ms = 100;
+  EmulatedNetworkNode* slow = network_.CreateNode(config);
+  config.queue_delay_ms = 10;
+  EmulatedNetworkNode* fast = network_.CreateNode(config);
+  EmulatedEndpoint* alice = network_.CreateEndpoint();
+  EmulatedEndpoint* bob = network_.CreateEndpoint();
+  PacketRecorder recorder;
+  bob->SetReceiver(&recorder);
+  network_.CreateRoute(alice, {slow, fast}, bob);
+
+  SendPackets(alice, bob, 1, 100);
+  network_.AdvanceTimeMs(50);
+  // The packet in |slow| now skips |fast|.
+  network_.CreateRoute(alice, {slow}, bob);
+  network_.AdvanceTimeMs(100);
+  ASSERT_EQ(1u, recorder.delays_ms.size());
+  EXPECT_EQ(100, recorder.delays_ms[0]);
+  EXPECT_EQ(0u, fast->sent_packets());
+
+  // Without a route packets are dropped.
+  slow->RemoveRoute(bob->id());
+  SendPackets(alice, bob, 1, 100);
+  network_.AdvanceTimeMs(100);
+  EXPECT_EQ(1u, bob->received_packets());
+  EXPECT_EQ(1u, slow->dropped_packets());
+}
+
+TEST_F(NetworkEmulationTest, CallTransportDeliversRtpWithDelayAndLoss) {
+  const uint8_t kPayloadType = 96;
+  const int kNumPackets = 1000;
+  EmulatedLinkConfig config;
+  config.queue_delay_ms = 40;
+  config.loss_probability_good = 0.1;
+  EmulatedNetworkNode* node = network_.CreateNode(config);
+  EmulatedEndpoint* alice = network_.CreateEndpoint();
+  EmulatedEndpoint* bob = network_.CreateEndpoint();
+  network_.CreateRoute(alice, {node}, bob);
+
+  const std::map<uint8_t, MediaType> payload_types = {
+      {kPayloadType, MediaType::VIDEO}};
+  EmulatedCallTransport sender(alice, bob->id(),
+                               rtc::MakeUnique<DemuxerImpl>(payload_types));
+  EmulatedCallTransport receiver(bob, alice->id(),
+                                 rtc::MakeUnique<DemuxerImpl>(payload_types));
+  RtpRecorder recorder(&clock_);
+  receiver.SetReceiver(&recorder);
+
+  std::map<uint16_t, int64_t> send_times_ms;
+  RtpPacketToSend packet(nullptr);
+  packet.SetPayloadType(kPayloadType);
+  packet.SetSsrc(1234);
+  packet.AllocatePayload(1000);
+  for (uint16_t seq = 0; seq < kNumPackets; ++seq) {
+    packet.SetSequenceNumber(seq);
+    send_times_ms[seq] = clock_.TimeInMilliseconds();
+    EXPECT_TRUE(sender.SendRtp(packet.data(), packet.size(), PacketOptions()));
+    network_.AdvanceTimeMs(5);
+  }
+  network_.AdvanceTimeMs(config.queue_delay_ms);
+
+  for (const auto& received : recorder.receive_times_ms) {
+    ASSERT_EQ(1u, send_times_ms.count(received.first));
+    EXPECT_EQ(config.queue_delay_ms,
+              received.second - send_times_ms[received.first]);
+  }
+  EXPECT_EQ(bob->received_packets(), recorder.receive_times_ms.size());
+  EXPECT_EQ(static_cast<size_t>(kNumPackets),
+            recorder.receive_times_ms.size() + node->dropped_packets());
+  EXPECT_NEAR(kNumPackets * 0.9, recorder.receive_times_ms.size(),
+              kNumPackets * 0.03);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace webrtc
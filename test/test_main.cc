@@ -8,7 +8,13 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <string.h>
+
+#include <string>
+
+#include "rtc_base/file.h"
 #include "rtc_base/flags.h"
+#include "rtc_base/lockprofiler.h"
 #include "rtc_base/logging.h"
 #include "system_wrappers/include/metrics_default.h"
 #include "test/field_trial.h"
@@ -32,8 +38,35 @@ DEFINE_string(force_fieldtrials, "",
     "E.g. running with --force_fieldtrials=WebRTC-FooFeature/Enable/"
     " will assign the group Enable to field trial WebRTC-FooFeature.");
 
+DEFINE_string(lock_profile_output, "",
+    "Requires a build with rtc_enable_lock_profiling=true. After all tests "
+    "have run, write the rtc::CriticalSection acquisition sites ranked by "
+    "contention to this file.");
+
 DEFINE_bool(help, false, "Print this message.");
 
+namespace {
+
+const size_t kLockProfileMaxSites = 100;
+
+void WriteLockProfile(const std::string& path) {
+  if (!rtc::LockProfiler::IsEnabled()) {
+    LOG(LS_WARNING) << "Lock profiling was not compiled in; build with "
+                       "rtc_enable_lock_profiling=true.";
+    return;
+  }
+  const std::string report =
+      rtc::LockProfiler::ReportToString(kLockProfileMaxSites);
+  rtc::File file = rtc::File::Create(path);
+  if (!file.IsOpen() ||
+      file.Write(reinterpret_cast<const uint8_t*>(report.data()),
+                 report.size()) != report.size()) {
+    LOG(LS_ERROR) << "Failed to write lock profile to " << path;
+  }
+}
+
+}  // namespace
+
 int main(int argc, char* argv[]) {
   ::testing::InitGoogleMock(&argc, argv);
 
@@ -61,5 +94,8 @@ int main(int argc, char* argv[]) {
   rtc::test::RunTestsFromIOSApp();
 #endif
 
-  return RUN_ALL_TESTS();
+  const int exit_code = RUN_ALL_TESTS();
+  if (strlen(FLAG_lock_profile_output) > 0)
+    WriteLockProfile(FLAG_lock_profile_output);
+  return exit_code;
 }
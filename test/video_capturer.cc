@@ -33,11 +33,14 @@ rtc::Optional<VideoFrame> VideoCapturer::AdaptFrame(const VideoFrame& frame) {
 
   rtc::Optional<VideoFrame> out_frame;
   if (out_height != frame.height() || out_width != frame.width()) {
-    // Video adapter has requested a down-scale. Allocate a new buffer and
-    // return scaled version.
+    // Video adapter has requested a down-scale. Crop and scale in one pass
+    // into a pooled buffer and return that.
     rtc::scoped_refptr<I420Buffer> scaled_buffer =
-        I420Buffer::Create(out_width, out_height);
-    scaled_buffer->ScaleFrom(*frame.video_frame_buffer()->ToI420());
+        scaled_buffer_pool_.CreateBuffer(out_width, out_height);
+    scaled_buffer->CropAndScaleFrom(*frame.video_frame_buffer()->ToI420(),
+                                    (frame.width() - cropped_width) / 2,
+                                    (frame.height() - cropped_height) / 2,
+                                    cropped_width, cropped_height);
     out_frame.emplace(
         VideoFrame(scaled_buffer, kVideoRotation_0, frame.timestamp_us()));
   } else {
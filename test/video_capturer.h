@@ -17,6 +17,7 @@
 #include "api/optional.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_frame.h"
+#include "common_video/include/i420_buffer_pool.h"
 #include "media/base/videoadapter.h"
 #include "media/base/videosourceinterface.h"
 #include "rtc_base/criticalsection.h"
@@ -46,6 +47,8 @@ class VideoCapturer : public rtc::VideoSourceInterface<VideoFrame> {
 
  private:
   const std::unique_ptr<cricket::VideoAdapter> video_adapter_;
+  // Buffers for adapted frames, reused until the adapted resolution changes.
+  I420BufferPool scaled_buffer_pool_;
 };
 }  // namespace test
 }  // namespace webrtc
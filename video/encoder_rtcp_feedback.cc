@@ -23,7 +23,8 @@ EncoderRtcpFeedback::EncoderRtcpFeedback(Clock* clock,
     : clock_(clock),
       ssrcs_(ssrcs),
       video_stream_encoder_(encoder),
-      time_last_intra_request_ms_(ssrcs.size(), -1) {
+      time_last_intra_request_ms_(ssrcs.size(), -1),
+      shared_encoder_feedback_(nullptr) {
   RTC_DCHECK(!ssrcs.empty());
 }
 
@@ -47,20 +48,40 @@ size_t EncoderRtcpFeedback::GetStreamIndex(uint32_t ssrc) {
 
 void EncoderRtcpFeedback::OnReceivedIntraFrameRequest(uint32_t ssrc) {
   RTC_DCHECK(HasSsrc(ssrc));
-  size_t index = GetStreamIndex(ssrc);
+  RequestKeyFrame(GetStreamIndex(ssrc));
+}
+
+void EncoderRtcpFeedback::SetSharedEncoderFeedback(
+    EncoderRtcpFeedback* leader) {
+  RTC_DCHECK_NE(this, leader);
+  rtc::CritScope lock(&crit_);
+  shared_encoder_feedback_ = leader;
+}
+
+void EncoderRtcpFeedback::RequestKeyFrame(size_t stream_index) {
+  EncoderRtcpFeedback* shared_encoder_feedback;
   {
     // TODO(mflodman): Move to VideoStreamEncoder after some more changes making
     // it easier to test there.
     int64_t now_ms = clock_->TimeInMilliseconds();
     rtc::CritScope lock(&crit_);
-    if (time_last_intra_request_ms_[index] + kMinKeyFrameRequestIntervalMs >
+    if (time_last_intra_request_ms_[stream_index] +
+            kMinKeyFrameRequestIntervalMs >
         now_ms) {
       return;
     }
-    time_last_intra_request_ms_[index] = now_ms;
+    time_last_intra_request_ms_[stream_index] = now_ms;
+    shared_encoder_feedback = shared_encoder_feedback_;
   }
 
-  video_stream_encoder_->OnReceivedIntraFrameRequest(index);
+  if (shared_encoder_feedback) {
+    RTC_DCHECK_LT(stream_index, shared_encoder_feedback->ssrcs_.size());
+    shared_encoder_feedback->RequestKeyFrame(stream_index);
+    return;
+  }
+  // Streams sharing an encoder have none of their own.
+  if (video_stream_encoder_)
+    video_stream_encoder_->OnReceivedIntraFrameRequest(stream_index);
 }
 
 }  // namespace webrtc
@@ -28,9 +28,17 @@ class EncoderRtcpFeedback : public RtcpIntraFrameObserver {
                        VideoStreamEncoder* encoder);
   void OnReceivedIntraFrameRequest(uint32_t ssrc) override;
 
+  // Forwards key frame requests to |leader| instead of to the own encoder,
+  // for streams sending the output of |leader|'s encoder. Requests from all
+  // streams sharing that encoder are then rate limited together, so that N
+  // receivers asking for a key frame at once result in a single key frame.
+  // Passing null restores the own encoder.
+  void SetSharedEncoderFeedback(EncoderRtcpFeedback* leader);
+
  private:
   bool HasSsrc(uint32_t ssrc);
   size_t GetStreamIndex(uint32_t ssrc);
+  void RequestKeyFrame(size_t stream_index);
 
   Clock* const clock_;
   const std::vector<uint32_t> ssrcs_;
@@ -38,6 +46,7 @@ class EncoderRtcpFeedback : public RtcpIntraFrameObserver {
 
   rtc::CriticalSection crit_;
   std::vector<int64_t> time_last_intra_request_ms_ RTC_GUARDED_BY(crit_);
+  EncoderRtcpFeedback* shared_encoder_feedback_ RTC_GUARDED_BY(crit_);
 };
 
 }  // namespace webrtc
@@ -77,4 +77,29 @@ TEST_F(VieKeyRequestTest, TooManyOnReceivedIntraFrameRequest) {
   encoder_rtcp_feedback_.OnReceivedIntraFrameRequest(kSsrc);
 }
 
+TEST_F(VieKeyRequestTest, ForwardsRequestsToSharedEncoderFeedback) {
+  const uint32_t kFollowerSsrc = 5678;
+  NiceMock<MockVideoStreamEncoder> follower_encoder(&send_stats_proxy_);
+  EncoderRtcpFeedback follower_feedback(
+      &simulated_clock_, std::vector<uint32_t>(1, kFollowerSsrc),
+      &follower_encoder);
+  follower_feedback.SetSharedEncoderFeedback(&encoder_rtcp_feedback_);
+
+  // Requests from the leader and the follower are coalesced.
+  EXPECT_CALL(follower_encoder, OnReceivedIntraFrameRequest(0)).Times(0);
+  EXPECT_CALL(encoder_, OnReceivedIntraFrameRequest(0)).Times(1);
+  encoder_rtcp_feedback_.OnReceivedIntraFrameRequest(kSsrc);
+  follower_feedback.OnReceivedIntraFrameRequest(kFollowerSsrc);
+
+  EXPECT_CALL(encoder_, OnReceivedIntraFrameRequest(0)).Times(1);
+  simulated_clock_.AdvanceTimeMilliseconds(300);
+  follower_feedback.OnReceivedIntraFrameRequest(kFollowerSsrc);
+  encoder_rtcp_feedback_.OnReceivedIntraFrameRequest(kSsrc);
+
+  follower_feedback.SetSharedEncoderFeedback(nullptr);
+  EXPECT_CALL(follower_encoder, OnReceivedIntraFrameRequest(0)).Times(1);
+  simulated_clock_.AdvanceTimeMilliseconds(300);
+  follower_feedback.OnReceivedIntraFrameRequest(kFollowerSsrc);
+}
+
 }  // namespace webrtc
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/temporal_layer_filter.h"
+
+#include "modules/video_coding/codecs/interface/common_constants.h"
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+TemporalLayerFilter::TemporalLayerFilter() = default;
+
+TemporalLayerFilter::~TemporalLayerFilter() = default;
+
+void TemporalLayerFilter::SetTargetBitrate(uint32_t bitrate_bps) {
+  rtc::CritScope lock(&crit_);
+  target_bitrate_bps_ = rtc::Optional<uint32_t>(bitrate_bps);
+}
+
+void TemporalLayerFilter::OnBitrateAllocationUpdated(
+    const BitrateAllocation& allocation) {
+  rtc::CritScope lock(&crit_);
+  allocation_ = allocation;
+}
+
+bool TemporalLayerFilter::OnEncodedFrame(CodecSpecificInfo* info) {
+  if (info->codecType != kVideoCodecVP8)
+    return true;
+  CodecSpecificInfoVP8* vp8 = &info->codecSpecific.VP8;
+  if (vp8->temporalIdx == kNoTemporalIdx)
+    return true;
+  RTC_DCHECK_LT(vp8->simulcastIdx, kMaxSimulcastStreams);
+
+  rtc::CritScope lock(&crit_);
+  StreamState* stream = &streams_[vp8->simulcastIdx];
+  // Temporal layers can be dropped at any frame, but only be added back at
+  // frames that don't depend on earlier frames of the layers above the base
+  // layer.
+  const int max_temporal_layer = SelectMaxTemporalLayer();
+  if (max_temporal_layer < stream->max_temporal_layer || vp8->layerSync ||
+      vp8->temporalIdx == 0) {
+    stream->max_temporal_layer = max_temporal_layer;
+  }
+  if (vp8->temporalIdx > stream->max_temporal_layer) {
+    if (vp8->pictureId != kNoPictureId)
+      --stream->picture_id_offset;
+    return false;
+  }
+  if (vp8->pictureId != kNoPictureId) {
+    vp8->pictureId = static_cast<int16_t>(
+        (vp8->pictureId + stream->picture_id_offset) & 0x7FFF);
+  }
+  return true;
+}
+
+int TemporalLayerFilter::SelectMaxTemporalLayer() const {
+  if (!target_bitrate_bps_)
+    return kMaxTemporalStreams - 1;
+  // Each temporal layer depends on all the ones below it, in every simulcast
+  // stream, which the allocation has as spatial layers.
+  uint32_t bitrate_bps = 0;
+  for (int tid = 0; tid < kMaxTemporalStreams; ++tid) {
+    for (int sid = 0; sid < kMaxSpatialLayers; ++sid)
+      bitrate_bps += allocation_.GetBitrate(sid, tid);
+    // The base layer is always sent.
+    if (tid > 0 && bitrate_bps > *target_bitrate_bps_)
+      return tid - 1;
+  }
+  return kMaxTemporalStreams - 1;
+}
+
+}  // namespace webrtc
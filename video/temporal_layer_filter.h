@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_TEMPORAL_LAYER_FILTER_H_
+#define VIDEO_TEMPORAL_LAYER_FILTER_H_
+
+#include "api/optional.h"
+#include "common_types.h"  // NOLINT(build/include)
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+struct CodecSpecificInfo;
+
+// Drops the VP8 temporal layers of encoder output that don't fit the bitrate
+// of a stream sending it, for a video send stream sharing the encoder of
+// another stream (see VideoSendStream::Config::shared_encoder_leader_ssrc).
+// The encoder runs at the bitrate of the stream that owns it, so a stream with
+// less bandwidth sends only the lower temporal layers. Picture ids are
+// rewritten to stay continuous, so that receivers don't wait for the frames
+// that were dropped.
+class TemporalLayerFilter {
+ public:
+  TemporalLayerFilter();
+  ~TemporalLayerFilter();
+
+  // Sets the bitrate available to the stream, from its own bandwidth
+  // estimate. All temporal layers are sent until this is called.
+  void SetTargetBitrate(uint32_t bitrate_bps);
+  // Sets the bitrate of each layer of the shared encoder.
+  void OnBitrateAllocationUpdated(const BitrateAllocation& allocation);
+
+  // Returns false if the frame described by |info| is to be dropped.
+  // Otherwise rewrites the picture id in |info|, if any.
+  bool OnEncodedFrame(CodecSpecificInfo* info);
+
+ private:
+  struct StreamState {
+    int max_temporal_layer = kMaxTemporalStreams - 1;
+    int16_t picture_id_offset = 0;
+  };
+
+  int SelectMaxTemporalLayer() const RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  rtc::CriticalSection crit_;
+  rtc::Optional<uint32_t> target_bitrate_bps_ RTC_GUARDED_BY(crit_);
+  BitrateAllocation allocation_ RTC_GUARDED_BY(crit_);
+  // Per simulcast stream, which have separate picture id sequences.
+  StreamState streams_[kMaxSimulcastStreams] RTC_GUARDED_BY(crit_);
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_TEMPORAL_LAYER_FILTER_H_
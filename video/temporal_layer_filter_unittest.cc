@@ -0,0 +1,142 @@
+/*
+ *  Copyright (c) 2017 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/temporal_layer_filter.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "modules/video_coding/codecs/interface/common_constants.h"
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::ElementsAre;
+
+// The temporal layer of each frame in the three layer VP8 pattern.
+const uint8_t kTemporalPattern[] = {0, 2, 1, 2};
+
+CodecSpecificInfo CreateVp8Info(int16_t picture_id,
+                                uint8_t temporal_idx,
+                                bool layer_sync = false) {
+  CodecSpecificInfo info;
+  memset(&info, 0, sizeof(info));
+  info.codecType = kVideoCodecVP8;
+  info.codecSpecific.VP8.pictureId = picture_id;
+  info.codecSpecific.VP8.temporalIdx = temporal_idx;
+  info.codecSpecific.VP8.layerSync = layer_sync;
+  info.codecSpecific.VP8.tl0PicIdx = kNoTl0PicIdx;
+  info.codecSpecific.VP8.keyIdx = kNoKeyIdx;
+  return info;
+}
+
+// 100 kbps per temporal layer of a single stream.
+BitrateAllocation CreateAllocation() {
+  BitrateAllocation allocation;
+  for (int tid = 0; tid < 3; ++tid)
+    allocation.SetBitrate(0, tid, 100000);
+  return allocation;
+}
+
+// Passes |num_frames| frames of the three layer pattern, starting with
+// |first_picture_id|, through |filter|, and returns the picture ids sent.
+std::vector<int> FilterFrames(TemporalLayerFilter* filter,
+                              int16_t first_picture_id,
+                              int num_frames) {
+  std::vector<int> picture_ids;
+  for (int i = 0; i < num_frames; ++i) {
+    CodecSpecificInfo info =
+        CreateVp8Info(first_picture_id + i, kTemporalPattern[i % 4]);
+    if (filter->OnEncodedFrame(&info))
+      picture_ids.push_back(info.codecSpecific.VP8.pictureId);
+  }
+  return picture_ids;
+}
+
+}  // namespace
+
+TEST(TemporalLayerFilterTest, SendsAllLayersWithoutTargetBitrate) {
+  TemporalLayerFilter filter;
+  filter.OnBitrateAllocationUpdated(CreateAllocation());
+  EXPECT_THAT(FilterFrames(&filter, 10, 4), ElementsAre(10, 11, 12, 13));
+}
+
+TEST(TemporalLayerFilterTest, DropsLayersAboveTargetWithContinuousPictureIds) {
+  TemporalLayerFilter filter;
+  filter.OnBitrateAllocationUpdated(CreateAllocation());
+  // The base layer and the first temporal layer fit.
+  filter.SetTargetBitrate(250000);
+  EXPECT_THAT(FilterFrames(&filter, 10, 8), ElementsAre(10, 11, 12, 13));
+}
+
+TEST(TemporalLayerFilterTest, AlwaysSendsBaseLayer) {
+  TemporalLayerFilter filter;
+  filter.OnBitrateAllocationUpdated(CreateAllocation());
+  filter.SetTargetBitrate(50000);
+  EXPECT_THAT(FilterFrames(&filter, 10, 8), ElementsAre(10, 11));
+}
+
+TEST(TemporalLayerFilterTest, AddsLayersBackAtBaseLayerFrames) {
+  TemporalLayerFilter filter;
+  filter.OnBitrateAllocationUpdated(CreateAllocation());
+  filter.SetTargetBitrate(50000);
+  EXPECT_THAT(FilterFrames(&filter, 10, 2), ElementsAre(10));
+
+  // Frame 12 is in layer 1 and depends on frames that were dropped.
+  filter.SetTargetBitrate(300000);
+  CodecSpecificInfo info = CreateVp8Info(12, 1);
+  EXPECT_FALSE(filter.OnEncodedFrame(&info));
+  info = CreateVp8Info(13, 2);
+  EXPECT_FALSE(filter.OnEncodedFrame(&info));
+  EXPECT_THAT(FilterFrames(&filter, 14, 4), ElementsAre(11, 12, 13, 14));
+}
+
+TEST(TemporalLayerFilterTest, AddsLayersBackAtLayerSyncFrames) {
+  TemporalLayerFilter filter;
+  filter.OnBitrateAllocationUpdated(CreateAllocation());
+  filter.SetTargetBitrate(50000);
+  EXPECT_THAT(FilterFrames(&filter, 10, 1), ElementsAre(10));
+
+  filter.SetTargetBitrate(300000);
+  CodecSpecificInfo info = CreateVp8Info(11, 2, true);
+  EXPECT_TRUE(filter.OnEncodedFrame(&info));
+  EXPECT_EQ(11, info.codecSpecific.VP8.pictureId);
+}
+
+TEST(TemporalLayerFilterTest, KeepsSimulcastStreamsApart) {
+  TemporalLayerFilter filter;
+  filter.OnBitrateAllocationUpdated(CreateAllocation());
+  filter.SetTargetBitrate(50000);
+  CodecSpecificInfo info = CreateVp8Info(10, 2);
+  EXPECT_FALSE(filter.OnEncodedFrame(&info));
+  // The dropped frame of stream 0 doesn't shift the picture ids of stream 1.
+  info = CreateVp8Info(500, 0);
+  info.codecSpecific.VP8.simulcastIdx = 1;
+  EXPECT_TRUE(filter.OnEncodedFrame(&info));
+  EXPECT_EQ(500, info.codecSpecific.VP8.pictureId);
+}
+
+TEST(TemporalLayerFilterTest, PassesFramesWithoutTemporalLayers) {
+  TemporalLayerFilter filter;
+  filter.OnBitrateAllocationUpdated(CreateAllocation());
+  filter.SetTargetBitrate(0);
+  CodecSpecificInfo info = CreateVp8Info(10, kNoTemporalIdx);
+  EXPECT_TRUE(filter.OnEncodedFrame(&info));
+  EXPECT_EQ(10, info.codecSpecific.VP8.pictureId);
+
+  info.codecType = kVideoCodecGeneric;
+  EXPECT_TRUE(filter.OnEncodedFrame(&info));
+}
+
+}  // namespace webrtc
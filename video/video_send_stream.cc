@@ -29,13 +29,17 @@
 #include "modules/video_coding/utility/ivf_file_writer.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/file.h"
+#include "rtc_base/function_view.h"
 #include "rtc_base/location.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/refcountedobject.h"
+#include "rtc_base/scoped_ref_ptr.h"
 #include "rtc_base/trace_event.h"
 #include "rtc_base/weak_ptr.h"
 #include "system_wrappers/include/field_trial.h"
 #include "video/call_stats.h"
 #include "video/payload_router.h"
+#include "video/temporal_layer_filter.h"
 #include "call/video_send_stream.h"
 
 namespace webrtc {
@@ -245,10 +249,32 @@ class VideoSendStreamImpl : public webrtc::BitrateAllocatorObserver,
 
   void SetTransportOverhead(size_t transport_overhead_per_packet);
 
+  // Makes |follower| send the output of this stream's encoder, see
+  // VideoSendStream::Config::shared_encoder_leader_ssrc. Once
+  // RemoveEncoderFollower() has returned, |follower| gets no more images.
+  void AddEncoderFollower(VideoSendStreamImpl* follower);
+  void RemoveEncoderFollower(VideoSendStreamImpl* follower);
+
  private:
   class CheckEncoderActivityTask;
   class EncoderReconfiguredTask;
 
+  // A stream sending the output of this stream's encoder. |delivery_lock| is
+  // held while encoder output is handed to |stream|, so that
+  // RemoveEncoderFollower() only has to wait for a delivery to that stream.
+  struct EncoderFollower {
+    explicit EncoderFollower(VideoSendStreamImpl* stream) : stream(stream) {}
+    VideoSendStreamImpl* const stream;
+    rtc::CriticalSection delivery_lock;
+    bool removed RTC_GUARDED_BY(delivery_lock) = false;
+  };
+  using EncoderFollowerRef =
+      rtc::scoped_refptr<rtc::RefCountedObject<EncoderFollower>>;
+  // Immutable once published in |encoder_followers_|, so that encoder output
+  // is delivered without holding |encoder_followers_crit_|.
+  using EncoderFollowers =
+      rtc::RefCountedObject<std::vector<EncoderFollowerRef>>;
+
   // Implements BitrateAllocatorObserver.
   uint32_t OnBitrateUpdated(uint32_t bitrate_bps,
                             uint8_t fraction_loss,
@@ -283,8 +309,14 @@ class VideoSendStreamImpl : public webrtc::BitrateAllocatorObserver,
   void ConfigureSsrcs();
   void SignalEncoderTimedOut();
   void SignalEncoderActive();
+  void RequestKeyFrame();
+  void ForEachEncoderFollower(
+      rtc::FunctionView<void(VideoSendStreamImpl*)> deliver);
 
   const bool send_side_bwe_with_overhead_;
+  // TODO(sprang): Enable this also for regular video calls if it works well.
+  // Only signal target bitrate for screenshare streams, for now.
+  const bool signal_target_bitrate_;
 
   SendStatisticsProxy* const stats_proxy_;
   const VideoSendStream::Config* const config_;
@@ -315,6 +347,9 @@ class VideoSendStreamImpl : public webrtc::BitrateAllocatorObserver,
   uint32_t encoder_target_rate_bps_;
 
   VideoStreamEncoder* const video_stream_encoder_;
+  // Drops the temporal layers of the shared encoder's output that don't fit
+  // this stream, when it has no encoder of its own.
+  TemporalLayerFilter temporal_layer_filter_;
   EncoderRtcpFeedback encoder_feedback_;
   ProtectionBitrateCalculator protection_bitrate_calculator_;
 
@@ -335,6 +370,17 @@ class VideoSendStreamImpl : public webrtc::BitrateAllocatorObserver,
   size_t overhead_bytes_per_packet_
       RTC_GUARDED_BY(overhead_bytes_per_packet_crit_);
   size_t transport_overhead_bytes_per_packet_;
+
+  // Streams sending the output of |video_stream_encoder_| in addition to this
+  // one. Only replaced on |worker_queue_|, read on the encoder callback
+  // thread.
+  rtc::CriticalSection encoder_followers_crit_;
+  rtc::scoped_refptr<EncoderFollowers> encoder_followers_
+      RTC_GUARDED_BY(encoder_followers_crit_);
+  // Last encoder configuration, for streams that start following this one.
+  // Accessed on |worker_queue_|.
+  std::vector<VideoStream> encoder_streams_;
+  int encoder_min_transmit_bitrate_bps_;
 };
 
 // TODO(tommi): See if there's a more elegant way to create a task that creates
@@ -525,12 +571,15 @@ VideoSendStream::VideoSendStream(
                    encoder_config.content_type),
       config_(std::move(config)),
       content_type_(encoder_config.content_type) {
-  video_stream_encoder_.reset(
-      new VideoStreamEncoder(num_cpu_cores, &stats_proxy_,
-                             config_.encoder_settings,
-                             config_.pre_encode_callback,
-                             config_.post_encode_callback,
-                             std::unique_ptr<OveruseFrameDetector>()));
+  // Streams sharing the encoder of another stream don't have one.
+  if (!config_.shared_encoder_leader_ssrc) {
+    video_stream_encoder_.reset(
+        new VideoStreamEncoder(num_cpu_cores, &stats_proxy_,
+                               config_.encoder_settings,
+                               config_.pre_encode_callback,
+                               config_.post_encode_callback,
+                               std::unique_ptr<OveruseFrameDetector>()));
+  }
   worker_queue_->PostTask(std::unique_ptr<rtc::QueuedTask>(new ConstructionTask(
       &send_stream_, &thread_sync_event_, &stats_proxy_,
       video_stream_encoder_.get(), module_process_thread, call_stats, transport,
@@ -543,11 +592,11 @@ VideoSendStream::VideoSendStream(
   // it was created on.
   thread_sync_event_.Wait(rtc::Event::kForever);
   send_stream_->RegisterProcessThread(module_process_thread);
-  // TODO(sprang): Enable this also for regular video calls if it works well.
-  if (encoder_config.content_type == VideoEncoderConfig::ContentType::kScreen) {
-    // Only signal target bitrate for screenshare streams, for now.
-    video_stream_encoder_->SetBitrateObserver(send_stream_.get());
-  }
+  if (!video_stream_encoder_)
+    return;
+  // The layer bitrates are needed by the streams sharing this encoder, and by
+  // screenshare streams, which signal their target bitrate.
+  video_stream_encoder_->SetBitrateObserver(send_stream_.get());
   video_stream_encoder_->RegisterProcessThread(module_process_thread);
 
   ReconfigureVideoEncoder(std::move(encoder_config));
@@ -556,6 +605,8 @@ VideoSendStream::VideoSendStream(
 VideoSendStream::~VideoSendStream() {
   RTC_DCHECK_RUN_ON(&thread_checker_);
   RTC_DCHECK(!send_stream_);
+  RTC_DCHECK(!shared_encoder_leader_);
+  RTC_DCHECK(shared_encoder_followers_.empty());
 }
 
 void VideoSendStream::Start() {
@@ -584,6 +635,13 @@ void VideoSendStream::SetSource(
     rtc::VideoSourceInterface<webrtc::VideoFrame>* source,
     const DegradationPreference& degradation_preference) {
   RTC_DCHECK_RUN_ON(&thread_checker_);
+  if (!video_stream_encoder_) {
+    if (source) {
+      LOG(LS_WARNING) << "Ignoring the source of a stream sharing the encoder "
+                      << "of another stream.";
+    }
+    return;
+  }
   video_stream_encoder_->SetSource(source, degradation_preference);
 }
 
@@ -592,6 +650,9 @@ void VideoSendStream::ReconfigureVideoEncoder(VideoEncoderConfig config) {
   // ReconfigureVideoEncoder from the network thread.
   // RTC_DCHECK_RUN_ON(&thread_checker_);
   RTC_DCHECK(content_type_ == config.content_type);
+  // Streams sharing another stream's encoder follow its configuration.
+  if (!video_stream_encoder_)
+    return;
   video_stream_encoder_->ConfigureEncoder(std::move(config),
                                           config_.rtp.max_packet_size,
                                           config_.rtp.nack.rtp_history_ms > 0);
@@ -615,8 +676,14 @@ void VideoSendStream::StopPermanentlyAndGetRtpStates(
     VideoSendStream::RtpStateMap* rtp_state_map,
     VideoSendStream::RtpPayloadStateMap* payload_state_map) {
   RTC_DCHECK_RUN_ON(&thread_checker_);
-  video_stream_encoder_->Stop();
-  video_stream_encoder_->DeRegisterProcessThread();
+  // The streams sharing an encoder must be unlinked first, since the
+  // VideoSendStreamImpls deliver to each other until then.
+  RTC_CHECK(!shared_encoder_leader_);
+  RTC_CHECK(shared_encoder_followers_.empty());
+  if (video_stream_encoder_) {
+    video_stream_encoder_->Stop();
+    video_stream_encoder_->DeRegisterProcessThread();
+  }
   send_stream_->DeRegisterProcessThread();
   worker_queue_->PostTask(
       std::unique_ptr<rtc::QueuedTask>(new DestructAndGetRtpStateTask(
@@ -625,6 +692,40 @@ void VideoSendStream::StopPermanentlyAndGetRtpStates(
   thread_sync_event_.Wait(rtc::Event::kForever);
 }
 
+void VideoSendStream::SetSharedEncoderLeader(VideoSendStream* leader) {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  RTC_DCHECK(!leader || config_.shared_encoder_leader_ssrc);
+  RTC_DCHECK_NE(this, leader);
+  VideoSendStream* const previous_leader = shared_encoder_leader_;
+  if (leader == previous_leader)
+    return;
+  if (previous_leader) {
+    std::vector<VideoSendStream*>& followers =
+        previous_leader->shared_encoder_followers_;
+    auto it = std::find(followers.begin(), followers.end(), this);
+    RTC_CHECK(it != followers.end());
+    followers.erase(it);
+  }
+  shared_encoder_leader_ = leader;
+  if (leader)
+    leader->shared_encoder_followers_.push_back(this);
+
+  VideoSendStreamImpl* send_stream = send_stream_.get();
+  VideoSendStreamImpl* previous_leader_stream =
+      previous_leader ? previous_leader->send_stream_.get() : nullptr;
+  VideoSendStreamImpl* leader_stream =
+      leader ? leader->send_stream_.get() : nullptr;
+  worker_queue_->PostTask(
+      [this, send_stream, previous_leader_stream, leader_stream] {
+        if (previous_leader_stream)
+          previous_leader_stream->RemoveEncoderFollower(send_stream);
+        if (leader_stream)
+          leader_stream->AddEncoderFollower(send_stream);
+        thread_sync_event_.Set();
+      });
+  thread_sync_event_.Wait(rtc::Event::kForever);
+}
+
 void VideoSendStream::SetTransportOverhead(
     size_t transport_overhead_per_packet) {
   RTC_DCHECK_RUN_ON(&thread_checker_);
@@ -661,6 +762,8 @@ VideoSendStreamImpl::VideoSendStreamImpl(
     VideoEncoderConfig::ContentType content_type)
     : send_side_bwe_with_overhead_(
           webrtc::field_trial::IsEnabled("WebRTC-SendSideBwe-WithOverhead")),
+      signal_target_bitrate_(content_type ==
+                             VideoEncoderConfig::ContentType::kScreen),
       stats_proxy_(stats_proxy),
       config_(config),
       suspended_ssrcs_(std::move(suspended_ssrcs)),
@@ -703,7 +806,8 @@ VideoSendStreamImpl::VideoSendStreamImpl(
                       suspended_payload_states),
       weak_ptr_factory_(this),
       overhead_bytes_per_packet_(0),
-      transport_overhead_bytes_per_packet_(0) {
+      transport_overhead_bytes_per_packet_(0),
+      encoder_min_transmit_bitrate_bps_(0) {
   RTC_DCHECK_RUN_ON(worker_queue_);
   LOG(LS_INFO) << "VideoSendStreamInternal: " << config_->ToString();
   weak_ptr_ = weak_ptr_factory_.GetWeakPtr();
@@ -779,6 +883,8 @@ VideoSendStreamImpl::VideoSendStreamImpl(
   RTC_DCHECK_GE(config_->encoder_settings.payload_type, 0);
   RTC_DCHECK_LE(config_->encoder_settings.payload_type, 127);
 
+  if (!video_stream_encoder_)
+    return;
   video_stream_encoder_->SetStartBitrate(
       bitrate_allocator_->GetStartBitrate(this));
 
@@ -816,6 +922,8 @@ VideoSendStreamImpl::~VideoSendStreamImpl() {
   RTC_DCHECK_RUN_ON(worker_queue_);
   RTC_DCHECK(!payload_router_.IsActive())
       << "VideoSendStreamImpl::Stop not called";
+  RTC_DCHECK(!encoder_followers_ || encoder_followers_->empty())
+      << "Streams sharing the encoder must be unlinked first";
   LOG(LS_INFO) << "~VideoSendStreamInternal: " << config_->ToString();
 
   for (RtpRtcp* rtp_rtcp : rtp_rtcp_modules_) {
@@ -855,7 +963,7 @@ void VideoSendStreamImpl::Start() {
         CheckEncoderActivityTask::kEncoderTimeOutMs);
   }
 
-  video_stream_encoder_->SendKeyFrame();
+  RequestKeyFrame();
 }
 
 void VideoSendStreamImpl::Stop() {
@@ -871,7 +979,8 @@ void VideoSendStreamImpl::Stop() {
     check_encoder_activity_task_->Stop();
     check_encoder_activity_task_ = nullptr;
   }
-  video_stream_encoder_->OnBitrateUpdated(0, 0, 0);
+  if (video_stream_encoder_)
+    video_stream_encoder_->OnBitrateUpdated(0, 0, 0);
   stats_proxy_->OnSetEncoderTargetRate(0);
 }
 
@@ -888,7 +997,85 @@ void VideoSendStreamImpl::SignalEncoderTimedOut() {
 
 void VideoSendStreamImpl::OnBitrateAllocationUpdated(
     const BitrateAllocation& allocation) {
-  payload_router_.OnBitrateAllocationUpdated(allocation);
+  if (!video_stream_encoder_)
+    temporal_layer_filter_.OnBitrateAllocationUpdated(allocation);
+  if (signal_target_bitrate_)
+    payload_router_.OnBitrateAllocationUpdated(allocation);
+  ForEachEncoderFollower([&allocation](VideoSendStreamImpl* follower) {
+    follower->OnBitrateAllocationUpdated(allocation);
+  });
+}
+
+void VideoSendStreamImpl::AddEncoderFollower(VideoSendStreamImpl* follower) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  RTC_DCHECK_NE(this, follower);
+  RTC_DCHECK(!follower->video_stream_encoder_);
+  RTC_DCHECK_EQ(rtp_rtcp_modules_.size(), follower->rtp_rtcp_modules_.size());
+  follower->encoder_feedback_.SetSharedEncoderFeedback(&encoder_feedback_);
+  if (!encoder_streams_.empty()) {
+    follower->OnEncoderConfigurationChanged(encoder_streams_,
+                                            encoder_min_transmit_bitrate_bps_);
+  }
+  {
+    rtc::CritScope lock(&encoder_followers_crit_);
+    std::vector<EncoderFollowerRef> followers;
+    if (encoder_followers_)
+      followers = *encoder_followers_;
+    followers.push_back(new rtc::RefCountedObject<EncoderFollower>(follower));
+    encoder_followers_ = new EncoderFollowers(std::move(followers));
+  }
+  // The receivers of |follower| need a key frame to start decoding.
+  if (follower->payload_router_.IsActive())
+    RequestKeyFrame();
+}
+
+void VideoSendStreamImpl::RemoveEncoderFollower(VideoSendStreamImpl* follower) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  EncoderFollowerRef removed;
+  {
+    rtc::CritScope lock(&encoder_followers_crit_);
+    RTC_CHECK(encoder_followers_);
+    std::vector<EncoderFollowerRef> followers;
+    for (const EncoderFollowerRef& encoder_follower : *encoder_followers_) {
+      if (encoder_follower->stream == follower)
+        removed = encoder_follower;
+      else
+        followers.push_back(encoder_follower);
+    }
+    encoder_followers_ = new EncoderFollowers(std::move(followers));
+  }
+  RTC_CHECK(removed) << "Not a follower of this stream";
+  {
+    // Waits for a delivery to |follower| in progress, if any.
+    rtc::CritScope lock(&removed->delivery_lock);
+    removed->removed = true;
+  }
+  follower->encoder_feedback_.SetSharedEncoderFeedback(nullptr);
+}
+
+void VideoSendStreamImpl::ForEachEncoderFollower(
+    rtc::FunctionView<void(VideoSendStreamImpl*)> deliver) {
+  rtc::scoped_refptr<EncoderFollowers> followers;
+  {
+    rtc::CritScope lock(&encoder_followers_crit_);
+    followers = encoder_followers_;
+  }
+  if (!followers)
+    return;
+  for (const EncoderFollowerRef& follower : *followers) {
+    rtc::CritScope lock(&follower->delivery_lock);
+    if (!follower->removed)
+      deliver(follower->stream);
+  }
+}
+
+void VideoSendStreamImpl::RequestKeyFrame() {
+  if (video_stream_encoder_) {
+    video_stream_encoder_->SendKeyFrame();
+    return;
+  }
+  // Asks the encoder of the stream this one follows, if any.
+  encoder_feedback_.OnReceivedIntraFrameRequest(config_->rtp.ssrcs[0]);
 }
 
 void VideoSendStreamImpl::SignalEncoderActive() {
@@ -942,6 +1129,14 @@ void VideoSendStreamImpl::OnEncoderConfigurationChanged(
         max_padding_bitrate_, !config_->suspend_below_min_bitrate,
         config_->track_id);
   }
+
+  // The streams sending this stream's encoder output are limited the same
+  // way.
+  encoder_min_transmit_bitrate_bps_ = min_transmit_bitrate_bps;
+  ForEachEncoderFollower([&](VideoSendStreamImpl* follower) {
+    follower->OnEncoderConfigurationChanged(streams, min_transmit_bitrate_bps);
+  });
+  encoder_streams_ = std::move(streams);
 }
 
 EncodedImageCallback::Result VideoSendStreamImpl::OnEncodedImage(
@@ -966,6 +1161,14 @@ EncodedImageCallback::Result VideoSendStreamImpl::OnEncodedImage(
       check_encoder_activity_task_->UpdateEncoderActivity();
   }
 
+  CodecSpecificInfo filtered_info;
+  if (!video_stream_encoder_ && codec_specific_info) {
+    filtered_info = *codec_specific_info;
+    if (!temporal_layer_filter_.OnEncodedFrame(&filtered_info))
+      return Result(Result::OK);
+    codec_specific_info = &filtered_info;
+  }
+
   protection_bitrate_calculator_.UpdateWithEncodedData(encoded_image);
   EncodedImageCallback::Result result = payload_router_.OnEncodedImage(
       encoded_image, codec_specific_info, fragmentation);
@@ -984,6 +1187,12 @@ EncodedImageCallback::Result VideoSendStreamImpl::OnEncodedImage(
     }
   }
 
+  // Streams sharing this encoder packetize the same image with their own
+  // SSRCs, sequence numbers and picture ids.
+  ForEachEncoderFollower([&](VideoSendStreamImpl* follower) {
+    follower->OnEncodedImage(encoded_image, codec_specific_info, fragmentation);
+  });
+
   return result;
 }
 
@@ -1203,8 +1412,14 @@ uint32_t VideoSendStreamImpl::OnBitrateUpdated(uint32_t bitrate_bps,
 
   encoder_target_rate_bps_ =
       std::min(encoder_max_bitrate_bps_, encoder_target_rate_bps_);
-  video_stream_encoder_->OnBitrateUpdated(encoder_target_rate_bps_,
-                                          fraction_loss, rtt);
+  // A stream sharing another stream's encoder doesn't set its rate, but
+  // only sends the temporal layers that fit it.
+  if (video_stream_encoder_) {
+    video_stream_encoder_->OnBitrateUpdated(encoder_target_rate_bps_,
+                                            fraction_loss, rtt);
+  } else {
+    temporal_layer_filter_.SetTargetBitrate(encoder_target_rate_bps_);
+  }
   stats_proxy_->OnSetEncoderTargetRate(encoder_target_rate_bps_);
   return protection_bitrate;
 }
@@ -1226,7 +1441,7 @@ void VideoSendStreamImpl::EnableEncodedFrameRecording(
   if (!files.empty()) {
     // Make a keyframe appear as early as possible in the logs, to give actually
     // decodable output.
-    video_stream_encoder_->SendKeyFrame();
+    RequestKeyFrame();
   }
 }
 
@@ -94,6 +94,16 @@ class VideoSendStream : public webrtc::VideoSendStream {
 
   void SetTransportOverhead(size_t transport_overhead_per_packet);
 
+  // Makes this stream send the encoder output of |leader|, or stops doing so
+  // if |leader| is null. Only for streams with
+  // Config::shared_encoder_leader_ssrc set. Called by Call, which unlinks the
+  // streams before destroying either of them.
+  void SetSharedEncoderLeader(VideoSendStream* leader);
+  const VideoSendStream::Config& config() const { return config_; }
+  const std::vector<VideoSendStream*>& shared_encoder_followers() const {
+    return shared_encoder_followers_;
+  }
+
  private:
   class ConstructionTask;
   class DestructAndGetRtpStateTask;
@@ -106,7 +116,10 @@ class VideoSendStream : public webrtc::VideoSendStream {
   const VideoSendStream::Config config_;
   const VideoEncoderConfig::ContentType content_type_;
   std::unique_ptr<VideoSendStreamImpl> send_stream_;
+  // Null for streams sending the encoder output of another stream.
   std::unique_ptr<VideoStreamEncoder> video_stream_encoder_;
+  VideoSendStream* shared_encoder_leader_ = nullptr;
+  std::vector<VideoSendStream*> shared_encoder_followers_;
 };
 
 }  // namespace internal
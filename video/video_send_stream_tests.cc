@@ -8,6 +8,7 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 #include <algorithm>  // max
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -94,6 +95,102 @@ TEST_F(VideoSendStreamTest, CanStopStoppedStream) {
   });
 }
 
+TEST_F(VideoSendStreamTest, FollowerSendsEncoderOutputOfLeader) {
+  static const uint32_t kFollowerSsrc = 0xF0110;
+  static const size_t kNumFrames = 10;
+
+  // Collects the last packet of each frame, per SSRC.
+  class FrameCollector : public Transport {
+   public:
+    FrameCollector()
+        : parser_(RtpHeaderParser::Create()), frame_sent_(false, false) {}
+
+    bool SendRtp(const uint8_t* packet,
+                 size_t length,
+                 const PacketOptions& options) override {
+      RTPHeader header;
+      EXPECT_TRUE(parser_->Parse(packet, length, &header));
+      const size_t payload_length =
+          length - header.headerLength - header.paddingLength;
+      if (!header.markerBit || payload_length == 0)
+        return true;
+      rtc::CritScope lock(&crit_);
+      payloads_[header.ssrc].emplace_back(
+          packet + header.headerLength,
+          packet + header.headerLength + payload_length);
+      frame_sent_.Set();
+      return true;
+    }
+
+    bool SendRtcp(const uint8_t* packet, size_t length) override {
+      return true;
+    }
+
+    bool WaitForFrames(uint32_t ssrc, size_t num_frames) {
+      while (true) {
+        {
+          rtc::CritScope lock(&crit_);
+          if (payloads_[ssrc].size() >= num_frames)
+            return true;
+        }
+        if (!frame_sent_.Wait(VideoSendStreamTest::kDefaultTimeoutMs))
+          return false;
+      }
+    }
+
+    std::vector<std::vector<uint8_t>> Payloads(uint32_t ssrc,
+                                               size_t num_frames) {
+      rtc::CritScope lock(&crit_);
+      const std::vector<std::vector<uint8_t>>& payloads = payloads_[ssrc];
+      return std::vector<std::vector<uint8_t>>(
+          payloads.begin(),
+          payloads.begin() + std::min(num_frames, payloads.size()));
+    }
+
+   private:
+    const std::unique_ptr<RtpHeaderParser> parser_;
+    rtc::Event frame_sent_;
+    rtc::CriticalSection crit_;
+    std::map<uint32_t, std::vector<std::vector<uint8_t>>> payloads_
+        RTC_GUARDED_BY(crit_);
+  };
+
+  FrameCollector transport;
+  VideoSendStream* follower = nullptr;
+
+  task_queue_.SendTask([this, &transport, &follower]() {
+    CreateSenderCall(Call::Config(event_log_.get()));
+    CreateSendConfig(1, 0, 0, &transport);
+    VideoSendStream::Config follower_config = video_send_config_.Copy();
+    follower_config.rtp.ssrcs = {kFollowerSsrc};
+    follower_config.shared_encoder_leader_ssrc =
+        rtc::Optional<uint32_t>(kVideoSendSsrcs[0]);
+    // Created before its leader, which Call links it to once it's created.
+    follower = sender_call_->CreateVideoSendStream(
+        std::move(follower_config), video_encoder_config_.Copy());
+    CreateVideoStreams();
+    follower->Start();
+    video_send_stream_->Start();
+    // Only the leader has a source.
+    CreateFrameGeneratorCapturer(kDefaultFramerate, kDefaultWidth,
+                                 kDefaultHeight);
+    frame_generator_capturer_->Start();
+  });
+
+  EXPECT_TRUE(transport.WaitForFrames(kVideoSendSsrcs[0], kNumFrames));
+  EXPECT_TRUE(transport.WaitForFrames(kFollowerSsrc, kNumFrames));
+  EXPECT_EQ(transport.Payloads(kVideoSendSsrcs[0], kNumFrames),
+            transport.Payloads(kFollowerSsrc, kNumFrames));
+
+  task_queue_.SendTask([this, &follower]() {
+    frame_generator_capturer_->Stop();
+    // The leader may be destroyed first; Call unlinks the follower.
+    DestroyStreams();
+    sender_call_->DestroyVideoSendStream(follower);
+    DestroyCalls();
+  });
+}
+
 TEST_F(VideoSendStreamTest, SupportsCName) {
   static std::string kCName = "PjQatC14dGfbVwGPUOA9IH7RlsFDbWl4AhXEiDsBizo=";
   class CNameObserver : public test::SendTest {
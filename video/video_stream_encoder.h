@@ -20,6 +20,7 @@
 #include "api/video_codecs/video_encoder.h"
 #include "call/call.h"
 #include "common_types.h"  // NOLINT(build/include)
+#include "common_video/include/i420_buffer_pool.h"
 #include "common_video/include/video_bitrate_allocator.h"
 #include "media/base/videosinkinterface.h"
 #include "modules/video_coding/include/video_coding_defines.h"
@@ -254,6 +255,9 @@ class VideoStreamEncoder : public rtc::VideoSinkInterface<VideoFrame>,
   rtc::Optional<VideoFrameInfo> last_frame_info_ RTC_ACCESS_ON(&encoder_queue_);
   int crop_width_ RTC_ACCESS_ON(&encoder_queue_);
   int crop_height_ RTC_ACCESS_ON(&encoder_queue_);
+  // Recycles the buffers of cropped frames, which otherwise would be
+  // allocated for every frame while cropping is in effect.
+  I420BufferPool cropped_buffer_pool_ RTC_ACCESS_ON(&encoder_queue_);
   uint32_t encoder_start_bitrate_bps_ RTC_ACCESS_ON(&encoder_queue_);
   size_t max_data_payload_length_ RTC_ACCESS_ON(&encoder_queue_);
   bool nack_enabled_ RTC_ACCESS_ON(&encoder_queue_);
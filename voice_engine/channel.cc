@@ -321,11 +321,15 @@ int32_t Channel::SendData(FrameType frameType,
                           size_t payloadSize,
                           const RTPFragmentationHeader* fragmentation) {
   RTC_DCHECK_RUN_ON(encoder_queue_);
+  // Average() resets |rms_level_|, so the level is read once for this channel
+  // and the channels sharing its encoder.
+  const int audio_level =
+      NeedsAudioLevelOnTaskQueue() ? rms_level_.Average() : 0;
   if (_includeAudioLevelIndication) {
     // Store current audio level in the RTP/RTCP module.
     // The level will be used in combination with voice-activity state
     // (frameType) to add an RTP header extension
-    _rtpRtcpModule->SetAudioLevel(rms_level_.Average());
+    _rtpRtcpModule->SetAudioLevel(audio_level);
   }
 
   // Push data from ACM to RTP/RTCP-module to deliver audio frame for
@@ -342,9 +346,41 @@ int32_t Channel::SendData(FrameType frameType,
     return -1;
   }
 
+  last_sent_timestamp_ = timeStamp;
+
+  // Fan the payload out to the channels sharing this channel's encoder.
+  for (Channel* follower : shared_encoder_followers_) {
+    follower->SendSharedEncoderData(frameType, payloadType, timeStamp,
+                                    payloadData, payloadSize, fragmentation,
+                                    audio_level);
+  }
+
   return 0;
 }
 
+void Channel::SendSharedEncoderData(FrameType frame_type,
+                                    uint8_t payload_type,
+                                    uint32_t timestamp,
+                                    const uint8_t* payload_data,
+                                    size_t payload_size,
+                                    const RTPFragmentationHeader* fragmentation,
+                                    int audio_level) {
+  RTC_DCHECK_RUN_ON(encoder_queue_);
+  RTC_DCHECK(shared_encoder_leader_);
+  if (_includeAudioLevelIndication)
+    _rtpRtcpModule->SetAudioLevel(audio_level);
+
+  // Move |timestamp| from the leader's timeline to the one of this channel,
+  // which continues where its own encoder left off.
+  last_sent_timestamp_ = timestamp + shared_encoder_timestamp_offset_;
+  if (!_rtpRtcpModule->SendOutgoingData(
+          frame_type, payload_type, last_sent_timestamp_, -1, payload_data,
+          payload_size, fragmentation, nullptr, nullptr)) {
+    LOG(LS_ERROR) << "Channel::SendSharedEncoderData() failed to send data to "
+                  << "RTP/RTCP module";
+  }
+}
+
 bool Channel::SendRtp(const uint8_t* data,
                       size_t len,
                       const PacketOptions& options) {
@@ -801,7 +837,10 @@ void Channel::StopSend() {
     // than this final "flush task" to be posted on the queue.
     rtc::CritScope cs(&encoder_queue_lock_);
     encoder_queue_is_active_ = false;
-    encoder_queue_->PostTask([&flush]() { flush.Set(); });
+    encoder_queue_->PostTask([this, &flush]() {
+      ClearSharedEncoderOnTaskQueue();
+      flush.Set();
+    });
   }
   flush.Wait(rtc::Event::kForever);
 
@@ -825,6 +864,8 @@ bool Channel::SetEncoder(int payload_type,
                          std::unique_ptr<AudioEncoder> encoder) {
   RTC_DCHECK_GE(payload_type, 0);
   RTC_DCHECK_LE(payload_type, 127);
+  // Channels sharing an encoder must have identical send codecs.
+  ClearSharedEncoder();
   // TODO(ossu): Make CodecInsts up, for now: one for the RTP/RTCP module and
   // one for for us to keep track of sample rate and number of channels, etc.
 
@@ -888,6 +929,7 @@ int32_t Channel::GetRecCodec(CodecInst& codec) {
 }
 
 int32_t Channel::SetSendCodec(const CodecInst& codec) {
+  ClearSharedEncoder();
   if (!codec_manager_.RegisterEncoder(codec) ||
       !codec_manager_.MakeEncoder(&rent_a_codec_, audio_coding_.get())) {
     LOG(LS_ERROR) << "SetSendCodec() failed to register codec to ACM";
@@ -909,13 +951,33 @@ int32_t Channel::SetSendCodec(const CodecInst& codec) {
 }
 
 void Channel::SetBitRate(int bitrate_bps, int64_t probing_interval_ms) {
+  retransmission_rate_limiter_->SetMaxRate(bitrate_bps);
+  {
+    rtc::CritScope cs(&encoder_queue_lock_);
+    target_bitrate_bps_ = rtc::Optional<int>(bitrate_bps);
+    probing_interval_ms_ = probing_interval_ms;
+    // A shared encoder is only accessed on the encoder queue, where the
+    // lowest target bitrate of the channels sharing it is applied.
+    if (encoder_queue_is_active_ &&
+        (uses_shared_encoder_ || has_shared_encoder_followers_)) {
+      encoder_queue_->PostTask([this]() {
+        Channel* leader =
+            shared_encoder_leader_ ? shared_encoder_leader_ : this;
+        leader->ApplyEncoderBitrateOnTaskQueue();
+      });
+      return;
+    }
+  }
+  SetEncoderBitrate(bitrate_bps, probing_interval_ms);
+}
+
+void Channel::SetEncoderBitrate(int bitrate_bps, int64_t probing_interval_ms) {
   audio_coding_->ModifyEncoder([&](std::unique_ptr<AudioEncoder>* encoder) {
     if (*encoder) {
       (*encoder)->OnReceivedUplinkBandwidth(
           bitrate_bps, rtc::Optional<int64_t>(probing_interval_ms));
     }
   });
-  retransmission_rate_limiter_->SetMaxRate(bitrate_bps);
 }
 
 void Channel::OnTwccBasedUplinkPacketLossRate(float packet_loss_rate) {
@@ -1101,8 +1163,14 @@ double Channel::GetTotalOutputDuration() const {
 }
 
 void Channel::SetInputMute(bool enable) {
-  rtc::CritScope cs(&volume_settings_critsect_);
-  input_mute_ = enable;
+  {
+    rtc::CritScope cs(&volume_settings_critsect_);
+    input_mute_ = enable;
+  }
+  // A muted follower must not send the audio of its leader, and the followers
+  // of a muted leader must not send silence.
+  if (enable)
+    ClearSharedEncoder();
 }
 
 bool Channel::InputMute() const {
@@ -1359,8 +1427,9 @@ int Channel::ResendPackets(const uint16_t* sequence_numbers, int length) {
 
 void Channel::ProcessAndEncodeAudio(const AudioFrame& audio_input) {
   // Avoid posting any new tasks if sending was already stopped in StopSend().
+  // Nothing to encode either if another channel encodes for this one.
   rtc::CritScope cs(&encoder_queue_lock_);
-  if (!encoder_queue_is_active_) {
+  if (!encoder_queue_is_active_ || uses_shared_encoder_) {
     return;
   }
   std::unique_ptr<AudioFrame> audio_frame(new AudioFrame());
@@ -1380,7 +1449,7 @@ void Channel::ProcessAndEncodeAudio(const int16_t* audio_data,
                                     size_t number_of_channels) {
   // Avoid posting as new task if sending was already stopped in StopSend().
   rtc::CritScope cs(&encoder_queue_lock_);
-  if (!encoder_queue_is_active_) {
+  if (!encoder_queue_is_active_ || uses_shared_encoder_) {
     return;
   }
   CodecInst codec;
@@ -1416,7 +1485,7 @@ void Channel::ProcessAndEncodeAudioOnTaskQueue(AudioFrame* audio_input) {
   bool is_muted = InputMute();
   AudioFrameOperations::Mute(audio_input, previous_frame_muted_, is_muted);
 
-  if (_includeAudioLevelIndication) {
+  if (NeedsAudioLevelOnTaskQueue()) {
     size_t length =
         audio_input->samples_per_channel_ * audio_input->num_channels_;
     RTC_CHECK_LE(length, AudioFrame::kMaxDataSizeBytes);
@@ -1441,7 +1510,167 @@ void Channel::ProcessAndEncodeAudioOnTaskQueue(AudioFrame* audio_input) {
     return;
   }
 
-  _timeStamp += static_cast<uint32_t>(audio_input->samples_per_channel_);
+  const uint32_t samples =
+      static_cast<uint32_t>(audio_input->samples_per_channel_);
+  _timeStamp += samples;
+  // Keep the input timeline of followers running, so that their encoders
+  // pick up at the right time if sharing ends.
+  for (Channel* follower : shared_encoder_followers_)
+    follower->_timeStamp += samples;
+}
+
+bool Channel::SetSharedEncoderLeader(Channel* leader) {
+  RTC_DCHECK(encoder_queue_);
+  RTC_DCHECK_NE(this, leader);
+  if (leader) {
+    RTC_DCHECK_EQ(encoder_queue_, leader->encoder_queue_);
+    CodecInst codec;
+    CodecInst leader_codec;
+    if (!Sending() || !leader->Sending() || InputMute() ||
+        leader->InputMute() || GetSendCodec(codec) != 0 ||
+        leader->GetSendCodec(leader_codec) != 0 || codec != leader_codec) {
+      LOG(LS_WARNING) << "Channel " << _channelId
+                      << " can't share the encoder of channel "
+                      << leader->ChannelId();
+      return false;
+    }
+  }
+
+  rtc::Event done(false, false);
+  {
+    rtc::CritScope cs(&encoder_queue_lock_);
+    if (!encoder_queue_is_active_)
+      return leader == nullptr;
+    encoder_queue_->PostTask([this, leader, &done]() {
+      SetSharedEncoderLeaderOnTaskQueue(leader);
+      done.Set();
+    });
+  }
+  done.Wait(rtc::Event::kForever);
+  return true;
+}
+
+void Channel::SetSharedEncoderLeaderOnTaskQueue(Channel* leader) {
+  RTC_DCHECK_RUN_ON(encoder_queue_);
+  if (leader) {
+    // Follow the leader's own leader, if any, so that every follower is
+    // reached directly from the SendData() of the channel that encodes.
+    if (leader->shared_encoder_leader_)
+      leader = leader->shared_encoder_leader_;
+    // The leader may have stopped sending after SetSharedEncoderLeader()
+    // checked it, in which case its followers have already been cleared.
+    if (leader == this || !leader->Sending())
+      leader = nullptr;
+  }
+
+  Channel* const previous_leader = shared_encoder_leader_;
+  if (previous_leader) {
+    std::vector<Channel*>& followers =
+        previous_leader->shared_encoder_followers_;
+    followers.erase(std::remove(followers.begin(), followers.end(), this),
+                    followers.end());
+  }
+  shared_encoder_leader_ = leader;
+  {
+    rtc::CritScope cs(&encoder_queue_lock_);
+    uses_shared_encoder_ = leader != nullptr;
+  }
+  if (leader) {
+    shared_encoder_timestamp_offset_ =
+        last_sent_timestamp_ - leader->last_sent_timestamp_;
+    // Channels following this one now follow |leader|.
+    leader->shared_encoder_followers_.push_back(this);
+    for (Channel* follower : shared_encoder_followers_) {
+      follower->shared_encoder_leader_ = leader;
+      follower->shared_encoder_timestamp_offset_ +=
+          shared_encoder_timestamp_offset_;
+      leader->shared_encoder_followers_.push_back(follower);
+    }
+    shared_encoder_followers_.clear();
+  }
+
+  if (previous_leader)
+    previous_leader->UpdateHasSharedEncoderFollowersOnTaskQueue();
+  if (leader)
+    leader->UpdateHasSharedEncoderFollowersOnTaskQueue();
+  UpdateHasSharedEncoderFollowersOnTaskQueue();
+
+  // Update the bitrates of the encoders whose sets of sends changed.
+  if (previous_leader && previous_leader != leader)
+    previous_leader->ApplyEncoderBitrateOnTaskQueue();
+  (leader ? leader : this)->ApplyEncoderBitrateOnTaskQueue();
+}
+
+void Channel::ClearSharedEncoder() {
+  rtc::Event done(false, false);
+  {
+    rtc::CritScope cs(&encoder_queue_lock_);
+    // Sending channels are often reconfigured, so avoid blocking on the
+    // encoder queue unless there is something to detach.
+    if (!encoder_queue_is_active_ ||
+        (!uses_shared_encoder_ && !has_shared_encoder_followers_)) {
+      return;
+    }
+    encoder_queue_->PostTask([this, &done]() {
+      ClearSharedEncoderOnTaskQueue();
+      done.Set();
+    });
+  }
+  done.Wait(rtc::Event::kForever);
+}
+
+void Channel::ClearSharedEncoderOnTaskQueue() {
+  RTC_DCHECK_RUN_ON(encoder_queue_);
+  SetSharedEncoderLeaderOnTaskQueue(nullptr);
+  // Followers go back to encoding their own input.
+  std::vector<Channel*> followers;
+  followers.swap(shared_encoder_followers_);
+  UpdateHasSharedEncoderFollowersOnTaskQueue();
+  for (Channel* follower : followers) {
+    follower->shared_encoder_leader_ = nullptr;
+    {
+      rtc::CritScope cs(&follower->encoder_queue_lock_);
+      follower->uses_shared_encoder_ = false;
+    }
+    follower->ApplyEncoderBitrateOnTaskQueue();
+  }
+  ApplyEncoderBitrateOnTaskQueue();
+}
+
+void Channel::UpdateHasSharedEncoderFollowersOnTaskQueue() {
+  RTC_DCHECK_RUN_ON(encoder_queue_);
+  rtc::CritScope cs(&encoder_queue_lock_);
+  has_shared_encoder_followers_ = !shared_encoder_followers_.empty();
+}
+
+bool Channel::NeedsAudioLevelOnTaskQueue() const {
+  RTC_DCHECK_RUN_ON(encoder_queue_);
+  if (_includeAudioLevelIndication)
+    return true;
+  for (const Channel* follower : shared_encoder_followers_) {
+    if (follower->_includeAudioLevelIndication)
+      return true;
+  }
+  return false;
+}
+
+void Channel::ApplyEncoderBitrateOnTaskQueue() {
+  RTC_DCHECK_RUN_ON(encoder_queue_);
+  rtc::Optional<int> bitrate_bps;
+  int64_t probing_interval_ms = 0;
+  auto take_lowest = [&](const Channel* channel) {
+    rtc::CritScope cs(&channel->encoder_queue_lock_);
+    if (channel->target_bitrate_bps_ &&
+        (!bitrate_bps || *channel->target_bitrate_bps_ < *bitrate_bps)) {
+      bitrate_bps = channel->target_bitrate_bps_;
+      probing_interval_ms = channel->probing_interval_ms_;
+    }
+  };
+  take_lowest(this);
+  for (const Channel* follower : shared_encoder_followers_)
+    take_lowest(follower);
+  if (bitrate_bps)
+    SetEncoderBitrate(*bitrate_bps, probing_interval_ms);
 }
 
 void Channel::set_associate_send_channel(const ChannelOwner& channel) {
@@ -12,6 +12,7 @@
 #define VOICE_ENGINE_CHANNEL_H_
 
 #include <memory>
+#include <vector>
 
 #include "api/audio/audio_mixer.h"
 #include "api/audio_codecs/audio_encoder.h"
@@ -304,6 +305,21 @@ class Channel
                              size_t number_of_frames,
                              size_t number_of_channels);
 
+  // Encoder sharing. Makes this channel send the payloads encoded by |leader|
+  // instead of encoding its own input, so that N sends of the same audio with
+  // the same send codec config (codec, payload type, rate and packet size)
+  // cost a single encode. Each channel still packetizes with its own RTP/RTCP
+  // module, i.e. with its own SSRC, sequence numbers and timestamp offset.
+  // Both channels must be sending, unmuted and have identical send codecs,
+  // otherwise false is returned. Sharing ends when either channel stops
+  // sending, is muted or gets a new encoder, or when called with a null
+  // |leader|; it's up to the caller to share again once possible.
+  // While shared, the encoder runs at the lowest target bitrate set with
+  // SetBitRate() on any of the channels, and the audio level extension of
+  // every channel carries the level of the input to |leader|. Uplink packet
+  // loss reported for followers doesn't reach the shared encoder.
+  bool SetSharedEncoderLeader(Channel* leader);
+
   // Associate to a send channel.
   // Used for obtaining RTT for a receive-only channel.
   void set_associate_send_channel(const ChannelOwner& channel);
@@ -361,6 +377,29 @@ class Channel
   // Called on the encoder task queue when a new input audio frame is ready
   // for encoding.
   void ProcessAndEncodeAudioOnTaskQueue(AudioFrame* audio_input);
+  void SetSharedEncoderLeaderOnTaskQueue(Channel* leader);
+  // Detaches this channel from its leader and from all of its followers.
+  // Returns right away if the channel doesn't share an encoder.
+  void ClearSharedEncoder();
+  void ClearSharedEncoderOnTaskQueue();
+  // Updates |has_shared_encoder_followers_| after a change of
+  // |shared_encoder_followers_|.
+  void UpdateHasSharedEncoderFollowersOnTaskQueue();
+  // True if the input level has to be analyzed for the audio level extension
+  // of this channel or of a channel sharing its encoder.
+  bool NeedsAudioLevelOnTaskQueue() const;
+  // Sets the encoder bitrate to the lowest target bitrate of this channel and
+  // of the channels sharing its encoder.
+  void ApplyEncoderBitrateOnTaskQueue();
+  void SetEncoderBitrate(int bitrate_bps, int64_t probing_interval_ms);
+  // Packetizes a payload encoded by the leader of this channel.
+  void SendSharedEncoderData(FrameType frame_type,
+                             uint8_t payload_type,
+                             uint32_t timestamp,
+                             const uint8_t* payload_data,
+                             size_t payload_size,
+                             const RTPFragmentationHeader* fragmentation,
+                             int audio_level);
 
   uint32_t _instanceId;
   int32_t _channelId;
@@ -451,6 +490,27 @@ class Channel
 
   bool encoder_queue_is_active_ RTC_GUARDED_BY(encoder_queue_lock_) = false;
 
+  // True while this channel sends the payloads of another channel's encoder,
+  // see SetSharedEncoderLeader(). Checked on the capture thread to skip
+  // copying and encoding the input.
+  bool uses_shared_encoder_ RTC_GUARDED_BY(encoder_queue_lock_) = false;
+  // True while other channels send the payloads of this channel's encoder.
+  // Together with |uses_shared_encoder_|, lets ClearSharedEncoder() and
+  // SetBitRate() skip the encoder queue for channels that don't share.
+  bool has_shared_encoder_followers_ RTC_GUARDED_BY(encoder_queue_lock_) =
+      false;
+  // Last target bitrate passed to SetBitRate(). Also read on the encoder queue
+  // by the leader of this channel.
+  rtc::Optional<int> target_bitrate_bps_ RTC_GUARDED_BY(encoder_queue_lock_);
+  int64_t probing_interval_ms_ RTC_GUARDED_BY(encoder_queue_lock_) = 0;
+
+  Channel* shared_encoder_leader_ RTC_ACCESS_ON(encoder_queue_) = nullptr;
+  std::vector<Channel*> shared_encoder_followers_ RTC_ACCESS_ON(encoder_queue_);
+  // Timestamp of the last payload handed to the RTP/RTCP module, and the
+  // difference between the leader's timestamps and the ones of this channel.
+  uint32_t last_sent_timestamp_ RTC_ACCESS_ON(encoder_queue_) = 0;
+  uint32_t shared_encoder_timestamp_offset_ RTC_ACCESS_ON(encoder_queue_) = 0;
+
   rtc::TaskQueue* encoder_queue_ = nullptr;
 };
 
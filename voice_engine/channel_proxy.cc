@@ -213,6 +213,12 @@ void ChannelProxy::SetInputMute(bool muted) {
   channel()->SetInputMute(muted);
 }
 
+bool ChannelProxy::SetSharedEncoderLeader(ChannelProxy* leader) {
+  RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
+  return channel()->SetSharedEncoderLeader(leader ? leader->channel()
+                                                  : nullptr);
+}
+
 void ChannelProxy::RegisterTransport(Transport* transport) {
   RTC_DCHECK(worker_thread_checker_.CalledOnValidThread());
   channel()->RegisterTransport(transport);
@@ -94,6 +94,8 @@ class ChannelProxy : public RtpPacketSinkInterface {
   virtual void SetReceiveCodecs(const std::map<int, SdpAudioFormat>& codecs);
   virtual void SetSink(std::unique_ptr<AudioSinkInterface> sink);
   virtual void SetInputMute(bool muted);
+  // See Channel::SetSharedEncoderLeader().
+  virtual bool SetSharedEncoderLeader(ChannelProxy* leader);
   virtual void RegisterTransport(Transport* transport);
 
   // Implements RtpPacketSinkInterface
@@ -8,8 +8,363 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <math.h>
+
+#include <memory>
+#include <vector>
+
+#include "api/call/transport.h"
+#include "modules/audio_coding/codecs/g711/audio_encoder_pcm.h"
+#include "modules/audio_device/include/fake_audio_device.h"
+#include "modules/audio_processing/include/mock_audio_processing.h"
+#include "modules/include/module_common_types.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/criticalsection.h"
+#include "rtc_base/event.h"
+#include "rtc_base/refcountedobject.h"
+#include "test/gmock.h"
 #include "test/gtest.h"
+#include "test/mock_audio_encoder.h"
 #include "voice_engine/channel.h"
+#include "voice_engine/channel_manager.h"
+#include "voice_engine/voice_engine_impl.h"
+
+namespace webrtc {
+namespace voe {
+namespace {
+
+using ::testing::_;
+using ::testing::InvokeWithoutArgs;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+const int kSampleRateHz = 8000;
+const size_t kSamplesPer10Ms = kSampleRateHz / 100;
+const int kAudioLevelId = 1;
+// PCMU packs two 10 ms frames into each packet.
+const int kNumFrames = 10;
+const int kNumPackets = kNumFrames / 2;
+
+struct SentPacket {
+  uint32_t ssrc;
+  uint16_t sequence_number;
+  uint32_t timestamp;
+  std::vector<uint8_t> payload;
+  bool has_audio_level;
+  uint8_t audio_level;
+};
+
+class RtpCollector : public Transport {
+ public:
+  RtpCollector() { extensions_.Register<webrtc::AudioLevel>(kAudioLevelId); }
+
+  bool SendRtp(const uint8_t* data,
+               size_t length,
+               const PacketOptions& options) override {
+    RtpPacketReceived packet(&extensions_);
+    EXPECT_TRUE(packet.Parse(data, length));
+    SentPacket sent;
+    sent.ssrc = packet.Ssrc();
+    sent.sequence_number = packet.SequenceNumber();
+    sent.timestamp = packet.Timestamp();
+    sent.payload.assign(packet.payload().begin(), packet.payload().end());
+    bool voice_activity;
+    sent.has_audio_level = packet.GetExtension<webrtc::AudioLevel>(
+        &voice_activity, &sent.audio_level);
+    rtc::CritScope cs(&crit_);
+    packets_.push_back(sent);
+    return true;
+  }
+  bool SendRtcp(const uint8_t* data, size_t length) override { return true; }
+
+  std::vector<SentPacket> packets() const {
+    rtc::CritScope cs(&crit_);
+    return packets_;
+  }
+
+ private:
+  RtpHeaderExtensionMap extensions_;
+  rtc::CriticalSection crit_;
+  std::vector<SentPacket> packets_ RTC_GUARDED_BY(crit_);
+};
+
+// Fills |frame| with 10 ms of a 1 kHz tone.
+void FillFrame(int16_t amplitude, AudioFrame* frame) {
+  int16_t data[kSamplesPer10Ms];
+  for (size_t i = 0; i < kSamplesPer10Ms; ++i)
+    data[i] = static_cast<int16_t>(amplitude * sin(M_PI * i / 4));
+  frame->UpdateFrame(0, data, kSamplesPer10Ms, kSampleRateHz,
+                     AudioFrame::kNormalSpeech, AudioFrame::kVadActive, 1);
+}
+
+std::unique_ptr<AudioEncoder> CreatePcmUEncoder() {
+  return std::unique_ptr<AudioEncoder>(
+      new AudioEncoderPcmU(AudioEncoderPcmU::Config()));
+}
+
+// Returns an encoder that looks like PCMU to voe::Channel, for checking which
+// target bitrates it gets.
+std::unique_ptr<NiceMock<MockAudioEncoder>> CreateMockEncoder() {
+  std::unique_ptr<NiceMock<MockAudioEncoder>> encoder(
+      new NiceMock<MockAudioEncoder>());
+  ON_CALL(*encoder, SampleRateHz()).WillByDefault(Return(kSampleRateHz));
+  ON_CALL(*encoder, RtpTimestampRateHz()).WillByDefault(Return(kSampleRateHz));
+  ON_CALL(*encoder, NumChannels()).WillByDefault(Return(1));
+  ON_CALL(*encoder, Max10MsFramesInAPacket()).WillByDefault(Return(2));
+  ON_CALL(*encoder, Num10MsFramesInNextPacket()).WillByDefault(Return(2));
+  return encoder;
+}
+
+class ChannelSharedEncoderTest : public ::testing::Test {
+ protected:
+  ChannelSharedEncoderTest()
+      : voe_(VoiceEngine::Create()), base_(VoEBase::GetInterface(voe_)) {
+    apm_ = new rtc::RefCountedObject<test::MockAudioProcessing>();
+    EXPECT_EQ(0, base_->Init(&adm_, apm_.get()));
+  }
+
+  ~ChannelSharedEncoderTest() {
+    while (!channels_.empty())
+      DeleteChannel(channels_.back().channel());
+    EXPECT_EQ(0, base_->Terminate());
+    EXPECT_EQ(1, base_->Release());
+    EXPECT_TRUE(VoiceEngine::Delete(voe_));
+  }
+
+  Channel* CreateSendChannel(uint32_t ssrc,
+                             Transport* transport,
+                             std::unique_ptr<AudioEncoder> encoder) {
+    const int channel_id = base_->CreateChannel();
+    EXPECT_NE(-1, channel_id);
+    channels_.push_back(static_cast<VoiceEngineImpl*>(voe_)
+                            ->channel_manager()
+                            .GetChannel(channel_id));
+    Channel* channel = channels_.back().channel();
+    channel->RegisterTransport(transport);
+    EXPECT_EQ(0, channel->SetLocalSSRC(ssrc));
+    EXPECT_TRUE(channel->SetEncoder(0, std::move(encoder)));
+    EXPECT_EQ(0, channel->StartSend());
+    return channel;
+  }
+
+  void DeleteChannel(Channel* channel) {
+    channel->StopSend();
+    const int channel_id = channel->ChannelId();
+    for (auto it = channels_.begin(); it != channels_.end(); ++it) {
+      if (it->channel() == channel) {
+        channels_.erase(it);
+        break;
+      }
+    }
+    EXPECT_EQ(0, base_->DeleteChannel(channel_id));
+  }
+
+  VoiceEngine* voe_;
+  VoEBase* base_;
+  FakeAudioDeviceModule adm_;
+  rtc::scoped_refptr<AudioProcessing> apm_;
+  std::vector<ChannelOwner> channels_;
+  AudioFrame tone_;
+  AudioFrame silence_;
+};
+
+}  // namespace
 
 // Empty test just to get coverage metrics.
 TEST(ChannelTest, EmptyTestToGetCodeCoverage) {}
+
+TEST_F(ChannelSharedEncoderTest, FollowerSendsPayloadsOfLeader) {
+  RtpCollector leader_transport;
+  RtpCollector follower_transport;
+  Channel* leader =
+      CreateSendChannel(1111, &leader_transport, CreatePcmUEncoder());
+  Channel* follower =
+      CreateSendChannel(2222, &follower_transport, CreatePcmUEncoder());
+  ASSERT_TRUE(follower->SetSharedEncoderLeader(leader));
+
+  FillFrame(10000, &tone_);
+  FillFrame(0, &silence_);
+  for (int i = 0; i < kNumFrames; ++i) {
+    leader->ProcessAndEncodeAudio(tone_);
+    // Ignored, since |follower| sends what |leader| encodes.
+    follower->ProcessAndEncodeAudio(silence_);
+  }
+  // Flushes the encoder queue.
+  leader->StopSend();
+  follower->StopSend();
+
+  const std::vector<SentPacket> leader_packets = leader_transport.packets();
+  const std::vector<SentPacket> follower_packets =
+      follower_transport.packets();
+  ASSERT_EQ(static_cast<size_t>(kNumPackets), leader_packets.size());
+  ASSERT_EQ(leader_packets.size(), follower_packets.size());
+  for (size_t i = 0; i < follower_packets.size(); ++i) {
+    EXPECT_EQ(2222u, follower_packets[i].ssrc);
+    EXPECT_EQ(leader_packets[i].payload, follower_packets[i].payload);
+    if (i > 0) {
+      EXPECT_EQ(static_cast<uint16_t>(follower_packets[i - 1].sequence_number +
+                                      1),
+                follower_packets[i].sequence_number);
+    }
+  }
+}
+
+TEST_F(ChannelSharedEncoderTest, FollowersGetAudioLevelOfLeaderInput) {
+  RtpCollector leader_transport;
+  RtpCollector first_transport;
+  RtpCollector second_transport;
+  // The leader doesn't send the audio level itself, but still has to measure
+  // it for its followers.
+  Channel* leader =
+      CreateSendChannel(1111, &leader_transport, CreatePcmUEncoder());
+  Channel* first =
+      CreateSendChannel(2222, &first_transport, CreatePcmUEncoder());
+  Channel* second =
+      CreateSendChannel(3333, &second_transport, CreatePcmUEncoder());
+  EXPECT_EQ(0, first->SetSendAudioLevelIndicationStatus(true, kAudioLevelId));
+  EXPECT_EQ(0, second->SetSendAudioLevelIndicationStatus(true, kAudioLevelId));
+  ASSERT_TRUE(first->SetSharedEncoderLeader(leader));
+  ASSERT_TRUE(second->SetSharedEncoderLeader(leader));
+
+  FillFrame(10000, &tone_);
+  for (int i = 0; i < kNumFrames; ++i)
+    leader->ProcessAndEncodeAudio(tone_);
+  leader->StopSend();
+
+  const std::vector<SentPacket> leader_packets = leader_transport.packets();
+  const std::vector<SentPacket> first_packets = first_transport.packets();
+  const std::vector<SentPacket> second_packets = second_transport.packets();
+  ASSERT_EQ(static_cast<size_t>(kNumPackets), first_packets.size());
+  ASSERT_EQ(first_packets.size(), second_packets.size());
+  for (size_t i = 0; i < first_packets.size(); ++i) {
+    EXPECT_FALSE(leader_packets[i].has_audio_level);
+    ASSERT_TRUE(first_packets[i].has_audio_level);
+    ASSERT_TRUE(second_packets[i].has_audio_level);
+    // 127 would mean digital silence, i.e. that no level was measured.
+    EXPECT_LT(first_packets[i].audio_level, 30);
+    EXPECT_EQ(first_packets[i].audio_level, second_packets[i].audio_level);
+  }
+}
+
+TEST_F(ChannelSharedEncoderTest, FollowerEncodesOwnInputAfterLeaderIsDeleted) {
+  RtpCollector leader_transport;
+  RtpCollector follower_transport;
+  Channel* leader =
+      CreateSendChannel(1111, &leader_transport, CreatePcmUEncoder());
+  Channel* follower =
+      CreateSendChannel(2222, &follower_transport, CreatePcmUEncoder());
+  ASSERT_TRUE(follower->SetSharedEncoderLeader(leader));
+
+  FillFrame(10000, &tone_);
+  FillFrame(0, &silence_);
+  for (int i = 0; i < kNumFrames; ++i) {
+    leader->ProcessAndEncodeAudio(tone_);
+    follower->ProcessAndEncodeAudio(silence_);
+  }
+  DeleteChannel(leader);
+  for (int i = 0; i < kNumFrames; ++i)
+    follower->ProcessAndEncodeAudio(silence_);
+  follower->StopSend();
+
+  const std::vector<SentPacket> leader_packets = leader_transport.packets();
+  const std::vector<SentPacket> packets = follower_transport.packets();
+  ASSERT_EQ(static_cast<size_t>(2 * kNumPackets), packets.size());
+  for (size_t i = 0; i < packets.size(); ++i) {
+    if (i < leader_packets.size()) {
+      EXPECT_EQ(leader_packets[i].payload, packets[i].payload);
+    } else {
+      EXPECT_NE(leader_packets[0].payload, packets[i].payload);
+    }
+    // The RTP timestamps continue where the shared encoder left off.
+    if (i > 0) {
+      EXPECT_EQ(packets[i - 1].timestamp + 2 * kSamplesPer10Ms,
+                packets[i].timestamp);
+    }
+  }
+}
+
+TEST_F(ChannelSharedEncoderTest, MutedFollowerDoesNotSendAudioOfLeader) {
+  RtpCollector leader_transport;
+  RtpCollector follower_transport;
+  Channel* leader =
+      CreateSendChannel(1111, &leader_transport, CreatePcmUEncoder());
+  Channel* follower =
+      CreateSendChannel(2222, &follower_transport, CreatePcmUEncoder());
+  ASSERT_TRUE(follower->SetSharedEncoderLeader(leader));
+
+  follower->SetInputMute(true);
+  EXPECT_FALSE(follower->SetSharedEncoderLeader(leader));
+
+  FillFrame(10000, &tone_);
+  for (int i = 0; i < kNumFrames; ++i) {
+    leader->ProcessAndEncodeAudio(tone_);
+    follower->ProcessAndEncodeAudio(tone_);
+  }
+  leader->StopSend();
+  follower->StopSend();
+
+  const std::vector<SentPacket> leader_packets = leader_transport.packets();
+  const std::vector<SentPacket> follower_packets =
+      follower_transport.packets();
+  ASSERT_EQ(static_cast<size_t>(kNumPackets), follower_packets.size());
+  // The follower encodes its own, muted, input.
+  EXPECT_NE(leader_packets.back().payload, follower_packets.back().payload);
+}
+
+TEST_F(ChannelSharedEncoderTest, SharedEncoderRunsAtLowestTargetBitrate) {
+  RtpCollector leader_transport;
+  RtpCollector follower_transport;
+  std::unique_ptr<NiceMock<MockAudioEncoder>> leader_encoder =
+      CreateMockEncoder();
+  std::unique_ptr<NiceMock<MockAudioEncoder>> follower_encoder =
+      CreateMockEncoder();
+  NiceMock<MockAudioEncoder>* leader_encoder_ptr = leader_encoder.get();
+  NiceMock<MockAudioEncoder>* follower_encoder_ptr = follower_encoder.get();
+  Channel* leader = CreateSendChannel(1111, &leader_transport,
+                                      std::move(leader_encoder));
+  Channel* follower = CreateSendChannel(2222, &follower_transport,
+                                        std::move(follower_encoder));
+  ASSERT_TRUE(follower->SetSharedEncoderLeader(leader));
+
+  rtc::Event applied(false, false);
+  EXPECT_CALL(*leader_encoder_ptr, OnReceivedUplinkBandwidth(32000, _))
+      .WillOnce(InvokeWithoutArgs([&applied] { applied.Set(); }));
+  leader->SetBitRate(32000, 0);
+  EXPECT_TRUE(applied.Wait(1000));
+  ::testing::Mock::VerifyAndClearExpectations(leader_encoder_ptr);
+
+  // A lower target of the follower applies to the shared encoder, and not to
+  // the unused encoder of the follower.
+  EXPECT_CALL(*leader_encoder_ptr, OnReceivedUplinkBandwidth(20000, _))
+      .WillOnce(InvokeWithoutArgs([&applied] { applied.Set(); }));
+  EXPECT_CALL(*follower_encoder_ptr, OnReceivedUplinkBandwidth(_, _)).Times(0);
+  follower->SetBitRate(20000, 0);
+  EXPECT_TRUE(applied.Wait(1000));
+  ::testing::Mock::VerifyAndClearExpectations(leader_encoder_ptr);
+  ::testing::Mock::VerifyAndClearExpectations(follower_encoder_ptr);
+
+  // Once sharing ends, each encoder runs at the target of its own channel.
+  EXPECT_CALL(*leader_encoder_ptr, OnReceivedUplinkBandwidth(32000, _));
+  EXPECT_CALL(*follower_encoder_ptr, OnReceivedUplinkBandwidth(20000, _));
+  EXPECT_TRUE(follower->SetSharedEncoderLeader(nullptr));
+  ::testing::Mock::VerifyAndClearExpectations(leader_encoder_ptr);
+  ::testing::Mock::VerifyAndClearExpectations(follower_encoder_ptr);
+}
+
+// A sending channel that doesn't share its encoder sets the bitrate without a
+// round trip through the encoder queue.
+TEST_F(ChannelSharedEncoderTest, UnsharedEncoderGetsBitrateDirectly) {
+  RtpCollector transport;
+  std::unique_ptr<NiceMock<MockAudioEncoder>> encoder = CreateMockEncoder();
+  NiceMock<MockAudioEncoder>* encoder_ptr = encoder.get();
+  Channel* channel = CreateSendChannel(1111, &transport, std::move(encoder));
+
+  EXPECT_CALL(*encoder_ptr, OnReceivedUplinkBandwidth(32000, _));
+  channel->SetBitRate(32000, 0);
+  ::testing::Mock::VerifyAndClearExpectations(encoder_ptr);
+}
+
+}  // namespace voe
+}  // namespace webrtc